@@ -0,0 +1,245 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <filesystem>
+#include <opencv2/core.hpp>
+
+#include "f2_io/dicom_reader.h"
+#include "f2_io/dataset_explorer.h"
+#include "utils/itk_opencv_bridge.h"
+#include "f3_preprocessing/denoising.h"
+#include "f3_preprocessing/preprocessing.h"
+
+// Macros para la ruta del proyecto
+#define GET_STR(x) #x
+#define GET_PROJECT_SOURCE_DIR(x) GET_STR(x)
+std::string projectPath = GET_PROJECT_SOURCE_DIR(PROJECT_SOURCE_DIR);
+
+// Ejecuta una función varias veces y devuelve el mejor tiempo (ms)
+double medirMejorTiempo(const std::function<void()>& fn, int repeticiones) {
+    double mejor = -1.0;
+    for (int r = 0; r < repeticiones; r++) {
+        auto inicio = std::chrono::high_resolution_clock::now();
+        fn();
+        auto fin = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(fin - inicio).count();
+        if (mejor < 0.0 || ms < mejor) mejor = ms;
+    }
+    return mejor;
+}
+
+// Diferencia máxima entre dos conjuntos de cortes
+double diferenciaMaxima(const std::vector<cv::Mat>& a, const std::vector<cv::Mat>& b) {
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        cv::Mat diff;
+        cv::absdiff(a[i], b[i], diff);
+        double minVal, maxVal;
+        cv::minMaxLoc(diff, &minVal, &maxVal);
+        maxDiff = std::max(maxDiff, maxVal);
+    }
+    return maxDiff;
+}
+
+void imprimirFila(const std::string& modo, double ms, size_t cortes, double maxDiff) {
+    std::cout << "  " << std::left << std::setw(28) << modo
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << ms << " ms"
+              << std::setw(10) << std::setprecision(2) << (cortes * 1000.0 / ms) << " cortes/s"
+              << std::setw(10) << std::setprecision(0) << maxDiff << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <carpeta_serie> [modelo.onnx] [max_cortes]" << std::endl;
+        return -1;
+    }
+
+    std::string folder = argv[1];
+    std::string modelPath = (argc > 2) ? argv[2] : projectPath + "/models/dncnn_grayscale.onnx";
+    size_t maxCortes = (argc > 3) ? static_cast<size_t>(std::stoi(argv[3])) : 32;
+
+    try {
+        // --- 1. CARGA DE CORTES ---
+        std::cout << "=== 1. CARGA DE CORTES ===" << std::endl;
+        auto files = DatasetExplorer::getDicomFileList(folder);
+        if (files.empty()) {
+            std::cerr << "No se encontraron archivos DICOM en " << folder << std::endl;
+            return -1;
+        }
+        if (files.size() > maxCortes) files.resize(maxCortes);
+
+        std::vector<cv::Mat> cortes;
+        for (const auto& file : files) {
+            cv::Mat imageHU = Bridge::itkToOpenCV(DicomIO::readDicomImage(file));
+            cortes.push_back(Bridge::normalize16to8bit(imageHU));
+        }
+        std::cout << cortes.size() << " cortes de " << cortes[0].cols << "x" << cortes[0].rows << std::endl;
+
+        // --- 2. MODELO ---
+        std::cout << "\n=== 2. MODELO ===" << std::endl;
+        Denoising::DnCNNDenoiser denoiser;
+        if (!denoiser.loadModel(modelPath)) {
+            std::cerr << "No se pudo cargar el modelo: " << modelPath << std::endl;
+            return -1;
+        }
+        std::cout << denoiser.getInfo() << std::endl;
+        denoiser.denoise(cortes[0]);  // Calentamiento
+
+        // --- 3. BENCHMARK ---
+        std::cout << "\n=== 3. BENCHMARK (mejor de 3) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(28) << "Modo"
+                  << std::right << std::setw(13) << "Tiempo" << std::setw(19) << "Rendimiento"
+                  << std::setw(10) << "MaxDiff" << std::endl;
+
+        // Referencia: un forward por corte
+        std::vector<cv::Mat> referencia(cortes.size());
+        double ms = medirMejorTiempo([&]() {
+            for (size_t i = 0; i < cortes.size(); i++) {
+                referencia[i] = denoiser.denoise(cortes[i]);
+            }
+        }, 3);
+        imprimirFila("Secuencial (" + Denoising::backendName(denoiser.getBackend()) + ")", ms, cortes.size(), 0.0);
+
+        // Mismo recorrido secuencial con cada backend disponible
+        std::vector<cv::Mat> salida(cortes.size());
+        const Denoising::InferenceBackend backendElegido = denoiser.getBackend();
+        for (Denoising::InferenceBackend backend : Denoising::getAvailableBackends()) {
+            if (backend == backendElegido || !denoiser.setBackend(backend)) continue;
+            denoiser.denoise(cortes[0]);  // Calentamiento
+            ms = medirMejorTiempo([&]() {
+                for (size_t i = 0; i < cortes.size(); i++) {
+                    salida[i] = denoiser.denoise(cortes[i]);
+                }
+            }, 3);
+            imprimirFila("Backend " + Denoising::backendName(backend), ms, cortes.size(),
+                         diferenciaMaxima(referencia, salida));
+        }
+        denoiser.setBackend(backendElegido);
+        
+        // Lotes NCHW con buffers de salida preasignados
+        for (int batch : {2, 4, 8, 16}) {
+            ms = medirMejorTiempo([&]() { denoiser.denoiseBatch(cortes, salida, batch); }, 3);
+            imprimirFila("Lotes de " + std::to_string(batch), ms, cortes.size(),
+                         diferenciaMaxima(referencia, salida));
+        }
+
+        // Cortes en paralelo: varios hilos llaman a denoise() con el pool de réplicas
+        int hilos = std::max(1, cv::getNumThreads());
+        denoiser.setParallelism(hilos, hilos);
+        ms = medirMejorTiempo([&]() {
+            std::atomic<size_t> siguiente(0);
+            auto trabajador = [&]() {
+                for (size_t i = siguiente++; i < cortes.size(); i = siguiente++) {
+                    salida[i] = denoiser.denoise(cortes[i]);
+                }
+            };
+            std::vector<std::thread> trabajadores;
+            for (int h = 1; h < hilos; h++) trabajadores.emplace_back(trabajador);
+            trabajador();
+            for (auto& t : trabajadores) t.join();
+        }, 3);
+        imprimirFila("Pool (" + std::to_string(hilos) + " hilos/réplicas)", ms, cortes.size(),
+                     diferenciaMaxima(referencia, salida));
+
+        // Teselas con halo, una réplica por hilo
+        for (int tile : {128, 256}) {
+            ms = medirMejorTiempo([&]() {
+                for (size_t i = 0; i < cortes.size(); i++) {
+                    salida[i] = denoiser.denoiseTiled(cortes[i], tile);
+                }
+            }, 3);
+            imprimirFila("Teselas de " + std::to_string(tile), ms, cortes.size(),
+                         diferenciaMaxima(referencia, salida));
+        }
+
+        // Caché en disco: segunda pasada sin inferencia
+        denoiser.enableCache((std::filesystem::temp_directory_path() / "dncnn_cache_benchmark").string());
+        for (size_t i = 0; i < cortes.size(); i++) denoiser.denoise(cortes[i]);
+        ms = medirMejorTiempo([&]() {
+            for (size_t i = 0; i < cortes.size(); i++) {
+                salida[i] = denoiser.denoise(cortes[i]);
+            }
+        }, 3);
+        imprimirFila("Caché en disco (aciertos)", ms, cortes.size(), diferenciaMaxima(referencia, salida));
+        denoiser.getCache()->clear();
+        denoiser.disableCache();
+
+        // --- 4. INT8 ---
+        // Calibrar con los cortes pares y validar con los impares
+        std::cout << "\n=== 4. INT8 (calibración y validación contra FP32) ===" << std::endl;
+        std::vector<cv::Mat> calibracion, validacion;
+        for (size_t i = 0; i < cortes.size(); i++) {
+            (i % 2 == 0 ? calibracion : validacion).push_back(cortes[i]);
+        }
+        Denoising::Int8Validation validacionInt8 = denoiser.enableInt8(calibracion, validacion);
+        if (denoiser.getBackend() == Denoising::InferenceBackend::NATIVE_INT8) {
+            denoiser.denoise(cortes[0]);  // Calentamiento
+            ms = medirMejorTiempo([&]() {
+                for (size_t i = 0; i < cortes.size(); i++) {
+                    salida[i] = denoiser.denoise(cortes[i]);
+                }
+            }, 3);
+            imprimirFila("Backend native_int8", ms, cortes.size(), diferenciaMaxima(referencia, salida));
+            denoiser.disableInt8();
+        } else if (validacionInt8.slices > 0) {
+            std::cout << "  INT8 descartado: PSNR min " << validacionInt8.minPSNR
+                      << " dB, SSIM min " << validacionInt8.minSSIM << std::endl;
+        }
+
+        // --- 5. POLÍTICA ADAPTATIVA ---
+        // Serie mixta: cortes impares con ruido añadido simulando baja dosis
+        std::cout << "\n=== 5. POLÍTICA ADAPTATIVA (dosis mixta) ===" << std::endl;
+        std::vector<cv::Mat> mixta(cortes.size());
+        cv::RNG rng(1234);
+        for (size_t i = 0; i < cortes.size(); i++) {
+            if (i % 2 == 0) {
+                mixta[i] = cortes[i];
+            } else {
+                cv::Mat ruido(cortes[i].size(), CV_16S);
+                rng.fill(ruido, cv::RNG::NORMAL, 0, 8);
+                cv::Mat ruidoso;
+                cv::add(cortes[i], ruido, ruidoso, cv::noArray(), CV_8U);
+                mixta[i] = ruidoso;
+            }
+        }
+
+        Preprocessing::DenoisePolicy siempreDnCNN;
+        siempreDnCNN.adaptive = false;
+        ms = medirMejorTiempo([&]() {
+            for (size_t i = 0; i < mixta.size(); i++) {
+                salida[i] = Preprocessing::preprocessCTImageWithDenoising(mixta[i], true, &denoiser, siempreDnCNN);
+            }
+        }, 3);
+        imprimirFila("Siempre DnCNN", ms, mixta.size(), 0.0);
+
+        int acciones[3] = {0, 0, 0};
+        ms = medirMejorTiempo([&]() {
+            acciones[0] = acciones[1] = acciones[2] = 0;
+            for (size_t i = 0; i < mixta.size(); i++) {
+                Preprocessing::DenoiseDecision decision;
+                salida[i] = Preprocessing::preprocessCTImageWithDenoising(mixta[i], true, &denoiser,
+                                                                         Preprocessing::DenoisePolicy(), &decision);
+                acciones[static_cast<int>(decision.action)]++;
+            }
+        }, 3);
+        imprimirFila("Política adaptativa", ms, mixta.size(), 0.0);
+        std::cout << "  Cortes: " << acciones[0] << " sin filtrar, " << acciones[1] << " filtro ligero, "
+                  << acciones[2] << " DnCNN" << std::endl;
+        for (size_t i = 0; i < std::min<size_t>(mixta.size(), 4); i++) {
+            std::cout << "  Corte " << i << ": sigma = " << std::setprecision(2)
+                      << Preprocessing::estimateNoiseSigma(mixta[i]).sigma << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "\nERROR: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <opencv2/core.hpp>
+
+#include "f2_io/dicom_reader.h"
+#include "f2_io/dataset_explorer.h"
+#include "utils/itk_opencv_bridge.h"
+#include "f3_preprocessing/preprocessing.h"
+
+// Benchmark de filtros que preservan bordes: cv::bilateralFilter (8-bit)
+// frente a la rejilla bilateral y el guided filter sobre HU, y coste por
+// iteración de la difusión anisotrópica
+// Uso: BenchmarkFilters <carpeta_serie> [max_cortes] [diametro] [sigma]
+
+// Ejecuta una función varias veces y devuelve el mejor tiempo (ms)
+double medirMejorTiempo(const std::function<void()>& fn, int repeticiones) {
+    double mejor = -1.0;
+    for (int r = 0; r < repeticiones; r++) {
+        auto inicio = std::chrono::high_resolution_clock::now();
+        fn();
+        auto fin = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(fin - inicio).count();
+        if (mejor < 0.0 || ms < mejor) mejor = ms;
+    }
+    return mejor;
+}
+
+// PSNR medio (8-bit) entre dos conjuntos de cortes
+double psnrMedio(const std::vector<cv::Mat>& a, const std::vector<cv::Mat>& b) {
+    double suma = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        suma += std::min(cv::PSNR(a[i], b[i]), 100.0);
+        n++;
+    }
+    return n > 0 ? suma / n : 0.0;
+}
+
+// Diferencia media absoluta (8-bit) entre dos conjuntos de cortes
+double diferenciaMedia(const std::vector<cv::Mat>& a, const std::vector<cv::Mat>& b) {
+    double suma = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        suma += cv::norm(a[i], b[i], cv::NORM_L1) / static_cast<double>(a[i].total());
+        n++;
+    }
+    return n > 0 ? suma / n : 0.0;
+}
+
+void imprimirFila(const std::string& modo, double ms, size_t cortes, double psnr, double diff) {
+    std::cout << "  " << std::left << std::setw(32) << modo
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << ms << " ms"
+              << std::setw(10) << std::setprecision(2) << (ms / cortes) << " ms/corte"
+              << std::setw(10) << std::setprecision(1) << psnr << " dB"
+              << std::setw(8) << std::setprecision(2) << diff << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <carpeta_serie> [max_cortes] [diametro] [sigma]" << std::endl;
+        return -1;
+    }
+
+    std::string folder = argv[1];
+    size_t maxCortes = (argc > 2) ? static_cast<size_t>(std::stoi(argv[2])) : 32;
+    int d = (argc > 3) ? std::stoi(argv[3]) : 9;
+    double sigma = (argc > 4) ? std::stod(argv[4]) : 75.0;
+
+    try {
+        // --- 1. CARGA DE CORTES ---
+        std::cout << "=== 1. CARGA DE CORTES ===" << std::endl;
+        auto files = DatasetExplorer::getDicomFileList(folder);
+        if (files.empty()) {
+            std::cerr << "No se encontraron archivos DICOM en " << folder << std::endl;
+            return -1;
+        }
+        if (files.size() > maxCortes) files.resize(maxCortes);
+
+        std::vector<cv::Mat> cortesHU;
+        std::vector<cv::Mat> cortes8;
+        std::vector<double> escalas;    // HU por nivel de 8 bits en cada corte
+        for (const auto& file : files) {
+            cv::Mat imageHU = Bridge::itkToOpenCV(DicomIO::readDicomImage(file));
+            double minVal, maxVal;
+            cv::minMaxLoc(imageHU, &minVal, &maxVal);
+            cortesHU.push_back(imageHU);
+            cortes8.push_back(Bridge::normalize16to8bit(imageHU));
+            escalas.push_back(std::max(1.0, (maxVal - minVal) / 255.0));
+        }
+        std::cout << cortesHU.size() << " cortes de " << cortesHU[0].cols << "x" << cortesHU[0].rows
+                  << " | d=" << d << " sigma=" << sigma << std::endl;
+
+        Preprocessing::EdgePreservingParams params = Preprocessing::mapBilateralSliders(d, sigma, escalas[0]);
+        std::cout << "Parámetros (primer corte): rejilla sigmaSpace=" << params.sigmaSpace
+                  << " sigmaRange=" << params.sigmaRange << " HU | guided r=" << params.radius
+                  << " eps=" << params.eps << std::endl;
+
+        // --- 2. BENCHMARK ---
+        std::cout << "\n=== 2. BENCHMARK (mejor de 3; calidad frente a cv::bilateralFilter) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(32) << "Método"
+                  << std::right << std::setw(13) << "Tiempo" << std::setw(19) << "Por corte"
+                  << std::setw(13) << "PSNR" << std::setw(8) << "MAE" << std::endl;
+
+        // Referencia: bilateral de OpenCV sobre 8-bit (lo que hace la GUI)
+        std::vector<cv::Mat> referencia(cortes8.size());
+        double ms = medirMejorTiempo([&]() {
+            for (size_t i = 0; i < cortes8.size(); i++) {
+                referencia[i] = Preprocessing::applyBilateralFilter(cortes8[i], d, sigma, sigma);
+            }
+        }, 3);
+        imprimirFila("cv::bilateralFilter (8-bit)", ms, cortes8.size(), 100.0, 0.0);
+
+        // Métodos O(N): 8-bit (comparación directa) y HU (lo que usa la GUI)
+        const Preprocessing::EdgePreservingMethod metodos[] = {
+            Preprocessing::EdgePreservingMethod::BILATERAL_GRID,
+            Preprocessing::EdgePreservingMethod::GUIDED
+        };
+        std::vector<cv::Mat> salida(cortes8.size());
+        for (Preprocessing::EdgePreservingMethod metodo : metodos) {
+            const std::string nombre = Preprocessing::edgePreservingMethodName(metodo);
+
+            ms = medirMejorTiempo([&]() {
+                for (size_t i = 0; i < cortes8.size(); i++) {
+                    salida[i] = Preprocessing::applyEdgePreservingFilter(cortes8[i], metodo, d, sigma);
+                }
+            }, 3);
+            imprimirFila(nombre + " (8-bit)", ms, cortes8.size(),
+                         psnrMedio(referencia, salida), diferenciaMedia(referencia, salida));
+
+            std::vector<cv::Mat> salidaHU(cortesHU.size());
+            ms = medirMejorTiempo([&]() {
+                for (size_t i = 0; i < cortesHU.size(); i++) {
+                    salidaHU[i] = Preprocessing::applyEdgePreservingFilter(cortesHU[i], metodo, d, sigma,
+                                                                           escalas[i]);
+                }
+            }, 3);
+            for (size_t i = 0; i < salidaHU.size(); i++) {
+                salida[i] = Bridge::normalize16to8bit(salidaHU[i]);
+            }
+            imprimirFila(nombre + " (HU)", ms, cortesHU.size(),
+                         psnrMedio(referencia, salida), diferenciaMedia(referencia, salida));
+        }
+
+        // --- 3. ESCALADO CON EL DIÁMETRO ---
+        std::cout << "\n=== 3. COSTE FRENTE AL DIÁMETRO (ms/corte, 8-bit) ===" << std::endl;
+        std::cout << "  " << std::setw(6) << "d" << std::setw(14) << "OpenCV"
+                  << std::setw(14) << "Rejilla" << std::setw(14) << "Guided" << std::endl;
+        for (int diametro : {5, 9, 15, 25}) {
+            double tiempos[3];
+            tiempos[0] = medirMejorTiempo([&]() {
+                Preprocessing::applyBilateralFilter(cortes8[0], diametro, sigma, sigma);
+            }, 3);
+            tiempos[1] = medirMejorTiempo([&]() {
+                Preprocessing::applyEdgePreservingFilter(cortes8[0], metodos[0], diametro, sigma);
+            }, 3);
+            tiempos[2] = medirMejorTiempo([&]() {
+                Preprocessing::applyEdgePreservingFilter(cortes8[0], metodos[1], diametro, sigma);
+            }, 3);
+            std::cout << "  " << std::setw(6) << diametro << std::fixed << std::setprecision(2)
+                      << std::setw(14) << tiempos[0] << std::setw(14) << tiempos[1]
+                      << std::setw(14) << tiempos[2] << std::endl;
+        }
+
+        // --- 4. DIFUSIÓN ANISOTRÓPICA ---
+        std::cout << "\n=== 4. DIFUSIÓN ANISOTRÓPICA SOBRE HU (coste por iteración) ===" << std::endl;
+        std::cout << "  " << std::left << std::setw(14) << "Conducción" << std::right << std::setw(8) << "Iter"
+                  << std::setw(14) << "ms/corte" << std::setw(16) << "ms/iteración" << std::setw(8) << "Bandas" << std::endl;
+        for (Preprocessing::ConductanceFunction conduccion : {Preprocessing::ConductanceFunction::EXPONENTIAL,
+                                                              Preprocessing::ConductanceFunction::QUADRATIC}) {
+            for (int iteraciones : {5, 10, 20}) {
+                Preprocessing::DiffusionParams difusion;
+                difusion.iterations = iteraciones;
+                difusion.conductance = conduccion;
+                Preprocessing::DiffusionStats stats;
+                double mejorPorIteracion = -1.0;
+                ms = medirMejorTiempo([&]() {
+                    Preprocessing::applyAnisotropicDiffusion(cortesHU[0], difusion, &stats);
+                    if (mejorPorIteracion < 0.0 || stats.msPerIteration < mejorPorIteracion) {
+                        mejorPorIteracion = stats.msPerIteration;
+                    }
+                }, 3);
+                std::cout << "  " << std::left << std::setw(14) << Preprocessing::conductanceName(conduccion)
+                          << std::right << std::setw(8) << iteraciones << std::fixed << std::setprecision(2)
+                          << std::setw(14) << ms << std::setw(16) << mejorPorIteracion
+                          << std::setw(8) << stats.bands << std::endl;
+            }
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
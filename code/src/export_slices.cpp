@@ -11,6 +11,7 @@
 #include "f2_io/dicom_reader.h"
 #include "utils/itk_opencv_bridge.h"
 #include "f6_visualization/visualization.h"
+#include "f3_preprocessing/slab_denoising.h"
 
 #define GET_STR(x) #x
 #define GET_PROJECT_SOURCE_DIR(x) GET_STR(x)
@@ -119,7 +120,24 @@ int main(int argc, char* argv[]) {
         }
     } else {
         std::cout << "Modo por defecto: Quarter Dose (QD)" << std::endl;
-        std::cout << "Uso: ./MyApp [fd|qd] para cambiar de dataset" << std::endl;
+        std::cout << "Uso: ./MyApp [fd|qd] [--slab <k>] [--nlm] para cambiar de dataset" << std::endl;
+    }
+
+    // Denoising 2.5D opcional con ±k cortes vecinos
+    int slabHalfWidth = 0;
+    Preprocessing::SlabParams slabParams;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--slab" && i + 1 < argc) {
+            slabHalfWidth = std::stoi(argv[++i]);
+        } else if (arg == "--nlm") {
+            slabParams.method = Preprocessing::SlabMethod::NLM;
+        }
+    }
+    if (slabHalfWidth > 0) {
+        slabParams.halfWidth = slabHalfWidth;
+        std::cout << "Denoising 2.5D: " << Preprocessing::slabMethodName(slabParams.method)
+                  << " con ±" << slabHalfWidth << " cortes" << std::endl;
     }
 
     try {
@@ -142,13 +160,28 @@ int main(int argc, char* argv[]) {
         
         int progressInterval = std::max(1, static_cast<int>(slices.size()) / 20);
         
+        // La losa recorre la serie en orden: cada archivo se lee una sola vez
+        Preprocessing::SlabDenoiser slab(static_cast<int>(slices.size()),
+            [&slices](int index) {
+                return Bridge::itkToOpenCV(DicomIO::readDicomImage(slices[index].filePath));
+            }, slabParams);
+        
         for (size_t i = 0; i < slices.size(); i++) {
             try {
-                // Leer imagen DICOM
-                DicomIO::ImagePointer itkImage = DicomIO::readDicomImage(slices[i].filePath);
-                
-                // Convertir a OpenCV
-                cv::Mat cvImage = Bridge::itkToOpenCV(itkImage);
+                cv::Mat cvImage;
+                if (slabHalfWidth > 0) {
+                    // Corte filtrado con sus vecinos (lectura a través del buffer circular)
+                    cvImage = slab.denoise(static_cast<int>(i));
+                    if (cvImage.empty()) {
+                        throw std::runtime_error("no se pudo filtrar la losa");
+                    }
+                } else {
+                    // Leer imagen DICOM
+                    DicomIO::ImagePointer itkImage = DicomIO::readDicomImage(slices[i].filePath);
+                    
+                    // Convertir a OpenCV
+                    cvImage = Bridge::itkToOpenCV(itkImage);
+                }
                 
                 // Normalizar a 8-bit para exportación
                 cv::Mat cvImage8bit = Bridge::normalize16to8bit(cvImage);
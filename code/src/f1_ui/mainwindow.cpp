@@ -1,6 +1,7 @@
 #include "f1_ui/mainwindow.h"
 #include "f2_io/dicom_reader.h"
 #include "utils/itk_opencv_bridge.h"
+#include "utils/stage_graph.h"
 #include "f3_preprocessing/preprocessing.h"
 #include "f3_preprocessing/denoising.h"
 #include "f4_segmentation/segmentation.h"
@@ -14,9 +15,345 @@
 #include <QMenu>
 #include <algorithm>
 #include <filesystem>
+#include <functional>
+#include <set>
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// Etapas del grafo de la interfaz (mismo orden que las llamadas a addStage)
+enum PipelineStage {
+    STAGE_SOURCE,
+    STAGE_SLAB,
+    STAGE_MEDIAN_HU,
+    STAGE_DIFFUSION,
+    STAGE_BILATERAL_HU,
+    STAGE_TO_8BIT,
+    STAGE_DNCNN,
+    STAGE_GAUSSIAN,
+    STAGE_MEDIAN,
+    STAGE_BILATERAL,
+    STAGE_CLAHE,
+    STAGE_PREPROCESSED,
+    STAGE_SEGMENTATION,
+    STAGE_MORPHOLOGY
+};
+
+// Resultado guardado de la etapa de segmentación
+struct SegmentationStageResult {
+    std::vector<Segmentation::SegmentedRegion> regions;  // Antes del refinamiento morfológico
+    cv::Mat mask;
+    cv::Mat overlay;
+};
+
+/**
+ * @brief Grafo F3 -> F4 -> F5: cada filtro es una etapa, así que mover un
+ *        slider solo recalcula esa etapa y las posteriores
+ */
+std::unique_ptr<Pipeline::StageGraph> createStageGraph()
+{
+    auto graph = std::make_unique<Pipeline::StageGraph>(4);
+    graph->addStage("Corte DICOM");
+    graph->addStage("Losa 2.5D", {STAGE_SOURCE});
+    graph->addStage("Mediana HU", {STAGE_SLAB});
+    graph->addStage("Difusión anisotrópica", {STAGE_MEDIAN_HU});
+    graph->addStage("Bilateral HU", {STAGE_DIFFUSION});
+    graph->addStage("Conversión a 8 bits", {STAGE_BILATERAL_HU});
+    graph->addStage("DnCNN", {STAGE_TO_8BIT});
+    graph->addStage("Gaussiano", {STAGE_TO_8BIT});
+    graph->addStage("Mediana", {STAGE_GAUSSIAN});
+    graph->addStage("Bilateral", {STAGE_MEDIAN});
+    graph->addStage("CLAHE", {STAGE_BILATERAL});
+    graph->addStage("Preprocesado", {STAGE_CLAHE});
+    graph->addStage("Segmentación", {STAGE_SOURCE, STAGE_PREPROCESSED});
+    graph->addStage("Morfología", {STAGE_SEGMENTATION});
+    return graph;
+}
+
+// Vista previa progresiva: tiempo sin cambios del slider antes de la pasada completa
+const int kPreviewSettleMs = 250;
+
+// Pasadas completas por encima de este tiempo usan vista previa a 1/4 (si no, a 1/2)
+const double kSlowFullPassMs = 150.0;
+
+// Etapas de la interfaz que un slider puede invalidar (se ejecutan en este orden)
+enum PipelinePass {
+    PASS_PREPROCESSING = 1,
+    PASS_SEGMENTATION = 2,
+    PASS_MORPHOLOGY = 4
+};
+
+/**
+ * @brief Kernel de la resolución completa llevado a la vista previa (impar, >= 1)
+ */
+int previewKernel(int size, int scale)
+{
+    int kernel = std::max(1, size / scale);
+    return kernel % 2 == 0 ? kernel + 1 : kernel;
+}
+
+/**
+ * @brief Resultado de la vista previa llevado al tamaño del corte para mostrarlo
+ */
+cv::Mat toFullResolution(const cv::Mat& image, const cv::Size& size, int interpolation)
+{
+    if (image.empty() || image.size() == size) {
+        return image;
+    }
+    cv::Mat full;
+    cv::resize(image, full, size, 0, 0, interpolation);
+    return full;
+}
+
+// Etiquetas de órgano en el mapa de la vista final (0 = fondo)
+enum OrganLabel {
+    ORGAN_LUNGS = 1,
+    ORGAN_BONES = 2,
+    ORGAN_AORTA = 3
+};
+
+/**
+ * @brief Vuelca las regiones de un órgano en el mapa de etiquetas
+ */
+void paintOrganLabel(cv::Mat& labels, const std::vector<Segmentation::SegmentedRegion>& regions, int label)
+{
+    for (const auto& region : regions) {
+        if (!region.mask.empty() && region.mask.size() == labels.size()) {
+            labels.setTo(label, region.mask);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Preprocesado (F3) de un corte: controles leídos en el hilo de la
+ *        interfaz y resultado, para poder ejecutarlo en otro hilo
+ */
+struct PreprocessingJob {
+    // Entrada
+    cv::Mat raw;                                    // Corte original (16-bit, resolución completa)
+    std::string path;
+    int sliceIndex = -1;
+    int scale = 1;                                  // 1 = resolución completa, 2 o 4 = vista previa
+    int generation = 0;                             // Corte al que pertenece (ver sliceGeneration)
+    Pipeline::StageGraph* graph = nullptr;
+    Preprocessing::SlabDenoiser* slab = nullptr;
+    Denoising::DnCNNDenoiser* dncnn = nullptr;      // nullptr = filtros tradicionales
+    
+    // Controles
+    bool slabEnabled = false;
+    Preprocessing::SlabParams slabParams;
+    bool medianOnHU = false;
+    bool medianEnabled = false;
+    int medianKernel = 5;
+    bool diffusionEnabled = false;
+    Preprocessing::DiffusionParams diffusion;
+    Preprocessing::EdgePreservingMethod bilateralMethod = Preprocessing::EdgePreservingMethod::BILATERAL_OPENCV;
+    bool bilateralEnabled = false;
+    bool bilateralOnHU = false;
+    int bilateralD = 9;
+    int bilateralSigma = 75;
+    bool claheEnabled = false;
+    bool claheOnHU = false;
+    double clipLimit = 2.0;
+    int tileSize = 8;
+    Preprocessing::HUClaheParams clahe;
+    std::string dncnnInfo;
+    bool dncnnInt8 = false;
+    bool gaussianEnabled = false;
+    int gaussianKernel = 5;
+    
+    // Salida
+    cv::Mat preprocessed;                           // A la resolución del trabajo
+    cv::Mat dncnnOutput;                            // Solo si se usó DnCNN
+    uint64_t key = 0;                               // Clave de la etapa de preprocesado
+    double elapsedMs = 0.0;
+};
+
+namespace {
+
+/**
+ * @brief Ejecuta las etapas F3 de un trabajo sobre su grafo
+ *
+ * No toca widgets ni el contexto del corte: solo el grafo, la losa y el
+ * denoiser del trabajo, que nadie más usa mientras se ejecuta.
+ */
+void runPreprocessingJob(PreprocessingJob& job)
+{
+    using Pipeline::ParamHash;
+    Pipeline::StageGraph& graph = *job.graph;
+    
+    cv::TickMeter totalTimer;
+    totalTimer.start();
+    
+    // En vista previa el corte entra reducido y los tamaños en píxeles se escalan
+    const int scale = job.scale;
+    graph.run<cv::Mat>(STAGE_SOURCE, ParamHash().add(job.path).add(job.sliceIndex).add(scale).value(),
+                       [&job, scale]() {
+        if (scale == 1) {
+            return job.raw;
+        }
+        cv::Mat reduced;
+        cv::resize(job.raw, reduced, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+        return reduced;
+    });
+    
+    // Etapa de imagen: si está desactivada reenvía su entrada, si no se
+    // ejecuta (o se recupera de la caché) con el hash de sus controles
+    auto imageStage = [&graph](int id, int input, bool enabled, const ParamHash& params,
+                               const std::function<cv::Mat(const cv::Mat&)>& filter) -> const cv::Mat& {
+        if (!enabled) {
+            return graph.forward<cv::Mat>(id, input);
+        }
+        return graph.run<cv::Mat>(id, params.value(), [&graph, input, &filter]() {
+            return filter(graph.value<cv::Mat>(input));
+        });
+    };
+    
+    // Filtros sobre HU y después normalización a 8-bit
+    const Preprocessing::SlabParams& slab = job.slabParams;
+    imageStage(STAGE_SLAB, STAGE_SOURCE, job.slabEnabled && job.slab,
+               ParamHash().add(slab.halfWidth).add(static_cast<int>(slab.method)),
+               [&](const cv::Mat& hu) {
+        job.slab->setParams(slab);
+        
+        // La losa se filtra a la escala del trabajo (vista previa incluida)
+        cv::TickMeter timer;
+        timer.start();
+        cv::Mat slabResult = job.slab->denoise(job.sliceIndex, scale);
+        timer.stop();
+        if (slabResult.empty()) {
+            return hu;
+        }
+        if (slabResult.size() != hu.size()) {
+            cv::resize(slabResult, slabResult, hu.size(), 0, 0, cv::INTER_AREA);
+        }
+        std::cout << Preprocessing::slabMethodName(slab.method) << " (±" << slab.halfWidth
+                  << " cortes, 1/" << scale << "): " << timer.getTimeMilli() << " ms, "
+                  << job.slab->getSlicesRead() << " cortes leídos en total" << std::endl;
+        return slabResult;
+    });
+    
+    imageStage(STAGE_MEDIAN_HU, STAGE_SLAB, job.medianOnHU, ParamHash().add(job.medianKernel),
+               [&](const cv::Mat& hu) {
+        return Preprocessing::applyMedianFilter(hu, job.medianKernel);
+    });
+    
+    const Preprocessing::DiffusionParams& diffusion = job.diffusion;
+    imageStage(STAGE_DIFFUSION, STAGE_MEDIAN_HU, job.diffusionEnabled,
+               ParamHash().add(diffusion.iterations).add(diffusion.kappa)
+                          .add(static_cast<int>(diffusion.conductance)),
+               [&](const cv::Mat& hu) {
+        Preprocessing::DiffusionStats diffusionStats;
+        cv::Mat result = Preprocessing::applyAnisotropicDiffusion(hu, diffusion, &diffusionStats);
+        std::cout << "Difusión anisotrópica (" << Preprocessing::conductanceName(diffusion.conductance)
+                  << "): " << diffusionStats.totalMs << " ms ("
+                  << diffusionStats.msPerIteration << " ms/iteración, "
+                  << diffusionStats.bands << " bandas)" << std::endl;
+        return result;
+    });
+    
+    imageStage(STAGE_BILATERAL_HU, STAGE_DIFFUSION, job.bilateralOnHU,
+               ParamHash().add(static_cast<int>(job.bilateralMethod)).add(job.bilateralD).add(job.bilateralSigma),
+               [&](const cv::Mat& hu) {
+        // Sigma del slider en niveles de 8 bits -> HU del corte (normalización min-max)
+        double minVal, maxVal;
+        cv::minMaxLoc(hu, &minVal, &maxVal);
+        double intensityScale = std::max(1.0, (maxVal - minVal) / 255.0);
+        
+        cv::TickMeter timer;
+        timer.start();
+        cv::Mat result = Preprocessing::applyEdgePreservingFilter(hu, job.bilateralMethod, job.bilateralD,
+                                                                  job.bilateralSigma, intensityScale);
+        timer.stop();
+        std::cout << Preprocessing::edgePreservingMethodName(job.bilateralMethod)
+                  << " sobre HU: " << timer.getTimeMilli() << " ms" << std::endl;
+        return result;
+    });
+    
+    // CLAHE sobre HU: la ventana sustituye a la normalización min-max
+    const Preprocessing::HUClaheParams& clahe = job.clahe;
+    ParamHash to8bitParams;
+    to8bitParams.add(job.claheOnHU);
+    if (job.claheOnHU) {
+        to8bitParams.add(clahe.window.low).add(clahe.window.high).add(clahe.bins)
+                    .add(clahe.clipLimit).add(job.tileSize);
+    }
+    imageStage(STAGE_TO_8BIT, STAGE_BILATERAL_HU, true, to8bitParams, [&](const cv::Mat& hu) {
+        if (!job.claheOnHU) {
+            return Bridge::normalize16to8bit(hu);
+        }
+        cv::TickMeter timer;
+        timer.start();
+        cv::Mat result = Preprocessing::applyCLAHEHU(hu, clahe);
+        timer.stop();
+        if (result.type() != CV_8U) {
+            // Parámetros rechazados: applyCLAHEHU devuelve la entrada en 16 bits
+            std::cerr << "CLAHE sobre HU no aplicado; se usa la normalización min-max" << std::endl;
+            return Bridge::normalize16to8bit(hu);
+        }
+        std::cout << "CLAHE sobre HU [" << clahe.window.low << ", " << clahe.window.high << "], "
+                  << clahe.bins << " bins: " << timer.getTimeMilli() << " ms" << std::endl;
+        return result;
+    });
+    
+    if (job.dncnn) {
+        // ===== OPCIÓN A: RED NEURONAL DnCNN =====
+        const cv::Mat& denoised = imageStage(STAGE_DNCNN, STAGE_TO_8BIT, true,
+                                             ParamHash().add(job.dncnnInfo).add(job.dncnnInt8),
+                                             [&](const cv::Mat& current) {
+            std::cout << "Aplicando DnCNN para denoising..." << std::endl;
+            
+            cv::TickMeter timer;
+            timer.start();
+            cv::Mat result = job.dncnn->denoise(current);
+            timer.stop();
+            std::cout << "  Tiempo DnCNN: " << timer.getTimeMilli() << " ms" << std::endl;
+            return result;
+        });
+        job.dncnnOutput = denoised;
+        job.preprocessed = graph.forward<cv::Mat>(STAGE_PREPROCESSED, STAGE_DNCNN);
+        
+    } else {
+        // ===== OPCIÓN B: FILTROS TRADICIONALES =====
+        
+        // 1. Filtro Gaussiano
+        imageStage(STAGE_GAUSSIAN, STAGE_TO_8BIT, job.gaussianEnabled,
+                   ParamHash().add(job.gaussianKernel), [&](const cv::Mat& current) {
+            return Preprocessing::applyGaussianBlur(current, job.gaussianKernel);
+        });
+        
+        // 2. Filtro Mediana (8-bit; la variante HU ya se aplicó)
+        imageStage(STAGE_MEDIAN, STAGE_GAUSSIAN, job.medianEnabled && !job.medianOnHU,
+                   ParamHash().add(job.medianKernel), [&](const cv::Mat& current) {
+            return Preprocessing::applyMedianFilter(current, job.medianKernel);
+        });
+        
+        // 3. Filtro Bilateral (8-bit; los métodos rápidos ya se aplicaron sobre HU)
+        imageStage(STAGE_BILATERAL, STAGE_MEDIAN, job.bilateralEnabled && !job.bilateralOnHU,
+                   ParamHash().add(job.bilateralD).add(job.bilateralSigma), [&](const cv::Mat& current) {
+            double sigma = job.bilateralSigma;
+            return Preprocessing::applyBilateralFilter(current, job.bilateralD, sigma, sigma);
+        });
+        
+        // 4. CLAHE (mejora de contraste; la variante HU ya se aplicó)
+        imageStage(STAGE_CLAHE, STAGE_BILATERAL, job.claheEnabled && !job.claheOnHU,
+                   ParamHash().add(job.clipLimit).add(job.tileSize), [&](const cv::Mat& current) {
+            return Preprocessing::applyCLAHE(current, job.clipLimit, cv::Size(job.tileSize, job.tileSize));
+        });
+        
+        job.preprocessed = graph.forward<cv::Mat>(STAGE_PREPROCESSED, STAGE_CLAHE);
+    }
+    job.key = graph.key(STAGE_PREPROCESSED);
+    
+    totalTimer.stop();
+    job.elapsedMs = totalTimer.getTimeMilli();
+}
+
+} // namespace
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , tabWidget(nullptr)
@@ -45,21 +382,38 @@ MainWindow::MainWindow(QWidget *parent)
     , checkMedian(nullptr)
     , sliderMedianKernel(nullptr)
     , lblMedianValue(nullptr)
+    , checkMedianHU(nullptr)
     , checkBilateral(nullptr)
+    , comboBilateralMethod(nullptr)
     , sliderBilateralD(nullptr)
     , sliderBilateralSigma(nullptr)
     , lblBilateralDValue(nullptr)
     , lblBilateralSigmaValue(nullptr)
+    , checkDiffusion(nullptr)
+    , comboDiffusionConductance(nullptr)
+    , sliderDiffusionIterations(nullptr)
+    , sliderDiffusionKappa(nullptr)
+    , lblDiffusionIterationsValue(nullptr)
+    , lblDiffusionKappaValue(nullptr)
+    , checkSlab(nullptr)
+    , comboSlabMethod(nullptr)
+    , sliderSlabHalfWidth(nullptr)
+    , lblSlabHalfWidthValue(nullptr)
     , checkCLAHE(nullptr)
     , sliderCLAHEClip(nullptr)
     , sliderCLAHETile(nullptr)
     , lblCLAHEClipValue(nullptr)
     , lblCLAHETileValue(nullptr)
+    , checkCLAHEHU(nullptr)
+    , spinCLAHEWindowLow(nullptr)
+    , spinCLAHEWindowHigh(nullptr)
+    , spinCLAHEBins(nullptr)
     , btnPresetLungs(nullptr)
     , btnPresetBones(nullptr)
     , btnPresetSoftTissue(nullptr)
     , btnResetFilters(nullptr)
     , checkDnCNN(nullptr)
+    , checkDnCNNInt8(nullptr)
     , lblDnCNNStatus(nullptr)
     , btnCompareWithDnCNN(nullptr)
     , imageSegBeforeLabel(nullptr)
@@ -123,37 +477,33 @@ MainWindow::MainWindow(QWidget *parent)
     , lblOpacityValue(nullptr)
     , btnSaveFinal(nullptr)
     , tableMetrics(nullptr)
+    , tableStageCache(nullptr)
     , lblHistogramROI(nullptr)
     , lblProcessTime(nullptr)
     , lblMemoryUsage(nullptr)
     , datasetLoaded(false)
     , currentSliceIndex(0)
+    , stageGraph(createStageGraph())
+    , previewSettleTimer(nullptr)
+    , previewScale(1)
+    , lastFullPassMs(0.0)
+    , pendingFullPasses(0)
+    , previewGraph(createStageGraph())
+    , fullPassThread(nullptr)
+    , sliceGeneration(0)
+    , modelLoaderThread(nullptr)
+    , int8CalibrationThread(nullptr)
 {
     setupUI();
     
-    // Inicializar DnCNN Denoiser
-    dncnnDenoiser = std::make_unique<Denoising::DnCNNDenoiser>();
-    std::string modelPath = "../models/dncnn_grayscale.onnx";
+    // Pasada a resolución completa cuando el slider deja de moverse
+    previewSettleTimer = new QTimer(this);
+    previewSettleTimer->setSingleShot(true);
+    previewSettleTimer->setInterval(kPreviewSettleMs);
+    connect(previewSettleTimer, &QTimer::timeout, this, &MainWindow::runFullResolutionPass);
     
-    if (dncnnDenoiser->loadModel(modelPath)) {
-        if (lblDnCNNStatus) {
-            lblDnCNNStatus->setText("Estado: Modelo cargado");
-            lblDnCNNStatus->setStyleSheet("QLabel { color: green; font-weight: bold; padding: 5px; }");
-        }
-        if (btnCompareWithDnCNN) {
-            btnCompareWithDnCNN->setEnabled(true);
-        }
-        std::cout << "✓ Modelo DnCNN cargado exitosamente desde: " << modelPath << std::endl;
-    } else {
-        if (lblDnCNNStatus) {
-            lblDnCNNStatus->setText("Estado: Modelo no encontrado");
-            lblDnCNNStatus->setStyleSheet("QLabel { color: red; font-weight: bold; padding: 5px; }");
-        }
-        if (checkDnCNN) {
-            checkDnCNN->setEnabled(false);
-        }
-        std::cerr << "✗ No se pudo cargar el modelo DnCNN desde: " << modelPath << std::endl;
-    }
+    // Cargar DnCNN en segundo plano: la ventana queda usable de inmediato
+    startModelLoading("../models/dncnn_grayscale.onnx");
     
     // Configurar tamaño inicial (80% de la pantalla)
     QScreen *screen = QApplication::primaryScreen();
@@ -175,9 +525,77 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // El hilo de carga escribe en pendingDenoiser: esperar a que termine
+    if (modelLoaderThread) {
+        modelLoaderThread->wait();
+    }
+    if (int8CalibrationThread) {
+        int8CalibrationThread->wait();
+    }
+    if (fullPassThread) {
+        fullPassThread->wait();
+    }
     // Los widgets Qt se limpian automáticamente por el sistema de padres
 }
 
+void MainWindow::startModelLoading(const std::string& modelPath)
+{
+    if (lblDnCNNStatus) {
+        lblDnCNNStatus->setText("Estado: Cargando modelo...");
+        lblDnCNNStatus->setStyleSheet("QLabel { color: #b8860b; font-weight: bold; padding: 5px; }");
+    }
+    if (checkDnCNN) {
+        checkDnCNN->setEnabled(false);
+    }
+    if (checkDnCNNInt8) {
+        checkDnCNNInt8->setEnabled(false);
+    }
+    
+    // Carga, caché y forward de calentamiento fuera del hilo de la interfaz
+    modelLoaderThread = QThread::create([this, modelPath]() {
+        auto denoiser = std::make_unique<Denoising::DnCNNDenoiser>();
+        if (denoiser->loadModel(modelPath)) {
+            // Volver a un corte ya visto (o reabrir el estudio) no repite la inferencia
+            denoiser->enableCache();
+            denoiser->warmUp();
+            pendingDenoiser = std::move(denoiser);
+        }
+    });
+    connect(modelLoaderThread, &QThread::finished, this, &MainWindow::onModelLoaded);
+    connect(modelLoaderThread, &QThread::finished, modelLoaderThread, &QObject::deleteLater);
+    modelLoaderThread->start();
+}
+
+void MainWindow::onModelLoaded()
+{
+    // Se ejecuta en el hilo de la interfaz (conexión en cola desde QThread::finished)
+    modelLoaderThread = nullptr;
+    dncnnDenoiser = std::move(pendingDenoiser);
+    
+    if (dncnnDenoiser && dncnnDenoiser->isLoaded()) {
+        if (lblDnCNNStatus) {
+            lblDnCNNStatus->setText("Estado: Modelo cargado");
+            lblDnCNNStatus->setStyleSheet("QLabel { color: green; font-weight: bold; padding: 5px; }");
+        }
+        if (checkDnCNN) {
+            checkDnCNN->setEnabled(true);
+        }
+        if (checkDnCNNInt8) {
+            checkDnCNNInt8->setEnabled(true);
+        }
+        if (btnCompareWithDnCNN) {
+            btnCompareWithDnCNN->setEnabled(true);
+        }
+        std::cout << "✓ Modelo DnCNN cargado en segundo plano" << std::endl;
+    } else {
+        if (lblDnCNNStatus) {
+            lblDnCNNStatus->setText("Estado: Modelo no encontrado");
+            lblDnCNNStatus->setStyleSheet("QLabel { color: red; font-weight: bold; padding: 5px; }");
+        }
+        std::cerr << "✗ No se pudo cargar el modelo DnCNN" << std::endl;
+    }
+}
+
 void MainWindow::setupUI()
 {
     setWindowTitle("Proyecto Visión por Computador - CT Low Dose Analysis");
@@ -541,6 +959,11 @@ QWidget* MainWindow::createPreprocessingTab()
     lblMedianValue->setMinimumWidth(30);
     medianLayout->addWidget(lblMedianValue);
     filtersLayout->addLayout(medianLayout);
+    checkMedianHU = new QCheckBox("Sobre HU (16-bit, sin normalizar antes)");
+    checkMedianHU->setToolTip("Mediana de tiempo constante sobre los HU originales; "
+                              "evita la pérdida de la normalización a 8 bits");
+    connect(checkMedianHU, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
+    filtersLayout->addWidget(checkMedianHU);
     filtersLayout->addSpacing(10);
     
     // Filtro Bilateral
@@ -548,6 +971,22 @@ QWidget* MainWindow::createPreprocessingTab()
     connect(checkBilateral, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
     filtersLayout->addWidget(checkBilateral);
     
+    QHBoxLayout *bilateralMethodLayout = new QHBoxLayout();
+    bilateralMethodLayout->addWidget(new QLabel("Método:"));
+    comboBilateralMethod = new QComboBox();
+    comboBilateralMethod->addItem("Bilateral OpenCV (8-bit)",
+                                  static_cast<int>(Preprocessing::EdgePreservingMethod::BILATERAL_OPENCV));
+    comboBilateralMethod->addItem("Rejilla bilateral (HU, rápido)",
+                                  static_cast<int>(Preprocessing::EdgePreservingMethod::BILATERAL_GRID));
+    comboBilateralMethod->addItem("Guided filter (HU, rápido)",
+                                  static_cast<int>(Preprocessing::EdgePreservingMethod::GUIDED));
+    comboBilateralMethod->setToolTip("Los métodos rápidos trabajan sobre los HU originales en O(N); "
+                                     "la sigma se escala al rango HU del corte");
+    connect(comboBilateralMethod, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onFilterChanged);
+    bilateralMethodLayout->addWidget(comboBilateralMethod);
+    filtersLayout->addLayout(bilateralMethodLayout);
+    
     QHBoxLayout *bilateralDLayout = new QHBoxLayout();
     bilateralDLayout->addWidget(new QLabel("Diámetro:"));
     sliderBilateralD = new QSlider(Qt::Horizontal);
@@ -575,6 +1014,82 @@ QWidget* MainWindow::createPreprocessingTab()
     filtersLayout->addLayout(bilateralSigmaLayout);
     filtersLayout->addSpacing(10);
     
+    // Difusión anisotrópica (Perona-Malik sobre HU)
+    checkDiffusion = new QCheckBox("Difusión Anisotrópica (HU)");
+    checkDiffusion->setToolTip("Perona-Malik sobre los HU originales; coste lineal en iteraciones");
+    connect(checkDiffusion, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
+    filtersLayout->addWidget(checkDiffusion);
+    
+    QHBoxLayout *diffusionConductanceLayout = new QHBoxLayout();
+    diffusionConductanceLayout->addWidget(new QLabel("Conducción:"));
+    comboDiffusionConductance = new QComboBox();
+    comboDiffusionConductance->addItem("Exponencial (bordes)",
+                                       static_cast<int>(Preprocessing::ConductanceFunction::EXPONENTIAL));
+    comboDiffusionConductance->addItem("Cuadrática (regiones)",
+                                       static_cast<int>(Preprocessing::ConductanceFunction::QUADRATIC));
+    connect(comboDiffusionConductance, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onFilterChanged);
+    diffusionConductanceLayout->addWidget(comboDiffusionConductance);
+    filtersLayout->addLayout(diffusionConductanceLayout);
+    
+    QHBoxLayout *diffusionIterLayout = new QHBoxLayout();
+    diffusionIterLayout->addWidget(new QLabel("Iteraciones:"));
+    sliderDiffusionIterations = new QSlider(Qt::Horizontal);
+    sliderDiffusionIterations->setMinimum(1);
+    sliderDiffusionIterations->setMaximum(50);
+    sliderDiffusionIterations->setValue(10);
+    connect(sliderDiffusionIterations, &QSlider::valueChanged, this, &MainWindow::onFilterChanged);
+    diffusionIterLayout->addWidget(sliderDiffusionIterations);
+    lblDiffusionIterationsValue = new QLabel("10");
+    lblDiffusionIterationsValue->setMinimumWidth(30);
+    diffusionIterLayout->addWidget(lblDiffusionIterationsValue);
+    filtersLayout->addLayout(diffusionIterLayout);
+    
+    QHBoxLayout *diffusionKappaLayout = new QHBoxLayout();
+    diffusionKappaLayout->addWidget(new QLabel("Kappa (HU):"));
+    sliderDiffusionKappa = new QSlider(Qt::Horizontal);
+    sliderDiffusionKappa->setMinimum(5);
+    sliderDiffusionKappa->setMaximum(200);
+    sliderDiffusionKappa->setValue(30);
+    connect(sliderDiffusionKappa, &QSlider::valueChanged, this, &MainWindow::onFilterChanged);
+    diffusionKappaLayout->addWidget(sliderDiffusionKappa);
+    lblDiffusionKappaValue = new QLabel("30");
+    lblDiffusionKappaValue->setMinimumWidth(30);
+    diffusionKappaLayout->addWidget(lblDiffusionKappaValue);
+    filtersLayout->addLayout(diffusionKappaLayout);
+    filtersLayout->addSpacing(10);
+    
+    // Denoising 2.5D con los cortes vecinos de la serie
+    checkSlab = new QCheckBox("Denoising 2.5D (cortes vecinos)");
+    checkSlab->setToolTip("Promedia con ±k cortes: el ruido apenas se correlaciona entre cortes "
+                          "y la anatomía sí");
+    connect(checkSlab, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
+    filtersLayout->addWidget(checkSlab);
+    
+    QHBoxLayout *slabMethodLayout = new QHBoxLayout();
+    slabMethodLayout->addWidget(new QLabel("Método:"));
+    comboSlabMethod = new QComboBox();
+    comboSlabMethod->addItem("Bilateral 3D", static_cast<int>(Preprocessing::SlabMethod::BILATERAL));
+    comboSlabMethod->addItem("NLM 2.5D", static_cast<int>(Preprocessing::SlabMethod::NLM));
+    connect(comboSlabMethod, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onFilterChanged);
+    slabMethodLayout->addWidget(comboSlabMethod);
+    filtersLayout->addLayout(slabMethodLayout);
+    
+    QHBoxLayout *slabHalfWidthLayout = new QHBoxLayout();
+    slabHalfWidthLayout->addWidget(new QLabel("Cortes (±k):"));
+    sliderSlabHalfWidth = new QSlider(Qt::Horizontal);
+    sliderSlabHalfWidth->setMinimum(1);
+    sliderSlabHalfWidth->setMaximum(4);
+    sliderSlabHalfWidth->setValue(2);
+    connect(sliderSlabHalfWidth, &QSlider::valueChanged, this, &MainWindow::onFilterChanged);
+    slabHalfWidthLayout->addWidget(sliderSlabHalfWidth);
+    lblSlabHalfWidthValue = new QLabel("2");
+    lblSlabHalfWidthValue->setMinimumWidth(30);
+    slabHalfWidthLayout->addWidget(lblSlabHalfWidthValue);
+    filtersLayout->addLayout(slabHalfWidthLayout);
+    filtersLayout->addSpacing(10);
+    
     // CLAHE (Mejora de Contraste)
     checkCLAHE = new QCheckBox("CLAHE (Mejora de Contraste)");
     connect(checkCLAHE, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
@@ -606,6 +1121,45 @@ QWidget* MainWindow::createPreprocessingTab()
     claheTileLayout->addWidget(lblCLAHETileValue);
     filtersLayout->addLayout(claheTileLayout);
     
+    checkCLAHEHU = new QCheckBox("Sobre HU (ventana, 16-bit)");
+    checkCLAHEHU->setToolTip("CLAHE directamente sobre los HU dentro de la ventana; sustituye a la "
+                             "normalización min-max y se aplica antes de los filtros de 8 bits");
+    connect(checkCLAHEHU, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
+    filtersLayout->addWidget(checkCLAHEHU);
+    
+    QHBoxLayout *claheWindowLayout = new QHBoxLayout();
+    claheWindowLayout->addWidget(new QLabel("Ventana HU:"));
+    spinCLAHEWindowLow = new QSpinBox();
+    spinCLAHEWindowLow->setRange(-1024, 3000);
+    spinCLAHEWindowLow->setValue(-1000);
+    connect(spinCLAHEWindowLow, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onFilterChanged);
+    claheWindowLayout->addWidget(spinCLAHEWindowLow);
+    spinCLAHEWindowHigh = new QSpinBox();
+    spinCLAHEWindowHigh->setRange(-1024, 3000);
+    spinCLAHEWindowHigh->setValue(1000);
+    connect(spinCLAHEWindowHigh, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onFilterChanged);
+    claheWindowLayout->addWidget(spinCLAHEWindowHigh);
+    // Límites cruzados: la ventana nunca queda vacía (low < high)
+    spinCLAHEWindowLow->setMaximum(spinCLAHEWindowHigh->value() - 1);
+    spinCLAHEWindowHigh->setMinimum(spinCLAHEWindowLow->value() + 1);
+    connect(spinCLAHEWindowLow, QOverload<int>::of(&QSpinBox::valueChanged), [this](int value) {
+        spinCLAHEWindowHigh->setMinimum(value + 1);
+    });
+    connect(spinCLAHEWindowHigh, QOverload<int>::of(&QSpinBox::valueChanged), [this](int value) {
+        spinCLAHEWindowLow->setMaximum(value - 1);
+    });
+    filtersLayout->addLayout(claheWindowLayout);
+    
+    QHBoxLayout *claheBinsLayout = new QHBoxLayout();
+    claheBinsLayout->addWidget(new QLabel("Bins:"));
+    spinCLAHEBins = new QSpinBox();
+    spinCLAHEBins->setRange(64, 4096);
+    spinCLAHEBins->setSingleStep(64);
+    spinCLAHEBins->setValue(1024);
+    connect(spinCLAHEBins, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onFilterChanged);
+    claheBinsLayout->addWidget(spinCLAHEBins);
+    filtersLayout->addLayout(claheBinsLayout);
+    
     controlLayout->addWidget(filtersGroup);
     
     // ========== GRUPO: RED NEURONAL DnCNN ==========
@@ -616,6 +1170,11 @@ QWidget* MainWindow::createPreprocessingTab()
     connect(checkDnCNN, &QCheckBox::stateChanged, this, &MainWindow::onFilterChanged);
     dncnnLayout->addWidget(checkDnCNN);
     
+    checkDnCNNInt8 = new QCheckBox("Modo INT8 (cuantizado, validado contra FP32)");
+    checkDnCNNInt8->setToolTip("Calibra con el corte actual y solo se activa si PSNR >= 40 dB y SSIM >= 0.98 frente a FP32");
+    connect(checkDnCNNInt8, &QCheckBox::toggled, this, &MainWindow::onDnCNNInt8Toggled);
+    dncnnLayout->addWidget(checkDnCNNInt8);
+    
     lblDnCNNStatus = new QLabel("Estado: Modelo no cargado");
     lblDnCNNStatus->setStyleSheet("QLabel { color: red; font-weight: bold; padding: 5px; }");
     dncnnLayout->addWidget(lblDnCNNStatus);
@@ -1350,6 +1909,21 @@ QWidget* MainWindow::createMetricsTab()
     
     mainLayout->addWidget(groupPerformance);
     
+    // Grupo 4: Caché de etapas (aciertos = etapas no recalculadas)
+    QGroupBox *groupStageCache = new QGroupBox("Caché de Etapas del Pipeline");
+    QVBoxLayout *cacheLayout = new QVBoxLayout(groupStageCache);
+    
+    tableStageCache = new QTableWidget();
+    tableStageCache->setColumnCount(6);
+    tableStageCache->setHorizontalHeaderLabels({"Etapa", "Aciertos", "Fallos", "Último (ms)", "Total (ms)", "Entradas"});
+    tableStageCache->horizontalHeader()->setStretchLastSection(true);
+    tableStageCache->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableStageCache->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableStageCache->setMinimumHeight(150);
+    cacheLayout->addWidget(tableStageCache);
+    
+    mainLayout->addWidget(groupStageCache);
+    
     mainLayout->addStretch();
     
     return metricsWidget;
@@ -1560,6 +2134,28 @@ void MainWindow::loadDatasetFiles(const QString& dirPath)
             return;
         }
         
+        // La pasada en curso usa la losa y el grafo de la serie anterior
+        waitForFullPass();
+        
+        // Losa para el denoising 2.5D: lee los vecinos bajo demanda. La vista
+        // previa tiene la suya para no compartirla con el hilo de la pasada completa
+        std::vector<std::string> files = dicomFiles;
+        Preprocessing::SlabDenoiser::SliceLoader loader = [files](int index) {
+            try {
+                return Bridge::itkToOpenCV(DicomIO::readDicomImage(files[index]));
+            } catch (const std::exception& e) {
+                std::cerr << "Error leyendo corte vecino: " << e.what() << std::endl;
+                return cv::Mat();
+            }
+        };
+        slabDenoiser = std::make_unique<Preprocessing::SlabDenoiser>(static_cast<int>(files.size()), loader);
+        previewSlabDenoiser = std::make_unique<Preprocessing::SlabDenoiser>(static_cast<int>(files.size()), loader);
+        
+        // Los resultados guardados de la serie anterior ya no sirven
+        stageGraph->clear();
+        stageGraph->resetStats();
+        previewGraph->clear();
+        
         // Actualizar UI
         datasetLoaded = true;
         actionExportSlices->setEnabled(true);
@@ -1624,6 +2220,19 @@ void MainWindow::loadSlice(int sliceIndex)
         sliceContext.pulmonesRegions.clear();
         sliceContext.huesosRegions.clear();
         sliceContext.aortaRegions.clear();
+        sliceContext.displayBase.release();
+        sliceContext.organLabels.release();
+        
+        // Las etapas derivadas se recalculan (o se recuperan de la caché) para este slice
+        sliceContext.preprocessed.release();
+        sliceContext.segmentationMask.release();
+        sliceContext.segmentationOriginal.release();
+        sliceContext.preprocessedKey = 0;
+        sliceContext.segmentationKey = 0;
+        sliceGeneration++;
+        previewSettleTimer->stop();
+        pendingFullPasses = 0;
+        runSourceStage();
         
         sliceContext.isValid = true;
         sliceContext.needsUpdate = true;
@@ -1759,59 +2368,120 @@ void MainWindow::applyPreprocessing()
         return;
     }
     
-    // Partir de la imagen normalizada a 8-bit
-    cv::Mat current = Bridge::normalize16to8bit(sliceContext.originalRaw);
+    if (previewScale > 1) {
+        // Vista previa: en este hilo, con su propio grafo y su propia losa
+        bool useDnCNN = checkDnCNN && checkDnCNN->isChecked() &&
+                        dncnnDenoiser && dncnnDenoiser->isLoaded();
+        if (useDnCNN && fullPassThread) {
+            // El denoiser lo está usando la pasada completa: se repite al terminar
+            pendingFullPasses |= PASS_PREPROCESSING;
+            return;
+        }
+        std::shared_ptr<PreprocessingJob> job =
+            createPreprocessingJob(previewScale, previewGraph.get(), previewSlabDenoiser.get());
+        try {
+            runPreprocessingJob(*job);
+        } catch (const std::exception& e) {
+            std::cerr << "Error en la vista previa del preprocesado: " << e.what() << std::endl;
+            return;
+        }
+        applyPreprocessingJob(*job);
+        return;
+    }
+    
+    if (fullPassThread) {
+        // Se repite con los controles actuales cuando termine la pasada en curso
+        pendingFullPasses |= PASS_PREPROCESSING;
+        return;
+    }
+    startFullPreprocessing();
+}
+
+std::shared_ptr<PreprocessingJob> MainWindow::createPreprocessingJob(int scale, Pipeline::StageGraph* graph,
+                                                                     Preprocessing::SlabDenoiser* slab)
+{
+    auto job = std::make_shared<PreprocessingJob>();
+    job->raw = sliceContext.originalRaw;
+    if (currentSliceIndex >= 0 && currentSliceIndex < static_cast<int>(dicomFiles.size())) {
+        job->path = dicomFiles[currentSliceIndex];
+    }
+    job->sliceIndex = currentSliceIndex;
+    job->scale = scale;
+    job->generation = sliceGeneration;
+    job->graph = graph;
+    job->slab = slab;
+    
+    // La mediana sobre HU se aplica antes de normalizar a 8-bit
+    job->medianEnabled = checkMedian && checkMedian->isChecked();
+    job->medianOnHU = job->medianEnabled && checkMedianHU && checkMedianHU->isChecked();
+    job->medianKernel = previewKernel(sliderMedianKernel ? sliderMedianKernel->value() : 5, scale);
+    
+    // Rejilla bilateral / guided filter también trabajan sobre HU
+    if (comboBilateralMethod) {
+        job->bilateralMethod = static_cast<Preprocessing::EdgePreservingMethod>(
+            comboBilateralMethod->currentData().toInt());
+    }
+    job->bilateralEnabled = checkBilateral && checkBilateral->isChecked();
+    job->bilateralOnHU = job->bilateralEnabled &&
+                         job->bilateralMethod != Preprocessing::EdgePreservingMethod::BILATERAL_OPENCV;
+    job->bilateralD = std::max(1, (sliderBilateralD ? sliderBilateralD->value() : 9) / scale);
+    job->bilateralSigma = sliderBilateralSigma ? sliderBilateralSigma->value() : 75;
+    
+    // La losa usa los parámetros por defecto salvo la anchura y el método
+    job->slabEnabled = checkSlab && checkSlab->isChecked() && slab;
+    if (job->slabEnabled) {
+        job->slabParams.halfWidth = sliderSlabHalfWidth->value();
+        job->slabParams.method = static_cast<Preprocessing::SlabMethod>(comboSlabMethod->currentData().toInt());
+    }
+    
+    job->diffusionEnabled = checkDiffusion && checkDiffusion->isChecked();
+    if (job->diffusionEnabled) {
+        // La difusión avanza ~sqrt(iteraciones) píxeles: menos iteraciones en la vista previa
+        job->diffusion.iterations = std::max(1, sliderDiffusionIterations->value() / (scale * scale));
+        job->diffusion.kappa = sliderDiffusionKappa->value();
+        job->diffusion.conductance = static_cast<Preprocessing::ConductanceFunction>(
+            comboDiffusionConductance->currentData().toInt());
+    }
     
     // DECISIÓN: ¿Usar DnCNN o filtros tradicionales?
     bool useDnCNN = checkDnCNN && checkDnCNN->isChecked() && 
                     dncnnDenoiser && dncnnDenoiser->isLoaded();
-    
     if (useDnCNN) {
-        // ===== OPCIÓN A: RED NEURONAL DnCNN =====
-        std::cout << "Aplicando DnCNN para denoising..." << std::endl;
-        
-        cv::TickMeter timer;
-        timer.start();
-        
-        sliceContext.preprocessedDnCNN = dncnnDenoiser->denoise(current);
-        sliceContext.preprocessed = sliceContext.preprocessedDnCNN.clone();
-        
-        timer.stop();
-        std::cout << "  Tiempo DnCNN: " << timer.getTimeMilli() << " ms" << std::endl;
-        
-    } else {
-        // ===== OPCIÓN B: FILTROS TRADICIONALES =====
-        
-        // 1. Filtro Gaussiano
-        if (checkGaussian && checkGaussian->isChecked()) {
-            int kernelSize = sliderGaussianKernel->value();
-            if (kernelSize % 2 == 0) kernelSize++;
-            current = Preprocessing::applyGaussianBlur(current, kernelSize);
-        }
-        
-        // 2. Filtro Mediana
-        if (checkMedian && checkMedian->isChecked()) {
-            int kernelSize = sliderMedianKernel->value();
-            if (kernelSize % 2 == 0) kernelSize++;
-            current = Preprocessing::applyMedianFilter(current, kernelSize);
-        }
-        
-        // 3. Filtro Bilateral
-        if (checkBilateral && checkBilateral->isChecked()) {
-            int d = sliderBilateralD->value();
-            double sigma = sliderBilateralSigma->value();
-            current = Preprocessing::applyBilateralFilter(current, d, sigma, sigma);
-        }
-        
-        // 4. CLAHE (mejora de contraste)
-        if (checkCLAHE && checkCLAHE->isChecked()) {
-            double clipLimit = sliderCLAHEClip->value() / 10.0;
-            int tileSize = sliderCLAHETile->value();
-            current = Preprocessing::applyCLAHE(current, clipLimit, cv::Size(tileSize, tileSize));
-        }
-        
-        sliceContext.preprocessed = current;
+        job->dncnn = dncnnDenoiser.get();
+        job->dncnnInfo = dncnnDenoiser->getInfo();
+        job->dncnnInt8 = checkDnCNNInt8 && checkDnCNNInt8->isChecked();
+    }
+    
+    // CLAHE sobre HU: la ventana sustituye a la normalización min-max
+    job->claheEnabled = checkCLAHE && checkCLAHE->isChecked();
+    job->claheOnHU = !useDnCNN && job->claheEnabled && checkCLAHEHU && checkCLAHEHU->isChecked();
+    job->clipLimit = sliderCLAHEClip ? sliderCLAHEClip->value() / 10.0 : 2.0;
+    job->tileSize = sliderCLAHETile ? sliderCLAHETile->value() : 8;
+    if (job->claheOnHU) {
+        job->clahe.window.low = spinCLAHEWindowLow->value();
+        job->clahe.window.high = spinCLAHEWindowHigh->value();
+        job->clahe.bins = spinCLAHEBins->value();
+        job->clahe.clipLimit = job->clipLimit;
+        job->clahe.tileGrid = cv::Size(job->tileSize, job->tileSize);
+    }
+    
+    job->gaussianEnabled = checkGaussian && checkGaussian->isChecked();
+    job->gaussianKernel = previewKernel(sliderGaussianKernel ? sliderGaussianKernel->value() : 5, scale);
+    return job;
+}
+
+void MainWindow::applyPreprocessingJob(const PreprocessingJob& job)
+{
+    if (job.preprocessed.empty()) {
+        return;
+    }
+    
+    if (job.scale == 1 && !job.dncnnOutput.empty()) {
+        sliceContext.preprocessedDnCNN = job.dncnnOutput;
     }
+    sliceContext.preprocessed = toFullResolution(job.preprocessed, sliceContext.originalRaw.size(),
+                                                 cv::INTER_LINEAR);
+    sliceContext.preprocessedKey = job.key;
     
     // Actualizar la visualización
     updatePreprocessingDisplay();
@@ -1866,6 +2536,18 @@ void MainWindow::onFilterChanged()
         lblBilateralSigmaValue->setText(QString::number(sliderBilateralSigma->value()));
     }
     
+    if (lblDiffusionIterationsValue) {
+        lblDiffusionIterationsValue->setText(QString::number(sliderDiffusionIterations->value()));
+    }
+    
+    if (lblDiffusionKappaValue) {
+        lblDiffusionKappaValue->setText(QString::number(sliderDiffusionKappa->value()));
+    }
+    
+    if (lblSlabHalfWidthValue) {
+        lblSlabHalfWidthValue->setText(QString::number(sliderSlabHalfWidth->value()));
+    }
+    
     if (lblCLAHEClipValue) {
         double val = sliderCLAHEClip->value() / 10.0;
         lblCLAHEClipValue->setText(QString::number(val, 'f', 1));
@@ -1877,7 +2559,7 @@ void MainWindow::onFilterChanged()
     
     // Aplicar preprocesamiento si hay datos cargados
     if (datasetLoaded && sliceContext.isValid) {
-        applyPreprocessing();
+        requestPasses(PASS_PREPROCESSING);
     }
 }
 
@@ -1892,7 +2574,10 @@ void MainWindow::onPresetLungs()
     if (checkGaussian) checkGaussian->setChecked(false);
     if (checkMedian) checkMedian->setChecked(false);
     if (checkBilateral) checkBilateral->setChecked(false);
+    if (checkDiffusion) checkDiffusion->setChecked(false);
+    if (checkSlab) checkSlab->setChecked(false);
     if (checkCLAHE) checkCLAHE->setChecked(false);
+    if (checkCLAHEHU) checkCLAHEHU->setChecked(false);
     if (checkDnCNN) checkDnCNN->setChecked(false);
     
     // Configuración óptima para pulmones:
@@ -1921,7 +2606,10 @@ void MainWindow::onPresetBones()
     if (checkGaussian) checkGaussian->setChecked(false);
     if (checkMedian) checkMedian->setChecked(false);
     if (checkBilateral) checkBilateral->setChecked(false);
+    if (checkDiffusion) checkDiffusion->setChecked(false);
+    if (checkSlab) checkSlab->setChecked(false);
     if (checkCLAHE) checkCLAHE->setChecked(false);
+    if (checkCLAHEHU) checkCLAHEHU->setChecked(false);
     if (checkDnCNN) checkDnCNN->setChecked(false);
     
     // Configuración óptima para huesos:
@@ -1956,7 +2644,10 @@ void MainWindow::onPresetSoftTissue()
     if (checkGaussian) checkGaussian->setChecked(false);
     if (checkMedian) checkMedian->setChecked(false);
     if (checkBilateral) checkBilateral->setChecked(false);
+    if (checkDiffusion) checkDiffusion->setChecked(false);
+    if (checkSlab) checkSlab->setChecked(false);
     if (checkCLAHE) checkCLAHE->setChecked(false);
+    if (checkCLAHEHU) checkCLAHEHU->setChecked(false);
     if (checkDnCNN) checkDnCNN->setChecked(false);
     
     // Configuración óptima para arterias/aorta:
@@ -1984,16 +2675,29 @@ void MainWindow::onResetFilters()
     // Desactivar todos los checkboxes
     if (checkGaussian) checkGaussian->setChecked(false);
     if (checkMedian) checkMedian->setChecked(false);
+    if (checkMedianHU) checkMedianHU->setChecked(false);
     if (checkBilateral) checkBilateral->setChecked(false);
+    if (checkDiffusion) checkDiffusion->setChecked(false);
+    if (checkSlab) checkSlab->setChecked(false);
     if (checkCLAHE) checkCLAHE->setChecked(false);
+    if (checkCLAHEHU) checkCLAHEHU->setChecked(false);
     
     // Resetear sliders a valores por defecto
     if (sliderGaussianKernel) sliderGaussianKernel->setValue(5);
     if (sliderMedianKernel) sliderMedianKernel->setValue(5);
+    if (comboBilateralMethod) comboBilateralMethod->setCurrentIndex(0);
+    if (comboDiffusionConductance) comboDiffusionConductance->setCurrentIndex(0);
+    if (sliderDiffusionIterations) sliderDiffusionIterations->setValue(10);
+    if (sliderDiffusionKappa) sliderDiffusionKappa->setValue(30);
+    if (comboSlabMethod) comboSlabMethod->setCurrentIndex(0);
+    if (sliderSlabHalfWidth) sliderSlabHalfWidth->setValue(2);
     if (sliderBilateralD) sliderBilateralD->setValue(9);
     if (sliderBilateralSigma) sliderBilateralSigma->setValue(75);
     if (sliderCLAHEClip) sliderCLAHEClip->setValue(20);
     if (sliderCLAHETile) sliderCLAHETile->setValue(8);
+    if (spinCLAHEWindowLow) spinCLAHEWindowLow->setValue(-1000);
+    if (spinCLAHEWindowHigh) spinCLAHEWindowHigh->setValue(1000);
+    if (spinCLAHEBins) spinCLAHEBins->setValue(1024);
     
     blockSignals(prevState);
     
@@ -2003,6 +2707,130 @@ void MainWindow::onResetFilters()
     lblStatus->setText("Filtros reseteados a valores por defecto");
 }
 
+void MainWindow::onDnCNNInt8Toggled(bool checked)
+{
+    if (!dncnnDenoiser || !dncnnDenoiser->isLoaded()) {
+        return;
+    }
+    // La pasada completa en curso puede estar usando el denoiser
+    waitForFullPass();
+    
+    if (!checked) {
+        dncnnDenoiser->disableInt8();
+        lblDnCNNStatus->setText("Estado: Modelo cargado");
+        lblDnCNNStatus->setStyleSheet("QLabel { color: green; font-weight: bold; padding: 5px; }");
+        applyPreprocessing();
+        return;
+    }
+    
+    if (!sliceContext.isValid || sliceContext.originalRaw.empty()) {
+        QMessageBox::warning(this, "Error", 
+            "Cargue un corte para calibrar el modo INT8.");
+        checkDnCNNInt8->setChecked(false);
+        return;
+    }
+    
+    // Calibrar con el corte actual (misma entrada que applyPreprocessing) y con
+    // cortes repartidos por la serie; validar con cortes vecinos que no
+    // intervienen en la calibración
+    std::vector<cv::Mat> calibrationSlices = { Bridge::normalize16to8bit(sliceContext.originalRaw) };
+    const int numFiles = static_cast<int>(dicomFiles.size());
+    std::set<int> usedIndices = { currentSliceIndex };
+    std::vector<std::string> validationFiles;
+    for (int offset : {-4, -2, 2, 4, -1, 1}) {
+        int index = currentSliceIndex + offset;
+        if (index >= 0 && index < numFiles && validationFiles.size() < 4) {
+            validationFiles.push_back(dicomFiles[index]);
+            usedIndices.insert(index);
+        }
+    }
+    const int spreadSlices = 7;
+    std::vector<std::string> calibrationFiles;
+    for (int i = 0; i < spreadSlices; i++) {
+        const int index = static_cast<int>((i + 0.5) * numFiles / spreadSlices);
+        if (index < numFiles && usedIndices.insert(index).second) {
+            calibrationFiles.push_back(dicomFiles[index]);
+        }
+    }
+    if (validationFiles.empty()) {
+        QMessageBox::warning(this, "INT8 no activado",
+            "Se necesitan cortes vecinos en la serie para validar el modo INT8.");
+        checkDnCNNInt8->blockSignals(true);
+        checkDnCNNInt8->setChecked(false);
+        checkDnCNNInt8->blockSignals(false);
+        return;
+    }
+    
+    // El hilo de calibración es el dueño del denoiser hasta que termina: mientras
+    // tanto applyPreprocessing no usa DnCNN
+    pendingDenoiser = std::move(dncnnDenoiser);
+    checkDnCNN->setEnabled(false);
+    checkDnCNNInt8->setEnabled(false);
+    lblDnCNNStatus->setText("Estado: Calibrando INT8...");
+    lblDnCNNStatus->setStyleSheet("QLabel { color: #b8860b; font-weight: bold; padding: 5px; }");
+    
+    auto validation = std::make_shared<Denoising::Int8Validation>();
+    int8CalibrationThread = QThread::create([this, validation, calibrationSlices, calibrationFiles, validationFiles]() {
+        auto readSlices = [](const std::vector<std::string>& files, std::vector<cv::Mat>& out) {
+            for (const std::string& file : files) {
+                try {
+                    cv::Mat raw = Bridge::itkToOpenCV(DicomIO::readDicomImage(file));
+                    if (!raw.empty()) {
+                        out.push_back(Bridge::normalize16to8bit(raw));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Error al leer corte INT8 " << file << ": " << e.what() << std::endl;
+                }
+            }
+        };
+        std::vector<cv::Mat> calibration = calibrationSlices;
+        readSlices(calibrationFiles, calibration);
+        std::vector<cv::Mat> validationSlices;
+        readSlices(validationFiles, validationSlices);
+        if (validationSlices.empty()) {
+            std::cerr << "Error: No se pudo leer ningún corte de validación INT8" << std::endl;
+            return;
+        }
+        *validation = pendingDenoiser->enableInt8(calibration, validationSlices);
+    });
+    connect(int8CalibrationThread, &QThread::finished, this, [this, validation]() {
+        onInt8CalibrationFinished(*validation);
+    });
+    connect(int8CalibrationThread, &QThread::finished, int8CalibrationThread, &QObject::deleteLater);
+    int8CalibrationThread->start();
+}
+
+void MainWindow::onInt8CalibrationFinished(const Denoising::Int8Validation& validation)
+{
+    // Se ejecuta en el hilo de la interfaz (conexión en cola desde QThread::finished)
+    int8CalibrationThread = nullptr;
+    dncnnDenoiser = std::move(pendingDenoiser);
+    checkDnCNN->setEnabled(true);
+    checkDnCNNInt8->setEnabled(true);
+    
+    if (!validation.passed) {
+        lblDnCNNStatus->setText("Estado: Modelo cargado");
+        lblDnCNNStatus->setStyleSheet("QLabel { color: green; font-weight: bold; padding: 5px; }");
+        QMessageBox::warning(this, "INT8 no activado",
+            QString("La salida INT8 difiere demasiado de FP32 en %1 cortes vecinos:<br>"
+                    "PSNR: %2 dB<br>SSIM: %3")
+                .arg(validation.slices)
+                .arg(validation.minPSNR, 0, 'f', 2)
+                .arg(validation.minSSIM, 0, 'f', 4));
+        checkDnCNNInt8->blockSignals(true);
+        checkDnCNNInt8->setChecked(false);
+        checkDnCNNInt8->blockSignals(false);
+        applyPreprocessing();
+        return;
+    }
+    
+    lblDnCNNStatus->setText(QString("Estado: INT8 activo (PSNR %1 dB, SSIM %2)")
+                                .arg(validation.minPSNR, 0, 'f', 1)
+                                .arg(validation.minSSIM, 0, 'f', 3));
+    lblDnCNNStatus->setStyleSheet("QLabel { color: green; font-weight: bold; padding: 5px; }");
+    applyPreprocessing();
+}
+
 void MainWindow::onCompareWithDnCNN()
 {
     if (!sliceContext.isValid || sliceContext.originalRaw.empty()) {
@@ -2017,6 +2845,12 @@ void MainWindow::onCompareWithDnCNN()
         return;
     }
     
+    // La pasada completa en curso puede estar usando el denoiser; su
+    // resultado se aplica igualmente al llegar la señal finished
+    if (fullPassThread) {
+        fullPassThread->wait();
+    }
+    
     // Obtener imagen original normalizada
     cv::Mat original8bit = Bridge::normalize16to8bit(sliceContext.originalRaw);
     
@@ -2072,18 +2906,15 @@ void MainWindow::applySegmentation()
     if (!sliceContext.isValid || sliceContext.originalRaw.empty()) {
         return;
     }
-    
-    // Usar la imagen preprocesada si existe, sino usar la original normalizada
-    cv::Mat sourceImage;
-    if (!sliceContext.preprocessed.empty()) {
-        sourceImage = sliceContext.preprocessed.clone();
-    } else {
-        sourceImage = Bridge::normalize16to8bit(sliceContext.originalRaw);
+    if (previewScale == 1 && fullPassThread) {
+        // Parte del preprocesado en curso: se ejecuta cuando termine
+        pendingFullPasses |= PASS_SEGMENTATION;
+        return;
+    }
+    Pipeline::StageGraph* graph = activeGraph();
+    if (!graph) {
+        return;
     }
-    
-    // Necesitamos trabajar con la imagen original en HU para umbralización correcta
-    // Pero mostraremos usando la preprocesada si existe
-    cv::Mat imageForSegmentation = sliceContext.originalRaw.clone();
     
     // Obtener parámetros de segmentación
     int minHU = sliderMinHU->value();
@@ -2091,203 +2922,273 @@ void MainWindow::applySegmentation()
     int minArea = sliderMinArea->value();
     int maxArea = sliderMaxArea->value();
     
-    // Crear parámetros de segmentación
-    Segmentation::SegmentationParams params;
-    params.minHU = minHU;
-    params.maxHU = maxHU;
-    params.minArea = minArea;
-    params.maxArea = maxArea;
-    params.visualColor = cv::Scalar(255, 0, 0); // Azul por defecto
+    // Determinar tipo de órgano según rango HU (usar variables ya declaradas)
+    bool esPulmones = (minHU <= -400 && maxHU <= -100);  // Aire/pulmones: [-1000, -400]
+    bool esAorta = (minHU >= 20 && maxHU <= 150);        // Vasos con contraste: [30, 120]
+    bool esHuesos = (minHU >= 150);                      // Huesos: [200, 1000]
     
-    // Segmentar
-    auto regions = Segmentation::segmentOrgan(imageForSegmentation, params, "Region");
+    // IMPORTANTE: Si ya existen regiones clasificadas de huesos (del pipeline especializado),
+    // preservar esa clasificación en lugar de sobrescribirla con etiquetas genéricas
+    bool preservarClasificacionHuesos = esHuesos && !sliceContext.huesosRegions.empty() &&
+                                        (sliceContext.huesosRegions[0].label.find("Columna") != std::string::npos ||
+                                         sliceContext.huesosRegions[0].label.find("Costilla") != std::string::npos);
     
-    // Filtrar regiones que tocan el borde si está activado
-    if (checkFilterBorder && checkFilterBorder->isChecked()) {
-        std::vector<Segmentation::SegmentedRegion> filteredRegions;
-        for (const auto& region : regions) {
-            bool touchesBorder = (region.boundingBox.x <= 1 || 
-                                 region.boundingBox.y <= 1 || 
-                                 (region.boundingBox.x + region.boundingBox.width) >= imageForSegmentation.cols - 1 || 
-                                 (region.boundingBox.y + region.boundingBox.height) >= imageForSegmentation.rows - 1);
-            
-            if (!touchesBorder) {
-                filteredRegions.push_back(region);
-            }
+    // Clave de la etapa: controles de la pestaña, si hay imagen preprocesada
+    // (sus claves ya son entradas de la etapa) y la clasificación preservada
+    Pipeline::ParamHash segParams;
+    segParams.add(minHU).add(maxHU).add(minArea).add(maxArea)
+             .add(checkFilterBorder && checkFilterBorder->isChecked())
+             .add(checkShowOverlay && checkShowOverlay->isChecked())
+             .add(checkShowContours && checkShowContours->isChecked())
+             .add(checkShowLabels && checkShowLabels->isChecked())
+             .add(sliceContext.preprocessedKey)
+             .add(preservarClasificacionHuesos);
+    if (preservarClasificacionHuesos) {
+        for (const auto& region : sliceContext.huesosRegions) {
+            segParams.add(region.label).add(region.area).add(region.centroid.x).add(region.centroid.y);
         }
-        regions = filteredRegions;
     }
     
-    // Ordenar por área (mayor a menor)
-    std::sort(regions.begin(), regions.end(), 
-              [](const Segmentation::SegmentedRegion& a, const Segmentation::SegmentedRegion& b) {
-                  return a.area > b.area;
-              });
-    
-    // Determinar tipo de órgano según rango HU (usar variables ya declaradas)
-    bool esPulmones = (minHU <= -400 && maxHU <= -100);  // Aire/pulmones: [-1000, -400]
-    bool esAorta = (minHU >= 20 && maxHU <= 150);        // Vasos con contraste: [30, 120]
-    bool esHuesos = (minHU >= 150);                      // Huesos: [200, 1000]
+    // En vista previa el corte entra reducido: distancias / escala, áreas / escala²
+    runSourceStage();
+    const int scale = previewScale;
+    const double areaScale = 1.0 / (scale * scale);
     
-    // FILTRADO ANATÓMICO ESPECÍFICO PARA AORTA (como en pipeline_aorta.cpp)
-    if (esAorta && !regions.empty()) {
-        cv::Point2d imgCenter(imageForSegmentation.cols / 2.0, imageForSegmentation.rows / 2.0);
+    const SegmentationStageResult& seg = graph->run<SegmentationStageResult>(
+        STAGE_SEGMENTATION, segParams.value(), [&]() {
+        const cv::Mat& raw = graph->value<cv::Mat>(STAGE_SOURCE);
         
-        std::vector<Segmentation::SegmentedRegion> filteredAorta;
-        for (const auto& region : regions) {
-            double distX = std::abs(region.centroid.x - imgCenter.x);
-            double distY = region.centroid.y - imgCenter.y;
-            double distTotal = cv::norm(region.centroid - imgCenter);
-            
-            // Filtros anatómicos (de pipeline_aorta.cpp):
-            bool esCentral = (distX < 70);      // Debe estar cerca del centro horizontal
-            bool esAnterior = (distY < 20);     // Debe estar en parte anterior (arriba del centro)
-            bool esMediano = (distTotal < 100); // No muy lejos del centro
-            bool tamanioOk = (region.area >= 300 && region.area <= 5000); // Tamaño apropiado
-            
-            if (esCentral && esAnterior && esMediano && tamanioOk) {
-                filteredAorta.push_back(region);
+        // Usar la imagen preprocesada si existe, sino usar la original normalizada
+        cv::Mat sourceImage;
+        if (!sliceContext.preprocessed.empty()) {
+            sourceImage = sliceContext.preprocessed.clone();
+            if (sourceImage.size() != raw.size()) {
+                cv::resize(sourceImage, sourceImage, raw.size(), 0, 0, cv::INTER_AREA);
             }
+        } else {
+            sourceImage = Bridge::normalize16to8bit(raw);
         }
         
-        // Si encontramos candidatos, aplicar procesamiento morfológico y quedarnos con el más grande
-        if (!filteredAorta.empty()) {
-            // Combinar máscaras
-            cv::Mat combinedMask = cv::Mat::zeros(imageForSegmentation.size(), CV_8U);
-            for (const auto& r : filteredAorta) {
-                cv::bitwise_or(combinedMask, r.mask, combinedMask);
-            }
-            
-            // Morfología: cierre + dilatación
-            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5, 5));
-            cv::morphologyEx(combinedMask, combinedMask, cv::MORPH_CLOSE, kernel);
-            cv::dilate(combinedMask, combinedMask, kernel);
-            
-            // Re-segmentar componentes conectados
-            auto finalComponents = Segmentation::findConnectedComponents(combinedMask, 500);
-            
-            if (!finalComponents.empty()) {
-                // Ordenar por área y tomar el más grande
-                std::sort(finalComponents.begin(), finalComponents.end(),
-                    [](const auto& a, const auto& b) { return a.area > b.area; });
-                
-                auto& largest = finalComponents[0];
-                double dist = cv::norm(largest.centroid - imgCenter);
-                
-                // Verificar que el más grande está cerca del centro
-                if (dist < 120.0) {
-                    regions.clear();
-                    regions.push_back(largest);
+        // Necesitamos trabajar con la imagen original en HU para umbralización correcta
+        // Pero mostraremos usando la preprocesada si existe
+        cv::Mat imageForSegmentation = raw.clone();
+        
+        // Crear parámetros de segmentación
+        Segmentation::SegmentationParams params;
+        params.minHU = minHU;
+        params.maxHU = maxHU;
+        params.minArea = std::max(1, static_cast<int>(minArea * areaScale));
+        params.maxArea = std::max(1, static_cast<int>(maxArea * areaScale));
+        params.visualColor = cv::Scalar(255, 0, 0); // Azul por defecto
+        
+        // Segmentar
+        auto regions = Segmentation::segmentOrgan(imageForSegmentation, params, "Region");
+        
+        // Filtrar regiones que tocan el borde si está activado
+        if (checkFilterBorder && checkFilterBorder->isChecked()) {
+            std::vector<Segmentation::SegmentedRegion> filteredRegions;
+            for (const auto& region : regions) {
+                bool touchesBorder = (region.boundingBox.x <= 1 || 
+                                     region.boundingBox.y <= 1 || 
+                                     (region.boundingBox.x + region.boundingBox.width) >= imageForSegmentation.cols - 1 || 
+                                     (region.boundingBox.y + region.boundingBox.height) >= imageForSegmentation.rows - 1);
+        
+                if (!touchesBorder) {
+                    filteredRegions.push_back(region);
+                }
+            }
+            regions = filteredRegions;
+        }
+        
+        // Ordenar por área (mayor a menor)
+        std::sort(regions.begin(), regions.end(), 
+                  [](const Segmentation::SegmentedRegion& a, const Segmentation::SegmentedRegion& b) {
+                      return a.area > b.area;
+                  });
+        
+        // FILTRADO ANATÓMICO ESPECÍFICO PARA AORTA (como en pipeline_aorta.cpp)
+        if (esAorta && !regions.empty()) {
+            cv::Point2d imgCenter(imageForSegmentation.cols / 2.0, imageForSegmentation.rows / 2.0);
+        
+            std::vector<Segmentation::SegmentedRegion> filteredAorta;
+            for (const auto& region : regions) {
+                double distX = std::abs(region.centroid.x - imgCenter.x);
+                double distY = region.centroid.y - imgCenter.y;
+                double distTotal = cv::norm(region.centroid - imgCenter);
+        
+                // Filtros anatómicos (de pipeline_aorta.cpp):
+                bool esCentral = (distX * scale < 70);      // Debe estar cerca del centro horizontal
+                bool esAnterior = (distY * scale < 20);     // Debe estar en parte anterior (arriba del centro)
+                bool esMediano = (distTotal * scale < 100); // No muy lejos del centro
+                bool tamanioOk = (region.area >= 300 * areaScale &&
+                                  region.area <= 5000 * areaScale); // Tamaño apropiado
+        
+                if (esCentral && esAnterior && esMediano && tamanioOk) {
+                    filteredAorta.push_back(region);
+                }
+            }
+        
+            // Si encontramos candidatos, aplicar procesamiento morfológico y quedarnos con el más grande
+            if (!filteredAorta.empty()) {
+                // Combinar máscaras
+                cv::Mat combinedMask = cv::Mat::zeros(imageForSegmentation.size(), CV_8U);
+                for (const auto& r : filteredAorta) {
+                    cv::bitwise_or(combinedMask, r.mask, combinedMask);
+                }
+        
+                // Morfología: cierre + dilatación
+                int k = previewKernel(5, scale);
+                cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(k, k));
+                cv::morphologyEx(combinedMask, combinedMask, cv::MORPH_CLOSE, kernel);
+                cv::dilate(combinedMask, combinedMask, kernel);
+        
+                // Re-segmentar componentes conectados
+                auto finalComponents = Segmentation::findConnectedComponents(
+                    combinedMask, std::max(1, static_cast<int>(500 * areaScale)));
+        
+                if (!finalComponents.empty()) {
+                    // Ordenar por área y tomar el más grande
+                    std::sort(finalComponents.begin(), finalComponents.end(),
+                        [](const auto& a, const auto& b) { return a.area > b.area; });
+        
+                    auto& largest = finalComponents[0];
+                    double dist = cv::norm(largest.centroid - imgCenter);
+        
+                    // Verificar que el más grande está cerca del centro
+                    if (dist * scale < 120.0) {
+                        regions.clear();
+                        regions.push_back(largest);
+                    } else {
+                        regions.clear(); // No se encontró aorta válida
+                    }
+                }
+            } else {
+                regions.clear(); // No se encontraron regiones que cumplan criterios anatómicos
+            }
+        }
+        
+        // Limitar número de regiones según el órgano (solo si NO es aorta, ya filtrada arriba)
+        if (!esAorta) {
+            size_t maxRegions = esPulmones ? 2 : 20; // Pulmones: 2, Huesos: múltiples
+            if (regions.size() > maxRegions) {
+                regions.resize(maxRegions);
+            }
+        }
+        
+        // Asignar etiquetas y colores específicos
+        if (preservarClasificacionHuesos) {
+            // Ya existe una clasificación anatómica detallada, mantenerla
+            regions = sliceContext.huesosRegions;
+            for (auto& region : regions) {
+                if (region.mask.size() != raw.size()) {
+                    cv::Mat mask;
+                    cv::resize(region.mask, mask, raw.size(), 0, 0, cv::INTER_NEAREST);
+                    region.mask = mask;
+                    region.boundingBox = cv::Rect(region.boundingBox.x / scale, region.boundingBox.y / scale,
+                                                  std::max(1, region.boundingBox.width / scale),
+                                                  std::max(1, region.boundingBox.height / scale));
+                }
+            }
+        } else {
+            // Asignar etiquetas genéricas para nueva segmentación
+            for (size_t i = 0; i < regions.size(); i++) {
+                if (esPulmones) {
+                    regions[i].label = (i == 0) ? "Pulmon Derecho" : "Pulmon Izquierdo";
+                    regions[i].color = cv::Scalar(255, 0, 0); // Azul
+                } else if (esAorta) {
+                    regions[i].label = "Aorta"; // Solo 1 estructura después del filtrado anatómico
+                    regions[i].color = cv::Scalar(0, 0, 255); // Rojo
+                } else if (esHuesos) {
+                    regions[i].label = "Hueso_" + std::to_string(i+1);
+                    regions[i].color = cv::Scalar(0, 255, 0); // Verde
                 } else {
-                    regions.clear(); // No se encontró aorta válida
+                    regions[i].label = "Region_" + std::to_string(i+1);
+                    regions[i].color = cv::Scalar(255, 255, 0); // Cian
                 }
             }
+        }
+        
+        // Las regiones se guardan en el contexto antes del refinamiento
+        SegmentationStageResult result;
+        result.regions = regions;
+        
+        // Crear imagen de visualización a color
+        cv::Mat imageColor;
+        if (sourceImage.channels() == 1) {
+            cv::cvtColor(sourceImage, imageColor, cv::COLOR_GRAY2BGR);
         } else {
-            regions.clear(); // No se encontraron regiones que cumplan criterios anatómicos
+            imageColor = sourceImage.clone();
         }
-    }
-    
-    // Limitar número de regiones según el órgano (solo si NO es aorta, ya filtrada arriba)
-    if (!esAorta) {
-        size_t maxRegions = esPulmones ? 2 : 20; // Pulmones: 2, Huesos: múltiples
-        if (regions.size() > maxRegions) {
-            regions.resize(maxRegions);
+        
+        // Aplicar refinamiento morfológico a las máscaras
+        for (auto& region : regions) {
+            // Apertura para suavizar bordes
+            int openSize = previewKernel(5, scale);
+            region.mask = Morphology::opening(region.mask, cv::Size(openSize, openSize));
+            // Cierre para rellenar huecos
+            int closeSize = previewKernel(9, scale);
+            region.mask = Morphology::closing(region.mask, cv::Size(closeSize, closeSize));
+            // Rellenar todos los huecos internos
+            region.mask = Morphology::fillHoles(region.mask);
         }
-    }
-    
-    // Asignar etiquetas y colores específicos
-    // IMPORTANTE: Si ya existen regiones clasificadas de huesos (del pipeline especializado),
-    // preservar esa clasificación en lugar de sobrescribirla con etiquetas genéricas
-    bool preservarClasificacionHuesos = esHuesos && !sliceContext.huesosRegions.empty() &&
-                                        (sliceContext.huesosRegions[0].label.find("Columna") != std::string::npos ||
-                                         sliceContext.huesosRegions[0].label.find("Costilla") != std::string::npos);
-    
-    if (preservarClasificacionHuesos) {
-        // Ya existe una clasificación anatómica detallada, mantenerla
-        regions = sliceContext.huesosRegions;
-    } else {
-        // Asignar etiquetas genéricas para nueva segmentación
-        for (size_t i = 0; i < regions.size(); i++) {
-            if (esPulmones) {
-                regions[i].label = (i == 0) ? "Pulmon Derecho" : "Pulmon Izquierdo";
-                regions[i].color = cv::Scalar(255, 0, 0); // Azul
-            } else if (esAorta) {
-                regions[i].label = "Aorta"; // Solo 1 estructura después del filtrado anatómico
-                regions[i].color = cv::Scalar(0, 0, 255); // Rojo
-            } else if (esHuesos) {
-                regions[i].label = "Hueso_" + std::to_string(i+1);
-                regions[i].color = cv::Scalar(0, 255, 0); // Verde
-            } else {
-                regions[i].label = "Region_" + std::to_string(i+1);
-                regions[i].color = cv::Scalar(255, 255, 0); // Cian
+        
+        // Crear overlay si está activado
+        if (checkShowOverlay && checkShowOverlay->isChecked()) {
+            cv::Mat overlay = imageColor.clone();
+            for (const auto& region : regions) {
+                overlay.setTo(region.color, region.mask);
             }
+            cv::addWeighted(imageColor, 0.7, overlay, 0.3, 0, imageColor);
         }
         
-        // Guardar regiones en el vector correspondiente según el tipo de órgano
-        if (esPulmones) {
-            sliceContext.pulmonesRegions = regions;
-        } else if (esAorta) {
-            sliceContext.aortaRegions = regions;
-        } else if (esHuesos) {
-            sliceContext.huesosRegions = regions;
+        // Dibujar contornos si está activado
+        if (checkShowContours && checkShowContours->isChecked()) {
+            for (const auto& region : regions) {
+                std::vector<std::vector<cv::Point>> contours;
+                cv::findContours(region.mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+                cv::drawContours(imageColor, contours, -1, region.color, 3);
+            }
         }
-    }
-    
-    // Crear imagen de visualización a color
-    cv::Mat imageColor;
-    if (sourceImage.channels() == 1) {
-        cv::cvtColor(sourceImage, imageColor, cv::COLOR_GRAY2BGR);
-    } else {
-        imageColor = sourceImage.clone();
-    }
-    
-    // Aplicar refinamiento morfológico a las máscaras
-    for (auto& region : regions) {
-        // Apertura para suavizar bordes
-        region.mask = Morphology::opening(region.mask, cv::Size(5, 5));
-        // Cierre para rellenar huecos
-        region.mask = Morphology::closing(region.mask, cv::Size(9, 9));
-        // Rellenar todos los huecos internos
-        region.mask = Morphology::fillHoles(region.mask);
-    }
-    
-    // Crear overlay si está activado
-    if (checkShowOverlay && checkShowOverlay->isChecked()) {
-        cv::Mat overlay = imageColor.clone();
-        for (const auto& region : regions) {
-            overlay.setTo(region.color, region.mask);
+        
+        // Dibujar etiquetas si está activado
+        if (checkShowLabels && checkShowLabels->isChecked()) {
+            for (const auto& region : regions) {
+                cv::putText(imageColor, region.label, 
+                           cv::Point(region.boundingBox.x, region.boundingBox.y - 10),
+                           cv::FONT_HERSHEY_SIMPLEX, 0.8, region.color, 2);
+            }
         }
-        cv::addWeighted(imageColor, 0.7, overlay, 0.3, 0, imageColor);
-    }
-    
-    // Dibujar contornos si está activado
-    if (checkShowContours && checkShowContours->isChecked()) {
+        
+        // Crear máscara binaria combinando todas las regiones
+        cv::Mat combinedMask = cv::Mat::zeros(sourceImage.size(), CV_8U);
         for (const auto& region : regions) {
-            std::vector<std::vector<cv::Point>> contours;
-            cv::findContours(region.mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-            cv::drawContours(imageColor, contours, -1, region.color, 3);
+            combinedMask |= region.mask;
         }
-    }
+        
+        result.mask = combinedMask;
+        result.overlay = imageColor;
+        return result;
+    });
     
-    // Dibujar etiquetas si está activado
-    if (checkShowLabels && checkShowLabels->isChecked()) {
-        for (const auto& region : regions) {
-            cv::putText(imageColor, region.label, 
-                       cv::Point(region.boundingBox.x, region.boundingBox.y - 10),
-                       cv::FONT_HERSHEY_SIMPLEX, 0.8, region.color, 2);
+    // Guardar regiones en el vector correspondiente según el tipo de órgano
+    // (solo las de resolución completa: las de la vista previa son provisionales)
+    if (!preservarClasificacionHuesos && scale == 1) {
+        if (esPulmones) {
+            sliceContext.pulmonesRegions = seg.regions;
+        } else if (esAorta) {
+            sliceContext.aortaRegions = seg.regions;
+        } else if (esHuesos) {
+            sliceContext.huesosRegions = seg.regions;
         }
-    }
-    
-    // Crear máscara binaria combinando todas las regiones
-    cv::Mat combinedMask = cv::Mat::zeros(sourceImage.size(), CV_8U);
-    for (const auto& region : regions) {
-        combinedMask |= region.mask;
+        sliceContext.organLabels.release();
     }
     
     // Guardar resultado en el contexto
-    sliceContext.segmentationMask = combinedMask;
-    sliceContext.segmentationOriginal = combinedMask.clone(); // Copia para morfología
-    sliceContext.finalOverlay = imageColor;
+    const cv::Size fullSize = sliceContext.originalRaw.size();
+    sliceContext.segmentationMask = toFullResolution(seg.mask, fullSize, cv::INTER_NEAREST).clone();
+    sliceContext.segmentationOriginal = sliceContext.segmentationMask.clone(); // Copia para morfología
+    sliceContext.segmentationKey = graph->key(STAGE_SEGMENTATION);
+    sliceContext.finalOverlay = toFullResolution(seg.overlay, fullSize, cv::INTER_LINEAR).clone();
     
     // Actualizar la visualización
     updateSegmentationDisplay();
@@ -2346,7 +3247,7 @@ void MainWindow::onSegmentationChanged()
     
     // Aplicar segmentación si hay datos cargados
     if (datasetLoaded && sliceContext.isValid) {
-        applySegmentation();
+        requestPasses(PASS_SEGMENTATION);
     }
 }
 
@@ -2501,6 +3402,7 @@ void MainWindow::onSegPresetBones()
     // Actualizar contexto
     sliceContext.segmentationMask = combinedMask;
     sliceContext.huesosRegions = allBones;
+    sliceContext.organLabels.release();
     
     sliceContext.finalOverlay = result;
     
@@ -2601,92 +3503,118 @@ void MainWindow::applyMorphology()
     if (!sliceContext.isValid) {
         return;
     }
-
-    // CRÍTICO: Siempre partir de la segmentación ORIGINAL, no de la modificada
-    cv::Mat workingImage;
-    
-    if (!sliceContext.segmentationOriginal.empty()) {
-        // IMPORTANTE: Usar la segmentación ORIGINAL, no la modificada
-        workingImage = sliceContext.segmentationOriginal.clone();
-    } else {
-        std::cerr << "No hay máscara de segmentación original para aplicar morfología" << std::endl;
+    if (previewScale == 1 && fullPassThread) {
+        // Parte del preprocesado en curso: se ejecuta cuando termine
+        pendingFullPasses |= PASS_MORPHOLOGY;
         return;
     }
-    
-    // Asegurarse de que es binaria de 8 bits
-    if (workingImage.type() != CV_8U) {
-        workingImage.convertTo(workingImage, CV_8U);
+    Pipeline::StageGraph* graph = activeGraph();
+    if (!graph) {
+        return;
     }
-    
-    // Si tiene múltiples canales, convertir a escala de grises
-    if (workingImage.channels() > 1) {
-        cv::cvtColor(workingImage, workingImage, cv::COLOR_BGR2GRAY);
+
+    if (sliceContext.segmentationOriginal.empty()) {
+        std::cerr << "No hay máscara de segmentación original para aplicar morfología" << std::endl;
+        return;
     }
     
-    // Asegurar que sea binaria (0 o 255)
-    cv::threshold(workingImage, workingImage, 10, 255, cv::THRESH_BINARY);
-
     // Obtener forma del kernel
     int shapeIdx = comboKernelShape ? comboKernelShape->currentIndex() : 0;
     Morphology::StructuringElementShape shape = static_cast<Morphology::StructuringElementShape>(shapeIdx);
-
-    cv::Mat result = workingImage.clone();
-
-    // Aplicar operaciones en orden
     
-    // 1. Erosión
-    if (checkErode && checkErode->isChecked()) {
-        int kernelSize = sliderErodeKernel ? sliderErodeKernel->value() : 3;
-        if (kernelSize % 2 == 0) kernelSize++;
-        int iterations = sliderErodeIter ? sliderErodeIter->value() : 1;
-        result = Morphology::erode(result, cv::Size(kernelSize, kernelSize), shape, iterations);
-    }
-
-    // 2. Dilatación
-    if (checkDilate && checkDilate->isChecked()) {
-        int kernelSize = sliderDilateKernel ? sliderDilateKernel->value() : 3;
-        if (kernelSize % 2 == 0) kernelSize++;
-        int iterations = sliderDilateIter ? sliderDilateIter->value() : 1;
-        result = Morphology::dilate(result, cv::Size(kernelSize, kernelSize), shape, iterations);
-    }
-
-    // 3. Apertura (Opening)
-    if (checkOpening && checkOpening->isChecked()) {
-        int kernelSize = sliderOpeningKernel ? sliderOpeningKernel->value() : 5;
-        if (kernelSize % 2 == 0) kernelSize++;
-        result = Morphology::opening(result, cv::Size(kernelSize, kernelSize), shape);
-    }
-
-    // 4. Cierre (Closing)
-    if (checkClosing && checkClosing->isChecked()) {
-        int kernelSize = sliderClosingKernel ? sliderClosingKernel->value() : 9;
-        if (kernelSize % 2 == 0) kernelSize++;
-        result = Morphology::closing(result, cv::Size(kernelSize, kernelSize), shape);
-    }
-
-    // 5. Gradiente morfológico
-    if (checkGradient && checkGradient->isChecked()) {
-        int kernelSize = sliderGradientKernel ? sliderGradientKernel->value() : 3;
-        if (kernelSize % 2 == 0) kernelSize++;
-        result = Morphology::morphologicalGradient(result, cv::Size(kernelSize, kernelSize), shape);
-    }
-
-    // 6. Rellenar huecos
-    if (checkFillHoles && checkFillHoles->isChecked()) {
-        result = Morphology::fillHoles(result);
-    }
-
-    // 7. Eliminar bordes
-    if (checkRemoveBorder && checkRemoveBorder->isChecked()) {
-        result = Morphology::clearBorder(result);
-    }
+    // Clave de la etapa: forma del kernel y todos los controles de la pestaña
+    // (la entrada es la etapa de segmentación, que produce segmentationOriginal)
+    auto checked = [](QCheckBox *check) { return check && check->isChecked(); };
+    auto value = [](QSlider *slider) { return slider ? slider->value() : 0; };
+    Pipeline::ParamHash morphParams;
+    morphParams.add(shapeIdx)
+               .add(checked(checkErode)).add(value(sliderErodeKernel)).add(value(sliderErodeIter))
+               .add(checked(checkDilate)).add(value(sliderDilateKernel)).add(value(sliderDilateIter))
+               .add(checked(checkOpening)).add(value(sliderOpeningKernel))
+               .add(checked(checkClosing)).add(value(sliderClosingKernel))
+               .add(checked(checkGradient)).add(value(sliderGradientKernel))
+               .add(checked(checkFillHoles)).add(checked(checkRemoveBorder))
+               .add(sliceContext.segmentationKey)
+               .add(previewScale);
+    const int scale = previewScale;
+    
+    const cv::Mat& processed = graph->run<cv::Mat>(STAGE_MORPHOLOGY, morphParams.value(), [&]() {
+        // CRÍTICO: Siempre partir de la segmentación ORIGINAL, no de la modificada
+        cv::Mat workingImage = sliceContext.segmentationOriginal.clone();
+        if (scale > 1) {
+            // Vista previa: máscara reducida y kernels escalados
+            cv::resize(workingImage, workingImage, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_NEAREST);
+        }
+        
+        // Asegurarse de que es binaria de 8 bits
+        if (workingImage.type() != CV_8U) {
+            workingImage.convertTo(workingImage, CV_8U);
+        }
+        
+        // Si tiene múltiples canales, convertir a escala de grises
+        if (workingImage.channels() > 1) {
+            cv::cvtColor(workingImage, workingImage, cv::COLOR_BGR2GRAY);
+        }
+        
+        // Asegurar que sea binaria (0 o 255)
+        cv::threshold(workingImage, workingImage, 10, 255, cv::THRESH_BINARY);
+        
+        cv::Mat result = workingImage.clone();
+        
+        // Aplicar operaciones en orden
+        
+        // 1. Erosión
+        if (checkErode && checkErode->isChecked()) {
+            int kernelSize = previewKernel(sliderErodeKernel ? sliderErodeKernel->value() : 3, scale);
+            int iterations = sliderErodeIter ? sliderErodeIter->value() : 1;
+            result = Morphology::erode(result, cv::Size(kernelSize, kernelSize), shape, iterations);
+        }
+        
+        // 2. Dilatación
+        if (checkDilate && checkDilate->isChecked()) {
+            int kernelSize = previewKernel(sliderDilateKernel ? sliderDilateKernel->value() : 3, scale);
+            int iterations = sliderDilateIter ? sliderDilateIter->value() : 1;
+            result = Morphology::dilate(result, cv::Size(kernelSize, kernelSize), shape, iterations);
+        }
+        
+        // 3. Apertura (Opening)
+        if (checkOpening && checkOpening->isChecked()) {
+            int kernelSize = previewKernel(sliderOpeningKernel ? sliderOpeningKernel->value() : 5, scale);
+            result = Morphology::opening(result, cv::Size(kernelSize, kernelSize), shape);
+        }
+        
+        // 4. Cierre (Closing)
+        if (checkClosing && checkClosing->isChecked()) {
+            int kernelSize = previewKernel(sliderClosingKernel ? sliderClosingKernel->value() : 9, scale);
+            result = Morphology::closing(result, cv::Size(kernelSize, kernelSize), shape);
+        }
+        
+        // 5. Gradiente morfológico
+        if (checkGradient && checkGradient->isChecked()) {
+            int kernelSize = previewKernel(sliderGradientKernel ? sliderGradientKernel->value() : 3, scale);
+            result = Morphology::morphologicalGradient(result, cv::Size(kernelSize, kernelSize), shape);
+        }
+        
+        // 6. Rellenar huecos
+        if (checkFillHoles && checkFillHoles->isChecked()) {
+            result = Morphology::fillHoles(result);
+        }
+        
+        // 7. Eliminar bordes
+        if (checkRemoveBorder && checkRemoveBorder->isChecked()) {
+            result = Morphology::clearBorder(result);
+        }
+        
+        return result;
+    });
 
     // Guardar resultado en sliceContext
-    sliceContext.segmentationMask = result;
+    sliceContext.segmentationMask = toFullResolution(processed, sliceContext.segmentationOriginal.size(),
+                                                     cv::INTER_NEAREST).clone();
     
     // Crear visualización en color
     cv::Mat colorResult;
-    cv::cvtColor(result, colorResult, cv::COLOR_GRAY2BGR);
+    cv::cvtColor(sliceContext.segmentationMask, colorResult, cv::COLOR_GRAY2BGR);
     sliceContext.finalOverlay = colorResult;
 
     // Actualizar display
@@ -2740,9 +3668,9 @@ void MainWindow::onMorphologyChanged()
         return;
     }
 
-    applyMorphology();
+    requestPasses(PASS_MORPHOLOGY);
     
-    if (lblStatus) {
+    if (lblStatus && pendingFullPasses == 0) {
         lblStatus->setText("Operaciones morfológicas actualizadas");
     }
 }
@@ -2920,105 +3848,95 @@ void MainWindow::updateVisualization()
         return;
     }
 
-    // 1. Convertir imagen original de 16-bit a 8-bit BGR
-    cv::Mat imgNormalized = Bridge::normalize16to8bit(sliceContext.originalRaw);
-    cv::Mat imgColor;
-    if (imgNormalized.channels() == 1) {
-        cv::cvtColor(imgNormalized, imgColor, cv::COLOR_GRAY2BGR);
-    } else {
-        imgColor = imgNormalized.clone();
-    }
+    cv::Mat finalResult = composeFinalView();
 
-    // 2. Crear overlay clonando la imagen base
-    cv::Mat overlay = imgColor.clone();
-    cv::Mat finalResult = imgColor.clone();
+    // Mostrar resultado en el QLabel
+    if (lblFinalView) {
+        QImage qimg = cvMatToQImage(finalResult);
+        if (!qimg.isNull()) {
+            QPixmap pixmap = QPixmap::fromImage(qimg);
+            lblFinalView->setPixmap(pixmap);
+            lblFinalView->resize(pixmap.size());
+        }
+    }
+}
 
+cv::Mat MainWindow::composeFinalView()
+{
     // Determinar el estilo de visualización
     bool useFillStyle = radStyleFill && radStyleFill->isChecked();
     
     // Obtener opacidad (0-100 -> 0.0-1.0)
     double alpha = (sliderOpacity ? sliderOpacity->value() : 40) / 100.0;
 
-    // 3. Aplicar capas de órganos desde vectores almacenados
-    
-    // CAPA: Pulmones (Azul)
-    if (chkShowLungs && chkShowLungs->isChecked() && 
-        !sliceContext.pulmonesRegions.empty()) {
-        
-        // Crear máscara combinando todas las regiones de pulmones
-        cv::Mat lungsMask = cv::Mat::zeros(imgColor.size(), CV_8U);
-        for (const auto& region : sliceContext.pulmonesRegions) {
-            lungsMask |= region.mask;
-        }
-        
-        if (useFillStyle) {
-            // Relleno sólido con blend
-            overlay.setTo(cv::Scalar(255, 0, 0), lungsMask); // BGR: Azul
-            cv::addWeighted(imgColor, 1.0 - alpha, overlay, alpha, 0, finalResult);
-            imgColor = finalResult.clone(); // Acumular para siguiente capa
-        } else {
-            // Solo contornos
-            std::vector<std::vector<cv::Point>> contours;
-            cv::findContours(lungsMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-            cv::drawContours(finalResult, contours, -1, cv::Scalar(255, 0, 0), 3);
+    // 1. Tabla de capas: color, opacidad y visibilidad por órgano
+    struct OrganLayer {
+        int label;
+        cv::Scalar color;
+        bool visible;
+    };
+    const OrganLayer layers[] = {
+        { ORGAN_LUNGS, cv::Scalar(255, 0, 0),       // BGR: Azul
+          chkShowLungs && chkShowLungs->isChecked() },
+        { ORGAN_BONES, cv::Scalar(0, 255, 0),       // BGR: Verde
+          chkShowBones && chkShowBones->isChecked() && chkShowBones->isEnabled() },
+        { ORGAN_AORTA, cv::Scalar(0, 0, 255),       // BGR: Rojo
+          chkShowSoftTissue && chkShowSoftTissue->isChecked() && chkShowSoftTissue->isEnabled() }
+    };
+    const std::vector<Segmentation::SegmentedRegion>* regions[] = {
+        &sliceContext.pulmonesRegions, &sliceContext.huesosRegions, &sliceContext.aortaRegions
+    };
+    int visibleOrgans = 0;
+    for (const auto& layer : layers) {
+        if (layer.visible) {
+            visibleOrgans |= 1 << layer.label;
         }
     }
 
-    // CAPA: Huesos (Verde)
-    if (chkShowBones && chkShowBones->isChecked() && chkShowBones->isEnabled() &&
-        !sliceContext.huesosRegions.empty()) {
-        
-        // Crear máscara combinando todas las regiones de huesos
-        cv::Mat bonesMask = cv::Mat::zeros(imgColor.size(), CV_8U);
-        for (const auto& region : sliceContext.huesosRegions) {
-            bonesMask |= region.mask;
-        }
-        
-        if (useFillStyle) {
-            // Relleno sólido con blend
-            overlay.setTo(cv::Scalar(0, 255, 0), bonesMask); // BGR: Verde
-            cv::addWeighted(imgColor, 1.0 - alpha, overlay, alpha, 0, finalResult);
-            imgColor = finalResult.clone(); // Acumular para siguiente capa
-        } else {
-            // Solo contornos
-            std::vector<std::vector<cv::Point>> contours;
-            cv::findContours(bonesMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-            cv::drawContours(finalResult, contours, -1, cv::Scalar(0, 255, 0), 3);
+    // 2. Imagen base y mapa de etiquetas: solo se reconstruyen al cambiar el
+    //    corte, la segmentación o los órganos visibles, no al cambiar estilo u
+    //    opacidad. Un órgano oculto no se pinta, así no tapa a los que quedan
+    //    debajo en las zonas solapadas
+    if (sliceContext.displayBase.empty()) {
+        sliceContext.displayBase = Bridge::normalize16to8bit(sliceContext.originalRaw);
+    }
+    if (sliceContext.organLabels.empty() || sliceContext.organLabelsVisible != visibleOrgans) {
+        // Orden de pintado: la aorta queda por encima de huesos y pulmones
+        sliceContext.organLabels = cv::Mat::zeros(sliceContext.originalRaw.size(), CV_8U);
+        for (size_t i = 0; i < std::size(layers); i++) {
+            if (layers[i].visible) {
+                paintOrganLabel(sliceContext.organLabels, *regions[i], layers[i].label);
+            }
         }
+        sliceContext.organLabelsVisible = visibleOrgans;
     }
 
-    // CAPA: Aorta/Tejido Blando (Rojo)
-    if (chkShowSoftTissue && chkShowSoftTissue->isChecked() && chkShowSoftTissue->isEnabled() &&
-        !sliceContext.aortaRegions.empty()) {
-        
-        // Crear máscara combinando todas las regiones de aorta
-        cv::Mat aortaMask = cv::Mat::zeros(imgColor.size(), CV_8U);
-        for (const auto& region : sliceContext.aortaRegions) {
-            aortaMask |= region.mask;
-        }
-        
-        if (useFillStyle) {
-            // Relleno sólido con blend
-            overlay.setTo(cv::Scalar(0, 0, 255), aortaMask); // BGR: Rojo
-            cv::addWeighted(imgColor, 1.0 - alpha, overlay, alpha, 0, finalResult);
-            imgColor = finalResult.clone(); // Acumular para siguiente capa
-        } else {
-            // Solo contornos
-            std::vector<std::vector<cv::Point>> contours;
-            cv::findContours(aortaMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-            cv::drawContours(finalResult, contours, -1, cv::Scalar(0, 0, 255), 3);
-        }
+    for (const auto& layer : layers) {
+        // En modo contornos la pasada solo convierte la base a BGR
+        organCompositor.setStyle(layer.label,
+            Visualization::LabelStyle{layer.color, alpha, layer.visible && useFillStyle});
     }
 
-    // 4. Mostrar resultado en el QLabel
-    if (lblFinalView) {
-        QImage qimg = cvMatToQImage(finalResult);
-        if (!qimg.isNull()) {
-            QPixmap pixmap = QPixmap::fromImage(qimg);
-            lblFinalView->setPixmap(pixmap);
-            lblFinalView->resize(pixmap.size());
+    // 3. Una sola pasada para todas las capas
+    cv::Mat finalResult = organCompositor.compose(sliceContext.displayBase, sliceContext.organLabels);
+
+    // 4. Solo contornos: se dibujan con la máscara completa de cada órgano, no
+    //    con el mapa exclusivo, para que un solapamiento no recorte el contorno
+    if (!useFillStyle) {
+        for (size_t i = 0; i < std::size(layers); i++) {
+            const OrganLayer& layer = layers[i];
+            if (!layer.visible) {
+                continue;
+            }
+            cv::Mat organMask = cv::Mat::zeros(sliceContext.originalRaw.size(), CV_8U);
+            paintOrganLabel(organMask, *regions[i], 255);
+            std::vector<std::vector<cv::Point>> contours;
+            cv::findContours(organMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+            cv::drawContours(finalResult, contours, -1, layer.color, 3);
         }
     }
+
+    return finalResult;
 }
 
 void MainWindow::onVisualizationChanged()
@@ -3065,40 +3983,8 @@ void MainWindow::onSaveClicked()
         return;
     }
 
-    // Regenerar la imagen final
-    if (sliceContext.originalRaw.empty()) {
-        QMessageBox::critical(this, "Error", "No hay imagen para guardar.");
-        return;
-    }
-
-    // Convertir y aplicar overlay
-    cv::Mat imgNormalized = Bridge::normalize16to8bit(sliceContext.originalRaw);
-    cv::Mat imgColor;
-    if (imgNormalized.channels() == 1) {
-        cv::cvtColor(imgNormalized, imgColor, cv::COLOR_GRAY2BGR);
-    } else {
-        imgColor = imgNormalized.clone();
-    }
-
-    cv::Mat overlay = imgColor.clone();
-    cv::Mat finalResult = imgColor.clone();
-
-    bool useFillStyle = radStyleFill && radStyleFill->isChecked();
-    double alpha = (sliderOpacity ? sliderOpacity->value() : 40) / 100.0;
-
-    // Aplicar pulmones si está activo
-    if (chkShowLungs && chkShowLungs->isChecked() && !sliceContext.segmentationMask.empty()) {
-        cv::Mat lungsMask = sliceContext.segmentationMask.clone();
-        
-        if (useFillStyle) {
-            overlay.setTo(cv::Scalar(255, 0, 0), lungsMask);
-            cv::addWeighted(imgColor, 1.0 - alpha, overlay, alpha, 0, finalResult);
-        } else {
-            std::vector<std::vector<cv::Point>> contours;
-            cv::findContours(lungsMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-            cv::drawContours(finalResult, contours, -1, cv::Scalar(255, 0, 0), 3);
-        }
-    }
+    // Regenerar la imagen final (mismas capas y estilo que la vista)
+    cv::Mat finalResult = composeFinalView();
 
     // Guardar imagen
     std::string fileNameStd = fileName.toStdString();
@@ -3119,6 +4005,8 @@ void MainWindow::updateMetrics()
     if (!tableMetrics || !lblHistogramROI || !lblProcessTime || !lblMemoryUsage) {
         return;
     }
+    
+    updateStageCacheTable();
 
     // Verificar si hay máscara de segmentación
     if (sliceContext.segmentationMask.empty() || sliceContext.originalRaw.empty()) {
@@ -3231,3 +4119,211 @@ void MainWindow::updateMetrics()
     lblMemoryUsage->setText(QString("Memoria Estimada: %1 MB")
                             .arg(QString::number(memoryMB, 'f', 2)));
 }
+
+void MainWindow::updateStageCacheTable()
+{
+    if (!tableStageCache || !stageGraph) {
+        return;
+    }
+    
+    std::vector<Pipeline::StageStats> stats = stageGraph->stats();
+    tableStageCache->setRowCount(static_cast<int>(stats.size()));
+    for (size_t i = 0; i < stats.size(); i++) {
+        const Pipeline::StageStats& stage = stats[i];
+        int row = static_cast<int>(i);
+        tableStageCache->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(stage.name)));
+        tableStageCache->setItem(row, 1, new QTableWidgetItem(QString::number(stage.hits)));
+        tableStageCache->setItem(row, 2, new QTableWidgetItem(QString::number(stage.misses)));
+        tableStageCache->setItem(row, 3, new QTableWidgetItem(QString::number(stage.lastMs, 'f', 2)));
+        tableStageCache->setItem(row, 4, new QTableWidgetItem(QString::number(stage.totalMs, 'f', 2)));
+        tableStageCache->setItem(row, 5, new QTableWidgetItem(QString::number(stage.entries)));
+    }
+}
+
+// ========== VISTA PREVIA PROGRESIVA ==========
+
+void MainWindow::runSourceStage()
+{
+    Pipeline::StageGraph* graph = activeGraph();
+    if (!graph) {
+        return;
+    }
+    
+    std::string path;
+    if (currentSliceIndex >= 0 && currentSliceIndex < static_cast<int>(dicomFiles.size())) {
+        path = dicomFiles[currentSliceIndex];
+    }
+    
+    const int scale = previewScale;
+    Pipeline::ParamHash key;
+    key.add(path).add(currentSliceIndex).add(scale);
+    graph->run<cv::Mat>(STAGE_SOURCE, key.value(), [this, scale]() {
+        if (scale == 1) {
+            return sliceContext.originalRaw;
+        }
+        cv::Mat reduced;
+        cv::resize(sliceContext.originalRaw, reduced, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+        return reduced;
+    });
+}
+
+Pipeline::StageGraph* MainWindow::activeGraph() const
+{
+    // La vista previa no desplaza los resultados a resolución completa de la caché
+    return previewScale > 1 ? previewGraph.get() : stageGraph.get();
+}
+
+bool MainWindow::isSliderDragging() const
+{
+    for (const QSlider *slider : findChildren<QSlider*>()) {
+        if (slider->isSliderDown() && slider != sliceSlider) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainWindow::requestPasses(int passes)
+{
+    pendingFullPasses |= passes;
+    if (!isSliderDragging()) {
+        // Cambio puntual (teclado, rueda, preset): directamente a resolución completa
+        previewSettleTimer->stop();
+        runFullResolutionPass();
+        return;
+    }
+    
+    // Arrastrando: vista previa reducida ahora, pasada completa cuando se detenga
+    const int scale = lastFullPassMs > kSlowFullPassMs ? 4 : 2;
+    previewScale = scale;
+    runPasses(passes);
+    previewScale = 1;
+    
+    previewSettleTimer->start();
+    lblStatus->setText(QString("Vista previa a 1/%1 de resolución").arg(scale));
+}
+
+void MainWindow::runFullResolutionPass()
+{
+    const int passes = pendingFullPasses;
+    pendingFullPasses = 0;
+    if (passes == 0 || !sliceContext.isValid) {
+        return;
+    }
+    
+    cv::TickMeter timer;
+    timer.start();
+    runPasses(passes);
+    timer.stop();
+    if (fullPassThread) {
+        // El preprocesado sigue en su hilo: onFullPassFinished mide la pasada
+        return;
+    }
+    lastFullPassMs = timer.getTimeMilli();
+    
+    lblStatus->setText(QString("Resolución completa: %1 ms").arg(lastFullPassMs, 0, 'f', 1));
+}
+
+void MainWindow::startFullPreprocessing()
+{
+    if (!stageGraph) {
+        return;
+    }
+    
+    // El hilo usa en exclusiva el grafo, la losa y el denoiser: el grafo sale
+    // de stageGraph hasta que termina, la losa solo la usa la pasada completa
+    // y quien cambie el denoiser espera antes (waitForFullPass)
+    std::shared_ptr<PreprocessingJob> job = createPreprocessingJob(1, stageGraph.get(), slabDenoiser.get());
+    fullPassGraph = std::move(stageGraph);
+    fullPassJob = job;
+    
+    fullPassThread = QThread::create([job]() {
+        try {
+            runPreprocessingJob(*job);
+        } catch (const std::exception& e) {
+            std::cerr << "Error en el preprocesado: " << e.what() << std::endl;
+            job->preprocessed.release();
+        }
+    });
+    QThread *thread = fullPassThread;
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        // Una pasada ya recogida por waitForFullPass no se vuelve a aplicar
+        if (fullPassThread == thread) {
+            onFullPassFinished();
+        }
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+    
+    lblStatus->setText("Preprocesando a resolución completa...");
+}
+
+std::shared_ptr<PreprocessingJob> MainWindow::collectFullPass()
+{
+    stageGraph = std::move(fullPassGraph);
+    fullPassThread = nullptr;
+    return std::move(fullPassJob);
+}
+
+void MainWindow::waitForFullPass()
+{
+    if (!fullPassThread) {
+        return;
+    }
+    // El resultado se descarta: quien espera va a cambiar lo que lo produjo
+    fullPassThread->wait();
+    collectFullPass();
+}
+
+void MainWindow::onFullPassFinished()
+{
+    std::shared_ptr<PreprocessingJob> job = collectFullPass();
+    
+    // El corte pudo cambiar mientras tanto: su resultado ya no se muestra
+    if (sliceContext.isValid && job->generation == sliceGeneration) {
+        applyPreprocessingJob(*job);
+    }
+    
+    if (isSliderDragging()) {
+        // Se sigue arrastrando: la pasada completa espera a que se suelte
+        previewSettleTimer->start();
+        return;
+    }
+    
+    // Etapas pedidas mientras el hilo trabajaba (segmentación, morfología o
+    // un nuevo preprocesado con los controles actuales)
+    const int passes = pendingFullPasses;
+    pendingFullPasses = 0;
+    cv::TickMeter timer;
+    timer.start();
+    runPasses(passes);
+    timer.stop();
+    if (fullPassThread) {
+        return;
+    }
+    
+    // Las pestañas finales dependen de la segmentación que esperaba al preprocesado
+    if (passes & PASS_SEGMENTATION) {
+        if (tabWidget->currentIndex() == 5) {
+            updateVisualization();
+        } else if (tabWidget->currentIndex() == 6) {
+            updateMetrics();
+        }
+    }
+    lastFullPassMs = job->elapsedMs + timer.getTimeMilli();
+    
+    lblStatus->setText(QString("Resolución completa: %1 ms").arg(lastFullPassMs, 0, 'f', 1));
+}
+
+void MainWindow::runPasses(int passes)
+{
+    if (passes & PASS_PREPROCESSING) {
+        applyPreprocessing();
+    }
+    if (passes & PASS_SEGMENTATION) {
+        applySegmentation();
+    }
+    if (passes & PASS_MORPHOLOGY) {
+        applyMorphology();
+    }
+}
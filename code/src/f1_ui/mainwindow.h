@@ -28,6 +28,8 @@
 #include <QImage>
 #include <QTableWidget>
 #include <QHeaderView>
+#include <QThread>
+#include <QTimer>
 
 #include <opencv2/core.hpp>
 #include <string>
@@ -37,9 +39,18 @@
 // Forward declarations
 namespace Denoising {
     class DnCNNDenoiser;
+    struct Int8Validation;
 }
+namespace Preprocessing {
+    class SlabDenoiser;
+}
+namespace Pipeline {
+    class StageGraph;
+}
+struct PreprocessingJob;
 
 #include "../f4_segmentation/segmentation.h"
+#include "../f6_visualization/label_compositor.h"
 
 // Estructura para manejar el estado del slice actual
 struct SliceContext {
@@ -50,6 +61,14 @@ struct SliceContext {
     cv::Mat segmentationMask; // Resultado de F4 (Máscaras)
     cv::Mat segmentationOriginal; // Copia de segmentación antes de morfología
     cv::Mat finalOverlay;     // Resultado visual a color
+    cv::Mat displayBase;      // Original en 8-bit para la vista final
+    cv::Mat organLabels;      // Mapa de etiquetas de órganos (vacío = reconstruir)
+    int organLabelsVisible = 0; // Bits (1 << etiqueta) de los órganos pintados en organLabels
+    
+    // Claves de las etapas que produjeron preprocessed y segmentationOriginal
+    // (0 = sin resultado); entran en las claves de las etapas siguientes
+    uint64_t preprocessedKey = 0;
+    uint64_t segmentationKey = 0;
     
     // Almacenamiento de regiones segmentadas por tipo de órgano
     std::vector<Segmentation::SegmentedRegion> pulmonesRegions;
@@ -98,6 +117,7 @@ private slots:
     void onPresetSoftTissue();
     void onResetFilters();
     void onCompareWithDnCNN();
+    void onDnCNNInt8Toggled(bool checked);
     
     // Slots para segmentación
     void onSegmentationChanged();
@@ -116,6 +136,9 @@ private slots:
     // Slots para visualización
     void onVisualizationChanged();
     void onSaveClicked();
+    
+    // Slot de la vista previa progresiva
+    void runFullResolutionPass();
 
 private:
     // Métodos de inicialización
@@ -144,6 +167,7 @@ private:
     void applySegmentation();
     void applyMorphology();
     void updateVisualization();
+    cv::Mat composeFinalView();
     void updateMetrics();
     
     // Métodos auxiliares
@@ -152,6 +176,26 @@ private:
     void updatePreprocessingDisplay();
     void updateSegmentationDisplay();
     void updateMorphologyDisplay();
+    void updateStageCacheTable();
+    
+    // Vista previa progresiva (sliders arrastrándose)
+    void runSourceStage();
+    void requestPasses(int passes);
+    void runPasses(int passes);
+    bool isSliderDragging() const;
+    Pipeline::StageGraph* activeGraph() const;
+    
+    // Preprocesado a resolución completa en un hilo de trabajo
+    std::shared_ptr<PreprocessingJob> createPreprocessingJob(int scale, Pipeline::StageGraph* graph,
+                                                             Preprocessing::SlabDenoiser* slab);
+    void applyPreprocessingJob(const PreprocessingJob& job);
+    void startFullPreprocessing();
+    void onFullPassFinished();
+    std::shared_ptr<PreprocessingJob> collectFullPass();
+    void waitForFullPass();
+    void startModelLoading(const std::string& modelPath);
+    void onModelLoaded();
+    void onInt8CalibrationFinished(const Denoising::Int8Validation& validation);
 
     // Widgets principales
     QTabWidget *tabWidget;
@@ -193,18 +237,36 @@ private:
     QCheckBox *checkMedian;
     QSlider *sliderMedianKernel;
     QLabel *lblMedianValue;
+    QCheckBox *checkMedianHU;
     
     QCheckBox *checkBilateral;
+    QComboBox *comboBilateralMethod;
     QSlider *sliderBilateralD;
     QSlider *sliderBilateralSigma;
     QLabel *lblBilateralDValue;
     QLabel *lblBilateralSigmaValue;
     
+    QCheckBox *checkDiffusion;
+    QComboBox *comboDiffusionConductance;
+    QSlider *sliderDiffusionIterations;
+    QSlider *sliderDiffusionKappa;
+    QLabel *lblDiffusionIterationsValue;
+    QLabel *lblDiffusionKappaValue;
+    
+    QCheckBox *checkSlab;
+    QComboBox *comboSlabMethod;
+    QSlider *sliderSlabHalfWidth;
+    QLabel *lblSlabHalfWidthValue;
+    
     QCheckBox *checkCLAHE;
     QSlider *sliderCLAHEClip;
     QSlider *sliderCLAHETile;
     QLabel *lblCLAHEClipValue;
     QLabel *lblCLAHETileValue;
+    QCheckBox *checkCLAHEHU;
+    QSpinBox *spinCLAHEWindowLow;
+    QSpinBox *spinCLAHEWindowHigh;
+    QSpinBox *spinCLAHEBins;
     
     QPushButton *btnPresetLungs;
     QPushButton *btnPresetBones;
@@ -213,6 +275,7 @@ private:
     
     // Controles de DnCNN
     QCheckBox *checkDnCNN;
+    QCheckBox *checkDnCNNInt8;
     QLabel *lblDnCNNStatus;
     QPushButton *btnCompareWithDnCNN;
     
@@ -294,6 +357,7 @@ private:
     
     // Metrics tab widgets
     QTableWidget *tableMetrics;
+    QTableWidget *tableStageCache;
     QLabel *lblHistogramROI;
     QLabel *lblProcessTime;
     QLabel *lblMemoryUsage;
@@ -309,8 +373,26 @@ private:
     // Contexto del slice actual
     SliceContext sliceContext;
     
-    // Red neuronal DnCNN
+    // Red neuronal DnCNN (nullptr hasta que termine la carga en segundo plano)
     std::unique_ptr<Denoising::DnCNNDenoiser> dncnnDenoiser;
+    std::unique_ptr<Denoising::DnCNNDenoiser> pendingDenoiser;  // En uso por el hilo de carga o de calibración
+    std::unique_ptr<Preprocessing::SlabDenoiser> slabDenoiser;  // Losa de cortes vecinos de la serie
+    std::unique_ptr<Pipeline::StageGraph> stageGraph;           // Caché por etapa F3 -> F4 -> F5 (nullptr mientras la usa fullPassThread)
+    Visualization::LabelCompositor organCompositor;             // Color/opacidad/visibilidad por órgano
+    
+    // Vista previa progresiva
+    QTimer *previewSettleTimer;     // Dispara la pasada completa cuando el slider se detiene
+    int previewScale;               // 1 = resolución completa, 2 o 4 = vista previa
+    double lastFullPassMs;          // Duración de la última pasada completa
+    int pendingFullPasses;          // Etapas mostradas solo en vista previa
+    std::unique_ptr<Pipeline::StageGraph> previewGraph;                 // Caché de la vista previa (hilo de la interfaz)
+    std::unique_ptr<Preprocessing::SlabDenoiser> previewSlabDenoiser;   // Losa de la vista previa (hilo de la interfaz)
+    QThread *fullPassThread;        // Preprocesado a resolución completa en curso
+    std::unique_ptr<Pipeline::StageGraph> fullPassGraph;     // stageGraph mientras lo usa fullPassThread
+    std::shared_ptr<PreprocessingJob> fullPassJob;
+    int sliceGeneration;            // Cambia con cada corte: descarta resultados de cortes anteriores
+    QThread *modelLoaderThread;
+    QThread *int8CalibrationThread; // Calibra y valida INT8 con el denoiser en pendingDenoiser
 };
 
 #endif // MAINWINDOW_H
@@ -4,6 +4,10 @@
 #include <iostream>
 #include <iomanip>
 #include <filesystem>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -39,6 +43,78 @@ ImagePointer readDicomImage(const std::string& filename) {
     return reader->GetOutput();
 }
 
+namespace {
+
+// Lee solo la cabecera (sin datos de píxel) de un archivo DICOM
+itk::ImageFileReader<ImageType>::Pointer readDicomHeader(const std::string& filename) {
+    using ReaderType = itk::ImageFileReader<ImageType>;
+    auto reader = ReaderType::New();
+    reader->SetImageIO(itk::GDCMImageIO::New());
+    reader->SetFileName(filename);
+
+    try {
+        reader->UpdateOutputInformation();
+    }
+    catch (itk::ExceptionObject& ex) {
+        throw std::runtime_error("Error al leer la cabecera DICOM: " + std::string(ex.GetDescription()));
+    }
+    return reader;
+}
+
+// Interpreta un valor DICOM multivalor separado por barras invertidas (ej: "x\y\z")
+std::vector<double> parseDicomValues(std::string value) {
+    std::replace(value.begin(), value.end(), '\\', ' ');
+    std::istringstream stream(value);
+    std::vector<double> values;
+    double v;
+    while (stream >> v) {
+        values.push_back(v);
+    }
+    return values;
+}
+
+} // namespace
+
+VoxelSpacing readVoxelSpacing(const std::string& firstFile, const std::string& secondFile) {
+    VoxelSpacing spacing;
+
+    auto first = readDicomHeader(firstFile);
+    const auto pixelSpacing = first->GetOutput()->GetSpacing();
+    spacing.x = pixelSpacing[0];
+    spacing.y = pixelSpacing[1];
+
+    const itk::MetaDataDictionary& firstDict = first->GetImageIO()->GetMetaDataDictionary();
+    std::string value;
+
+    // Distancia entre las posiciones de dos cortes consecutivos (más fiable que SliceThickness)
+    if (!secondFile.empty()) {
+        auto second = readDicomHeader(secondFile);
+        const itk::MetaDataDictionary& secondDict = second->GetImageIO()->GetMetaDataDictionary();
+        std::string value2;
+        if (itk::ExposeMetaData<std::string>(firstDict, "0020|0032", value) &&
+            itk::ExposeMetaData<std::string>(secondDict, "0020|0032", value2)) {
+            const auto p1 = parseDicomValues(value);
+            const auto p2 = parseDicomValues(value2);
+            if (p1.size() == 3 && p2.size() == 3) {
+                const double dx = p2[0] - p1[0], dy = p2[1] - p1[1], dz = p2[2] - p1[2];
+                const double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                if (distance > 0.0) {
+                    spacing.z = distance;
+                    return spacing;
+                }
+            }
+        }
+    }
+
+    if (itk::ExposeMetaData<std::string>(firstDict, "0018|0050", value)) {
+        const auto thickness = parseDicomValues(value);
+        if (!thickness.empty() && thickness[0] > 0.0) {
+            spacing.z = thickness[0];
+        }
+    }
+    return spacing;
+}
+
 std::map<std::string, std::string> extractMetadata(itk::ImageFileReader<ImageType>::Pointer reader) {
     std::map<std::string, std::string> metadata;
     
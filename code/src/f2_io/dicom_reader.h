@@ -16,9 +16,20 @@ using PixelType = short;
 using ImageType = itk::Image<PixelType, Dimension>;
 using ImagePointer = ImageType::Pointer;
 
+// Espaciado físico de vóxel en mm (x, y: PixelSpacing; z: distancia entre cortes)
+struct VoxelSpacing {
+    double x = 1.0;
+    double y = 1.0;
+    double z = 1.0;
+};
+
 // Lee un archivo DICOM y retorna un puntero a la imagen ITK
 ImagePointer readDicomImage(const std::string& filename);
 
+// Lee el espaciado de vóxel de una serie a partir de la cabecera de dos cortes consecutivos.
+// Z se obtiene de ImagePositionPatient; si no hay segundo corte se usa SliceThickness
+VoxelSpacing readVoxelSpacing(const std::string& firstFile, const std::string& secondFile = "");
+
 // Extrae metadata de un archivo DICOM
 std::map<std::string, std::string> extractMetadata(itk::ImageFileReader<ImageType>::Pointer reader);
 
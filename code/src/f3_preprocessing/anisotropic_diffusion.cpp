@@ -0,0 +1,151 @@
+#include "anisotropic_diffusion.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+namespace Preprocessing {
+
+namespace {
+
+// Filas mínimas por banda: por debajo la barrera por iteración domina
+const int kMinBandRows = 16;
+
+/**
+ * @brief Buffers de una banda: diferencias y conducción de los 4 vecinos
+ *
+ * Una fila por vecino (N, S, E, O) para tratar los cuatro con una sola
+ * llamada vectorizada de OpenCV.
+ */
+struct RowScratch {
+    cv::Mat diff;
+    cv::Mat conduct;
+
+    explicit RowScratch(int cols)
+        : diff(4, cols, CV_32F), conduct(4, cols, CV_32F) {}
+};
+
+/**
+ * @brief Una iteración sobre la fila y: lee de in (incluidas las filas vecinas) y escribe en out
+ */
+void diffuseRow(const cv::Mat& in, cv::Mat& out, int y, float invKappa2, float lambda,
+                ConductanceFunction conductance, RowScratch& scratch) {
+    const int cols = in.cols;
+    const float* center = in.ptr<float>(y);
+    // Neumann: fuera de la imagen el vecino es el propio píxel (diferencia nula)
+    const float* up = y > 0 ? in.ptr<float>(y - 1) : center;
+    const float* down = y < in.rows - 1 ? in.ptr<float>(y + 1) : center;
+
+    float* dN = scratch.diff.ptr<float>(0);
+    float* dS = scratch.diff.ptr<float>(1);
+    float* dE = scratch.diff.ptr<float>(2);
+    float* dW = scratch.diff.ptr<float>(3);
+
+    for (int x = 0; x < cols; x++) {
+        dN[x] = up[x] - center[x];
+        dS[x] = down[x] - center[x];
+    }
+    for (int x = 0; x < cols - 1; x++) {
+        dE[x] = center[x + 1] - center[x];
+    }
+    dE[cols - 1] = 0.0f;
+    dW[0] = 0.0f;
+    for (int x = 1; x < cols; x++) {
+        dW[x] = center[x - 1] - center[x];
+    }
+
+    // Conducción de los cuatro vecinos (rutinas SIMD de OpenCV)
+    if (conductance == ConductanceFunction::EXPONENTIAL) {
+        cv::multiply(scratch.diff, scratch.diff, scratch.conduct, -invKappa2);
+        cv::exp(scratch.conduct, scratch.conduct);
+    } else {
+        cv::multiply(scratch.diff, scratch.diff, scratch.conduct, invKappa2);
+        cv::add(scratch.conduct, cv::Scalar(1.0), scratch.conduct);
+        cv::divide(1.0, scratch.conduct, scratch.conduct);
+    }
+
+    const float* gN = scratch.conduct.ptr<float>(0);
+    const float* gS = scratch.conduct.ptr<float>(1);
+    const float* gE = scratch.conduct.ptr<float>(2);
+    const float* gW = scratch.conduct.ptr<float>(3);
+    float* dst = out.ptr<float>(y);
+    for (int x = 0; x < cols; x++) {
+        dst[x] = center[x] + lambda * (gN[x] * dN[x] + gS[x] * dS[x] + gE[x] * dE[x] + gW[x] * dW[x]);
+    }
+}
+
+} // namespace
+
+cv::Mat applyAnisotropicDiffusion(const cv::Mat& image, const DiffusionParams& params, DiffusionStats* stats) {
+    if (image.empty() || image.channels() != 1 ||
+        (image.depth() != CV_8U && image.depth() != CV_16S &&
+         image.depth() != CV_16U && image.depth() != CV_32F)) {
+        std::cerr << "Advertencia: la difusión anisotrópica requiere una imagen de un canal "
+                  << "(CV_8U, CV_16S, CV_16U o CV_32F)" << std::endl;
+        return image.clone();
+    }
+    if (params.iterations <= 0 || params.kappa <= 0.0) {
+        return image.clone();
+    }
+
+    float lambda = static_cast<float>(params.lambda);
+    if (lambda <= 0.0f || lambda > 0.25f) {
+        std::cerr << "Advertencia: lambda=" << params.lambda
+                  << " fuera de (0, 0.25]; se usa 0.25 para mantener la estabilidad" << std::endl;
+        lambda = 0.25f;
+    }
+    const float invKappa2 = static_cast<float>(1.0 / (params.kappa * params.kappa));
+
+    int bands = params.numBands > 0 ? params.numBands : std::max(1, cv::getNumThreads());
+    bands = std::max(1, std::min(bands, image.rows / kMinBandRows));
+    const int bandRows = (image.rows + bands - 1) / bands;
+
+    // Buffers ping-pong: se reservan una vez y se alternan en cada iteración
+    cv::Mat current, next(image.size(), CV_32F);
+    image.convertTo(current, CV_32F);
+
+    // Buffers de fila de cada banda, también reservados una sola vez (uno por
+    // banda y no por hilo: parallel_for_ no dice qué hilo ejecuta cada banda)
+    std::vector<RowScratch> scratch;
+    scratch.reserve(bands);
+    for (int b = 0; b < bands; b++) {
+        scratch.emplace_back(image.cols);
+    }
+
+    cv::TickMeter timer;
+    timer.start();
+    for (int it = 0; it < params.iterations; it++) {
+        // Cada banda lee la fila de halo de sus vecinas en current (iteración anterior);
+        // parallel_for_ actúa como barrera antes del intercambio de buffers
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+            for (int b = range.start; b < range.end; b++) {
+                const int y0 = b * bandRows;
+                const int y1 = std::min(image.rows, y0 + bandRows);
+                for (int y = y0; y < y1; y++) {
+                    diffuseRow(current, next, y, invKappa2, lambda, params.conductance, scratch[b]);
+                }
+            }
+        });
+        std::swap(current, next);
+    }
+    timer.stop();
+
+    if (stats) {
+        stats->totalMs = timer.getTimeMilli();
+        stats->msPerIteration = stats->totalMs / params.iterations;
+        stats->bands = bands;
+    }
+
+    cv::Mat output;
+    current.convertTo(output, image.type());
+    return output;
+}
+
+std::string conductanceName(ConductanceFunction conductance) {
+    switch (conductance) {
+        case ConductanceFunction::EXPONENTIAL: return "exponencial";
+        case ConductanceFunction::QUADRATIC:   return "cuadrática";
+    }
+    return "desconocida";
+}
+
+} // namespace Preprocessing
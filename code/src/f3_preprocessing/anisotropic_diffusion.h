@@ -0,0 +1,69 @@
+#ifndef ANISOTROPIC_DIFFUSION_H
+#define ANISOTROPIC_DIFFUSION_H
+
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace Preprocessing {
+
+// ============================================================================
+// DIFUSIÓN ANISOTRÓPICA (PERONA-MALIK)
+// ============================================================================
+
+/**
+ * @brief Función de conducción g(|∇I|)
+ */
+enum class ConductanceFunction {
+    EXPONENTIAL,    // exp(-(|∇I|/kappa)^2): favorece bordes de alto contraste
+    QUADRATIC       // 1 / (1 + (|∇I|/kappa)^2): favorece regiones amplias
+};
+
+/**
+ * @brief Parámetros de la difusión
+ */
+struct DiffusionParams {
+    int iterations = 10;        // Iteraciones (el coste es lineal)
+    double kappa = 30.0;        // Umbral de gradiente (unidades de la imagen; HU para CV_16S)
+    double lambda = 0.2;        // Paso de integración (estable si <= 0.25)
+    ConductanceFunction conductance = ConductanceFunction::EXPONENTIAL;
+    int numBands = 0;           // Bandas de filas en paralelo; 0 = automático
+};
+
+/**
+ * @brief Estadísticas de tiempo de una ejecución
+ */
+struct DiffusionStats {
+    double totalMs = 0.0;
+    double msPerIteration = 0.0;
+    int bands = 0;
+};
+
+/**
+ * @brief Difusión anisotrópica de Perona-Malik con 4 vecinos
+ *
+ * Trabaja en float sobre dos buffers que se alternan (ping-pong) sin
+ * reservar memoria por iteración. Cada iteración se reparte en bandas de
+ * filas; una banda lee la fila vecina de las bandas contiguas (halo) del
+ * buffer de la iteración anterior, por lo que basta con una barrera entre
+ * iteraciones. Los flujos de cada fila se calculan vectorizados (restas en
+ * bucles contiguos y cv::exp de OpenCV). Bordes con flujo nulo (Neumann).
+ *
+ * El coste por iteración solo depende del tamaño de la imagen, no de
+ * kappa ni de la conducción, así que msPerIteration permite presupuestar.
+ *
+ * @param image Imagen de un canal (CV_8U, CV_16S en HU, CV_16U o CV_32F)
+ * @param params Parámetros de la difusión
+ * @param stats Si no es nulo, recibe los tiempos
+ * @return Imagen difundida del mismo tipo
+ */
+cv::Mat applyAnisotropicDiffusion(const cv::Mat& image, const DiffusionParams& params = DiffusionParams(),
+                                  DiffusionStats* stats = nullptr);
+
+/**
+ * @brief Nombre legible de la función de conducción
+ */
+std::string conductanceName(ConductanceFunction conductance);
+
+} // namespace Preprocessing
+
+#endif // ANISOTROPIC_DIFFUSION_H
@@ -0,0 +1,242 @@
+#include "denoise_cache.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace Denoising {
+
+namespace {
+
+const uint64_t kFnvOffset = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+const uint32_t kEntryMagic = 0x31434E44;   // "DNC1"
+
+// Tras una evicción se deja la caché al 90% del máximo para no evictar en cada store
+const double kEvictionTarget = 0.9;
+
+inline uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+struct EntryHeader {
+    uint32_t magic;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+};
+
+} // namespace
+
+DenoiseCache::DenoiseCache(const std::string& directory, uint64_t maxBytes)
+    : directory(directory),
+      maxBytes(maxBytes),
+      currentBytes(0),
+      hits(0),
+      misses(0) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Advertencia: No se pudo crear la caché en " << directory << ": " << ec.message() << std::endl;
+        return;
+    }
+
+    uint64_t total = 0;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".bin") {
+            total += entry.file_size();
+        }
+    }
+    currentBytes = total;
+}
+
+std::string DenoiseCache::entryPath(const std::string& key) const {
+    return (fs::path(directory) / (key + ".bin")).string();
+}
+
+bool DenoiseCache::lookup(const std::string& key, int type, const cv::Size& size, cv::Mat& output) {
+    const std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        misses++;
+        return false;
+    }
+
+    // La cabecera debe describir justo la imagen pedida y el archivo contenerla entera
+    EntryHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kEntryMagic || header.type != type ||
+        header.rows != size.height || header.cols != size.width || size.area() <= 0) {
+        misses++;
+        return false;
+    }
+    std::error_code ec;
+    const uint64_t payload = static_cast<uint64_t>(size.area()) * CV_ELEM_SIZE(type);
+    const uint64_t fileBytes = fs::file_size(path, ec);
+    if (ec || fileBytes != sizeof(header) + payload) {
+        misses++;
+        return false;
+    }
+
+    cv::Mat image(header.rows, header.cols, header.type);
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows && file; y++) {
+        file.read(reinterpret_cast<char*>(image.ptr(y)), rowBytes);
+    }
+    if (!file) {
+        misses++;
+        return false;
+    }
+    file.close();
+
+    // LRU: la fecha de modificación marca el último uso
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    output = image;
+    hits++;
+    return true;
+}
+
+bool DenoiseCache::store(const std::string& key, const cv::Mat& image) {
+    if (image.empty() || image.dims != 2) return false;
+
+    const std::string path = entryPath(key);
+    std::ostringstream tmpName;
+    tmpName << path << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+    const std::string tmpPath = tmpName.str();
+
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        EntryHeader header = {kEntryMagic, image.rows, image.cols, image.type()};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const size_t rowBytes = image.cols * image.elemSize();
+        for (int y = 0; y < image.rows; y++) {
+            file.write(reinterpret_cast<const char*>(image.ptr(y)), rowBytes);
+        }
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    // Renombrar para que un lector nunca vea una entrada a medio escribir
+    std::error_code ec;
+    const bool existed = fs::exists(path, ec);
+    const uint64_t size = fs::file_size(tmpPath, ec);
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return existed;
+    }
+    if (!existed) {
+        currentBytes += size;
+    }
+
+    if (currentBytes > maxBytes) {
+        evict();
+    }
+    return true;
+}
+
+void DenoiseCache::evict() {
+    std::lock_guard<std::mutex> lock(evictionMutex);
+
+    struct Entry {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type lastUse;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".bin") continue;
+        Entry e = {entry.path(), entry.file_size(ec), entry.last_write_time(ec)};
+        total += e.size;
+        entries.push_back(e);
+    }
+    if (total <= maxBytes) {
+        currentBytes = total;
+        return;
+    }
+
+    // Borrar primero las entradas usadas hace más tiempo
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.lastUse < b.lastUse;
+    });
+    const uint64_t target = static_cast<uint64_t>(maxBytes * kEvictionTarget);
+    size_t removed = 0;
+    for (const Entry& e : entries) {
+        if (total <= target) break;
+        if (fs::remove(e.path, ec)) {
+            total -= e.size;
+            removed++;
+        }
+    }
+    currentBytes = total;
+    std::cout << "Caché de denoising: " << removed << " entradas eliminadas (LRU), "
+              << (total / (1024 * 1024)) << " MB en uso" << std::endl;
+}
+
+void DenoiseCache::clear() {
+    std::lock_guard<std::mutex> lock(evictionMutex);
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".bin") {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    currentBytes = 0;
+}
+
+// ============================================================================
+// HASHES Y CLAVES
+// ============================================================================
+
+uint64_t DenoiseCache::hashImage(const cv::Mat& image) {
+    const int32_t meta[] = {image.rows, image.cols, image.type()};
+    uint64_t hash = fnv1a(kFnvOffset, meta, sizeof(meta));
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; y++) {
+        hash = fnv1a(hash, image.ptr(y), rowBytes);
+    }
+    return hash;
+}
+
+uint64_t DenoiseCache::hashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    uint64_t hash = kFnvOffset;
+    std::vector<char> buffer(1 << 16);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return hash;
+}
+
+std::string DenoiseCache::makeKey(uint64_t imageHash, uint64_t modelHash, const std::string& backend) {
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << imageHash << "_"
+        << std::setw(16) << modelHash << "_" << backend;
+    return key.str();
+}
+
+} // namespace Denoising
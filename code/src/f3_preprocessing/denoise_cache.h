@@ -0,0 +1,93 @@
+#ifndef DENOISE_CACHE_H
+#define DENOISE_CACHE_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+
+namespace Denoising {
+
+// ============================================================================
+// CACHÉ EN DISCO DE CORTES DENOISED
+// ============================================================================
+
+/**
+ * @brief Caché en disco de salidas de denoising
+ *
+ * Cada entrada es un archivo "<clave>.bin" (cabecera + píxeles en crudo).
+ * La clave combina el hash de los píxeles de entrada, el del modelo y el
+ * backend (ver DnCNNDenoiser::enableCache). Al leer una entrada se actualiza
+ * su fecha de modificación, y al superar el tamaño máximo se borran las
+ * menos usadas recientemente (LRU por fecha de modificación).
+ * Las operaciones son seguras desde varios hilos.
+ */
+class DenoiseCache {
+public:
+    /**
+     * @param directory Carpeta de la caché (se crea si no existe)
+     * @param maxBytes Tamaño máximo en disco
+     */
+    DenoiseCache(const std::string& directory, uint64_t maxBytes);
+
+    /**
+     * @brief Busca una entrada
+     *
+     * Una entrada con otro tipo o tamaño, o cuyo contenido no ocupa
+     * exactamente rows·cols píxeles, cuenta como fallo.
+     *
+     * @param key Clave (ver makeKey)
+     * @param type Tipo esperado de la imagen
+     * @param size Tamaño esperado de la imagen
+     * @param output Imagen guardada (si existe)
+     * @return true si hubo acierto
+     */
+    bool lookup(const std::string& key, int type, const cv::Size& size, cv::Mat& output);
+
+    /**
+     * @brief Guarda una entrada y aplica el límite de tamaño
+     */
+    bool store(const std::string& key, const cv::Mat& image);
+
+    /**
+     * @brief Borra todas las entradas
+     */
+    void clear();
+
+    const std::string& getDirectory() const { return directory; }
+    uint64_t getMaxBytes() const { return maxBytes; }
+    uint64_t getCurrentBytes() const { return currentBytes; }
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+
+    /**
+     * @brief Hash FNV-1a de 64 bits de los píxeles (incluye tamaño y tipo)
+     */
+    static uint64_t hashImage(const cv::Mat& image);
+
+    /**
+     * @brief Hash FNV-1a de 64 bits del contenido de un archivo (0 si no existe)
+     */
+    static uint64_t hashFile(const std::string& path);
+
+    /**
+     * @brief Compone la clave de una entrada
+     */
+    static std::string makeKey(uint64_t imageHash, uint64_t modelHash, const std::string& backend);
+
+private:
+    std::string entryPath(const std::string& key) const;
+    void evict();
+
+    std::string directory;
+    uint64_t maxBytes;
+    std::atomic<uint64_t> currentBytes;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::mutex evictionMutex;
+};
+
+} // namespace Denoising
+
+#endif // DENOISE_CACHE_H
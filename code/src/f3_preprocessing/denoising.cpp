@@ -1,40 +1,274 @@
 #include "denoising.h"
+#include "native_dncnn.h"
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <filesystem>
 
 namespace Denoising {
 
-DnCNNDenoiser::DnCNNDenoiser() : modelLoaded(false) {}
+namespace {
 
-bool DnCNNDenoiser::loadModel(const std::string& onnxPath) {
-    try {
-        std::cout << "Cargando modelo DnCNN: " << onnxPath << std::endl;
-        
-        net = cv::dnn::readNetFromONNX(onnxPath);
-        
-        if (net.empty()) {
-            std::cerr << "Error: No se pudo cargar el modelo ONNX" << std::endl;
-            return false;
+// Campo receptivo de DnCNN: 17 convoluciones 3x3 -> 17 píxeles por lado
+const int kReceptiveFieldRadius = 17;
+
+/**
+ * @brief Convierte una imagen a float [0, 1] monocanal para la red
+ * @param minVal Valor que se mapea a 0 (salida)
+ * @param range Rango que se mapea a 1 (salida)
+ */
+cv::Mat toNetworkInput(const cv::Mat& image, double& minVal, double& range) {
+    cv::Mat gray = image;
+    if (gray.channels() > 1) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
+    
+    minVal = 0.0;
+    range = 1.0;
+    if (gray.depth() == CV_8U) {
+        range = 255.0;
+    } else if (gray.depth() == CV_16S || gray.depth() == CV_16U) {
+        // Para imágenes CT (16-bit), normalizar a [0, 1] con un solo minMaxLoc
+        double maxVal;
+        cv::minMaxLoc(gray, &minVal, &maxVal);
+        range = std::max(maxVal - minVal, 1.0);
+    }
+    
+    cv::Mat inputFloat;
+    gray.convertTo(inputFloat, CV_32F, 1.0 / range, -minVal / range);
+    return inputFloat;
+}
+
+/**
+ * @brief Recorta la salida de la red a [0, 1] y la devuelve al rango original
+ * @param denoisedFloat Salida de la red (se modifica en el sitio)
+ * @param depth Profundidad de la imagen original
+ * @param dst Destino (se reutiliza si ya tiene el tamaño y tipo correctos)
+ */
+void fromNetworkOutput(cv::Mat& denoisedFloat, int depth, double minVal, double range, cv::Mat& dst) {
+    cv::max(denoisedFloat, 0.0, denoisedFloat);
+    cv::min(denoisedFloat, 1.0, denoisedFloat);
+    
+    if (depth == CV_8U || depth == CV_16S || depth == CV_16U) {
+        denoisedFloat.convertTo(dst, depth, range, minVal);
+    } else {
+        denoisedFloat.copyTo(dst);
+    }
+}
+
+/**
+ * @brief Tipo que produce fromNetworkOutput para una entrada (la red es monocanal)
+ */
+int networkOutputType(const cv::Mat& image) {
+    const int depth = image.depth();
+    return (depth == CV_8U || depth == CV_16S || depth == CV_16U) ? CV_MAKETYPE(depth, 1) : CV_32FC1;
+}
+
+} // namespace
+
+DnCNNDenoiser::DnCNNDenoiser()
+    : pool(std::make_unique<DnCNNNetPool>()),
+      modelLoaded(false),
+      numThreads(0),
+      numReplicas(0),
+      fp32Backend(InferenceBackend::OPENCV_DNN),
+      modelHash(0),
+      int8Hash(0) {}
+
+bool DnCNNDenoiser::loadModel(const std::string& onnxPath,
+                              InferenceBackend backend,
+                              const cv::Size& benchmarkSize) {
+    std::cout << "Cargando modelo DnCNN: " << onnxPath << std::endl;
+    
+    // Backend: el guardado para esta máquina o, si no hay, el más rápido del micro-benchmark
+    if (backend == InferenceBackend::AUTO) {
+        backend = loadBackendChoice(onnxPath, benchmarkSize);
+        if (backend == InferenceBackend::AUTO) {
+            std::cout << "Midiendo backends de inferencia (" << benchmarkSize.width << "x"
+                      << benchmarkSize.height << ")..." << std::endl;
+            backend = selectFastestBackend(onnxPath, benchmarkSize);
+            saveBackendChoice(onnxPath, benchmarkSize, backend);
         }
-        
-        // Configurar backend (CPU por defecto)
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-        
-        modelLoaded = true;
-        modelPath = onnxPath;
-        
-        std::cout << "Modelo DnCNN cargado exitosamente" << std::endl;
-        return true;
-        
-    } catch (const cv::Exception& e) {
-        std::cerr << "Excepcion OpenCV: " << e.what() << std::endl;
-        modelLoaded = false;
+    }
+    
+    // El pool se dimensiona aquí (y en setParallelism), no en la inferencia
+    modelLoaded = pool->load(onnxPath, replicaCount(), backend);
+    if (!modelLoaded) {
+        std::cerr << "Error: No se pudo cargar el modelo ONNX" << std::endl;
+        return false;
+    }
+    
+    modelPath = onnxPath;
+    if (cache) {
+        modelHash = hashModelFiles(modelPath);
+    }
+    if (backend != InferenceBackend::NATIVE_INT8) {
+        fp32Backend = backend;
+    } else {
+        int8Hash = DenoiseCache::hashFile(NativeDnCNNEngine::calibrationPath(modelPath));
+    }
+    std::cout << "Modelo DnCNN cargado exitosamente (backend: " << backendName(backend) << ")" << std::endl;
+    return true;
+}
+
+bool DnCNNDenoiser::warmUp(const cv::Size& size) {
+    if (!modelLoaded) return false;
+    
+    const int sizes[] = {1, 1, size.height, size.width};
+    cv::Mat blob(4, sizes, CV_32F, cv::Scalar(0));
+    cv::Mat output;
+    DnCNNNetPool::Lease lease = pool->acquire();
+    return lease.valid() && lease.engine().run(blob, output);
+}
+
+bool DnCNNDenoiser::setBackend(InferenceBackend backend) {
+    if (backend == InferenceBackend::AUTO) {
+        if (!modelLoaded) return false;
+        backend = selectFastestBackend(modelPath, cv::Size(512, 512));
+    }
+    if (!pool->setBackend(backend)) return false;
+    if (backend != InferenceBackend::NATIVE_INT8) {
+        fp32Backend = backend;
+    } else if (int8Hash == 0) {
+        int8Hash = DenoiseCache::hashFile(NativeDnCNNEngine::calibrationPath(modelPath));
+    }
+    return true;
+}
+
+// ============================================================================
+// MODO INT8
+// ============================================================================
+
+bool DnCNNDenoiser::calibrateInt8(const std::vector<cv::Mat>& slices) {
+    if (!modelLoaded) {
+        std::cerr << "Error: Modelo no cargado" << std::endl;
+        return false;
+    }
+    
+    NativeDnCNNEngine engine;
+    if (!engine.load(modelPath)) {
+        std::cerr << "Error: El motor nativo no admite este modelo" << std::endl;
+        return false;
+    }
+    
+    std::vector<cv::Mat> blobs;
+    for (const cv::Mat& slice : slices) {
+        double minVal = 0.0, range = 1.0;
+        cv::Mat inputFloat = toNetworkInput(slice, minVal, range);
+        blobs.push_back(cv::dnn::blobFromImage(inputFloat, 1.0, inputFloat.size(), cv::Scalar(0), false, false));
+    }
+    const std::string calibration = NativeDnCNNEngine::calibrationPath(modelPath);
+    if (!engine.calibrate(blobs) || !engine.saveCalibration(calibration)) {
+        std::cerr << "Error: No se pudo calibrar el modo INT8" << std::endl;
         return false;
     }
+    std::cout << "Calibración INT8 guardada (" << blobs.size() << " cortes): " << calibration << std::endl;
+    
+    // Las claves de caché INT8 dependen de las escalas: un solo hash por calibración
+    int8Hash = DenoiseCache::hashFile(calibration);
+    
+    // Las réplicas INT8 existentes usan las escalas anteriores: recrearlas
+    if (getBackend() == InferenceBackend::NATIVE_INT8) {
+        pool->setBackend(fp32Backend);
+        pool->setBackend(InferenceBackend::NATIVE_INT8);
+    }
+    return true;
+}
+
+Int8Validation DnCNNDenoiser::validateInt8(const std::vector<cv::Mat>& slices,
+                                           double minPSNR, double minSSIM) {
+    Int8Validation result;
+    if (!modelLoaded || slices.empty()) {
+        return result;
+    }
+    
+    const InferenceBackend previous = getBackend();
+    
+    // Referencia FP32
+    if (!pool->setBackend(fp32Backend)) {
+        return result;
+    }
+    std::vector<cv::Mat> reference;
+    reference.reserve(slices.size());
+    for (const cv::Mat& slice : slices) {
+        reference.push_back(denoise(slice));
+    }
+    
+    if (!pool->setBackend(InferenceBackend::NATIVE_INT8)) {
+        pool->setBackend(previous);
+        return result;
+    }
+    
+    double sumPSNR = 0.0, sumSSIM = 0.0;
+    result.minPSNR = std::numeric_limits<double>::max();
+    result.minSSIM = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < slices.size(); i++) {
+        cv::Mat quantized = denoise(slices[i]);
+        const double psnr = calculatePSNR(reference[i], quantized);
+        const double ssim = calculateSSIM(reference[i], quantized);
+        result.minPSNR = std::min(result.minPSNR, psnr);
+        result.minSSIM = std::min(result.minSSIM, ssim);
+        sumPSNR += psnr;
+        sumSSIM += ssim;
+    }
+    pool->setBackend(previous);
+    
+    result.slices = static_cast<int>(slices.size());
+    result.meanPSNR = sumPSNR / result.slices;
+    result.meanSSIM = sumSSIM / result.slices;
+    result.passed = (result.minPSNR >= minPSNR && result.minSSIM >= minSSIM);
+    
+    std::cout << "Validación INT8 vs FP32 (" << backendName(fp32Backend) << ", "
+              << result.slices << " cortes):" << std::endl;
+    std::cout << "   PSNR min/medio: " << result.minPSNR << " / " << result.meanPSNR << " dB" << std::endl;
+    std::cout << "   SSIM min/medio: " << result.minSSIM << " / " << result.meanSSIM << std::endl;
+    std::cout << "   " << (result.passed ? "Dentro de los umbrales" : "Fuera de los umbrales")
+              << " (PSNR >= " << minPSNR << " dB, SSIM >= " << minSSIM << ")" << std::endl;
+    return result;
+}
+
+Int8Validation DnCNNDenoiser::enableInt8(const std::vector<cv::Mat>& calibrationSlices,
+                                         const std::vector<cv::Mat>& validationSlices,
+                                         double minPSNR, double minSSIM) {
+    Int8Validation result;
+    if (!calibrateInt8(calibrationSlices)) {
+        return result;
+    }
+    
+    if (validationSlices.empty()) {
+        std::cerr << "Advertencia: Validación INT8 sobre los cortes de calibración (no independiente)" << std::endl;
+    }
+    result = validateInt8(validationSlices.empty() ? calibrationSlices : validationSlices, minPSNR, minSSIM);
+    if (result.passed) {
+        setBackend(InferenceBackend::NATIVE_INT8);
+    } else {
+        std::cerr << "Advertencia: INT8 no activado, se mantiene " << backendName(getBackend()) << std::endl;
+    }
+    return result;
+}
+
+bool DnCNNDenoiser::disableInt8() {
+    return pool->setBackend(fp32Backend);
+}
+
+int DnCNNDenoiser::replicaCount() const {
+    // Las configuradas o una por hilo de la inferencia por teselas
+    if (numReplicas > 0) return numReplicas;
+    return (numThreads > 0) ? numThreads : std::max(1, cv::getNumThreads());
+}
+
+void DnCNNDenoiser::setParallelism(int threads, int replicas) {
+    numThreads = std::max(0, threads);
+    numReplicas = std::max(0, replicas);
+    if (modelLoaded) {
+        pool->reserve(replicaCount());
+    }
 }
 
 cv::Mat DnCNNDenoiser::denoise(const cv::Mat& noisyImage) {
@@ -43,28 +277,22 @@ cv::Mat DnCNNDenoiser::denoise(const cv::Mat& noisyImage) {
         return noisyImage.clone();
     }
     
-    try {
-        // 1. Convertir a float [0, 1]
-        cv::Mat inputFloat;
-        int originalType = noisyImage.type();
-        
-        if (noisyImage.type() == CV_8U) {
-            noisyImage.convertTo(inputFloat, CV_32F, 1.0/255.0);
-        } else if (noisyImage.type() == CV_16S || noisyImage.type() == CV_16U) {
-            // Para imágenes CT (16-bit), normalizar a [0, 1]
-            double minVal, maxVal;
-            cv::minMaxLoc(noisyImage, &minVal, &maxVal);
-            noisyImage.convertTo(inputFloat, CV_32F, 1.0/(maxVal - minVal), -minVal/(maxVal - minVal));
-        } else {
-            inputFloat = noisyImage.clone();
-        }
-        
-        // 2. Asegurar single-channel
-        if (inputFloat.channels() > 1) {
-            cv::cvtColor(inputFloat, inputFloat, cv::COLOR_BGR2GRAY);
+    // Caché en disco: un acierto evita la inferencia
+    std::string key;
+    if (cache) {
+        key = cacheKey(noisyImage);
+        cv::Mat cached;
+        if (cache->lookup(key, networkOutputType(noisyImage), noisyImage.size(), cached)) {
+            return cached;
         }
+    }
+    
+    try {
+        // 1. Convertir a float [0, 1] (single-channel)
+        double minVal = 0.0, range = 1.0;
+        cv::Mat inputFloat = toNetworkInput(noisyImage, minVal, range);
         
-        // 3. Crear blob (NCHW: 1 x 1 x H x W)
+        // 2. Crear blob (NCHW: 1 x 1 x H x W)
         cv::Mat blob = cv::dnn::blobFromImage(
             inputFloat,
             1.0,                    // NO re-escalar (ya está en [0,1])
@@ -74,51 +302,22 @@ cv::Mat DnCNNDenoiser::denoise(const cv::Mat& noisyImage) {
             false                   
         );
         
-        // 4. Inferencia
-        net.setInput(blob);
-        cv::Mat outputBlob = net.forward();
-        
-        // 5. CORRECCIÓN CRÍTICA: Extraer imagen del blob de SALIDA
-        // El blob tiene formato NCHW (1 x 1 x H x W)
-        // Necesitamos extraer el canal [0][0]
-        
-        cv::Mat denoisedFloat;
-        
-        // Método 1: Acceso directo a los datos
-        const int* dims = outputBlob.size.p;
-        int height = dims[2];
-        int width = dims[3];
-        
-        // Crear Mat desde los datos del blob
-        denoisedFloat = cv::Mat(height, width, CV_32F, outputBlob.ptr<float>(0, 0));
-        denoisedFloat = denoisedFloat.clone(); // Hacer copia profunda
+        // 3. Inferencia (réplica exclusiva mientras dure el préstamo)
+        DnCNNNetPool::Lease lease = pool->acquire();
+        cv::Mat outputBlob;
+        if (!lease.valid() || !lease.engine().run(blob, outputBlob)) {
+            return noisyImage.clone();
+        }
         
-        // 6. Clamp a [0, 1] para evitar valores fuera de rango
-        cv::max(denoisedFloat, 0.0, denoisedFloat);
-        cv::min(denoisedFloat, 1.0, denoisedFloat);
+        // 4. Extraer el canal [0][0] del blob de salida (NCHW)
+        cv::Mat denoisedFloat(outputBlob.size[2], outputBlob.size[3], CV_32F, outputBlob.ptr<float>(0, 0));
         
-        // 7. Convertir de vuelta al tipo original
+        // 5. Clamp y conversión al tipo original
         cv::Mat result;
-        
-        if (originalType == CV_8U) {
-            denoisedFloat.convertTo(result, CV_8U, 255.0);
-        } else if (originalType == CV_16S || originalType == CV_16U) {
-            double minVal, maxVal;
-            cv::minMaxLoc(noisyImage, &minVal, &maxVal);
-            denoisedFloat.convertTo(result, originalType, (maxVal - minVal), minVal);
-        } else {
-            result = denoisedFloat;
+        fromNetworkOutput(denoisedFloat, noisyImage.depth(), minVal, range, result);
+        if (cache) {
+            cache->store(key, result);
         }
-        
-        // 8. Verificación de debug (opcional, comentar en producción)
-        /*
-        cv::Mat diff;
-        cv::absdiff(noisyImage, result, diff);
-        double maxDiff = 0;
-        cv::minMaxLoc(diff, nullptr, &maxDiff);
-        std::cout << "   [DEBUG] Diferencia máxima: " << maxDiff << std::endl;
-        */
-        
         return result;
         
     } catch (const cv::Exception& e) {
@@ -127,11 +326,249 @@ cv::Mat DnCNNDenoiser::denoise(const cv::Mat& noisyImage) {
     }
 }
 
+bool DnCNNDenoiser::denoiseBatch(const std::vector<cv::Mat>& inputs,
+                                 std::vector<cv::Mat>& outputs,
+                                 int batchSize) {
+    if (!cache || !modelLoaded) {
+        return denoiseBatchUncached(inputs, outputs, batchSize);
+    }
+    
+    // Solo los cortes que no están en la caché pasan por la red
+    outputs.resize(inputs.size());
+    std::vector<std::string> keys(inputs.size());
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        keys[i] = cacheKey(inputs[i]);
+        if (!cache->lookup(keys[i], networkOutputType(inputs[i]), inputs[i].size(), outputs[i])) {
+            missing.push_back(i);
+        }
+    }
+    if (missing.empty()) {
+        return true;
+    }
+    
+    std::vector<cv::Mat> missingInputs, missingOutputs;
+    missingInputs.reserve(missing.size());
+    for (size_t i : missing) {
+        missingInputs.push_back(inputs[i]);
+    }
+    const bool ok = denoiseBatchUncached(missingInputs, missingOutputs, batchSize);
+    for (size_t j = 0; j < missing.size(); j++) {
+        outputs[missing[j]] = missingOutputs[j];
+        if (ok) {
+            cache->store(keys[missing[j]], missingOutputs[j]);
+        }
+    }
+    return ok;
+}
+
+bool DnCNNDenoiser::denoiseBatchUncached(const std::vector<cv::Mat>& inputs,
+                                         std::vector<cv::Mat>& outputs,
+                                         int batchSize) {
+    outputs.resize(inputs.size());
+    if (!modelLoaded) {
+        std::cerr << "Advertencia: Modelo no cargado, devolviendo imágenes originales" << std::endl;
+        for (size_t i = 0; i < inputs.size(); i++) inputs[i].copyTo(outputs[i]);
+        return false;
+    }
+    batchSize = std::max(1, batchSize);
+    
+    std::vector<cv::Mat> floats;
+    std::vector<double> mins, ranges;
+    floats.reserve(batchSize);
+    mins.reserve(batchSize);
+    ranges.reserve(batchSize);
+    
+    size_t start = 0;
+    while (start < inputs.size()) {
+        // Lote de hasta batchSize cortes consecutivos del mismo tamaño
+        size_t end = start + 1;
+        while (end < inputs.size() && end - start < static_cast<size_t>(batchSize) &&
+               inputs[end].size() == inputs[start].size()) {
+            end++;
+        }
+        
+        floats.clear();
+        mins.clear();
+        ranges.clear();
+        for (size_t i = start; i < end; i++) {
+            double minVal = 0.0, range = 1.0;
+            floats.push_back(toNetworkInput(inputs[i], minVal, range));
+            mins.push_back(minVal);
+            ranges.push_back(range);
+        }
+        
+        try {
+            // Un solo forward para todo el lote (NCHW: N x 1 x H x W)
+            cv::Mat blob = cv::dnn::blobFromImages(floats, 1.0, cv::Size(), cv::Scalar(0), false, false);
+            DnCNNNetPool::Lease lease = pool->acquire();
+            cv::Mat outputBlob;
+            if (!lease.valid() || !lease.engine().run(blob, outputBlob)) {
+                for (size_t i = start; i < end; i++) inputs[i].copyTo(outputs[i]);
+                return false;
+            }
+            
+            const int height = outputBlob.size[2];
+            const int width = outputBlob.size[3];
+            for (size_t i = start; i < end; i++) {
+                const int n = static_cast<int>(i - start);
+                cv::Mat plane(height, width, CV_32F, outputBlob.ptr<float>(n, 0));
+                fromNetworkOutput(plane, inputs[i].depth(), mins[n], ranges[n], outputs[i]);
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Error en denoising por lotes: " << e.what() << std::endl;
+            for (size_t i = start; i < end; i++) inputs[i].copyTo(outputs[i]);
+            return false;
+        }
+        
+        start = end;
+    }
+    
+    return true;
+}
+
+cv::Mat DnCNNDenoiser::denoiseTiled(const cv::Mat& noisyImage, int tileSize, int numThreads) {
+    if (!modelLoaded) {
+        std::cerr << "Advertencia: Modelo no cargado, devolviendo imagen original" << std::endl;
+        return noisyImage.clone();
+    }
+    
+    std::string key;
+    if (cache) {
+        key = cacheKey(noisyImage);
+        cv::Mat cached;
+        if (cache->lookup(key, networkOutputType(noisyImage), noisyImage.size(), cached)) {
+            return cached;
+        }
+    }
+    
+    tileSize = std::max(tileSize, 16);
+    if (numThreads <= 0) {
+        numThreads = (this->numThreads > 0) ? this->numThreads : std::max(1, cv::getNumThreads());
+    }
+    
+    double minVal = 0.0, range = 1.0;
+    cv::Mat inputFloat = toNetworkInput(noisyImage, minVal, range);
+    const cv::Rect imageRect(0, 0, inputFloat.cols, inputFloat.rows);
+    
+    // Rejilla de teselas (la última fila/columna puede ser más pequeña)
+    std::vector<cv::Rect> tiles;
+    for (int y = 0; y < inputFloat.rows; y += tileSize) {
+        for (int x = 0; x < inputFloat.cols; x += tileSize) {
+            tiles.emplace_back(x, y, std::min(tileSize, inputFloat.cols - x),
+                               std::min(tileSize, inputFloat.rows - y));
+        }
+    }
+    numThreads = std::min<int>(numThreads, static_cast<int>(tiles.size()));
+    
+    // El pool ya está dimensionado (loadModel / setParallelism): más hilos
+    // que réplicas solo harían esperar turno
+    numThreads = std::max(1, std::min(numThreads, pool->size()));
+    
+    cv::Mat outputFloat(inputFloat.size(), CV_32F);
+    std::atomic<size_t> nextTile(0);
+    std::atomic<bool> failed(false);
+    
+    auto worker = [&]() {
+        for (size_t t = nextTile++; t < tiles.size() && !failed; t = nextTile++) {
+            const cv::Rect& core = tiles[t];
+            
+            // Halo del tamaño del campo receptivo; en los bordes de la imagen
+            // el relleno con ceros de cada capa coincide con el de la imagen completa
+            cv::Rect extended(core.x - kReceptiveFieldRadius, core.y - kReceptiveFieldRadius,
+                              core.width + 2 * kReceptiveFieldRadius,
+                              core.height + 2 * kReceptiveFieldRadius);
+            extended &= imageRect;
+            
+            try {
+                cv::Mat blob = cv::dnn::blobFromImage(inputFloat(extended), 1.0, extended.size(),
+                                                      cv::Scalar(0), false, false);
+                DnCNNNetPool::Lease lease = pool->acquire();
+                cv::Mat outputBlob;
+                if (!lease.valid() || !lease.engine().run(blob, outputBlob)) {
+                    failed = true;
+                    break;
+                }
+                
+                cv::Mat plane(extended.height, extended.width, CV_32F, outputBlob.ptr<float>(0, 0));
+                cv::Rect interior(core.x - extended.x, core.y - extended.y, core.width, core.height);
+                plane(interior).copyTo(outputFloat(core));
+            } catch (const cv::Exception& e) {
+                std::cerr << "Error en denoising por teselas: " << e.what() << std::endl;
+                failed = true;
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (int w = 1; w < numThreads; w++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    if (failed) {
+        return noisyImage.clone();
+    }
+    
+    cv::Mat result;
+    fromNetworkOutput(outputFloat, noisyImage.depth(), minVal, range, result);
+    if (cache) {
+        cache->store(key, result);
+    }
+    return result;
+}
+
+// ============================================================================
+// CACHÉ
+// ============================================================================
+
+bool DnCNNDenoiser::enableCache(const std::string& directory, uint64_t maxMegabytes) {
+    std::string dir = directory;
+    if (dir.empty()) {
+        std::error_code ec;
+        std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+        dir = ((ec ? std::filesystem::path(".") : tmp) / "dncnn_cache").string();
+    }
+    
+    cache = std::make_unique<DenoiseCache>(dir, maxMegabytes * 1024 * 1024);
+    if (modelLoaded) {
+        modelHash = hashModelFiles(modelPath);
+    }
+    std::cout << "Caché de denoising: " << dir << " (máx. " << maxMegabytes << " MB, "
+              << (cache->getCurrentBytes() / (1024 * 1024)) << " MB en uso)" << std::endl;
+    return true;
+}
+
+void DnCNNDenoiser::disableCache() {
+    cache.reset();
+}
+
+uint64_t DnCNNDenoiser::hashModelFiles(const std::string& onnxPath) {
+    // El modelo guarda los pesos como datos externos (.onnx.data)
+    uint64_t hash = DenoiseCache::hashFile(onnxPath);
+    hash ^= DenoiseCache::hashFile(onnxPath + ".data") * 31;
+    return hash;
+}
+
+std::string DnCNNDenoiser::cacheKey(const cv::Mat& image) const {
+    const InferenceBackend backend = getBackend();
+    uint64_t hash = modelHash;
+    if (backend == InferenceBackend::NATIVE_INT8) {
+        // Las salidas INT8 dependen también de la calibración
+        hash ^= int8Hash;
+    }
+    return DenoiseCache::makeKey(DenoiseCache::hashImage(image), hash, backendName(backend));
+}
+
 std::string DnCNNDenoiser::getInfo() const {
     if (!modelLoaded) {
         return "Modelo no cargado";
     }
-    return "DnCNN | Path: " + modelPath + " | Backend: CPU";
+    return "DnCNN | Path: " + modelPath + " | Backend: " + backendName(pool->getBackend()) +
+           " (CPU) | Réplicas: " + std::to_string(pool->size());
 }
 
 // ============================================================================
@@ -198,6 +635,56 @@ double calculatePSNR(const cv::Mat& img1, const cv::Mat& img2) {
     return psnr;
 }
 
+double calculateSSIM(const cv::Mat& img1, const cv::Mat& img2) {
+    if (img1.empty() || img1.size() != img2.size() || img1.channels() != img2.channels()) {
+        return 0.0;
+    }
+    
+    // Rango dinámico: 255 en 8-bit, rango de la referencia en 16-bit
+    double dynamicRange = 255.0;
+    if (img1.depth() != CV_8U) {
+        double minVal, maxVal;
+        cv::minMaxLoc(img1.reshape(1), &minVal, &maxVal);
+        dynamicRange = std::max(maxVal - minVal, 1.0);
+    }
+    const double C1 = (0.01 * dynamicRange) * (0.01 * dynamicRange);
+    const double C2 = (0.03 * dynamicRange) * (0.03 * dynamicRange);
+    
+    cv::Mat I1, I2;
+    img1.convertTo(I1, CV_64F);
+    img2.convertTo(I2, CV_64F);
+    
+    const cv::Size window(11, 11);
+    const double sigma = 1.5;
+    cv::Mat mu1, mu2;
+    cv::GaussianBlur(I1, mu1, window, sigma);
+    cv::GaussianBlur(I2, mu2, window, sigma);
+    
+    cv::Mat mu1Sq = mu1.mul(mu1);
+    cv::Mat mu2Sq = mu2.mul(mu2);
+    cv::Mat mu1mu2 = mu1.mul(mu2);
+    
+    cv::Mat sigma1Sq, sigma2Sq, sigma12;
+    cv::GaussianBlur(I1.mul(I1), sigma1Sq, window, sigma);
+    cv::GaussianBlur(I2.mul(I2), sigma2Sq, window, sigma);
+    cv::GaussianBlur(I1.mul(I2), sigma12, window, sigma);
+    sigma1Sq -= mu1Sq;
+    sigma2Sq -= mu2Sq;
+    sigma12 -= mu1mu2;
+    
+    cv::Mat numerator = (2 * mu1mu2 + C1).mul(2 * sigma12 + C2);
+    cv::Mat denominator = (mu1Sq + mu2Sq + C1).mul(sigma1Sq + sigma2Sq + C2);
+    cv::Mat ssimMap;
+    cv::divide(numerator, denominator, ssimMap);
+    
+    cv::Scalar channelMeans = cv::mean(ssimMap);
+    double ssim = 0.0;
+    for (int c = 0; c < img1.channels(); c++) {
+        ssim += channelMeans[c];
+    }
+    return ssim / img1.channels();
+}
+
 double calculateSNR(const cv::Mat& image) {
     cv::Scalar mean, stddev;
     cv::meanStdDev(image, mean, stddev);
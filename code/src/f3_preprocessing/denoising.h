@@ -4,27 +4,139 @@
 #include <opencv2/core.hpp>
 #include <opencv2/dnn.hpp>
 #include <string>
+#include <vector>
+#include <memory>
+#include "dncnn_pool.h"
+#include "denoise_cache.h"
 
 namespace Denoising {
 
+/**
+ * @brief Resultado de comparar la salida INT8 con la FP32
+ */
+struct Int8Validation {
+    double minPSNR;             // PSNR mínimo entre cortes (dB)
+    double meanPSNR;            // PSNR medio (dB)
+    double minSSIM;             // SSIM mínimo entre cortes
+    double meanSSIM;            // SSIM medio
+    int slices;                 // Cortes comparados
+    bool passed;                // true si se cumplen los umbrales
+    
+    Int8Validation() : minPSNR(0.0), meanPSNR(0.0), minSSIM(0.0), meanSSIM(0.0), slices(0), passed(false) {}
+};
+
 /**
  * @brief Clase para aplicar denoising con red neuronal DnCNN
  */
 class DnCNNDenoiser {
 private:
-    cv::dnn::Net net;
+    std::unique_ptr<DnCNNNetPool> pool;     // Réplicas de la red (una por hilo activo)
     bool modelLoaded;
     std::string modelPath;
+    int numThreads;                         // 0 = cv::getNumThreads()
+    int numReplicas;                        // 0 = igual que numThreads
+    InferenceBackend fp32Backend;           // Backend al que se vuelve al desactivar INT8
+    std::unique_ptr<DenoiseCache> cache;    // nullptr = sin caché
+    uint64_t modelHash;                     // Hash de los archivos del modelo (clave de caché)
+    uint64_t int8Hash;                      // Hash de la calibración INT8 (se calcula al calibrar o activar INT8)
+    
+    bool denoiseBatchUncached(const std::vector<cv::Mat>& inputs,
+                              std::vector<cv::Mat>& outputs,
+                              int batchSize);
+    std::string cacheKey(const cv::Mat& image) const;
+    static uint64_t hashModelFiles(const std::string& onnxPath);
+    int replicaCount() const;
     
 public:
     DnCNNDenoiser();
     
+    /**
+     * @brief Configurar el paralelismo de la inferencia
+     *
+     * denoise() y denoiseBatch() toman una réplica del pool, por lo que se
+     * pueden llamar desde varios hilos a la vez; con menos réplicas que
+     * hilos, los hilos esperan turno. El pool se dimensiona aquí y en
+     * loadModel(); la inferencia solo toma réplicas, nunca las crea.
+     *
+     * @param threads Hilos para la inferencia por teselas (0 = cv::getNumThreads())
+     * @param replicas Réplicas de la red (0 = igual que threads)
+     */
+    void setParallelism(int threads, int replicas = 0);
+    
     /**
      * @brief Cargar modelo ONNX
+     *
+     * Con AUTO se usa el backend guardado para esta máquina y tamaño en
+     * "<modelo>.backend"; si no existe, se mide cada backend disponible con
+     * un micro-benchmark y se guarda el más rápido.
+     *
      * @param onnxPath Ruta al archivo .onnx
+     * @param backend Backend de inferencia (default: AUTO)
+     * @param benchmarkSize Tamaño de imagen para el micro-benchmark (default: 512x512)
      * @return true si carga exitosa
      */
-    bool loadModel(const std::string& onnxPath);
+    bool loadModel(const std::string& onnxPath,
+                   InferenceBackend backend = InferenceBackend::AUTO,
+                   const cv::Size& benchmarkSize = cv::Size(512, 512));
+    
+    /**
+     * @brief Forward de calentamiento sobre un blob de ceros
+     *
+     * La primera inferencia reserva memoria e inicializa las capas; hacerla
+     * al cargar evita que la pague el primer corte real. No usa la caché.
+     *
+     * @param size Tamaño del blob (default: 512x512)
+     * @return true si el forward se ejecutó
+     */
+    bool warmUp(const cv::Size& size = cv::Size(512, 512));
+    
+    /**
+     * @brief Cambiar el backend de inferencia con el modelo ya cargado
+     * @return false si el backend no está disponible (se conserva el actual)
+     */
+    bool setBackend(InferenceBackend backend);
+    
+    InferenceBackend getBackend() const { return pool->getBackend(); }
+    
+    /**
+     * @brief Calibrar las escalas INT8 con cortes CT reales
+     *
+     * Guarda las escalas de activación en NativeDnCNNEngine::calibrationPath(),
+     * que es lo que usa el backend NATIVE_INT8.
+     *
+     * @param slices Cortes de calibración (CV_8U o CV_16S)
+     * @return true si la calibración se guardó
+     */
+    bool calibrateInt8(const std::vector<cv::Mat>& slices);
+    
+    /**
+     * @brief Comparar la salida INT8 con la FP32 (PSNR y SSIM)
+     *
+     * Ejecuta ambos backends sobre los cortes y deja activo el backend que
+     * hubiera antes de la llamada.
+     *
+     * @param slices Cortes de validación (distintos de los de calibración si es posible)
+     * @param minPSNR PSNR mínimo exigido frente a FP32 (dB, default: 40)
+     * @param minSSIM SSIM mínimo exigido frente a FP32 (default: 0.98)
+     */
+    Int8Validation validateInt8(const std::vector<cv::Mat>& slices,
+                                double minPSNR = 40.0, double minSSIM = 0.98);
+    
+    /**
+     * @brief Calibrar, validar y activar el backend INT8 si supera los umbrales
+     * @param calibrationSlices Cortes para calibrar
+     * @param validationSlices Cortes para validar, distintos de los de calibración
+     *        (vacío = los de calibración, con aviso: la validación no es independiente)
+     * @return Resultado de la validación; si no pasa se mantiene FP32
+     */
+    Int8Validation enableInt8(const std::vector<cv::Mat>& calibrationSlices,
+                              const std::vector<cv::Mat>& validationSlices = std::vector<cv::Mat>(),
+                              double minPSNR = 40.0, double minSSIM = 0.98);
+    
+    /**
+     * @brief Volver al backend FP32 anterior a enableInt8
+     */
+    bool disableInt8();
     
     /**
      * @brief Aplicar denoising a imagen CT
@@ -33,6 +145,47 @@ public:
      */
     cv::Mat denoise(const cv::Mat& noisyImage);
     
+    /**
+     * @brief Aplicar denoising a varios cortes en lotes NCHW
+     * @param inputs Cortes con ruido (CV_8U o CV_16S)
+     * @param outputs Cortes sin ruido; se reutilizan si ya tienen tamaño y tipo correctos
+     * @param batchSize Número de cortes por forward (default: 8)
+     * @return true si todos los lotes se procesaron
+     */
+    bool denoiseBatch(const std::vector<cv::Mat>& inputs,
+                      std::vector<cv::Mat>& outputs,
+                      int batchSize = 8);
+    
+    /**
+     * @brief Aplicar denoising por teselas en paralelo
+     *
+     * Cada tesela se amplía con un halo igual al campo receptivo de la red
+     * (17 píxeles) y solo se conserva su interior, por lo que el resultado
+     * no tiene costuras. La memoria de activaciones queda acotada por el
+     * tamaño de tesela y se admite cualquier tamaño de imagen.
+     *
+     * @param noisyImage Imagen con ruido (CV_8U o CV_16S)
+     * @param tileSize Lado de la tesela sin halo (default: 128)
+     * @param numThreads Hilos; 0 = valor de setParallelism()
+     * @return Imagen sin ruido (mismo tipo que entrada)
+     */
+    cv::Mat denoiseTiled(const cv::Mat& noisyImage, int tileSize = 128, int numThreads = 0);
+    
+    /**
+     * @brief Activar la caché en disco de cortes denoised
+     *
+     * denoise(), denoiseBatch() y denoiseTiled() la consultan antes de la
+     * inferencia. La clave combina el hash de los píxeles, el de los archivos
+     * del modelo y el backend activo.
+     *
+     * @param directory Carpeta (vacío = <temp>/dncnn_cache)
+     * @param maxMegabytes Tamaño máximo; se eliminan las entradas menos usadas (default: 512)
+     */
+    bool enableCache(const std::string& directory = "", uint64_t maxMegabytes = 512);
+    
+    void disableCache();
+    DenoiseCache* getCache() const { return cache.get(); }
+    
     /**
      * @brief Verificar si modelo está cargado
      */
@@ -76,6 +229,14 @@ DenoisingComparison compareWithAndWithoutDenoising(
  */
 double calculatePSNR(const cv::Mat& img1, const cv::Mat& img2);
 
+/**
+ * @brief Calcular SSIM medio entre dos imágenes (ventana gaussiana 11x11, sigma 1.5)
+ * @param img1 Imagen de referencia
+ * @param img2 Imagen a comparar (mismo tamaño)
+ * @return SSIM en [-1, 1] (1 = idénticas)
+ */
+double calculateSSIM(const cv::Mat& img1, const cv::Mat& img2);
+
 /**
  * @brief Calcular SNR de una imagen
  * @param image Imagen
@@ -0,0 +1,197 @@
+#include "dncnn_pool.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+namespace Denoising {
+
+// ============================================================================
+// LEASE
+// ============================================================================
+
+DnCNNNetPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), index(other.index), replica(other.replica) {
+    other.pool = nullptr;
+    other.index = -1;
+    other.replica = nullptr;
+}
+
+DnCNNNetPool::Lease& DnCNNNetPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool) pool->release(index);
+        pool = other.pool;
+        index = other.index;
+        replica = other.replica;
+        other.pool = nullptr;
+        other.index = -1;
+        other.replica = nullptr;
+    }
+    return *this;
+}
+
+DnCNNNetPool::Lease::~Lease() {
+    if (pool) pool->release(index);
+}
+
+InferenceEngine& DnCNNNetPool::Lease::engine() {
+    // Puntero tomado en acquire(): reserve() puede ampliar el vector mientras
+    // tanto, y load() / setBackend() esperan a que se devuelvan los préstamos
+    return *replica;
+}
+
+// ============================================================================
+// POOL
+// ============================================================================
+
+std::unique_ptr<InferenceEngine> DnCNNNetPool::createReplica(const ModelSource& source, InferenceBackend kind) {
+    std::unique_ptr<InferenceEngine> replica = createInferenceEngine(kind);
+    if (!replica) {
+        std::cerr << "Error: Backend " << backendName(kind) << " no disponible" << std::endl;
+        return nullptr;
+    }
+    const bool loaded = source.bytes.empty() ? replica->load(source.path)
+                                             : replica->loadFromBuffer(source.bytes, source.path);
+    if (!loaded) {
+        std::cerr << "Error: No se pudo crear una réplica de DnCNN (" << backendName(kind) << ")" << std::endl;
+        return nullptr;
+    }
+    return replica;
+}
+
+std::vector<std::unique_ptr<InferenceEngine>> DnCNNNetPool::createReplicas(const ModelSource& source,
+                                                                          InferenceBackend kind, int count) {
+    std::vector<std::unique_ptr<InferenceEngine>> created;
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<InferenceEngine> replica = createReplica(source, kind);
+        if (!replica) return {};
+        created.push_back(std::move(replica));
+    }
+    return created;
+}
+
+bool DnCNNNetPool::load(const std::string& onnxPath, int count, InferenceBackend kind) {
+    // Leer el modelo una sola vez; las réplicas (también al cambiar de backend)
+    // se construyen desde estos bytes. Con pesos externos (".onnx.data") el
+    // parser necesita la ruta para resolverlos, así que se carga desde el archivo.
+    auto newSource = std::make_shared<ModelSource>();
+    newSource->path = onnxPath;
+    std::error_code ec;
+    if (!std::filesystem::exists(onnxPath + ".data", ec)) {
+        std::ifstream file(onnxPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: No se pudo abrir el modelo " << onnxPath << std::endl;
+            return false;
+        }
+        newSource->bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Las réplicas se cargan sin el mutex; las actuales siguen en servicio
+    std::vector<std::unique_ptr<InferenceEngine>> created = createReplicas(*newSource, kind, std::max(1, count));
+    if (created.empty()) return false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Esperar a que se devuelvan todas las réplicas antes de reemplazarlas
+    available.wait(lock, [this]() { return freeList.size() == replicas.size(); });
+    replicas = std::move(created);
+    freeList.clear();
+    for (size_t i = 0; i < replicas.size(); i++) {
+        freeList.push_back(static_cast<int>(i));
+    }
+    modelPath = onnxPath;
+    source = std::move(newSource);
+    backend = kind;
+    lock.unlock();
+    available.notify_all();
+    return true;
+}
+
+bool DnCNNNetPool::reserve(int count) {
+    std::shared_ptr<const ModelSource> model;
+    InferenceBackend kind;
+    int missing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!source) return false;
+        missing = count - static_cast<int>(replicas.size());
+        if (missing <= 0) return true;
+        model = source;
+        kind = backend;
+    }
+
+    // Cargar fuera del mutex: acquire() sigue sirviendo las réplicas existentes
+    std::vector<std::unique_ptr<InferenceEngine>> created = createReplicas(*model, kind, missing);
+    if (created.empty()) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Otro load()/setBackend() reemplazó las réplicas mientras tanto
+        if (source != model || backend != kind) return false;
+        // Los préstamos guardan su puntero: ampliar el vector no les afecta
+        for (auto& replica : created) {
+            if (static_cast<int>(replicas.size()) >= count) break;
+            replicas.push_back(std::move(replica));
+            freeList.push_back(static_cast<int>(replicas.size()) - 1);
+        }
+    }
+    available.notify_all();
+    return true;
+}
+
+DnCNNNetPool::Lease DnCNNNetPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (replicas.empty()) return Lease();
+
+    available.wait(lock, [this]() { return !freeList.empty(); });
+    int index = freeList.back();
+    freeList.pop_back();
+    return Lease(this, index, replicas[index].get());
+}
+
+void DnCNNNetPool::release(int index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(index);
+    }
+    available.notify_all();
+}
+
+bool DnCNNNetPool::setBackend(InferenceBackend kind) {
+    std::shared_ptr<const ModelSource> model;
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (kind == backend) return true;
+        if (!source) {
+            backend = kind;
+            return true;
+        }
+        model = source;
+        count = replicas.size();
+    }
+
+    // Crear todas las réplicas nuevas (sin el mutex) antes de descartar las actuales
+    std::vector<std::unique_ptr<InferenceEngine>> created =
+        createReplicas(*model, kind, static_cast<int>(std::max<size_t>(1, count)));
+    if (created.empty()) return false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    available.wait(lock, [this]() { return freeList.size() == replicas.size(); });
+    if (source != model) return false;
+    replicas = std::move(created);
+    freeList.clear();
+    for (size_t i = 0; i < replicas.size(); i++) {
+        freeList.push_back(static_cast<int>(i));
+    }
+    backend = kind;
+    lock.unlock();
+    available.notify_all();
+    return true;
+}
+
+int DnCNNNetPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(replicas.size());
+}
+
+} // namespace Denoising
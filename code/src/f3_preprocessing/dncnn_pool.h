@@ -0,0 +1,119 @@
+#ifndef DNCNN_POOL_H
+#define DNCNN_POOL_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "inference_engine.h"
+
+namespace Denoising {
+
+/**
+ * @brief Pool de réplicas de la red DnCNN para uso desde varios hilos
+ *
+ * Un motor de inferencia no es seguro para llamadas concurrentes, así que
+ * cada hilo toma una réplica en exclusiva (acquire) y la devuelve al
+ * destruir el Lease. El .onnx se lee una sola vez y las réplicas se crean
+ * desde esos bytes; los backends no comparten los pesos entre instancias,
+ * así que cada réplica tiene su propia copia (~2 MB para DnCNN).
+ *
+ * El tamaño se fija al configurar (load / reserve); las réplicas se cargan
+ * sin tener el mutex, de modo que acquire() sigue sirviendo las existentes.
+ */
+class DnCNNNetPool {
+public:
+    /**
+     * @brief Préstamo exclusivo de una réplica (se devuelve al destruirse)
+     */
+    class Lease {
+    public:
+        Lease() : pool(nullptr), index(-1), replica(nullptr) {}
+        Lease(DnCNNNetPool* pool, int index, InferenceEngine* replica)
+            : pool(pool), index(index), replica(replica) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        bool valid() const { return pool != nullptr; }
+        InferenceEngine& engine();
+
+    private:
+        DnCNNNetPool* pool;
+        int index;
+        InferenceEngine* replica;   // Estable aunque reserve() amplíe el vector
+    };
+
+    DnCNNNetPool() = default;
+    DnCNNNetPool(const DnCNNNetPool&) = delete;
+    DnCNNNetPool& operator=(const DnCNNNetPool&) = delete;
+
+    /**
+     * @brief Carga el modelo ONNX y crea las réplicas iniciales
+     * @param onnxPath Ruta al archivo .onnx
+     * @param replicas Número de réplicas (al menos 1)
+     * @param backend Backend concreto de las réplicas (no AUTO)
+     * @return true si todas las réplicas se cargaron
+     */
+    bool load(const std::string& onnxPath, int replicas = 1,
+              InferenceBackend backend = InferenceBackend::OPENCV_DNN);
+
+    /**
+     * @brief Asegura que el pool tenga al menos 'replicas' redes
+     *
+     * Para configuración, no para el camino de inferencia: las réplicas
+     * nuevas se cargan fuera del mutex y se añaden sin esperar a que se
+     * devuelvan los préstamos activos.
+     *
+     * @return true si el pool tiene el tamaño pedido
+     */
+    bool reserve(int replicas);
+
+    /**
+     * @brief Toma una réplica libre (bloquea hasta que haya una)
+     * @return Préstamo inválido si el pool no está cargado
+     */
+    Lease acquire();
+
+    /**
+     * @brief Cambia el backend de todas las réplicas (las recrea)
+     * @return false si el backend no está disponible; se conserva el anterior
+     */
+    bool setBackend(InferenceBackend backend);
+
+    int size() const;
+    InferenceBackend getBackend() const { return backend.load(); }
+    bool isLoaded() const { return size() > 0; }
+    const std::string& getModelPath() const { return modelPath; }
+
+private:
+    /**
+     * @brief Modelo del que se crean las réplicas (inmutable una vez publicado)
+     */
+    struct ModelSource {
+        std::string path;
+        std::vector<uchar> bytes;       // Contenido del .onnx (vacío si los pesos son externos)
+    };
+
+    void release(int index);
+    static std::unique_ptr<InferenceEngine> createReplica(const ModelSource& source, InferenceBackend kind);
+    static std::vector<std::unique_ptr<InferenceEngine>> createReplicas(const ModelSource& source,
+                                                                       InferenceBackend kind, int count);
+
+    std::string modelPath;
+    std::shared_ptr<const ModelSource> source;
+    std::atomic<InferenceBackend> backend{InferenceBackend::OPENCV_DNN};
+    std::vector<std::unique_ptr<InferenceEngine>> replicas;
+    std::vector<int> freeList;
+    mutable std::mutex mutex;
+    std::condition_variable available;
+};
+
+} // namespace Denoising
+
+#endif // DNCNN_POOL_H
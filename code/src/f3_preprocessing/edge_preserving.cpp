@@ -0,0 +1,260 @@
+#include "edge_preserving.h"
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace Preprocessing {
+
+namespace {
+
+// Celdas de borde alrededor de la rejilla para el kernel de 5 taps
+const int kGridPad = 2;
+// Límite de celdas en el eje de intensidad (acota la memoria con sigmaRange pequeña)
+const int kMaxRangeCells = 256;
+
+bool supportedImage(const cv::Mat& image, const char* filterName) {
+    if (image.empty() || image.channels() != 1 ||
+        (image.depth() != CV_8U && image.depth() != CV_16S &&
+         image.depth() != CV_16U && image.depth() != CV_32F)) {
+        std::cerr << "Advertencia: " << filterName << " requiere una imagen de un canal "
+                  << "(CV_8U, CV_16S, CV_16U o CV_32F)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Desenfoque [1 4 6 4 1]/16 (gaussiana de sigma ~1 celda) a lo largo de un eje
+ *
+ * La rejilla guarda pares (suma de intensidades, peso) intercalados.
+ */
+void blurGridAxis(const std::vector<float>& in, std::vector<float>& out, const int dims[3], int axis) {
+    static const float weights[5] = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16};
+    const size_t strides[3] = {2, 2 * static_cast<size_t>(dims[0]),
+                               2 * static_cast<size_t>(dims[0]) * dims[1]};
+    const int n = dims[axis];
+    const size_t stride = strides[axis];
+    const int axisA = (axis + 1) % 3;
+    const int axisB = (axis + 2) % 3;
+
+    cv::parallel_for_(cv::Range(0, dims[axisB]), [&](const cv::Range& range) {
+        for (int j = range.start; j < range.end; j++) {
+            for (int i = 0; i < dims[axisA]; i++) {
+                const size_t base = i * strides[axisA] + j * strides[axisB];
+                for (int p = 0; p < n; p++) {
+                    float value = 0.0f, weight = 0.0f;
+                    for (int k = -2; k <= 2; k++) {
+                        const int q = p + k;
+                        if (q < 0 || q >= n) continue;
+                        const size_t idx = base + q * stride;
+                        value += weights[k + 2] * in[idx];
+                        weight += weights[k + 2] * in[idx + 1];
+                    }
+                    const size_t o = base + p * stride;
+                    out[o] = value;
+                    out[o + 1] = weight;
+                }
+            }
+        }
+    });
+}
+
+cv::Mat boxMean(const cv::Mat& src, int radius) {
+    cv::Mat mean;
+    cv::boxFilter(src, mean, CV_32F, cv::Size(2 * radius + 1, 2 * radius + 1),
+                  cv::Point(-1, -1), true, cv::BORDER_REFLECT);
+    return mean;
+}
+
+} // namespace
+
+// ============================================================================
+// REJILLA BILATERAL
+// ============================================================================
+
+cv::Mat applyBilateralGrid(const cv::Mat& image, double sigmaSpace, double sigmaRange) {
+    if (!supportedImage(image, "applyBilateralGrid")) {
+        return image.clone();
+    }
+    if (sigmaSpace <= 0.0 || sigmaRange <= 0.0) {
+        return image.clone();
+    }
+
+    cv::Mat src;
+    image.convertTo(src, CV_32F);
+    double minVal, maxVal;
+    cv::minMaxLoc(src, &minVal, &maxVal);
+
+    // Muestreo de la rejilla = sigma; el desenfoque de 1 celda da la gaussiana pedida
+    int dims[3];
+    dims[0] = static_cast<int>((src.cols - 1) / sigmaSpace) + 1 + 2 * kGridPad;
+    dims[1] = static_cast<int>((src.rows - 1) / sigmaSpace) + 1 + 2 * kGridPad;
+    if ((maxVal - minVal) / sigmaRange + 1 > kMaxRangeCells - 2 * kGridPad) {
+        sigmaRange = (maxVal - minVal) / (kMaxRangeCells - 2 * kGridPad - 1);
+    }
+    dims[2] = static_cast<int>((maxVal - minVal) / sigmaRange) + 1 + 2 * kGridPad;
+
+    const size_t cells = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+    std::vector<float> grid(cells * 2, 0.0f);
+    std::vector<float> tmp(cells * 2);
+    auto cellIndex = [&](int gx, int gy, int gz) {
+        return ((static_cast<size_t>(gz) * dims[1] + gy) * dims[0] + gx) * 2;
+    };
+
+    // 1. Splat (vecino más cercano)
+    const double invSpace = 1.0 / sigmaSpace;
+    const double invRange = 1.0 / sigmaRange;
+    for (int y = 0; y < src.rows; y++) {
+        const float* row = src.ptr<float>(y);
+        const int gy = static_cast<int>(std::lround(y * invSpace)) + kGridPad;
+        for (int x = 0; x < src.cols; x++) {
+            const int gx = static_cast<int>(std::lround(x * invSpace)) + kGridPad;
+            const int gz = static_cast<int>(std::lround((row[x] - minVal) * invRange)) + kGridPad;
+            const size_t idx = cellIndex(gx, gy, gz);
+            grid[idx] += row[x];
+            grid[idx + 1] += 1.0f;
+        }
+    }
+
+    // 2. Desenfoque separable en x, y, intensidad
+    blurGridAxis(grid, tmp, dims, 0);
+    blurGridAxis(tmp, grid, dims, 1);
+    blurGridAxis(grid, tmp, dims, 2);
+    grid.swap(tmp);
+
+    // 3. Slice (interpolación trilineal)
+    cv::Mat result(src.size(), CV_32F);
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const float* row = src.ptr<float>(y);
+            float* out = result.ptr<float>(y);
+            const double fy = y * invSpace + kGridPad;
+            const int y0 = static_cast<int>(fy);
+            const float wy = static_cast<float>(fy - y0);
+            for (int x = 0; x < src.cols; x++) {
+                const double fx = x * invSpace + kGridPad;
+                const double fz = (row[x] - minVal) * invRange + kGridPad;
+                const int x0 = static_cast<int>(fx);
+                const int z0 = static_cast<int>(fz);
+                const float wx = static_cast<float>(fx - x0);
+                const float wz = static_cast<float>(fz - z0);
+
+                float value = 0.0f, weight = 0.0f;
+                for (int dz = 0; dz <= 1; dz++) {
+                    const float cz = dz ? wz : 1.0f - wz;
+                    for (int dy = 0; dy <= 1; dy++) {
+                        const float cy = dy ? wy : 1.0f - wy;
+                        for (int dx = 0; dx <= 1; dx++) {
+                            const float c = (dx ? wx : 1.0f - wx) * cy * cz;
+                            const size_t idx = cellIndex(x0 + dx, y0 + dy, z0 + dz);
+                            value += c * grid[idx];
+                            weight += c * grid[idx + 1];
+                        }
+                    }
+                }
+                out[x] = weight > 1e-6f ? value / weight : row[x];
+            }
+        }
+    });
+
+    cv::Mat output;
+    result.convertTo(output, image.type());
+    return output;
+}
+
+// ============================================================================
+// GUIDED FILTER
+// ============================================================================
+
+cv::Mat applyGuidedFilter(const cv::Mat& image, int radius, double eps, const cv::Mat& guide) {
+    if (!supportedImage(image, "applyGuidedFilter")) {
+        return image.clone();
+    }
+    if (radius < 1 || eps <= 0.0) {
+        return image.clone();
+    }
+
+    cv::Mat p;
+    image.convertTo(p, CV_32F);
+    const bool selfGuided = guide.empty();
+    cv::Mat I;
+    if (selfGuided) {
+        I = p;
+    } else {
+        if (guide.size() != image.size() || guide.channels() != 1) {
+            std::cerr << "Advertencia: la guía debe tener el tamaño de la imagen y un canal" << std::endl;
+            return image.clone();
+        }
+        guide.convertTo(I, CV_32F);
+    }
+
+    // Coeficientes del modelo lineal local q = a*I + b
+    cv::Mat meanI = boxMean(I, radius);
+    cv::Mat meanP = selfGuided ? meanI : boxMean(p, radius);
+    cv::Mat corrI = boxMean(I.mul(I), radius);
+    cv::Mat corrIp = selfGuided ? corrI : boxMean(I.mul(p), radius);
+
+    cv::Mat varI = corrI - meanI.mul(meanI);
+    cv::Mat covIp = corrIp - meanI.mul(meanP);
+    cv::Mat denominator = varI + eps;
+    cv::Mat a;
+    cv::divide(covIp, denominator, a);
+    cv::Mat b = meanP - a.mul(meanI);
+
+    cv::Mat q = boxMean(a, radius).mul(I) + boxMean(b, radius);
+
+    cv::Mat output;
+    q.convertTo(output, image.type());
+    return output;
+}
+
+// ============================================================================
+// SLIDERS Y SELECCIÓN DE MÉTODO
+// ============================================================================
+
+EdgePreservingParams mapBilateralSliders(int d, double sigmaColor, double intensityScale) {
+    EdgePreservingParams params;
+    params.sigmaSpace = std::max(1.0, d / 3.0);
+    params.sigmaRange = std::max(1e-3, sigmaColor * intensityScale);
+    params.radius = std::max(1, d / 2);
+    params.eps = params.sigmaRange * params.sigmaRange;
+    return params;
+}
+
+cv::Mat applyEdgePreservingFilter(const cv::Mat& image, EdgePreservingMethod method,
+                                  int d, double sigmaColor, double intensityScale) {
+    const EdgePreservingParams params = mapBilateralSliders(d, sigmaColor, intensityScale);
+    switch (method) {
+        case EdgePreservingMethod::BILATERAL_GRID:
+            return applyBilateralGrid(image, params.sigmaSpace, params.sigmaRange);
+        case EdgePreservingMethod::GUIDED:
+            return applyGuidedFilter(image, params.radius, params.eps);
+        case EdgePreservingMethod::BILATERAL_OPENCV:
+            break;
+    }
+
+    // cv::bilateralFilter solo admite 8 bits y float
+    cv::Mat filtered;
+    if (image.depth() == CV_8U || image.depth() == CV_32F) {
+        cv::bilateralFilter(image, filtered, d, params.sigmaRange, sigmaColor);
+        return filtered;
+    }
+    cv::Mat asFloat;
+    image.convertTo(asFloat, CV_32F);
+    cv::bilateralFilter(asFloat, filtered, d, params.sigmaRange, sigmaColor);
+    filtered.convertTo(filtered, image.type());
+    return filtered;
+}
+
+std::string edgePreservingMethodName(EdgePreservingMethod method) {
+    switch (method) {
+        case EdgePreservingMethod::BILATERAL_OPENCV: return "Bilateral (OpenCV)";
+        case EdgePreservingMethod::BILATERAL_GRID:   return "Rejilla bilateral";
+        case EdgePreservingMethod::GUIDED:           return "Guided filter";
+    }
+    return "desconocido";
+}
+
+} // namespace Preprocessing
@@ -0,0 +1,88 @@
+#ifndef EDGE_PRESERVING_H
+#define EDGE_PRESERVING_H
+
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace Preprocessing {
+
+// ============================================================================
+// FILTROS QUE PRESERVAN BORDES EN O(N)
+// ============================================================================
+
+/**
+ * @brief Método de filtrado que preserva bordes
+ */
+enum class EdgePreservingMethod {
+    BILATERAL_OPENCV,   // cv::bilateralFilter, O(d^2) por píxel, solo 8 bits/float
+    BILATERAL_GRID,     // Rejilla bilateral, O(N)
+    GUIDED              // Guided filter con box filters, O(N)
+};
+
+/**
+ * @brief Filtro bilateral aproximado con una rejilla bilateral
+ *
+ * Splat de cada píxel en una rejilla 3D (x/sigmaSpace, y/sigmaSpace,
+ * intensidad/sigmaRange), desenfoque gaussiano separable de la rejilla y
+ * slice con interpolación trilineal. El coste no depende de sigmaSpace.
+ *
+ * @param image Imagen de un canal (CV_8U, CV_16S en HU, CV_16U o CV_32F)
+ * @param sigmaSpace Sigma espacial en píxeles
+ * @param sigmaRange Sigma de intensidad en unidades de la imagen (HU para CV_16S)
+ * @return Imagen filtrada del mismo tipo
+ */
+cv::Mat applyBilateralGrid(const cv::Mat& image, double sigmaSpace, double sigmaRange);
+
+/**
+ * @brief Guided filter (He et al.) con box filters
+ *
+ * Ajuste lineal local q = a*I + b en ventanas de (2*radius+1)^2; eps
+ * controla qué varianza local se considera borde. Sin guía se usa la propia
+ * imagen (suavizado que preserva bordes).
+ *
+ * @param image Imagen de un canal (CV_8U, CV_16S en HU, CV_16U o CV_32F)
+ * @param radius Radio de la ventana en píxeles
+ * @param eps Regularización en unidades de la imagen al cuadrado
+ * @param guide Imagen guía del mismo tamaño (vacía = la propia imagen)
+ * @return Imagen filtrada del mismo tipo
+ */
+cv::Mat applyGuidedFilter(const cv::Mat& image, int radius, double eps, const cv::Mat& guide = cv::Mat());
+
+/**
+ * @brief Parámetros equivalentes a los sliders del filtro bilateral
+ */
+struct EdgePreservingParams {
+    double sigmaSpace = 3.0;    // Rejilla bilateral (píxeles)
+    double sigmaRange = 75.0;   // Rejilla bilateral (unidades de la imagen)
+    int radius = 4;             // Guided filter (píxeles)
+    double eps = 5625.0;        // Guided filter (unidades de la imagen al cuadrado)
+};
+
+/**
+ * @brief Traduce los sliders del bilateral (diámetro y sigma en niveles de 8 bits)
+ *
+ * El diámetro d limita el soporte espacial de cv::bilateralFilter a un
+ * radio d/2, por lo que la sigma espacial efectiva es ~d/3 aunque sigmaSpace
+ * sea mayor. La sigma de color se escala por intensityScale para trabajar
+ * sobre HU (rango del corte / 255 cuando la vista de 8 bits es min-max).
+ *
+ * @param d Diámetro del slider
+ * @param sigmaColor Sigma del slider (niveles de 8 bits)
+ * @param intensityScale Unidades de la imagen por nivel de 8 bits (1 = imagen de 8 bits)
+ */
+EdgePreservingParams mapBilateralSliders(int d, double sigmaColor, double intensityScale = 1.0);
+
+/**
+ * @brief Aplica el método elegido con los parámetros de los sliders
+ */
+cv::Mat applyEdgePreservingFilter(const cv::Mat& image, EdgePreservingMethod method,
+                                  int d, double sigmaColor, double intensityScale = 1.0);
+
+/**
+ * @brief Nombre legible del método (para logs y la interfaz)
+ */
+std::string edgePreservingMethodName(EdgePreservingMethod method);
+
+} // namespace Preprocessing
+
+#endif // EDGE_PRESERVING_H
@@ -0,0 +1,269 @@
+#include "hu_equalization.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+namespace Preprocessing {
+
+namespace {
+
+const int kShortOffset = 32768;
+const int kMaxBins = 65536;
+
+bool validInput(const cv::Mat& image, HUWindow& window, int& bins, int outputType, const char* name) {
+    if (image.empty() || image.type() != CV_16SC1) {
+        std::cerr << "Advertencia: " << name << " requiere una imagen CV_16S (HU) de un canal" << std::endl;
+        return false;
+    }
+    if (outputType != CV_8U && outputType != CV_16S) {
+        std::cerr << "Advertencia: " << name << " solo genera CV_8U o CV_16S" << std::endl;
+        return false;
+    }
+    if (window.low >= window.high) {
+        std::cerr << "Advertencia: ventana HU vacía [" << window.low << ", " << window.high << "]" << std::endl;
+        return false;
+    }
+    bins = std::max(2, std::min(bins, kMaxBins));
+    return true;
+}
+
+/**
+ * @brief Tabla HU -> bin para todo el rango de int16 (los valores fuera de la ventana se recortan)
+ */
+std::vector<ushort> buildBinTable(const HUWindow& window, int bins) {
+    std::vector<ushort> table(65536);
+    const double scale = static_cast<double>(bins) / (window.high - window.low + 1);
+    for (int v = -kShortOffset; v < kShortOffset; v++) {
+        int bin = static_cast<int>((v - window.low) * scale);
+        table[v + kShortOffset] = static_cast<ushort>(std::min(std::max(bin, 0), bins - 1));
+    }
+    return table;
+}
+
+void outputRange(const HUWindow& window, int outputType, float& outMin, float& outMax) {
+    outMin = outputType == CV_8U ? 0.0f : static_cast<float>(window.low);
+    outMax = outputType == CV_8U ? 255.0f : static_cast<float>(window.high);
+}
+
+/**
+ * @brief Tabla de ecualización de un histograma, con recorte opcional (clip <= 0: sin recorte)
+ */
+void buildEqualizationLut(std::vector<int>& hist, int area, int clip, float outMin, float outMax, float* lut) {
+    const int bins = static_cast<int>(hist.size());
+    if (clip > 0) {
+        // Recorte y redistribución uniforme del exceso (como cv::CLAHE)
+        int excess = 0;
+        for (int& h : hist) {
+            if (h > clip) {
+                excess += h - clip;
+                h = clip;
+            }
+        }
+        const int batch = excess / bins;
+        const int residual = excess - batch * bins;
+        for (int& h : hist) {
+            h += batch;
+        }
+        if (residual > 0) {
+            const int step = std::max(bins / residual, 1);
+            for (int b = 0, added = 0; b < bins && added < residual; b += step, added++) {
+                hist[b]++;
+            }
+        }
+    }
+
+    const float scale = area > 0 ? (outMax - outMin) / area : 0.0f;
+    int sum = 0;
+    for (int b = 0; b < bins; b++) {
+        sum += hist[b];
+        lut[b] = outMin + sum * scale;
+    }
+}
+
+/**
+ * @brief Límites de n tiles sobre length píxeles (todos no vacíos si length >= n)
+ */
+std::vector<int> tileBounds(int length, int n) {
+    std::vector<int> bounds(n + 1);
+    for (int i = 0; i <= n; i++) {
+        bounds[i] = static_cast<int>(static_cast<long long>(i) * length / n);
+    }
+    return bounds;
+}
+
+/**
+ * @brief Para cada posición: tiles vecinos (por centros) y peso del segundo
+ */
+void interpolationWeights(const std::vector<int>& bounds, int length,
+                          std::vector<int>& first, std::vector<int>& second, std::vector<float>& weight) {
+    const int n = static_cast<int>(bounds.size()) - 1;
+    std::vector<float> centers(n);
+    for (int i = 0; i < n; i++) {
+        centers[i] = 0.5f * (bounds[i] + bounds[i + 1] - 1);
+    }
+    first.resize(length);
+    second.resize(length);
+    weight.resize(length);
+    int t = 0;
+    for (int p = 0; p < length; p++) {
+        while (t + 1 < n && centers[t + 1] <= p) {
+            t++;
+        }
+        if (p <= centers[0]) {
+            first[p] = second[p] = 0;
+            weight[p] = 0.0f;
+        } else if (t + 1 >= n) {
+            first[p] = second[p] = n - 1;
+            weight[p] = 0.0f;
+        } else {
+            first[p] = t;
+            second[p] = t + 1;
+            weight[p] = (p - centers[t]) / (centers[t + 1] - centers[t]);
+        }
+    }
+}
+
+template <typename T>
+void storeRow(const float* values, T* dst, int cols) {
+    for (int x = 0; x < cols; x++) {
+        dst[x] = cv::saturate_cast<T>(values[x]);
+    }
+}
+
+} // namespace
+
+HUWindow HUWindow::fromCenterWidth(int center, int width) {
+    HUWindow window;
+    window.low = center - width / 2;
+    window.high = center + (width - width / 2);
+    return window;
+}
+
+// ============================================================================
+// ECUALIZACIÓN GLOBAL
+// ============================================================================
+
+cv::Mat equalizeHistogramHU(const cv::Mat& image, const HUWindow& window, int bins, int outputType) {
+    HUWindow w = window;
+    if (!validInput(image, w, bins, outputType, "equalizeHistogramHU")) {
+        return image.clone();
+    }
+
+    const std::vector<ushort> binTable = buildBinTable(w, bins);
+    std::vector<int> hist(bins, 0);
+    for (int y = 0; y < image.rows; y++) {
+        const short* row = image.ptr<short>(y);
+        for (int x = 0; x < image.cols; x++) {
+            hist[binTable[row[x] + kShortOffset]]++;
+        }
+    }
+
+    float outMin, outMax;
+    outputRange(w, outputType, outMin, outMax);
+    std::vector<float> lut(bins);
+    buildEqualizationLut(hist, static_cast<int>(image.total()), 0, outMin, outMax, lut.data());
+
+    cv::Mat output(image.size(), outputType);
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        std::vector<float> values(image.cols);
+        for (int y = range.start; y < range.end; y++) {
+            const short* row = image.ptr<short>(y);
+            for (int x = 0; x < image.cols; x++) {
+                values[x] = lut[binTable[row[x] + kShortOffset]];
+            }
+            if (outputType == CV_8U) {
+                storeRow(values.data(), output.ptr<uchar>(y), image.cols);
+            } else {
+                storeRow(values.data(), output.ptr<short>(y), image.cols);
+            }
+        }
+    });
+    return output;
+}
+
+// ============================================================================
+// CLAHE
+// ============================================================================
+
+cv::Mat applyCLAHEHU(const cv::Mat& image, const HUClaheParams& params, int outputType) {
+    HUWindow window = params.window;
+    int bins = params.bins;
+    if (!validInput(image, window, bins, outputType, "applyCLAHEHU")) {
+        return image.clone();
+    }
+    const int tilesX = std::max(1, std::min(params.tileGrid.width, image.cols));
+    const int tilesY = std::max(1, std::min(params.tileGrid.height, image.rows));
+
+    const std::vector<ushort> binTable = buildBinTable(window, bins);
+    const std::vector<int> boundsX = tileBounds(image.cols, tilesX);
+    const std::vector<int> boundsY = tileBounds(image.rows, tilesY);
+    float outMin, outMax;
+    outputRange(window, outputType, outMin, outMax);
+
+    // 1. Histograma y tabla de cada tile (un tile por tarea)
+    std::vector<float> luts(static_cast<size_t>(tilesX) * tilesY * bins);
+    cv::parallel_for_(cv::Range(0, tilesX * tilesY), [&](const cv::Range& range) {
+        std::vector<int> hist(bins);
+        for (int t = range.start; t < range.end; t++) {
+            const int tx = t % tilesX;
+            const int ty = t / tilesX;
+            std::fill(hist.begin(), hist.end(), 0);
+            for (int y = boundsY[ty]; y < boundsY[ty + 1]; y++) {
+                const short* row = image.ptr<short>(y);
+                for (int x = boundsX[tx]; x < boundsX[tx + 1]; x++) {
+                    hist[binTable[row[x] + kShortOffset]]++;
+                }
+            }
+            const int area = (boundsX[tx + 1] - boundsX[tx]) * (boundsY[ty + 1] - boundsY[ty]);
+            const int clip = params.clipLimit > 0.0
+                ? std::max(static_cast<int>(params.clipLimit * area / bins), 1) : 0;
+            buildEqualizationLut(hist, area, clip, outMin, outMax, &luts[static_cast<size_t>(t) * bins]);
+        }
+    });
+
+    // 2. Interpolación bilineal entre los cuatro tiles vecinos
+    std::vector<int> firstX, secondX, firstY, secondY;
+    std::vector<float> weightX, weightY;
+    interpolationWeights(boundsX, image.cols, firstX, secondX, weightX);
+    interpolationWeights(boundsY, image.rows, firstY, secondY, weightY);
+
+    cv::Mat output(image.size(), outputType);
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& range) {
+        const int cols = image.cols;
+        std::vector<float> topLeft(cols), topRight(cols), bottomLeft(cols), bottomRight(cols), values(cols);
+        for (int y = range.start; y < range.end; y++) {
+            const short* row = image.ptr<short>(y);
+            const float* lutTop = &luts[static_cast<size_t>(firstY[y]) * tilesX * bins];
+            const float* lutBottom = &luts[static_cast<size_t>(secondY[y]) * tilesX * bins];
+
+            // Recogida de las cuatro tablas (acceso indirecto)
+            for (int x = 0; x < cols; x++) {
+                const int bin = binTable[row[x] + kShortOffset];
+                const size_t left = static_cast<size_t>(firstX[x]) * bins + bin;
+                const size_t right = static_cast<size_t>(secondX[x]) * bins + bin;
+                topLeft[x] = lutTop[left];
+                topRight[x] = lutTop[right];
+                bottomLeft[x] = lutBottom[left];
+                bottomRight[x] = lutBottom[right];
+            }
+
+            // Mezcla sobre buffers contiguos
+            const float wy = weightY[y];
+            const float* wx = weightX.data();
+            for (int x = 0; x < cols; x++) {
+                const float top = topLeft[x] + wx[x] * (topRight[x] - topLeft[x]);
+                const float bottom = bottomLeft[x] + wx[x] * (bottomRight[x] - bottomLeft[x]);
+                values[x] = top + wy * (bottom - top);
+            }
+
+            if (outputType == CV_8U) {
+                storeRow(values.data(), output.ptr<uchar>(y), cols);
+            } else {
+                storeRow(values.data(), output.ptr<short>(y), cols);
+            }
+        }
+    });
+    return output;
+}
+
+} // namespace Preprocessing
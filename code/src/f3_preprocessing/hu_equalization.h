@@ -0,0 +1,70 @@
+#ifndef HU_EQUALIZATION_H
+#define HU_EQUALIZATION_H
+
+#include <opencv2/core.hpp>
+
+namespace Preprocessing {
+
+// ============================================================================
+// ECUALIZACIÓN Y CLAHE SOBRE HU (16 BITS)
+// ============================================================================
+
+/**
+ * @brief Ventana de HU [low, high] sobre la que se ecualiza
+ */
+struct HUWindow {
+    int low = -1000;
+    int high = 1000;
+
+    /**
+     * @brief Ventana a partir de centro y anchura (convención de visualización CT)
+     */
+    static HUWindow fromCenterWidth(int center, int width);
+};
+
+/**
+ * @brief Parámetros del CLAHE sobre HU
+ */
+struct HUClaheParams {
+    HUWindow window;
+    int bins = 1024;                        // Bins del histograma dentro de la ventana
+    double clipLimit = 2.0;                 // Mismo significado que en cv::createCLAHE
+    cv::Size tileGrid = cv::Size(8, 8);     // Tiles en x e y
+};
+
+/**
+ * @brief Ecualización global del histograma de una imagen CV_16S dentro de una ventana HU
+ *
+ * Los valores fuera de la ventana se asignan al primer o último bin. Sin
+ * pasar antes por la normalización min-max a 8 bits, así que los 256 niveles
+ * de salida se reparten solo entre los HU de interés.
+ *
+ * @param image Imagen CV_16S (HU)
+ * @param window Ventana HU
+ * @param bins Número de bins (2..65536)
+ * @param outputType CV_8U (0..255) o CV_16S (valores dentro de la ventana)
+ * @return Imagen ecualizada
+ */
+cv::Mat equalizeHistogramHU(const cv::Mat& image, const HUWindow& window = HUWindow(),
+                            int bins = 1024, int outputType = CV_8U);
+
+/**
+ * @brief CLAHE sobre una imagen CV_16S dentro de una ventana HU
+ *
+ * Histogramas por tile calculados en paralelo (un tile por tarea), recorte
+ * y redistribución como cv::CLAHE, y una pasada de interpolación bilineal
+ * entre las tablas de los cuatro tiles vecinos: por fila se recogen los
+ * valores de las tablas y la mezcla se hace sobre buffers contiguos
+ * (vectorizable), con las filas repartidas en paralelo.
+ *
+ * @param image Imagen CV_16S (HU)
+ * @param params Ventana, bins, límite de recorte y tiles
+ * @param outputType CV_8U (0..255) o CV_16S (valores dentro de la ventana)
+ * @return Imagen con CLAHE aplicado
+ */
+cv::Mat applyCLAHEHU(const cv::Mat& image, const HUClaheParams& params = HUClaheParams(),
+                     int outputType = CV_8U);
+
+} // namespace Preprocessing
+
+#endif // HU_EQUALIZATION_H
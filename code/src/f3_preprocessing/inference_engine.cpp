@@ -0,0 +1,348 @@
+#include "inference_engine.h"
+#include "native_dncnn.h"
+#include <opencv2/dnn.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+namespace Denoising {
+
+namespace {
+
+// Diferencia máxima admitida con la salida de OpenCV DNN (imagen en [0, 1])
+const double kMaxBackendDifference = 1e-3;
+
+// ============================================================================
+// OPENCV DNN (y OpenVINO a través de cv::dnn)
+// ============================================================================
+
+class OpenCVDnnEngine : public InferenceEngine {
+public:
+    OpenCVDnnEngine(InferenceBackend kind, int dnnBackend, int dnnTarget)
+        : kind(kind), dnnBackend(dnnBackend), dnnTarget(dnnTarget) {}
+
+    bool load(const std::string& onnxPath) override {
+        try {
+            return configure(cv::dnn::readNetFromONNX(onnxPath));
+        } catch (const cv::Exception& e) {
+            std::cerr << "Excepcion OpenCV: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool loadFromBuffer(const std::vector<uchar>& model, const std::string& onnxPath) override {
+        (void)onnxPath;
+        try {
+            return configure(cv::dnn::readNetFromONNX(model));
+        } catch (const cv::Exception& e) {
+            std::cerr << "Excepcion OpenCV: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool run(const cv::Mat& blob, cv::Mat& output) override {
+        try {
+            net.setInput(blob);
+            // La salida apunta a memoria de la red: válida hasta el siguiente forward
+            output = net.forward();
+            return true;
+        } catch (const cv::Exception& e) {
+            std::cerr << "Error en inferencia (" << backendName(kind) << "): " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    InferenceBackend backend() const override { return kind; }
+
+private:
+    bool configure(const cv::dnn::Net& loaded) {
+        if (loaded.empty()) return false;
+        net = loaded;
+        net.setPreferableBackend(dnnBackend);
+        net.setPreferableTarget(dnnTarget);
+        return true;
+    }
+
+    InferenceBackend kind;
+    int dnnBackend;
+    int dnnTarget;
+    cv::dnn::Net net;
+};
+
+// ============================================================================
+// ONNX RUNTIME
+// ============================================================================
+
+#ifdef HAVE_ONNXRUNTIME
+Ort::Env& ortEnvironment() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "DnCNN");
+    return env;
+}
+
+class OnnxRuntimeEngine : public InferenceEngine {
+public:
+    OnnxRuntimeEngine()
+        : memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {}
+
+    bool load(const std::string& onnxPath) override {
+        return createSession(onnxPath, nullptr);
+    }
+
+    bool loadFromBuffer(const std::vector<uchar>& model, const std::string& onnxPath) override {
+        return createSession(onnxPath, &model);
+    }
+
+    bool run(const cv::Mat& blob, cv::Mat& output) override {
+        if (!session || blob.dims != 4 || !blob.isContinuous()) return false;
+        try {
+            std::vector<int64_t> shape = {blob.size[0], blob.size[1], blob.size[2], blob.size[3]};
+
+            // DnCNN conserva la forma: la salida se escribe directamente en 'output'
+            const int sizes[] = {blob.size[0], blob.size[1], blob.size[2], blob.size[3]};
+            output.create(4, sizes, CV_32F);
+
+            Ort::Value input = Ort::Value::CreateTensor<float>(
+                memoryInfo, const_cast<float*>(blob.ptr<float>()), blob.total(), shape.data(), shape.size());
+            Ort::Value result = Ort::Value::CreateTensor<float>(
+                memoryInfo, output.ptr<float>(), output.total(), shape.data(), shape.size());
+
+            const char* inputNames[] = {inputName.c_str()};
+            const char* outputNames[] = {outputName.c_str()};
+            session->Run(Ort::RunOptions{nullptr}, inputNames, &input, 1, outputNames, &result, 1);
+            return true;
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Error en inferencia (onnxruntime): " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    InferenceBackend backend() const override { return InferenceBackend::ONNX_RUNTIME; }
+
+private:
+    bool createSession(const std::string& onnxPath, const std::vector<uchar>* model) {
+        try {
+            Ort::SessionOptions options;
+            options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+            if (model) {
+                session = std::make_unique<Ort::Session>(ortEnvironment(), model->data(), model->size(), options);
+            } else {
+#ifdef _WIN32
+                std::wstring widePath(onnxPath.begin(), onnxPath.end());
+                session = std::make_unique<Ort::Session>(ortEnvironment(), widePath.c_str(), options);
+#else
+                session = std::make_unique<Ort::Session>(ortEnvironment(), onnxPath.c_str(), options);
+#endif
+            }
+            Ort::AllocatorWithDefaultOptions allocator;
+            inputName = session->GetInputNameAllocated(0, allocator).get();
+            outputName = session->GetOutputNameAllocated(0, allocator).get();
+            return true;
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Excepcion ONNX Runtime: " << e.what() << std::endl;
+            session.reset();
+            return false;
+        }
+    }
+
+    Ort::MemoryInfo memoryInfo;
+    std::unique_ptr<Ort::Session> session;
+    std::string inputName;
+    std::string outputName;
+};
+#endif
+
+bool openVinoAvailable() {
+    try {
+        auto targets = cv::dnn::getAvailableTargets(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE);
+        return std::find(targets.begin(), targets.end(), cv::dnn::DNN_TARGET_CPU) != targets.end();
+    } catch (const cv::Exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Clave de la elección guardada: tamaño, núcleos y backends compilados
+ */
+std::string choiceKey(const cv::Size& imageSize) {
+    std::ostringstream key;
+    key << imageSize.width << "x" << imageSize.height << ";" << cv::getNumberOfCPUs() << ";";
+    const auto backends = getAvailableBackends();
+    for (size_t i = 0; i < backends.size(); i++) {
+        key << (i > 0 ? "," : "") << backendName(backends[i]);
+    }
+    return key.str();
+}
+
+std::string choiceFile(const std::string& onnxPath) {
+    return onnxPath + ".backend";
+}
+
+} // namespace
+
+std::unique_ptr<InferenceEngine> createInferenceEngine(InferenceBackend backend) {
+    switch (backend) {
+        case InferenceBackend::OPENCV_DNN:
+            return std::make_unique<OpenCVDnnEngine>(backend, cv::dnn::DNN_BACKEND_OPENCV, cv::dnn::DNN_TARGET_CPU);
+        case InferenceBackend::OPENVINO:
+            if (!openVinoAvailable()) return nullptr;
+            return std::make_unique<OpenCVDnnEngine>(backend, cv::dnn::DNN_BACKEND_INFERENCE_ENGINE, cv::dnn::DNN_TARGET_CPU);
+        case InferenceBackend::NATIVE:
+            return std::make_unique<NativeDnCNNEngine>();
+        case InferenceBackend::NATIVE_INT8:
+            return std::make_unique<NativeDnCNNEngine>(true);
+        case InferenceBackend::ONNX_RUNTIME:
+#ifdef HAVE_ONNXRUNTIME
+            return std::make_unique<OnnxRuntimeEngine>();
+#else
+            return nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+std::vector<InferenceBackend> getAvailableBackends() {
+    std::vector<InferenceBackend> backends = {InferenceBackend::OPENCV_DNN, InferenceBackend::NATIVE};
+#ifdef HAVE_ONNXRUNTIME
+    backends.push_back(InferenceBackend::ONNX_RUNTIME);
+#endif
+    if (openVinoAvailable()) {
+        backends.push_back(InferenceBackend::OPENVINO);
+    }
+    return backends;
+}
+
+std::string backendName(InferenceBackend backend) {
+    switch (backend) {
+        case InferenceBackend::OPENCV_DNN:   return "opencv";
+        case InferenceBackend::ONNX_RUNTIME: return "onnxruntime";
+        case InferenceBackend::OPENVINO:     return "openvino";
+        case InferenceBackend::NATIVE:       return "native";
+        case InferenceBackend::NATIVE_INT8:  return "native_int8";
+        default:                             return "auto";
+    }
+}
+
+InferenceBackend backendFromName(const std::string& name) {
+    if (name == "opencv") return InferenceBackend::OPENCV_DNN;
+    if (name == "onnxruntime") return InferenceBackend::ONNX_RUNTIME;
+    if (name == "openvino") return InferenceBackend::OPENVINO;
+    if (name == "native") return InferenceBackend::NATIVE;
+    if (name == "native_int8") return InferenceBackend::NATIVE_INT8;
+    return InferenceBackend::AUTO;
+}
+
+// ============================================================================
+// SELECCIÓN AUTOMÁTICA
+// ============================================================================
+
+InferenceBackend selectFastestBackend(const std::string& onnxPath,
+                                      const cv::Size& imageSize,
+                                      std::vector<BackendTiming>* timings,
+                                      int repetitions) {
+    // Imagen sintética en [0, 1]: el coste de DnCNN no depende del contenido
+    cv::Mat image(imageSize, CV_32F);
+    cv::randu(image, 0.0f, 1.0f);
+    const int sizes[] = {1, 1, imageSize.height, imageSize.width};
+    cv::Mat blob(4, sizes, CV_32F, image.data);
+
+    InferenceBackend best = InferenceBackend::OPENCV_DNN;
+    double bestMs = -1.0;
+    cv::Mat reference;
+    if (timings) timings->clear();
+
+    for (InferenceBackend backend : getAvailableBackends()) {
+        std::unique_ptr<InferenceEngine> engine = createInferenceEngine(backend);
+        if (!engine || !engine->load(onnxPath)) continue;
+
+        cv::Mat output;
+        if (!engine->run(blob, output)) continue;  // Calentamiento
+
+        // Verificar la salida contra la de OpenCV DNN (primer backend de la lista)
+        if (reference.empty()) {
+            output.copyTo(reference);
+        } else if (output.total() != reference.total() ||
+                   cv::norm(cv::Mat(1, static_cast<int>(output.total()), CV_32F, output.data),
+                            cv::Mat(1, static_cast<int>(reference.total()), CV_32F, reference.data),
+                            cv::NORM_INF) > kMaxBackendDifference) {
+            std::cerr << "Advertencia: Backend " << backendName(backend)
+                      << " descartado (salida distinta de la del ONNX)" << std::endl;
+            continue;
+        }
+
+        double ms = -1.0;
+        for (int r = 0; r < std::max(1, repetitions); r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (!engine->run(blob, output)) {
+                ms = -1.0;
+                break;
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double t = std::chrono::duration<double, std::milli>(end - start).count();
+            if (ms < 0.0 || t < ms) ms = t;
+        }
+        if (ms < 0.0) continue;
+
+        std::cout << "   Backend " << backendName(backend) << ": " << ms << " ms" << std::endl;
+        if (timings) timings->push_back({backend, ms});
+        if (bestMs < 0.0 || ms < bestMs) {
+            bestMs = ms;
+            best = backend;
+        }
+    }
+    return best;
+}
+
+InferenceBackend loadBackendChoice(const std::string& onnxPath, const cv::Size& imageSize) {
+    std::ifstream file(choiceFile(onnxPath));
+    if (!file.is_open()) return InferenceBackend::AUTO;
+
+    const std::string key = choiceKey(imageSize) + ";";
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, key.size(), key) == 0) {
+            InferenceBackend backend = backendFromName(line.substr(key.size()));
+            // Ignorar elecciones de backends que ya no se pueden crear
+            if (backend != InferenceBackend::AUTO && createInferenceEngine(backend)) {
+                return backend;
+            }
+        }
+    }
+    return InferenceBackend::AUTO;
+}
+
+bool saveBackendChoice(const std::string& onnxPath, const cv::Size& imageSize, InferenceBackend backend) {
+    const std::string key = choiceKey(imageSize) + ";";
+
+    // Conservar las elecciones de otras claves
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(choiceFile(onnxPath));
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.compare(0, key.size(), key) != 0) {
+                lines.push_back(line);
+            }
+        }
+    }
+    lines.push_back(key + backendName(backend));
+
+    std::ofstream file(choiceFile(onnxPath), std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Advertencia: No se pudo guardar la elección de backend en "
+                  << choiceFile(onnxPath) << std::endl;
+        return false;
+    }
+    for (const auto& line : lines) {
+        file << line << "\n";
+    }
+    return true;
+}
+
+} // namespace Denoising
@@ -0,0 +1,130 @@
+#ifndef INFERENCE_ENGINE_H
+#define INFERENCE_ENGINE_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Denoising {
+
+// ============================================================================
+// BACKENDS DE INFERENCIA
+// ============================================================================
+
+/**
+ * @brief Backends de inferencia en CPU para el modelo ONNX
+ */
+enum class InferenceBackend {
+    AUTO,           // Elegir el más rápido con un micro-benchmark
+    OPENCV_DNN,     // cv::dnn (DNN_BACKEND_OPENCV / DNN_TARGET_CPU)
+    ONNX_RUNTIME,   // ONNX Runtime CPU (requiere HAVE_ONNXRUNTIME)
+    OPENVINO,       // cv::dnn con DNN_BACKEND_INFERENCE_ENGINE (si OpenCV se compiló con OpenVINO)
+    NATIVE,         // Motor propio para la topología DnCNN (native_dncnn.h)
+    NATIVE_INT8     // Motor propio cuantizado (requiere calibración; fuera de AUTO)
+};
+
+/**
+ * @brief Motor de inferencia: ejecuta el modelo sobre un blob NCHW float32
+ *
+ * Una instancia no es segura para llamadas concurrentes; DnCNNNetPool
+ * mantiene una instancia por hilo activo.
+ */
+class InferenceEngine {
+public:
+    virtual ~InferenceEngine() = default;
+
+    /**
+     * @brief Carga el modelo ONNX
+     * @return true si carga exitosa
+     */
+    virtual bool load(const std::string& onnxPath) = 0;
+
+    /**
+     * @brief Carga el modelo desde los bytes del .onnx ya leídos en memoria
+     *
+     * Permite crear varias réplicas sin releer el archivo. Por defecto
+     * equivale a load(onnxPath).
+     *
+     * @param model Contenido del archivo .onnx
+     * @param onnxPath Ruta de origen (para mensajes y archivos asociados)
+     */
+    virtual bool loadFromBuffer(const std::vector<uchar>& model, const std::string& onnxPath) {
+        (void)model;
+        return load(onnxPath);
+    }
+
+    /**
+     * @brief Ejecuta un forward
+     * @param blob Entrada NCHW CV_32F
+     * @param output Salida NCHW CV_32F
+     * @return false si la inferencia falló (el error se informa por std::cerr)
+     */
+    virtual bool run(const cv::Mat& blob, cv::Mat& output) = 0;
+
+    virtual InferenceBackend backend() const = 0;
+};
+
+/**
+ * @brief Crea un motor (sin cargar) del backend indicado
+ * @return nullptr si el backend no está disponible en esta compilación
+ */
+std::unique_ptr<InferenceEngine> createInferenceEngine(InferenceBackend backend);
+
+/**
+ * @brief Backends concretos disponibles en esta compilación y máquina
+ *
+ * NATIVE_INT8 no se incluye: pierde precisión y solo se activa de forma
+ * explícita tras validarlo (DnCNNDenoiser::enableInt8).
+ */
+std::vector<InferenceBackend> getAvailableBackends();
+
+std::string backendName(InferenceBackend backend);
+InferenceBackend backendFromName(const std::string& name);
+
+// ============================================================================
+// SELECCIÓN AUTOMÁTICA
+// ============================================================================
+
+/**
+ * @brief Tiempo medido para un backend
+ */
+struct BackendTiming {
+    InferenceBackend backend;
+    double ms;                  // Mejor tiempo por forward (ms)
+};
+
+/**
+ * @brief Micro-benchmark: mide cada backend disponible con una imagen sintética
+ *
+ * Los backends cuya salida difiere de la de OpenCV DNN se descartan.
+ *
+ * @param onnxPath Ruta al modelo
+ * @param imageSize Tamaño de imagen representativo
+ * @param timings Tiempos medidos (salida opcional)
+ * @param repetitions Forwards medidos por backend (tras uno de calentamiento)
+ * @return Backend más rápido (OPENCV_DNN si ninguno se pudo medir)
+ */
+InferenceBackend selectFastestBackend(const std::string& onnxPath,
+                                      const cv::Size& imageSize,
+                                      std::vector<BackendTiming>* timings = nullptr,
+                                      int repetitions = 2);
+
+/**
+ * @brief Backend elegido previamente para esta máquina y tamaño
+ *
+ * Las elecciones se guardan en "<modelo>.backend", junto al modelo, con una
+ * línea por clave (tamaño de imagen, núcleos y backends compilados).
+ *
+ * @return AUTO si no hay una elección guardada
+ */
+InferenceBackend loadBackendChoice(const std::string& onnxPath, const cv::Size& imageSize);
+
+/**
+ * @brief Guarda la elección de backend para esta máquina y tamaño
+ */
+bool saveBackendChoice(const std::string& onnxPath, const cv::Size& imageSize, InferenceBackend backend);
+
+} // namespace Denoising
+
+#endif // INFERENCE_ENGINE_H
@@ -0,0 +1,220 @@
+#include "median_filter.h"
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+namespace Preprocessing {
+
+namespace {
+
+// Máximo de niveles del histograma (memoria por franja: columnas * niveles * 2 bytes)
+const int kMaxLevels = 16384;
+// Rango de recorte si la imagen tiene más niveles (HU)
+const int kClipLow = -1024;
+// Ancho mínimo de franja: por debajo el coste de inicializar cada fila domina
+const int kMinStripWidth = 64;
+
+/**
+ * @brief Convierte la imagen a índices de bin (uint16) con borde replicado
+ */
+template <typename T>
+void toBins(const cv::Mat& image, int offset, int maxBin, int radius, cv::Mat& bins) {
+    cv::Mat shifted(image.size(), CV_16U);
+    for (int y = 0; y < image.rows; y++) {
+        const T* src = image.ptr<T>(y);
+        ushort* dst = shifted.ptr<ushort>(y);
+        for (int x = 0; x < image.cols; x++) {
+            dst[x] = static_cast<ushort>(std::min(std::max(static_cast<int>(src[x]) - offset, 0), maxBin));
+        }
+    }
+    cv::copyMakeBorder(shifted, bins, radius, radius, radius, radius, cv::BORDER_REPLICATE);
+}
+
+template <typename T>
+void fromBins(const cv::Mat& bins, int offset, cv::Mat& output) {
+    for (int y = 0; y < output.rows; y++) {
+        const ushort* src = bins.ptr<ushort>(y);
+        T* dst = output.ptr<T>(y);
+        for (int x = 0; x < output.cols; x++) {
+            dst[x] = cv::saturate_cast<T>(static_cast<int>(src[x]) + offset);
+        }
+    }
+}
+
+/**
+ * @brief Mediana de una franja de columnas de salida [x0, x1)
+ *
+ * padded: bins con borde de radius píxeles; result: bins de salida (sin borde)
+ */
+void medianStrip(const cv::Mat& padded, int radius, int fineBits, int x0, int x1, cv::Mat& result) {
+    const int levels = 1 << (2 * fineBits);
+    const int fineSize = 1 << fineBits;
+    const int coarseSize = levels >> fineBits;
+    const int diameter = 2 * radius + 1;
+    const int rank = (diameter * diameter) / 2;     // Mediana (índice base 0)
+    const int rows = result.rows;
+
+    // Histogramas de columna para las columnas acolchadas [x0, x1 + 2r)
+    const int columns = (x1 - x0) + 2 * radius;
+    std::vector<ushort> colCoarse(static_cast<size_t>(columns) * coarseSize, 0);
+    std::vector<ushort> colFine(static_cast<size_t>(columns) * levels, 0);
+
+    auto addRow = [&](int paddedRow, int delta) {
+        const ushort* row = padded.ptr<ushort>(paddedRow) + x0;
+        for (int c = 0; c < columns; c++) {
+            const int bin = row[c];
+            colCoarse[static_cast<size_t>(c) * coarseSize + (bin >> fineBits)] += delta;
+            colFine[static_cast<size_t>(c) * levels + bin] += delta;
+        }
+    };
+
+    // Las columnas cubren las filas acolchadas [y, y + 2r] para la fila de salida y
+    for (int r = 0; r < 2 * radius; r++) {
+        addRow(r, 1);
+    }
+
+    std::vector<int> kernelCoarse(coarseSize);
+    std::vector<int> kernelFine(levels);
+    std::vector<int> lastUpdated(coarseSize);   // Siguiente columna a sumar en el nivel fino
+
+    for (int y = 0; y < rows; y++) {
+        addRow(y + 2 * radius, 1);
+
+        // Histograma grueso del kernel en la primera columna de la franja
+        std::fill(kernelCoarse.begin(), kernelCoarse.end(), 0);
+        for (int c = 0; c < diameter; c++) {
+            const ushort* h = &colCoarse[static_cast<size_t>(c) * coarseSize];
+            for (int k = 0; k < coarseSize; k++) {
+                kernelCoarse[k] += h[k];
+            }
+        }
+        // El nivel fino se recalcula la primera vez que se necesita cada bin grueso
+        std::fill(lastUpdated.begin(), lastUpdated.end(), INT_MIN / 2);
+
+        ushort* out = result.ptr<ushort>(y);
+        for (int x = 0; x < x1 - x0; x++) {
+            // Ventana: columnas locales [x, x + 2r]
+            if (x > 0) {
+                const ushort* added = &colCoarse[static_cast<size_t>(x + 2 * radius) * coarseSize];
+                const ushort* removed = &colCoarse[static_cast<size_t>(x - 1) * coarseSize];
+                for (int k = 0; k < coarseSize; k++) {
+                    kernelCoarse[k] += added[k] - removed[k];
+                }
+            }
+
+            // 1. Bin grueso que contiene la mediana
+            int k = 0;
+            int count = 0;
+            while (count + kernelCoarse[k] <= rank) {
+                count += kernelCoarse[k];
+                k++;
+            }
+
+            // 2. Actualización perezosa del nivel fino de ese bin
+            int* fine = &kernelFine[static_cast<size_t>(k) << fineBits];
+            const size_t fineOffset = static_cast<size_t>(k) << fineBits;
+            const int windowEnd = x + diameter;
+            if (lastUpdated[k] <= x) {
+                // Desactualizado más de una ventana: recalcular desde cero
+                std::fill(fine, fine + fineSize, 0);
+                for (int c = x; c < windowEnd; c++) {
+                    const ushort* h = &colFine[static_cast<size_t>(c) * levels + fineOffset];
+                    for (int f = 0; f < fineSize; f++) {
+                        fine[f] += h[f];
+                    }
+                }
+            } else {
+                for (int c = lastUpdated[k]; c < windowEnd; c++) {
+                    const ushort* added = &colFine[static_cast<size_t>(c) * levels + fineOffset];
+                    const ushort* removed = &colFine[static_cast<size_t>(c - diameter) * levels + fineOffset];
+                    for (int f = 0; f < fineSize; f++) {
+                        fine[f] += added[f] - removed[f];
+                    }
+                }
+            }
+            lastUpdated[k] = windowEnd;
+
+            // 3. Bin fino de la mediana
+            int f = 0;
+            while (count + fine[f] <= rank) {
+                count += fine[f];
+                f++;
+            }
+            out[x0 + x] = static_cast<ushort>((k << fineBits) + f);
+        }
+
+        addRow(y, -1);
+    }
+}
+
+} // namespace
+
+cv::Mat applyMedianFilterConstantTime(const cv::Mat& image, int kernelSize, int numStrips) {
+    if (image.empty() || image.channels() != 1 ||
+        (image.depth() != CV_16S && image.depth() != CV_16U && image.depth() != CV_8U)) {
+        std::cerr << "Advertencia: la mediana de tiempo constante requiere CV_16S, CV_16U o CV_8U de un canal" << std::endl;
+        return image.clone();
+    }
+    if (kernelSize % 2 == 0) {
+        kernelSize++;
+    }
+    if (kernelSize <= 1) {
+        return image.clone();
+    }
+    const int radius = kernelSize / 2;
+
+    // Rango de niveles: [mínimo, máximo] de la imagen
+    double minVal, maxVal;
+    cv::minMaxLoc(image, &minVal, &maxVal);
+    int offset = static_cast<int>(minVal);
+    int range = static_cast<int>(maxVal) - offset + 1;
+    if (range > kMaxLevels) {
+        offset = image.depth() == CV_16S ? kClipLow : 0;
+        std::cerr << "Advertencia: rango de " << range << " niveles; la mediana se limita a ["
+                  << offset << ", " << (offset + kMaxLevels - 1) << "]" << std::endl;
+        range = kMaxLevels;
+    }
+
+    // Niveles = 2^(2*fineBits): mismo número de bins gruesos y finos
+    int fineBits = 4;
+    while ((1 << (2 * fineBits)) < range) {
+        fineBits++;
+    }
+
+    cv::Mat padded;
+    switch (image.depth()) {
+        case CV_16S: toBins<short>(image, offset, range - 1, radius, padded); break;
+        case CV_16U: toBins<ushort>(image, offset, range - 1, radius, padded); break;
+        default:     toBins<uchar>(image, offset, range - 1, radius, padded); break;
+    }
+
+    // Franjas verticales independientes
+    if (numStrips <= 0) {
+        numStrips = std::max(1, cv::getNumThreads());
+    }
+    numStrips = std::max(1, std::min(numStrips, image.cols / kMinStripWidth));
+    const int stripWidth = (image.cols + numStrips - 1) / numStrips;
+
+    cv::Mat resultBins(image.size(), CV_16U);
+    cv::parallel_for_(cv::Range(0, numStrips), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; s++) {
+            const int x0 = s * stripWidth;
+            const int x1 = std::min(image.cols, x0 + stripWidth);
+            if (x0 < x1) {
+                medianStrip(padded, radius, fineBits, x0, x1, resultBins);
+            }
+        }
+    });
+
+    cv::Mat output(image.size(), image.type());
+    switch (image.depth()) {
+        case CV_16S: fromBins<short>(resultBins, offset, output); break;
+        case CV_16U: fromBins<ushort>(resultBins, offset, output); break;
+        default:     fromBins<uchar>(resultBins, offset, output); break;
+    }
+    return output;
+}
+
+} // namespace Preprocessing
@@ -0,0 +1,34 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <opencv2/core.hpp>
+
+namespace Preprocessing {
+
+// ============================================================================
+// MEDIANA DE TIEMPO CONSTANTE (16 BITS)
+// ============================================================================
+
+/**
+ * @brief Filtro de mediana de coste por píxel independiente del kernel
+ *
+ * Algoritmo de Perreault–Hébert: un histograma por columna que se desplaza
+ * una fila cada vez y un histograma del kernel que se desplaza una columna
+ * cada vez, ambos en dos niveles (grueso/fino). El nivel fino del kernel
+ * solo se actualiza, de forma perezosa, en el bin grueso donde cae la
+ * mediana. Trabaja directamente sobre HU sin pasar a 8 bits; la imagen se
+ * divide en franjas verticales que se procesan en paralelo.
+ *
+ * Los histogramas cubren el rango [mínimo, máximo] de la imagen; si supera
+ * 16384 niveles se recorta a [-1024, 15359] (HU) con aviso.
+ *
+ * @param image Imagen CV_16S (HU), CV_16U o CV_8U, un canal
+ * @param kernelSize Lado del kernel (impar; se corrige si es par)
+ * @param numStrips Franjas en paralelo; 0 = automático
+ * @return Imagen filtrada del mismo tipo (borde replicado)
+ */
+cv::Mat applyMedianFilterConstantTime(const cv::Mat& image, int kernelSize, int numStrips = 0);
+
+} // namespace Preprocessing
+
+#endif // MEDIAN_FILTER_H
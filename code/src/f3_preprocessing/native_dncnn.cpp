@@ -0,0 +1,508 @@
+#include "native_dncnn.h"
+#include "denoise_cache.h"
+#include <opencv2/dnn.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+namespace Denoising {
+
+namespace {
+
+// Canales de salida que comparten cada lectura de las filas de entrada
+const int kOutputBlock = 8;
+
+// eps de BatchNorm en DnCNN (se usa si la capa no lo expone)
+const float kDefaultBatchNormEps = 1e-4f;
+
+// Comprobación de la cadena interpretada contra OpenCV DNN al cargar
+const int kReferenceCheckSize = 32;
+const double kMaxReferenceDifference = 1e-3;
+
+// Rango de la cuantización: pesos simétricos INT8, activaciones (>= 0 tras ReLU) UINT8
+const float kWeightQMax = 127.0f;
+const float kActivationQMax = 255.0f;
+
+/**
+ * @brief Pliega BatchNorm (mean, var[, gamma, beta]) en la convolución previa
+ */
+void foldBatchNorm(NativeConvLayer& conv, const cv::dnn::Layer& bn) {
+    const cv::dnn::BatchNormLayer* bnLayer = dynamic_cast<const cv::dnn::BatchNormLayer*>(&bn);
+    const float eps = bnLayer ? bnLayer->epsilon : kDefaultBatchNormEps;
+    const bool hasWeights = bnLayer ? bnLayer->hasWeights : bn.blobs.size() > 2;
+    const bool hasBias = bnLayer ? bnLayer->hasBias : bn.blobs.size() > 3;
+
+    const float* mean = bn.blobs[0].ptr<float>();
+    const float* var = bn.blobs[1].ptr<float>();
+    const float* gamma = (hasWeights && bn.blobs.size() > 2) ? bn.blobs[2].ptr<float>() : nullptr;
+    const float* beta = (hasBias && bn.blobs.size() > 3) ? bn.blobs[3].ptr<float>() : nullptr;
+
+    const int kernel = conv.inChannels * 9;
+    for (int co = 0; co < conv.outChannels; co++) {
+        const float scale = (gamma ? gamma[co] : 1.0f) / std::sqrt(var[co] + eps);
+        for (int k = 0; k < kernel; k++) {
+            conv.weights[co * kernel + k] *= scale;
+        }
+        conv.bias[co] = (conv.bias[co] - mean[co]) * scale + (beta ? beta[co] : 0.0f);
+    }
+}
+
+} // namespace
+
+bool NativeDnCNNEngine::load(const std::string& onnxPath) {
+    return loadModel(onnxPath, nullptr);
+}
+
+bool NativeDnCNNEngine::loadFromBuffer(const std::vector<uchar>& model, const std::string& onnxPath) {
+    return loadModel(onnxPath, &model);
+}
+
+bool NativeDnCNNEngine::loadModel(const std::string& onnxPath, const std::vector<uchar>* model) {
+    layers.clear();
+    residual = false;
+    maxChannels = 0;
+    bufferSize = cv::Size();
+
+    try {
+        cv::dnn::Net net = model ? cv::dnn::readNetFromONNX(*model) : cv::dnn::readNetFromONNX(onnxPath);
+        if (net.empty()) return false;
+
+        // Recorrer la cadena de capas en orden: Conv [BatchNorm] [ReLU] ... [Sub]
+        for (const std::string& name : net.getLayerNames()) {
+            cv::Ptr<cv::dnn::Layer> layer = net.getLayer(name);
+            const std::string& type = layer->type;
+
+            if (type == "Convolution") {
+                const cv::Mat& w = layer->blobs[0];
+                if (w.dims != 4 || w.size[2] != 3 || w.size[3] != 3) {
+                    std::cerr << "Error: Motor nativo solo admite convoluciones 3x3 (" << name << ")" << std::endl;
+                    layers.clear();
+                    return false;
+                }
+                NativeConvLayer conv;
+                conv.outChannels = w.size[0];
+                conv.inChannels = w.size[1];
+                conv.weights.assign(w.ptr<float>(), w.ptr<float>() + w.total());
+                conv.bias.assign(conv.outChannels, 0.0f);
+                if (layer->blobs.size() > 1 && !layer->blobs[1].empty()) {
+                    const float* b = layer->blobs[1].ptr<float>();
+                    std::copy(b, b + conv.outChannels, conv.bias.begin());
+                }
+                if (!layers.empty() && layers.back().outChannels != conv.inChannels) {
+                    std::cerr << "Error: Canales inconsistentes en " << name << std::endl;
+                    layers.clear();
+                    return false;
+                }
+                layers.push_back(conv);
+                maxChannels = std::max({maxChannels, conv.inChannels, conv.outChannels});
+            } else if (type == "BatchNorm" && !layers.empty()) {
+                foldBatchNorm(layers.back(), *layer);
+            } else if (type == "ReLU" && !layers.empty()) {
+                layers.back().relu = true;
+            } else if (type == "Eltwise" || type == "NaryEltwise" || type == "Sub") {
+                // Se interpreta como y - dncnn(y); la operación y el orden de los
+                // operandos se verifican abajo contra la salida de OpenCV DNN
+                residual = true;
+            } else if (type != "Identity") {
+                std::cerr << "Error: Capa no soportada por el motor nativo: " << name
+                          << " (" << type << ")" << std::endl;
+                layers.clear();
+                return false;
+            }
+        }
+        
+        if (layers.empty() || layers.front().inChannels != layers.back().outChannels) {
+            std::cerr << "Error: Topología DnCNN no reconocida en " << onnxPath << std::endl;
+            layers.clear();
+            return false;
+        }
+        
+        // Verificar la interpretación (capa final incluida) con un blob de prueba,
+        // también cuando el backend se elige explícitamente o desde ".backend"
+        const int sizes[] = {1, layers.front().inChannels, kReferenceCheckSize, kReferenceCheckSize};
+        cv::Mat blob(4, sizes, CV_32F);
+        cv::RNG rng(0x5EED);
+        rng.fill(blob, cv::RNG::UNIFORM, 0.0, 1.0);
+        net.setInput(blob);
+        cv::Mat reference = net.forward();
+        
+        const bool quantized = int8;
+        int8 = false;   // La referencia es FP32; la cuantización se prepara después
+        cv::Mat output;
+        const bool ran = run(blob, output);
+        int8 = quantized;
+        bufferSize = cv::Size();    // Los buffers INT8 se reservan en la primera inferencia real
+        
+        if (!ran || output.total() != reference.total() ||
+            cv::norm(cv::Mat(1, static_cast<int>(output.total()), CV_32F, output.data),
+                     cv::Mat(1, static_cast<int>(reference.total()), CV_32F, reference.data),
+                     cv::NORM_INF) > kMaxReferenceDifference) {
+            std::cerr << "Error: La salida del motor nativo no coincide con la del ONNX ("
+                      << onnxPath << "); operación final no reconocida" << std::endl;
+            layers.clear();
+            return false;
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "Excepcion OpenCV: " << e.what() << std::endl;
+        layers.clear();
+        return false;
+    }
+
+    if (int8) {
+        // Las activaciones UINT8 requieren ReLU en todas las capas salvo la última
+        for (size_t l = 0; l + 1 < layers.size(); l++) {
+            if (!layers[l].relu) {
+                std::cerr << "Error: Modo INT8 requiere ReLU tras cada capa intermedia" << std::endl;
+                layers.clear();
+                return false;
+            }
+        }
+        if (!loadCalibration(calibrationPath(onnxPath))) {
+            std::cerr << "Error: Falta la calibración INT8 (" << calibrationPath(onnxPath)
+                      << "); ejecute DnCNNDenoiser::calibrateInt8" << std::endl;
+            layers.clear();
+            return false;
+        }
+        quantizeWeights();
+    }
+    return true;
+}
+
+void NativeDnCNNEngine::quantizeWeights() {
+    for (NativeConvLayer& layer : layers) {
+        const int kernel = layer.inChannels * 9;
+        layer.qweights.resize(layer.weights.size());
+        layer.weightScales.resize(layer.outChannels);
+        for (int co = 0; co < layer.outChannels; co++) {
+            const float* w = &layer.weights[static_cast<size_t>(co) * kernel];
+            float maxAbs = 0.0f;
+            for (int k = 0; k < kernel; k++) maxAbs = std::max(maxAbs, std::abs(w[k]));
+            const float scale = std::max(maxAbs, 1e-12f) / kWeightQMax;
+            layer.weightScales[co] = scale;
+            for (int k = 0; k < kernel; k++) {
+                layer.qweights[static_cast<size_t>(co) * kernel + k] =
+                    static_cast<int8_t>(std::lround(w[k] / scale));
+            }
+        }
+    }
+}
+
+// ============================================================================
+// CALIBRACIÓN INT8
+// ============================================================================
+
+bool NativeDnCNNEngine::calibrate(const std::vector<cv::Mat>& blobs) {
+    if (layers.empty()) return false;
+
+    std::vector<float> layerMax(layers.size(), 0.0f);
+    int calibrated = 0;
+    for (const cv::Mat& blob : blobs) {
+        if (blob.dims != 4 || blob.type() != CV_32F || blob.size[1] != layers.front().inChannels) continue;
+        ensureBuffers(blob.size[3], blob.size[2]);
+        for (int n = 0; n < blob.size[0]; n++) {
+            forwardFP32(blob, n, &layerMax);
+            calibrated++;
+        }
+    }
+    if (calibrated == 0) return false;
+
+    activationScales.resize(layers.size());
+    for (size_t l = 0; l < layers.size(); l++) {
+        activationScales[l] = std::max(layerMax[l], 1e-6f) / kActivationQMax;
+    }
+    return true;
+}
+
+bool NativeDnCNNEngine::saveCalibration(const std::string& path) const {
+    if (activationScales.empty()) return false;
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: No se pudo escribir la calibración INT8 en " << path << std::endl;
+        return false;
+    }
+    file << "# DnCNN INT8: escala de la entrada de cada capa\n";
+    file << activationScales.size() << "\n";
+    file.precision(9);
+    for (float scale : activationScales) {
+        file << scale << "\n";
+    }
+    return true;
+}
+
+std::string NativeDnCNNEngine::calibrationPath(const std::string& onnxPath) {
+    std::error_code ec;
+    std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+    // Hash del grafo y de los pesos externos (.onnx.data)
+    const uint64_t hash = DenoiseCache::hashFile(onnxPath) ^ (DenoiseCache::hashFile(onnxPath + ".data") * 31);
+    std::ostringstream name;
+    name << std::filesystem::path(onnxPath).stem().string() << "_" << std::hex << std::setfill('0')
+         << std::setw(16) << hash << ".int8";
+    return ((ec ? std::filesystem::path(".") : tmp) / "dncnn_int8" / name.str()).string();
+}
+
+bool NativeDnCNNEngine::loadCalibration(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string header;
+    std::getline(file, header);
+    size_t count = 0;
+    file >> count;
+    if (!file || count != layers.size()) return false;
+
+    std::vector<float> scales(count);
+    for (size_t l = 0; l < count; l++) {
+        file >> scales[l];
+        if (!file || scales[l] <= 0.0f) return false;
+    }
+    activationScales = scales;
+    return true;
+}
+
+void NativeDnCNNEngine::runLayer(const NativeConvLayer& layer, const float* src, float* dst,
+                                 int height, int width) const {
+    const int paddedWidth = width + 2;
+    const size_t plane = static_cast<size_t>(height + 2) * paddedWidth;
+
+    // Bandas de filas: cada hilo acumula kOutputBlock filas de salida a la vez
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& range) {
+        std::vector<float> acc(static_cast<size_t>(kOutputBlock) * width);
+
+        for (int y = range.start; y < range.end; y++) {
+            for (int co0 = 0; co0 < layer.outChannels; co0 += kOutputBlock) {
+                const int blockSize = std::min(kOutputBlock, layer.outChannels - co0);
+                for (int c = 0; c < blockSize; c++) {
+                    std::fill(acc.begin() + c * width, acc.begin() + (c + 1) * width, layer.bias[co0 + c]);
+                }
+
+                for (int ci = 0; ci < layer.inChannels; ci++) {
+                    // Filas y-1, y, y+1 de la entrada (y, y+1, y+2 con el borde de ceros)
+                    const float* in = src + ci * plane + static_cast<size_t>(y) * paddedWidth;
+                    for (int c = 0; c < blockSize; c++) {
+                        const float* w = &layer.weights[(static_cast<size_t>(co0 + c) * layer.inChannels + ci) * 9];
+                        float* a = &acc[static_cast<size_t>(c) * width];
+                        for (int ky = 0; ky < 3; ky++) {
+                            const float* r = in + ky * paddedWidth;
+                            const float w0 = w[ky * 3];
+                            const float w1 = w[ky * 3 + 1];
+                            const float w2 = w[ky * 3 + 2];
+                            int x = 0;
+#if CV_SIMD
+                            const cv::v_float32 vw0 = cv::vx_setall_f32(w0);
+                            const cv::v_float32 vw1 = cv::vx_setall_f32(w1);
+                            const cv::v_float32 vw2 = cv::vx_setall_f32(w2);
+                            for (; x <= width - cv::v_float32::nlanes; x += cv::v_float32::nlanes) {
+                                cv::v_float32 sum = cv::vx_load(a + x);
+                                sum = cv::v_fma(vw0, cv::vx_load(r + x), sum);
+                                sum = cv::v_fma(vw1, cv::vx_load(r + x + 1), sum);
+                                sum = cv::v_fma(vw2, cv::vx_load(r + x + 2), sum);
+                                cv::v_store(a + x, sum);
+                            }
+#endif
+                            for (; x < width; x++) {
+                                a[x] += w0 * r[x] + w1 * r[x + 1] + w2 * r[x + 2];
+                            }
+                        }
+                    }
+                }
+
+                // ReLU fusionada al escribir en el interior del buffer de salida
+                for (int c = 0; c < blockSize; c++) {
+                    const float* a = &acc[static_cast<size_t>(c) * width];
+                    float* out = dst + (co0 + c) * plane + static_cast<size_t>(y + 1) * paddedWidth + 1;
+                    if (layer.relu) {
+                        for (int x = 0; x < width; x++) out[x] = std::max(a[x], 0.0f);
+                    } else {
+                        std::copy(a, a + width, out);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void NativeDnCNNEngine::runLayerInt8(const NativeConvLayer& layer, float inScale, float outScale,
+                                     const uint8_t* src, uint8_t* dstQ, float* dstF,
+                                     int height, int width) const {
+    const int paddedWidth = width + 2;
+    const size_t plane = static_cast<size_t>(height + 2) * paddedWidth;
+    const float invOutScale = (outScale > 0.0f) ? 1.0f / outScale : 0.0f;
+
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& range) {
+        std::vector<int32_t> acc(static_cast<size_t>(kOutputBlock) * width);
+
+        for (int y = range.start; y < range.end; y++) {
+            for (int co0 = 0; co0 < layer.outChannels; co0 += kOutputBlock) {
+                const int blockSize = std::min(kOutputBlock, layer.outChannels - co0);
+                std::fill(acc.begin(), acc.begin() + static_cast<size_t>(blockSize) * width, 0);
+
+                // Acumulación entera: 64·9 productos UINT8·INT8 caben en int32
+                for (int ci = 0; ci < layer.inChannels; ci++) {
+                    const uint8_t* in = src + ci * plane + static_cast<size_t>(y) * paddedWidth;
+                    for (int c = 0; c < blockSize; c++) {
+                        const int8_t* w = &layer.qweights[(static_cast<size_t>(co0 + c) * layer.inChannels + ci) * 9];
+                        int32_t* a = &acc[static_cast<size_t>(c) * width];
+                        for (int ky = 0; ky < 3; ky++) {
+                            const uint8_t* r = in + ky * paddedWidth;
+                            const int32_t w0 = w[ky * 3];
+                            const int32_t w1 = w[ky * 3 + 1];
+                            const int32_t w2 = w[ky * 3 + 2];
+                            for (int x = 0; x < width; x++) {
+                                a[x] += w0 * r[x] + w1 * r[x + 1] + w2 * r[x + 2];
+                            }
+                        }
+                    }
+                }
+
+                // Descuantizar, sumar sesgo, ReLU y recuantizar a la escala de la capa siguiente
+                for (int c = 0; c < blockSize; c++) {
+                    const int co = co0 + c;
+                    const int32_t* a = &acc[static_cast<size_t>(c) * width];
+                    const float scale = inScale * layer.weightScales[co];
+                    const float bias = layer.bias[co];
+                    const size_t offset = co * plane + static_cast<size_t>(y + 1) * paddedWidth + 1;
+                    if (dstQ) {
+                        uint8_t* out = dstQ + offset;
+                        for (int x = 0; x < width; x++) {
+                            const float v = std::max(a[x] * scale + bias, 0.0f) * invOutScale + 0.5f;
+                            out[x] = static_cast<uint8_t>(std::min(v, kActivationQMax));
+                        }
+                    } else {
+                        float* out = dstF + offset;
+                        for (int x = 0; x < width; x++) {
+                            const float v = a[x] * scale + bias;
+                            out[x] = layer.relu ? std::max(v, 0.0f) : v;
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+void NativeDnCNNEngine::ensureBuffers(int width, int height) {
+    // Los bordes de ceros no se escriben nunca: basta con inicializarlos al cambiar de tamaño
+    if (bufferSize == cv::Size(width, height)) return;
+    const size_t size = static_cast<size_t>(maxChannels) * (height + 2) * (width + 2);
+    bufferA.assign(size, 0.0f);
+    bufferB.assign(size, 0.0f);
+    if (int8) {
+        qbufferA.assign(size, 0);
+        qbufferB.assign(size, 0);
+    }
+    bufferSize = cv::Size(width, height);
+}
+
+const float* NativeDnCNNEngine::forwardFP32(const cv::Mat& blob, int n, std::vector<float>* layerMax) {
+    const int channels = blob.size[1];
+    const int height = blob.size[2];
+    const int width = blob.size[3];
+    const int paddedWidth = width + 2;
+    const size_t plane = static_cast<size_t>(height + 2) * paddedWidth;
+
+    for (int c = 0; c < channels; c++) {
+        const float* in = blob.ptr<float>(n, c);
+        for (int y = 0; y < height; y++) {
+            std::copy(in + y * width, in + (y + 1) * width,
+                      &bufferA[c * plane + static_cast<size_t>(y + 1) * paddedWidth + 1]);
+        }
+    }
+
+    // Ping-pong entre los dos buffers de activaciones
+    float* src = bufferA.data();
+    float* dst = bufferB.data();
+    for (size_t l = 0; l < layers.size(); l++) {
+        if (layerMax) {
+            // Máximo de la entrada de la capa (el borde de ceros no afecta: valores >= 0)
+            const float* begin = src;
+            const float* end = src + layers[l].inChannels * plane;
+            (*layerMax)[l] = std::max((*layerMax)[l], *std::max_element(begin, end));
+        }
+        runLayer(layers[l], src, dst, height, width);
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+const float* NativeDnCNNEngine::forwardInt8(const cv::Mat& blob, int n) {
+    const int channels = blob.size[1];
+    const int height = blob.size[2];
+    const int width = blob.size[3];
+    const int paddedWidth = width + 2;
+    const size_t plane = static_cast<size_t>(height + 2) * paddedWidth;
+
+    // Cuantizar la entrada con la escala de la primera capa
+    const float invScale = 1.0f / activationScales[0];
+    for (int c = 0; c < channels; c++) {
+        const float* in = blob.ptr<float>(n, c);
+        for (int y = 0; y < height; y++) {
+            uint8_t* q = &qbufferA[c * plane + static_cast<size_t>(y + 1) * paddedWidth + 1];
+            for (int x = 0; x < width; x++) {
+                const float v = std::max(in[y * width + x], 0.0f) * invScale + 0.5f;
+                q[x] = static_cast<uint8_t>(std::min(v, kActivationQMax));
+            }
+        }
+    }
+
+    uint8_t* src = qbufferA.data();
+    uint8_t* dst = qbufferB.data();
+    for (size_t l = 0; l < layers.size(); l++) {
+        const bool last = (l + 1 == layers.size());
+        // La última capa (ruido estimado) se escribe en float para la resta residual
+        runLayerInt8(layers[l], activationScales[l], last ? 0.0f : activationScales[l + 1],
+                     src, last ? nullptr : dst, last ? bufferB.data() : nullptr, height, width);
+        std::swap(src, dst);
+    }
+    return bufferB.data();
+}
+
+bool NativeDnCNNEngine::run(const cv::Mat& blob, cv::Mat& output) {
+    if (layers.empty() || blob.dims != 4 || blob.type() != CV_32F ||
+        blob.size[1] != layers.front().inChannels) {
+        std::cerr << "Error en inferencia (native): blob no compatible" << std::endl;
+        return false;
+    }
+
+    const int batch = blob.size[0];
+    const int height = blob.size[2];
+    const int width = blob.size[3];
+    const int paddedWidth = width + 2;
+    const size_t plane = static_cast<size_t>(height + 2) * paddedWidth;
+
+    ensureBuffers(width, height);
+
+    const int sizes[] = {batch, layers.back().outChannels, height, width};
+    output.create(4, sizes, CV_32F);
+
+    for (int n = 0; n < batch; n++) {
+        const float* src = int8 ? forwardInt8(blob, n) : forwardFP32(blob, n, nullptr);
+
+        for (int c = 0; c < layers.back().outChannels; c++) {
+            const float* in = blob.ptr<float>(n, c);
+            float* out = output.ptr<float>(n, c);
+            for (int y = 0; y < height; y++) {
+                const float* noise = src + c * plane + static_cast<size_t>(y + 1) * paddedWidth + 1;
+                const float* x = in + y * width;
+                float* o = out + y * width;
+                if (residual) {
+                    for (int i = 0; i < width; i++) o[i] = x[i] - noise[i];
+                } else {
+                    std::copy(noise, noise + width, o);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace Denoising
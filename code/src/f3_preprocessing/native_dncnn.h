@@ -0,0 +1,112 @@
+#ifndef NATIVE_DNCNN_H
+#define NATIVE_DNCNN_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "inference_engine.h"
+
+namespace Denoising {
+
+// ============================================================================
+// MOTOR NATIVO DNCNN
+// ============================================================================
+
+/**
+ * @brief Capa convolucional 3x3 con BatchNorm ya plegado en pesos y sesgo
+ */
+struct NativeConvLayer {
+    int inChannels = 0;
+    int outChannels = 0;
+    std::vector<float> weights;     // [out][in][3][3]
+    std::vector<float> bias;        // [out]
+    bool relu = false;              // ReLU fusionada a la salida
+
+    // Modo INT8: pesos simétricos con una escala por canal de salida
+    std::vector<int8_t> qweights;       // [out][in][3][3]
+    std::vector<float> weightScales;    // [out]
+};
+
+/**
+ * @brief Inferencia DnCNN en CPU sin runtime genérico
+ *
+ * Lee los pesos del ONNX con cv::dnn, pliega BatchNorm en la convolución
+ * anterior y ejecuta la pila de convoluciones 3x3 directamente (sin im2col)
+ * con la ReLU fusionada. Las activaciones alternan entre dos buffers con
+ * un borde de ceros de 1 píxel, y cada capa se reparte por bandas de filas
+ * con cv::parallel_for_. El bucle interno recorre una fila contigua para que
+ * el compilador lo pueda vectorizar. Al cargar, la salida se compara con la
+ * de OpenCV DNN sobre un blob de prueba y el modelo se rechaza si difiere.
+ */
+class NativeDnCNNEngine : public InferenceEngine {
+public:
+    /**
+     * @param int8 Modo cuantizado: pesos INT8 por canal y activaciones UINT8 por
+     *             capa, con las escalas de calibrationPath() (ver calibrate())
+     */
+    explicit NativeDnCNNEngine(bool int8 = false) : int8(int8) {}
+
+    bool load(const std::string& onnxPath) override;
+    bool loadFromBuffer(const std::vector<uchar>& model, const std::string& onnxPath) override;
+    bool run(const cv::Mat& blob, cv::Mat& output) override;
+    InferenceBackend backend() const override {
+        return int8 ? InferenceBackend::NATIVE_INT8 : InferenceBackend::NATIVE;
+    }
+
+    /**
+     * @brief Calibra las escalas de activación INT8 con cortes reales
+     *
+     * Ejecuta la red en FP32 sobre los blobs y registra el máximo de la
+     * entrada de cada capa. El resultado se guarda con saveCalibration().
+     *
+     * @param blobs Blobs NCHW en [0, 1] (p.ej. cortes CT normalizados)
+     * @return true si se calibró con al menos un blob
+     */
+    bool calibrate(const std::vector<cv::Mat>& blobs);
+
+    bool saveCalibration(const std::string& path) const;
+    bool loadCalibration(const std::string& path);
+
+    /**
+     * @brief Archivo de calibración INT8 de un modelo
+     *
+     * Vive en la carpeta temporal del usuario (<temp>/dncnn_int8), como la
+     * caché de denoising, y no junto al modelo, cuya carpeta puede ser de solo
+     * lectura. El nombre incluye el hash del ONNX.
+     */
+    static std::string calibrationPath(const std::string& onnxPath);
+
+    int getLayerCount() const { return static_cast<int>(layers.size()); }
+    bool isResidual() const { return residual; }
+    bool isInt8() const { return int8; }
+
+private:
+    bool loadModel(const std::string& onnxPath, const std::vector<uchar>* model);
+    void runLayer(const NativeConvLayer& layer, const float* src, float* dst, int height, int width) const;
+    void runLayerInt8(const NativeConvLayer& layer, float inScale, float outScale,
+                      const uint8_t* src, uint8_t* dstQ, float* dstF, int height, int width) const;
+    const float* forwardFP32(const cv::Mat& blob, int n, std::vector<float>* layerMax);
+    const float* forwardInt8(const cv::Mat& blob, int n);
+    void ensureBuffers(int width, int height);
+    void quantizeWeights();
+
+    bool int8;
+    std::vector<NativeConvLayer> layers;
+    bool residual = true;           // Salida = entrada - ruido estimado
+    int maxChannels = 0;
+
+    // Escala de la entrada de cada capa (valor real = q · escala)
+    std::vector<float> activationScales;
+
+    // Activaciones con borde de ceros: [canal][H+2][W+2]
+    std::vector<float> bufferA;
+    std::vector<float> bufferB;
+    std::vector<uint8_t> qbufferA;
+    std::vector<uint8_t> qbufferB;
+    cv::Size bufferSize;
+};
+
+} // namespace Denoising
+
+#endif // NATIVE_DNCNN_H
@@ -0,0 +1,177 @@
+#include "noise_estimation.h"
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace Preprocessing {
+
+namespace {
+
+// Factor de consistencia MAD -> sigma para ruido gaussiano
+const double kMadToSigma = 1.4826;
+// Norma L2 de la máscara de Immerkær: sqrt(4*1 + 4*4 + 16) = 6
+const double kMaskNorm = 6.0;
+// Por debajo de -500 HU se considera aire (fuera del paciente o pulmón)
+const double kBodyThresholdHU = -500.0;
+// Mínimo de puntos para que la MAD sea estable
+const int kMinSamples = 64;
+
+/**
+ * @brief Respuesta de la máscara de Immerkær en los puntos de la rejilla
+ *
+ * Solo se usan puntos cuyo vecindario 3x3 entero está dentro del rango
+ * (low, high): fuera del cuerpo y en zonas saturadas el ruido se ha perdido.
+ */
+template <typename T>
+void collectResponses(const cv::Mat& image, int step, double low, double high, std::vector<float>& responses) {
+    for (int y = 1; y < image.rows - 1; y += step) {
+        const T* above = image.ptr<T>(y - 1);
+        const T* row = image.ptr<T>(y);
+        const T* below = image.ptr<T>(y + 1);
+        for (int x = 1; x < image.cols - 1; x += step) {
+            const double n[9] = {
+                static_cast<double>(above[x - 1]), static_cast<double>(above[x]), static_cast<double>(above[x + 1]),
+                static_cast<double>(row[x - 1]),   static_cast<double>(row[x]),   static_cast<double>(row[x + 1]),
+                static_cast<double>(below[x - 1]), static_cast<double>(below[x]), static_cast<double>(below[x + 1])
+            };
+            bool inside = true;
+            for (int k = 0; k < 9 && inside; k++) {
+                inside = n[k] > low && n[k] < high;
+            }
+            if (!inside) continue;
+
+            const double response = (n[0] + n[2] + n[6] + n[8])
+                                  - 2.0 * (n[1] + n[3] + n[5] + n[7])
+                                  + 4.0 * n[4];
+            responses.push_back(static_cast<float>(response));
+        }
+    }
+}
+
+// Mediana in situ (reordena el vector)
+float medianInPlace(std::vector<float>& values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+} // namespace
+
+// ============================================================================
+// ESTIMACIÓN DEL NIVEL DE RUIDO
+// ============================================================================
+
+NoiseEstimate estimateNoiseSigma(const cv::Mat& image, int step) {
+    NoiseEstimate estimate;
+    if (image.empty() || image.channels() != 1 || image.rows < 3 || image.cols < 3) {
+        std::cerr << "Advertencia: estimateNoiseSigma requiere una imagen en escala de grises" << std::endl;
+        return estimate;
+    }
+    step = std::max(1, step);
+
+    // Rango "dentro del cuerpo" según el tipo de la imagen
+    double low, high;
+    if (image.depth() == CV_16S) {
+        low = kBodyThresholdHU;
+        high = 1e9;    // En HU no hay saturación superior relevante
+    } else {
+        double minVal, maxVal;
+        cv::minMaxLoc(image, &minVal, &maxVal);
+        low = minVal + 0.1 * (maxVal - minVal);
+        high = maxVal;  // Excluir píxeles saturados por el ventaneo
+    }
+
+    std::vector<float> responses;
+    responses.reserve(static_cast<size_t>((image.rows / step + 1) * (image.cols / step + 1)));
+    switch (image.depth()) {
+        case CV_8U:  collectResponses<uchar>(image, step, low, high, responses); break;
+        case CV_16S: collectResponses<short>(image, step, low, high, responses); break;
+        case CV_16U: collectResponses<ushort>(image, step, low, high, responses); break;
+        case CV_32F: collectResponses<float>(image, step, low, high, responses); break;
+        default: {
+            cv::Mat converted;
+            image.convertTo(converted, CV_32F);
+            collectResponses<float>(converted, step, low, high, responses);
+            break;
+        }
+    }
+
+    estimate.samples = static_cast<int>(responses.size());
+    if (estimate.samples < kMinSamples) {
+        return estimate;
+    }
+
+    // MAD = mediana(|r - mediana(r)|)
+    const float center = medianInPlace(responses);
+    for (float& r : responses) {
+        r = std::abs(r - center);
+    }
+    const double mad = medianInPlace(responses);
+
+    estimate.sigma = kMadToSigma * mad / kMaskNorm;
+    estimate.valid = true;
+    return estimate;
+}
+
+// ============================================================================
+// POLÍTICA DE DENOISING
+// ============================================================================
+
+std::pair<double, double> DenoisePolicy::thresholdsFor(int depth) const {
+    // Cortes de 16 bits: la sigma del estimador está en HU
+    if (depth == CV_16S || depth == CV_16U) {
+        return {skipBelowHU, dncnnAboveHU};
+    }
+    return {skipBelow, dncnnAbove};
+}
+
+DenoiseDecision decideDenoising(const cv::Mat& image, const DenoisePolicy& policy, bool dncnnAvailable) {
+    DenoiseDecision decision;
+
+    if (!policy.adaptive) {
+        decision.action = dncnnAvailable ? DenoiseAction::DNCNN : DenoiseAction::NONE;
+        return decision;
+    }
+
+    decision.estimate = estimateNoiseSigma(image, policy.gridStep);
+    if (!decision.estimate.valid) {
+        // Sin estimación fiable se mantiene el comportamiento anterior
+        decision.action = dncnnAvailable ? DenoiseAction::DNCNN : DenoiseAction::NONE;
+        return decision;
+    }
+
+    const double sigma = decision.estimate.sigma;
+    const auto [skipBelow, dncnnAbove] = policy.thresholdsFor(image.depth());
+    if (sigma < skipBelow) {
+        decision.action = DenoiseAction::NONE;
+    } else if (sigma >= dncnnAbove && dncnnAvailable) {
+        decision.action = DenoiseAction::DNCNN;
+    } else {
+        decision.action = DenoiseAction::CHEAP_FILTER;
+    }
+    return decision;
+}
+
+cv::Mat applyCheapDenoising(const cv::Mat& image, double sigma) {
+    cv::Mat result;
+    if (image.depth() == CV_8U || image.depth() == CV_32F) {
+        // sigmaColor proporcional al ruido: suaviza el grano sin cruzar bordes
+        cv::bilateralFilter(image, result, 5, std::max(1.0, 3.0 * sigma), 2.0);
+    } else {
+        cv::GaussianBlur(image, result, cv::Size(3, 3), 0.8);
+    }
+    return result;
+}
+
+std::string denoiseActionName(DenoiseAction action) {
+    switch (action) {
+        case DenoiseAction::NONE:         return "ninguno";
+        case DenoiseAction::CHEAP_FILTER: return "filtro ligero";
+        case DenoiseAction::DNCNN:        return "DnCNN";
+    }
+    return "desconocido";
+}
+
+} // namespace Preprocessing
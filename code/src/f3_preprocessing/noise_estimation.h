@@ -0,0 +1,102 @@
+#ifndef NOISE_ESTIMATION_H
+#define NOISE_ESTIMATION_H
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <utility>
+
+namespace Preprocessing {
+
+// ============================================================================
+// ESTIMACIÓN DEL NIVEL DE RUIDO
+// ============================================================================
+
+/**
+ * @brief Resultado de la estimación de ruido de un corte
+ */
+struct NoiseEstimate {
+    double sigma = 0.0;         // Desviación estándar estimada (unidades de la imagen)
+    int samples = 0;            // Puntos de la rejilla usados
+    bool valid = false;         // false si no hubo suficientes puntos dentro del cuerpo
+};
+
+/**
+ * @brief Estima la sigma del ruido gaussiano de un corte
+ *
+ * Método de Immerkær: se aplica la máscara [1 -2 1; -2 4 -2; 1 -2 1]
+ * (diferencia de dos laplacianos, anula planos y rampas) y se toma la MAD
+ * de la respuesta, robusta frente a los bordes anatómicos:
+ * sigma = 1.4826 * MAD / 6. Solo se evalúa en una rejilla submuestreada y
+ * dentro del cuerpo (el aire fuera del paciente no tiene ruido útil y en
+ * muchas series está recortado a un valor constante).
+ *
+ * @param image Corte en escala de grises (CV_8U, CV_16S, CV_16U o CV_32F)
+ * @param step Paso de la rejilla en píxeles (default: 4)
+ * @return Estimación; sigma está en HU para CV_16S y en niveles de gris para CV_8U
+ */
+NoiseEstimate estimateNoiseSigma(const cv::Mat& image, int step = 4);
+
+// ============================================================================
+// POLÍTICA DE DENOISING
+// ============================================================================
+
+/**
+ * @brief Filtro elegido para un corte según su nivel de ruido
+ */
+enum class DenoiseAction {
+    NONE,           // Ruido despreciable (dosis completa)
+    CHEAP_FILTER,   // Ruido moderado: filtro bilateral/gaussiano pequeño
+    DNCNN           // Ruido alto: red neuronal
+};
+
+/**
+ * @brief Umbrales de sigma para elegir el filtro
+ *
+ * Hay un par de umbrales en niveles de gris de 8 bits y otro en HU; se
+ * usa uno u otro según la profundidad del corte (CV_16S/CV_16U = HU).
+ */
+struct DenoisePolicy {
+    bool adaptive = true;           // false = siempre DnCNN (comportamiento anterior)
+    double skipBelow = 1.5;         // 8 bits: sigma < skipBelow -> NONE
+    double dncnnAbove = 4.0;        // 8 bits: sigma >= dncnnAbove -> DNCNN
+    double skipBelowHU = 8.0;       // HU: ~5 HU en dosis completa
+    double dncnnAboveHU = 20.0;     // HU: >20 HU en baja dosis
+    int gridStep = 4;               // Paso de la rejilla del estimador
+
+    /**
+     * @brief Umbrales (skipBelow, dncnnAbove) para la profundidad del corte
+     */
+    std::pair<double, double> thresholdsFor(int depth) const;
+};
+
+/**
+ * @brief Decisión tomada para un corte
+ */
+struct DenoiseDecision {
+    NoiseEstimate estimate;
+    DenoiseAction action = DenoiseAction::NONE;
+};
+
+/**
+ * @brief Elige el filtro para un corte a partir de su ruido estimado
+ * @param image Corte en escala de grises
+ * @param policy Umbrales
+ * @param dncnnAvailable Si hay un modelo DnCNN cargado; si no, DNCNN se degrada a CHEAP_FILTER
+ */
+DenoiseDecision decideDenoising(const cv::Mat& image, const DenoisePolicy& policy, bool dncnnAvailable);
+
+/**
+ * @brief Filtro barato de la política, ajustado a la sigma estimada
+ *
+ * Bilateral 5x5 para CV_8U/CV_32F y gaussiano 3x3 para el resto de tipos.
+ */
+cv::Mat applyCheapDenoising(const cv::Mat& image, double sigma);
+
+/**
+ * @brief Nombre legible de la acción (para logs)
+ */
+std::string denoiseActionName(DenoiseAction action);
+
+} // namespace Preprocessing
+
+#endif // NOISE_ESTIMATION_H
@@ -29,6 +29,10 @@ cv::Mat normalizeImage(const cv::Mat& image, double minVal, double maxVal) {
 cv::Mat equalizeHistogram(const cv::Mat& image) {
     cv::Mat equalized;
     
+    if (image.type() == CV_16SC1) {
+        return equalizeHistogramHU(image);
+    }
+    
     // Verificar que la imagen esté en escala de grises
     cv::Mat gray = convertToGrayscale(image);
     
@@ -40,6 +44,13 @@ cv::Mat equalizeHistogram(const cv::Mat& image) {
 cv::Mat applyCLAHE(const cv::Mat& image, double clipLimit, cv::Size tileGridSize) {
     cv::Mat clahe_result;
     
+    if (image.type() == CV_16SC1) {
+        HUClaheParams params;
+        params.clipLimit = clipLimit;
+        params.tileGrid = tileGridSize;
+        return applyCLAHEHU(image, params);
+    }
+    
     // Verificar que la imagen esté en escala de grises
     cv::Mat gray = convertToGrayscale(image);
     
@@ -73,6 +84,10 @@ cv::Mat applyMedianFilter(const cv::Mat& image, int kernelSize) {
         kernelSize++;
     }
     
+    if (image.depth() == CV_16S || image.depth() == CV_16U) {
+        return applyMedianFilterConstantTime(image, kernelSize);
+    }
+    
     cv::medianBlur(image, filtered, kernelSize);
     
     return filtered;
@@ -190,12 +205,30 @@ std::vector<std::pair<std::string, cv::Mat>> comparePreprocessingTechniques(cons
 
 cv::Mat preprocessCTImageWithDenoising(const cv::Mat& image, 
                                         bool useCLAHE,
-                                        Denoising::DnCNNDenoiser* denoiser) {
+                                        Denoising::DnCNNDenoiser* denoiser,
+                                        const DenoisePolicy& policy,
+                                        DenoiseDecision* decision) {
     cv::Mat processed = image.clone();
     
-    // 1. Aplicar denoising si está habilitado
-    if (denoiser != nullptr && denoiser->isLoaded()) {
-        processed = denoiser->denoise(processed);
+    // 1. Denoising según el ruido estimado del corte. Sin denoiser no se
+    // filtra; con un denoiser sin modelo cargado la política usa el filtro ligero
+    const bool dncnnAvailable = denoiser != nullptr && denoiser->isLoaded();
+    DenoiseDecision chosen = decideDenoising(convertToGrayscale(processed), policy, dncnnAvailable);
+    if (denoiser == nullptr) {
+        chosen.action = DenoiseAction::NONE;
+    }
+    switch (chosen.action) {
+        case DenoiseAction::DNCNN:
+            processed = denoiser->denoise(processed);
+            break;
+        case DenoiseAction::CHEAP_FILTER:
+            processed = applyCheapDenoising(processed, chosen.estimate.sigma);
+            break;
+        case DenoiseAction::NONE:
+            break;
+    }
+    if (decision != nullptr) {
+        *decision = chosen;
     }
     
     // 2. Convertir a escala de grises
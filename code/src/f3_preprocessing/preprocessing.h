@@ -4,6 +4,12 @@
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc.hpp"
 #include "denoising.h"
+#include "noise_estimation.h"
+#include "median_filter.h"
+#include "edge_preserving.h"
+#include "anisotropic_diffusion.h"
+#include "slab_denoising.h"
+#include "hu_equalization.h"
 
 namespace Preprocessing {
 
@@ -29,14 +35,14 @@ cv::Mat normalizeImage(const cv::Mat& image, double minVal = 0.0, double maxVal
 
 /**
  * @brief Aplica ecualización de histograma clásica
- * @param image Imagen en escala de grises
- * @return Imagen ecualizada
+ * @param image Imagen en escala de grises (CV_16S: equalizeHistogramHU con la ventana por defecto)
+ * @return Imagen ecualizada (8 bits)
  */
 cv::Mat equalizeHistogram(const cv::Mat& image);
 
 /**
  * @brief Aplica CLAHE (Contrast Limited Adaptive Histogram Equalization)
- * @param image Imagen en escala de grises
+ * @param image Imagen en escala de grises (CV_16S: applyCLAHEHU con la ventana por defecto)
  * @param clipLimit Límite de contraste (default: 2.0)
  * @param tileGridSize Tamaño de la cuadrícula de tiles (default: 8x8)
  * @return Imagen con CLAHE aplicado
@@ -57,6 +63,10 @@ cv::Mat applyGaussianBlur(const cv::Mat& image, int kernelSize = 5, double sigma
 
 /**
  * @brief Aplica filtro de la mediana
+ *
+ * Las imágenes de 16 bits (HU) usan applyMedianFilterConstantTime, ya que
+ * cv::medianBlur no admite CV_16S ni kernels mayores que 5 fuera de 8 bits.
+ *
  * @param image Imagen de entrada
  * @param kernelSize Tamaño del kernel (debe ser impar, default: 5)
  * @return Imagen con ruido reducido
@@ -134,14 +144,24 @@ std::vector<std::pair<std::string, cv::Mat>> comparePreprocessingTechniques(cons
 
 /**
  * @brief Pipeline completo con opción de denoising con red neuronal
+ *
+ * Con la política adaptativa (por defecto) se estima el ruido del corte y
+ * se omite el denoising, se aplica un filtro ligero o se usa DnCNN según
+ * los umbrales de la política.
+ *
  * @param image Imagen de entrada
  * @param useCLAHE Usar CLAHE para ecualización
- * @param denoiser Puntero a denoiser (nullptr = no usar)
+ * @param denoiser Puntero a denoiser (nullptr = sin denoising; sin modelo cargado
+ *                 se degrada al filtro ligero)
+ * @param policy Umbrales de la política de denoising (8 bits o HU según la profundidad)
+ * @param decision Salida opcional: sigma estimada y filtro aplicado
  * @return Imagen preprocesada
  */
 cv::Mat preprocessCTImageWithDenoising(const cv::Mat& image, 
                                         bool useCLAHE,
-                                        Denoising::DnCNNDenoiser* denoiser);
+                                        Denoising::DnCNNDenoiser* denoiser,
+                                        const DenoisePolicy& policy = DenoisePolicy(),
+                                        DenoiseDecision* decision = nullptr);
 
 } // namespace Preprocessing
 
@@ -0,0 +1,259 @@
+#include "slab_denoising.h"
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace Preprocessing {
+
+namespace {
+
+// Filas mínimas por banda paralela
+const int kMinBandRows = 32;
+
+/**
+ * @brief Acumula la contribución de un desplazamiento (dz, dy, dx) en una banda de filas
+ *
+ * padded: cortes con borde de pad píxeles; [y0, y1) filas de salida.
+ * offsetExponent: exponente del peso fijo del desplazamiento (se suma antes del exp).
+ */
+void accumulateOffset(const cv::Mat& centerPadded, const cv::Mat& neighbourPadded, int pad,
+                      int y0, int y1, int dx, int dy, double offsetExponent,
+                      const SlabParams& params, cv::Mat& acc, cv::Mat& weightSum) {
+    const int width = acc.cols;
+    const int height = y1 - y0;
+    const cv::Mat neighbour = neighbourPadded(cv::Rect(pad + dx, pad + y0 + dy, width, height));
+
+    cv::Mat diff, distance, weight;
+    if (params.method == SlabMethod::BILATERAL) {
+        const cv::Mat center = centerPadded(cv::Rect(pad, pad + y0, width, height));
+        cv::subtract(neighbour, center, diff);
+        const double invRange = 1.0 / (2.0 * params.sigmaRange * params.sigmaRange);
+        cv::multiply(diff, diff, distance, -invRange);
+        distance.convertTo(distance, CV_32F, 1.0, -offsetExponent);
+    } else {
+        // Distancia media entre parches: diferencia al cuadrado con box filter
+        const int p = params.patchRadius;
+        const cv::Rect extCenter(pad - p, pad + y0 - p, width + 2 * p, height + 2 * p);
+        const cv::Rect extNeighbour(extCenter.x + dx, extCenter.y + dy, extCenter.width, extCenter.height);
+        cv::subtract(neighbourPadded(extNeighbour), centerPadded(extCenter), diff);
+        cv::Mat squared, patchDistance;
+        cv::multiply(diff, diff, squared);
+        cv::boxFilter(squared, patchDistance, CV_32F, cv::Size(2 * p + 1, 2 * p + 1),
+                      cv::Point(-1, -1), true, cv::BORDER_REPLICATE);
+        const double invH = 1.0 / (params.h * params.h);
+        patchDistance(cv::Rect(p, p, width, height)).convertTo(distance, CV_32F, -invH, -offsetExponent);
+    }
+    cv::exp(distance, weight);
+
+    cv::accumulateProduct(weight, neighbour, acc);
+    cv::accumulate(weight, weightSum);
+}
+
+} // namespace
+
+bool SlabParams::operator==(const SlabParams& other) const {
+    return halfWidth == other.halfWidth && method == other.method && radius == other.radius &&
+           sigmaSpace == other.sigmaSpace && sigmaSlice == other.sigmaSlice &&
+           sigmaRange == other.sigmaRange && patchRadius == other.patchRadius && h == other.h;
+}
+
+// ============================================================================
+// FILTRO DE LA LOSA
+// ============================================================================
+
+cv::Mat denoiseSlab(const std::vector<cv::Mat>& slab, int center, const SlabParams& params,
+                    const std::vector<int>& positions) {
+    if (center < 0 || center >= static_cast<int>(slab.size()) || slab[center].empty() ||
+        slab[center].type() != CV_32FC1) {
+        std::cerr << "Advertencia: denoiseSlab requiere cortes CV_32F y un índice central válido" << std::endl;
+        return center >= 0 && center < static_cast<int>(slab.size()) ? slab[center].clone() : cv::Mat();
+    }
+    if (!positions.empty() && positions.size() != slab.size()) {
+        std::cerr << "Advertencia: denoiseSlab requiere una posición z por corte" << std::endl;
+        return slab[center].clone();
+    }
+    // Desplazamiento z real de cada corte respecto al central
+    auto offsetOf = [&](int z) {
+        return positions.empty() ? z - center : positions[z] - positions[center];
+    };
+    const cv::Mat& reference = slab[center];
+    const int radius = std::max(0, params.radius);
+    const int patchRadius = params.method == SlabMethod::NLM ? std::max(0, params.patchRadius) : 0;
+    const int pad = radius + patchRadius;
+    if ((params.method == SlabMethod::BILATERAL && (params.sigmaRange <= 0.0 || params.sigmaSpace <= 0.0)) ||
+        (params.method == SlabMethod::NLM && params.h <= 0.0)) {
+        return reference.clone();
+    }
+
+    // Cortes de la losa utilizables (mismo tamaño) con borde reflejado
+    std::vector<cv::Mat> padded(slab.size());
+    std::vector<int> usable;
+    for (int z = 0; z < static_cast<int>(slab.size()); z++) {
+        if (std::abs(offsetOf(z)) > params.halfWidth || slab[z].size() != reference.size() ||
+            slab[z].type() != CV_32FC1) {
+            continue;
+        }
+        cv::copyMakeBorder(slab[z], padded[z], pad, pad, pad, pad, cv::BORDER_REFLECT);
+        usable.push_back(z);
+    }
+
+    const double invSlice = params.sigmaSlice > 0.0 ? 1.0 / (2.0 * params.sigmaSlice * params.sigmaSlice) : 0.0;
+    const double invSpace = 1.0 / (2.0 * params.sigmaSpace * params.sigmaSpace);
+
+    int bands = std::max(1, cv::getNumThreads());
+    bands = std::max(1, std::min(bands, reference.rows / kMinBandRows));
+    const int bandRows = (reference.rows + bands - 1) / bands;
+
+    cv::Mat output(reference.size(), CV_32F);
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; b++) {
+            const int y0 = b * bandRows;
+            const int y1 = std::min(reference.rows, y0 + bandRows);
+            if (y0 >= y1) continue;
+
+            cv::Mat acc = cv::Mat::zeros(y1 - y0, reference.cols, CV_32F);
+            cv::Mat weightSum = cv::Mat::zeros(y1 - y0, reference.cols, CV_32F);
+            for (int z : usable) {
+                const int dz = offsetOf(z);
+                for (int dy = -radius; dy <= radius; dy++) {
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        // Peso fijo del desplazamiento (distancia en el plano solo en el bilateral)
+                        double exponent = dz * dz * invSlice;
+                        if (params.method == SlabMethod::BILATERAL) {
+                            exponent += (dx * dx + dy * dy) * invSpace;
+                        }
+                        accumulateOffset(padded[center], padded[z], pad, y0, y1, dx, dy,
+                                         exponent, params, acc, weightSum);
+                    }
+                }
+            }
+            cv::Mat outputBand = output.rowRange(y0, y1);
+            cv::divide(acc, weightSum, outputBand);
+        }
+    });
+    return output;
+}
+
+// ============================================================================
+// SLAB DENOISER (BUFFER CIRCULAR)
+// ============================================================================
+
+SlabDenoiser::SlabDenoiser(int numSlices, SliceLoader loader, const SlabParams& params)
+    : numSlices(std::max(0, numSlices))
+    , loader(std::move(loader))
+    , params(params)
+    , sliceType(CV_16SC1)
+    , slicesRead(0)
+    , nextIndex(0)
+    , lastIndex(-1)
+    , lastScale(1) {
+    resizeRing();
+}
+
+void SlabDenoiser::resizeRing() {
+    const size_t size = static_cast<size_t>(2 * std::max(0, params.halfWidth) + 1);
+    ring.assign(size, cv::Mat());
+    ringIndex.assign(size, -1);
+}
+
+bool SlabDenoiser::fetch(int index, cv::Mat& slice) {
+    const size_t slot = static_cast<size_t>(index) % ring.size();
+    if (ringIndex[slot] != index) {
+        cv::Mat raw = loader(index);
+        slicesRead++;
+        if (raw.empty() || raw.channels() != 1) {
+            std::cerr << "Advertencia: no se pudo leer el corte " << index << " para la losa" << std::endl;
+            ringIndex[slot] = -1;
+            ring[slot].release();
+            return false;
+        }
+        sliceType = raw.type();
+        raw.convertTo(ring[slot], CV_32F);
+        ringIndex[slot] = index;
+    }
+    slice = ring[slot];
+    return true;
+}
+
+cv::Mat SlabDenoiser::denoise(int index, int scale) {
+    if (index < 0 || index >= numSlices) {
+        return cv::Mat();
+    }
+    scale = std::max(1, scale);
+    if (index == lastIndex && scale == lastScale && params == lastParams && !lastOutput.empty()) {
+        return lastOutput.clone();
+    }
+
+    const int k = std::max(0, params.halfWidth);
+    const int first = std::max(0, index - k);
+    const int last = std::min(numSlices - 1, index + k);
+
+    std::vector<cv::Mat> slab;
+    std::vector<int> positions;         // z real de cada corte (la losa puede tener huecos)
+    int center = -1;
+    for (int z = first; z <= last; z++) {
+        cv::Mat slice;
+        if (!fetch(z, slice)) {
+            if (z == index) return cv::Mat();
+            continue;   // Un vecino ilegible se omite
+        }
+        if (z == index) center = static_cast<int>(slab.size());
+        if (scale > 1) {
+            cv::Mat reduced;
+            cv::resize(slice, reduced, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+            slice = reduced;
+        }
+        slab.push_back(slice);
+        positions.push_back(z);
+    }
+
+    // Vista previa: soporte en el plano reducido en la misma proporción que la imagen
+    SlabParams scaled = params;
+    if (scale > 1) {
+        scaled.radius = std::max(1, params.radius / scale);
+        scaled.sigmaSpace = std::max(0.5, params.sigmaSpace / scale);
+    }
+
+    cv::Mat filtered = denoiseSlab(slab, center, scaled, positions);
+    filtered.convertTo(lastOutput, sliceType);
+    lastIndex = index;
+    lastScale = scale;
+    lastParams = params;
+    return lastOutput.clone();
+}
+
+bool SlabDenoiser::next(cv::Mat& output, int* index) {
+    if (nextIndex >= numSlices) {
+        return false;
+    }
+    if (index) *index = nextIndex;
+    output = denoise(nextIndex);
+    nextIndex++;
+    return true;
+}
+
+void SlabDenoiser::setParams(const SlabParams& newParams) {
+    const bool resize = newParams.halfWidth != params.halfWidth;
+    params = newParams;
+    if (resize) {
+        resizeRing();
+    }
+}
+
+void SlabDenoiser::reset() {
+    resizeRing();
+    nextIndex = 0;
+    lastIndex = -1;
+    lastOutput.release();
+}
+
+std::string slabMethodName(SlabMethod method) {
+    switch (method) {
+        case SlabMethod::BILATERAL: return "Bilateral 3D";
+        case SlabMethod::NLM:       return "NLM 2.5D";
+    }
+    return "desconocido";
+}
+
+} // namespace Preprocessing
@@ -0,0 +1,137 @@
+#ifndef SLAB_DENOISING_H
+#define SLAB_DENOISING_H
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Preprocessing {
+
+// ============================================================================
+// DENOISING 2.5D (LOSA DE CORTES VECINOS)
+// ============================================================================
+
+/**
+ * @brief Método de denoising sobre la losa
+ */
+enum class SlabMethod {
+    BILATERAL,      // Bilateral 3D: peso espacial, entre cortes y de intensidad
+    NLM             // Non-local means con parches 2D buscados en los cortes vecinos
+};
+
+/**
+ * @brief Parámetros del denoising 2.5D (intensidades en unidades de la imagen; HU para CV_16S)
+ */
+struct SlabParams {
+    int halfWidth = 2;              // k: cortes a cada lado (losa de 2k+1)
+    SlabMethod method = SlabMethod::BILATERAL;
+    int radius = 2;                 // Radio de búsqueda en el plano (píxeles)
+    double sigmaSpace = 1.5;        // Bilateral: sigma en el plano (píxeles)
+    double sigmaSlice = 1.0;        // Sigma entre cortes (cortes); ambos métodos
+    double sigmaRange = 40.0;       // Bilateral: sigma de intensidad
+    int patchRadius = 1;            // NLM: radio del parche
+    double h = 25.0;                // NLM: parámetro de filtrado
+
+    bool operator==(const SlabParams& other) const;
+    bool operator!=(const SlabParams& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Denoising de un corte con sus vecinos
+ *
+ * El ruido de baja dosis apenas está correlacionado entre cortes contiguos
+ * mientras que la anatomía sí, así que promediar con pesos que respetan la
+ * intensidad (bilateral) o el parche (NLM) en la losa reduce el ruido sin
+ * el emborronamiento de un filtro 2D de igual soporte. Cada desplazamiento
+ * (dz, dy, dx) se procesa sobre la imagen completa con operaciones
+ * vectorizadas de OpenCV; las filas se reparten en bandas paralelas.
+ *
+ * @param slab Cortes CV_32F del mismo tamaño, ordenados en z
+ * @param center Índice del corte a filtrar dentro de slab
+ * @param params Parámetros
+ * @param positions Posición z (índice de corte) de cada elemento de slab; vacío =
+ *        cortes consecutivos. Necesario si la losa tiene huecos (vecinos ilegibles)
+ * @return Corte filtrado CV_32F
+ */
+cv::Mat denoiseSlab(const std::vector<cv::Mat>& slab, int center, const SlabParams& params = SlabParams(),
+                    const std::vector<int>& positions = std::vector<int>());
+
+/**
+ * @brief Denoising 2.5D de una serie con buffer circular de cortes
+ *
+ * Mantiene como mucho 2k+1 cortes decodificados (en float). Al avanzar un
+ * corte solo se lee el nuevo, así que recorrer la serie en orden lee cada
+ * archivo una vez y el consumo de memoria no depende del número de cortes.
+ * También sirve para acceso aleatorio (desplazarse en la interfaz): los
+ * cortes que siguen en la ventana no se vuelven a leer. El último resultado
+ * se guarda para no recalcularlo si no cambian el índice ni los parámetros.
+ */
+class SlabDenoiser {
+public:
+    /// Devuelve el corte i (normalmente CV_16S en HU) o una matriz vacía si falla
+    using SliceLoader = std::function<cv::Mat(int)>;
+
+    SlabDenoiser(int numSlices, SliceLoader loader, const SlabParams& params = SlabParams());
+
+    /**
+     * @brief Filtra el corte index con su losa
+     *
+     * Con scale > 1 (vista previa) los cortes de la losa se reducen antes de
+     * filtrar y el radio y la sigma en el plano se escalan igual, así que el
+     * coste baja con scale²; el buffer circular sigue guardando la resolución
+     * completa.
+     *
+     * @param index Corte a filtrar
+     * @param scale Factor de reducción (1 = resolución completa)
+     * @return Corte filtrado del tipo del original (reducido si scale > 1), o vacío si no se pudo leer
+     */
+    cv::Mat denoise(int index, int scale = 1);
+
+    /**
+     * @brief Recorrido secuencial: filtra el siguiente corte
+     * @param output Corte filtrado
+     * @param index Si no es nulo, recibe el índice del corte
+     * @return false al terminar la serie
+     */
+    bool next(cv::Mat& output, int* index = nullptr);
+
+    void setParams(const SlabParams& newParams);
+    const SlabParams& getParams() const { return params; }
+
+    int getNumSlices() const { return numSlices; }
+    size_t getSlicesRead() const { return slicesRead; }
+
+    /**
+     * @brief Vacía el buffer circular y reinicia el recorrido
+     */
+    void reset();
+
+private:
+    bool fetch(int index, cv::Mat& slice);
+    void resizeRing();
+
+    int numSlices;
+    SliceLoader loader;
+    SlabParams params;
+
+    std::vector<cv::Mat> ring;          // Cortes en float, posición index % ring.size()
+    std::vector<int> ringIndex;         // Corte almacenado en cada posición (-1 = libre)
+    int sliceType;                      // Tipo original de los cortes
+    size_t slicesRead;
+    int nextIndex;
+
+    int lastIndex;
+    int lastScale;
+    SlabParams lastParams;
+    cv::Mat lastOutput;
+};
+
+/**
+ * @brief Nombre legible del método
+ */
+std::string slabMethodName(SlabMethod method);
+
+} // namespace Preprocessing
+
+#endif // SLAB_DENOISING_H
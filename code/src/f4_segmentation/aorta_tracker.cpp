@@ -0,0 +1,140 @@
+#include "aorta_tracker.h"
+#include "vesselness.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Segmentation {
+
+AortaTracker::AortaTracker(const AortaTrackerParams& params)
+    : params(params),
+      priorValid(false),
+      priorRadius(0.0),
+      priorArea(0.0),
+      trackedCount(0),
+      fullSearchCount(0) {
+}
+
+void AortaTracker::reset() {
+    priorValid = false;
+    priorRadius = 0.0;
+    priorArea = 0.0;
+}
+
+void AortaTracker::updatePrior(const SegmentedRegion& region) {
+    priorValid = true;
+    priorCentroid = region.centroid;
+    priorArea = region.area;
+    priorRadius = std::sqrt(region.area / CV_PI);
+}
+
+AortaTrackResult AortaTracker::process(const cv::Mat& imageHU, const cv::Mat& vesselness) {
+    if (priorValid) {
+        AortaTrackResult result = trackInROI(imageHU, vesselness);
+        if (result.confidence >= params.minConfidence) {
+            updatePrior(result.regions.front());
+            trackedCount++;
+            return result;
+        }
+    }
+
+    // Búsqueda completa (primer corte o seguimiento perdido)
+    AortaTrackResult result;
+    result.regions = segmentAorta(imageHU, params.segmentation, vesselness, params.minVesselness);
+    fullSearchCount++;
+    if (result.regions.empty()) {
+        reset();
+    } else {
+        result.confidence = 1.0;
+        updatePrior(result.regions.front());
+    }
+    return result;
+}
+
+AortaTrackResult AortaTracker::trackInROI(const cv::Mat& imageHU, const cv::Mat& vesselness) {
+    AortaTrackResult result;
+    result.tracked = true;
+
+    // ROI centrada en el prior
+    const int half = static_cast<int>(std::ceil(priorRadius * params.roiRadiusFactor)) + params.maxShiftPx;
+    cv::Rect roi(static_cast<int>(std::lround(priorCentroid.x)) - half,
+                 static_cast<int>(std::lround(priorCentroid.y)) - half,
+                 2 * half + 1, 2 * half + 1);
+    roi &= cv::Rect(0, 0, imageHU.cols, imageHU.rows);
+    result.roi = roi;
+    if (roi.empty()) return result;
+
+    const cv::Mat sub = imageHU(roi);
+
+    // Mismo procesamiento que segmentAorta, restringido a la ROI: candidatos
+    // filtrados por área, después cierre + dilatación y etiquetado final
+    cv::Mat mask = thresholdByRange(sub, params.segmentation.minHU, params.segmentation.maxHU);
+    if (!vesselness.empty()) {
+        mask = gateByVesselness(mask, vesselness(roi), params.minVesselness);
+    }
+    cv::Mat combinedMask = cv::Mat::zeros(sub.size(), CV_8U);
+    for (const auto& candidate : findConnectedComponents(mask, params.segmentation.minArea)) {
+        if (candidate.area > params.segmentation.maxArea) continue;
+        cv::bitwise_or(combinedMask, candidate.mask, combinedMask);
+    }
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5, 5));
+    cv::morphologyEx(combinedMask, combinedMask, cv::MORPH_CLOSE, kernel);
+    cv::dilate(combinedMask, combinedMask, kernel);
+
+    cv::Mat labels, stats, centroids;
+    const int nLabels = cv::connectedComponentsWithStats(combinedMask, labels, stats, centroids);
+
+    const cv::Point2d priorLocal(priorCentroid.x - roi.x, priorCentroid.y - roi.y);
+    int bestLabel = -1;
+    double bestConfidence = 0.0;
+
+    for (int i = 1; i < nLabels; i++) {
+        const double area = stats.at<int>(i, cv::CC_STAT_AREA);
+        if (area < params.minAreaRatio * priorArea || area > params.maxAreaRatio * priorArea) continue;
+
+        const cv::Point2d c(centroids.at<double>(i, 0), centroids.at<double>(i, 1));
+        const double shift = cv::norm(c - priorLocal);
+        if (shift > params.maxShiftPx) continue;
+
+        // Confianza: consistencia de área y de posición
+        double confidence = (std::min(area, priorArea) / std::max(area, priorArea)) *
+                            (1.0 - 0.5 * shift / params.maxShiftPx);
+
+        // Una región que toca el borde de la ROI probablemente se ha fugado a otra estructura
+        const int left = stats.at<int>(i, cv::CC_STAT_LEFT);
+        const int top = stats.at<int>(i, cv::CC_STAT_TOP);
+        const int width = stats.at<int>(i, cv::CC_STAT_WIDTH);
+        const int height = stats.at<int>(i, cv::CC_STAT_HEIGHT);
+        if (left == 0 || top == 0 || left + width >= roi.width || top + height >= roi.height) {
+            confidence *= 0.5;
+        }
+
+        if (confidence > bestConfidence) {
+            bestConfidence = confidence;
+            bestLabel = i;
+        }
+    }
+
+    result.confidence = bestConfidence;
+    if (bestLabel < 0) return result;
+
+    // Región en coordenadas de la imagen completa
+    const cv::Mat localMask = (labels == bestLabel);
+    SegmentedRegion region;
+    region.mask = cv::Mat::zeros(imageHU.size(), CV_8U);
+    localMask.copyTo(region.mask(roi));
+    region.boundingBox = cv::Rect(stats.at<int>(bestLabel, cv::CC_STAT_LEFT) + roi.x,
+                                  stats.at<int>(bestLabel, cv::CC_STAT_TOP) + roi.y,
+                                  stats.at<int>(bestLabel, cv::CC_STAT_WIDTH),
+                                  stats.at<int>(bestLabel, cv::CC_STAT_HEIGHT));
+    region.area = stats.at<int>(bestLabel, cv::CC_STAT_AREA);
+    region.centroid = cv::Point2d(centroids.at<double>(bestLabel, 0) + roi.x,
+                                  centroids.at<double>(bestLabel, 1) + roi.y);
+    region.meanHU = cv::mean(sub, localMask)[0];
+    region.label = "Aorta / Arterias";
+    region.color = params.segmentation.visualColor;
+
+    result.regions.push_back(region);
+    return result;
+}
+
+} // namespace Segmentation
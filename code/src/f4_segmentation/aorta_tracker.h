@@ -0,0 +1,79 @@
+#ifndef AORTA_TRACKER_H
+#define AORTA_TRACKER_H
+
+#include "segmentation.h"
+
+namespace Segmentation {
+
+// ============================================================================
+// SEGUIMIENTO DE LA AORTA ENTRE CORTES
+// ============================================================================
+
+/**
+ * @brief Parámetros del seguimiento de la aorta
+ */
+struct AortaTrackerParams {
+    SegmentationParams segmentation = getDefaultAortaParams();
+    double roiRadiusFactor = 2.5;   // Semilado de la ROI = factor · radio previo + desplazamiento máximo
+    int maxShiftPx = 15;            // Desplazamiento máximo esperado entre cortes (píxeles)
+    double minAreaRatio = 0.5;      // Área mínima relativa al corte anterior
+    double maxAreaRatio = 2.0;      // Área máxima relativa al corte anterior
+    double minConfidence = 0.5;     // Por debajo se recurre a la búsqueda completa
+    double minVesselness = 0.05;    // Vesselness mínima cuando se pasa ese canal a process
+};
+
+/**
+ * @brief Resultado de procesar un corte con el seguimiento
+ */
+struct AortaTrackResult {
+    std::vector<SegmentedRegion> regions;   // Región de la aorta (vacío si no se encontró)
+    bool tracked = false;                   // true = ROI; false = búsqueda en toda la imagen
+    double confidence = 0.0;                // Confianza del seguimiento (0-1)
+    cv::Rect roi;                           // ROI procesada (vacía en búsqueda completa)
+};
+
+/**
+ * @brief Seguimiento de la aorta corte a corte
+ *
+ * Usa el centroide y el radio de la aorta del corte anterior como prior y
+ * procesa solo una ROI pequeña a su alrededor. Si la confianza cae (área o
+ * desplazamiento inconsistentes, región pegada al borde de la ROI) se
+ * recurre a segmentAorta sobre la imagen completa.
+ */
+class AortaTracker {
+public:
+    explicit AortaTracker(const AortaTrackerParams& params = AortaTrackerParams());
+
+    /**
+     * @brief Procesa el siguiente corte de la serie
+     * @param imageHU Imagen CT en HU (CV_16S)
+     * @param vesselness Vesselness CV_32F del corte (opcional, p.ej. de computeVesselness3D)
+     * @return Región detectada y estado del seguimiento
+     */
+    AortaTrackResult process(const cv::Mat& imageHU, const cv::Mat& vesselness = cv::Mat());
+
+    /**
+     * @brief Olvida el prior (p.ej. al cambiar de serie)
+     */
+    void reset();
+
+    bool hasPrior() const { return priorValid; }
+    int getTrackedCount() const { return trackedCount; }
+    int getFullSearchCount() const { return fullSearchCount; }
+
+private:
+    AortaTrackResult trackInROI(const cv::Mat& imageHU, const cv::Mat& vesselness);
+    void updatePrior(const SegmentedRegion& region);
+
+    AortaTrackerParams params;
+    bool priorValid;
+    cv::Point2d priorCentroid;
+    double priorRadius;
+    double priorArea;
+    int trackedCount;
+    int fullSearchCount;
+};
+
+} // namespace Segmentation
+
+#endif // AORTA_TRACKER_H
@@ -0,0 +1,196 @@
+#include "auto_threshold.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace Segmentation {
+
+namespace {
+
+// Ventana HU útil en CT y número máximo de bins para Otsu de 3+ clases
+const int kHUWindowMin = -1024;
+const int kHUWindowMax = 3071;
+const int kMaxOtsuBins = 4096;
+
+// Media nominal del tejido blando usada para desplazar los rangos por defecto
+const double kNominalSoftTissueHU = 40.0;
+const double kMaxSoftTissueShift = 40.0;
+
+} // namespace
+
+// OTSU MULTINIVEL
+
+HistogramClusters multiOtsu(const HUHistogram& hist, int classes,
+                            int minValue, int maxValue, int binWidth) {
+    HistogramClusters result;
+    if (hist.empty() || classes < 2 || classes > 4) {
+        std::cerr << "Error: multiOtsu requiere un histograma no vacío y 2-4 clases" << std::endl;
+        return result;
+    }
+
+    // Ventana en índices de bin, recortada a los bins ocupados
+    const int lastBin = static_cast<int>(hist.counts.size()) - 1;
+    int first = static_cast<int>(std::max<long long>(0, static_cast<long long>(minValue) - hist.offset));
+    int last = static_cast<int>(std::min<long long>(lastBin, static_cast<long long>(maxValue) - hist.offset));
+    while (first <= last && hist.counts[first] == 0.0) first++;
+    while (last >= first && hist.counts[last] == 0.0) last--;
+    if (first > last) {
+        std::cerr << "Error: No hay píxeles dentro de la ventana de multiOtsu" << std::endl;
+        return result;
+    }
+
+    const int range = last - first + 1;
+    if (binWidth <= 0) {
+        binWidth = (classes > 2) ? std::max(1, (range + kMaxOtsuBins - 1) / kMaxOtsuBins) : 1;
+    }
+    const int n = (range + binWidth - 1) / binWidth;
+
+    // Sumas prefijas exactas (valores relativos a 'first' para conservar precisión)
+    std::vector<double> P0(n + 1, 0.0), P1(n + 1, 0.0), P2(n + 1, 0.0);
+    for (int b = 0; b < n; b++) {
+        double w = 0.0, s = 0.0, s2 = 0.0;
+        const int end = std::min(range, (b + 1) * binWidth);
+        for (int i = b * binWidth; i < end; i++) {
+            const double c = hist.counts[first + i];
+            w += c;
+            s += c * i;
+            s2 += c * i * static_cast<double>(i);
+        }
+        P0[b + 1] = P0[b] + w;
+        P1[b + 1] = P1[b] + s;
+        P2[b + 1] = P2[b] + s2;
+    }
+
+    // Contribución de una clase [a, b) a la varianza entre clases: S² / W
+    auto term = [&](int a, int b) {
+        const double w = P0[b] - P0[a];
+        if (w <= 0.0) return 0.0;
+        const double s = P1[b] - P1[a];
+        return s * s / w;
+    };
+
+    const int K = std::min(classes, n);
+    std::vector<int> bounds(K + 1, 0);
+    bounds[K] = n;
+
+    if (K > 1) {
+        // best[k][i]: mejor valor repartiendo los bins [0, i) en k+1 clases
+        std::vector<std::vector<double>> best(K - 1, std::vector<double>(n + 1, 0.0));
+        std::vector<std::vector<int>> arg(K - 1, std::vector<int>(n + 1, 0));
+        for (int i = 1; i <= n; i++) best[0][i] = term(0, i);
+
+        for (int k = 1; k < K - 1; k++) {
+            for (int i = k + 1; i <= n; i++) {
+                double bestValue = -1.0;
+                int bestSplit = k;
+                for (int j = k; j < i; j++) {
+                    const double v = best[k - 1][j] + term(j, i);
+                    if (v > bestValue) {
+                        bestValue = v;
+                        bestSplit = j;
+                    }
+                }
+                best[k][i] = bestValue;
+                arg[k][i] = bestSplit;
+            }
+        }
+
+        // La última clase solo necesita evaluarse para i = n
+        double bestValue = -1.0;
+        int bestSplit = K - 1;
+        for (int j = K - 1; j < n; j++) {
+            const double v = best[K - 2][j] + term(j, n);
+            if (v > bestValue) {
+                bestValue = v;
+                bestSplit = j;
+            }
+        }
+        bounds[K - 1] = bestSplit;
+        for (int k = K - 2; k >= 1; k--) {
+            bounds[k] = arg[k][bounds[k + 1]];
+        }
+    }
+
+    const double base = hist.valueOf(first);
+    result.centers.resize(K);
+    result.thresholds.resize(K - 1);
+    double withinVariance = 0.0;
+    for (int j = 0; j < K; j++) {
+        const int a = bounds[j], b = bounds[j + 1];
+        const double w = P0[b] - P0[a];
+        const double mean = (w > 0.0) ? (P1[b] - P1[a]) / w : 0.5 * (a + b) * binWidth;
+        result.centers[j] = base + mean;
+        withinVariance += (P2[b] - P2[a]) - term(a, b);
+        if (j < K - 1) {
+            result.thresholds[j] = hist.valueOf(first + std::min(range, b * binWidth) - 1);
+        }
+    }
+    result.compactness = withinVariance;
+    return result;
+}
+
+// UMBRALES HU AUTOMÁTICOS
+
+AutoHUThresholds computeAutoThresholds(const HUHistogram& hist) {
+    AutoHUThresholds thresholds;
+    if (hist.empty() || hist.depth != CV_16S) {
+        std::cerr << "Advertencia: Umbrales automáticos requieren histograma HU (CV_16S), "
+                  << "se usan los valores por defecto" << std::endl;
+        return thresholds;
+    }
+
+    HistogramClusters tissues = multiOtsu(hist, 3, kHUWindowMin, kHUWindowMax);
+    if (tissues.thresholds.size() != 2) return thresholds;
+
+    thresholds.airTissue = std::clamp(tissues.thresholds[0], -700, -200);
+    thresholds.softBone = std::clamp(tissues.thresholds[1], 120, 400);
+
+    HistogramClusters soft = multiOtsu(hist, 2, thresholds.airTissue + 1, thresholds.softBone);
+    if (soft.thresholds.size() == 1) {
+        thresholds.fatSoft = std::clamp(soft.thresholds[0], -80, 20);
+        thresholds.softTissueMean = soft.centers[1];
+    }
+
+    thresholds.valid = true;
+    return thresholds;
+}
+
+SegmentationParams getAdaptiveLungParams(const AutoHUThresholds& thresholds) {
+    SegmentationParams params = getDefaultLungParams();
+    if (thresholds.valid) {
+        params.maxHU = thresholds.airTissue;
+    }
+    return params;
+}
+
+SegmentationParams getAdaptiveHeartParams(const AutoHUThresholds& thresholds) {
+    SegmentationParams params = getDefaultHeartParams();
+    if (thresholds.valid) {
+        const int shift = static_cast<int>(std::lround(std::clamp(
+            thresholds.softTissueMean - kNominalSoftTissueHU, -kMaxSoftTissueShift, kMaxSoftTissueShift)));
+        params.minHU = std::max(params.minHU + shift, thresholds.fatSoft);
+        params.maxHU = std::min(params.maxHU + shift, thresholds.softBone - 1);
+    }
+    return params;
+}
+
+SegmentationParams getAdaptiveBoneParams(const AutoHUThresholds& thresholds) {
+    SegmentationParams params = getDefaultBoneParams();
+    if (thresholds.valid) {
+        params.minHU = thresholds.softBone;
+    }
+    return params;
+}
+
+SegmentationParams getAdaptiveAortaParams(const AutoHUThresholds& thresholds) {
+    SegmentationParams params = getDefaultAortaParams();
+    if (thresholds.valid) {
+        const int shift = static_cast<int>(std::lround(std::clamp(
+            thresholds.softTissueMean - kNominalSoftTissueHU, -kMaxSoftTissueShift, kMaxSoftTissueShift)));
+        params.minHU = std::max(params.minHU + shift, thresholds.fatSoft);
+        params.maxHU = std::min(params.maxHU + shift, thresholds.softBone - 1);
+    }
+    return params;
+}
+
+} // namespace Segmentation
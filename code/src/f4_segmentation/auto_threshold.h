@@ -0,0 +1,88 @@
+#ifndef AUTO_THRESHOLD_H
+#define AUTO_THRESHOLD_H
+
+#include "hu_histogram.h"
+#include "segmentation.h"
+#include <climits>
+
+namespace Segmentation {
+
+// ============================================================================
+// OTSU MULTINIVEL
+// ============================================================================
+
+/**
+ * @brief Otsu multinivel (2 a 4 clases) sobre un histograma
+ *
+ * Maximiza la varianza entre clases con programación dinámica sobre sumas
+ * prefijas: O(bins) para 2 clases y O((K-2)·bins²) para K clases.
+ *
+ * @param hist Histograma (computeHUHistogram / accumulateHUHistogram)
+ * @param classes Número de clases (2 a 4)
+ * @param minValue Valor mínimo considerado (ventana HU)
+ * @param maxValue Valor máximo considerado (ventana HU)
+ * @param binWidth Ancho de bin en unidades de intensidad (0 = automático)
+ * @return Umbrales y media de cada clase (mismo formato que kmeansHistogram)
+ */
+HistogramClusters multiOtsu(const HUHistogram& hist, int classes,
+                            int minValue = INT_MIN, int maxValue = INT_MAX,
+                            int binWidth = 0);
+
+// ============================================================================
+// UMBRALES HU AUTOMÁTICOS
+// ============================================================================
+
+/**
+ * @brief Umbrales entre tejidos estimados a partir del histograma HU
+ */
+struct AutoHUThresholds {
+    bool valid = false;
+    int airTissue = -400;           // Aire / pulmón  vs  tejido
+    int fatSoft = -30;              // Grasa  vs  tejido blando
+    int softBone = 200;             // Tejido blando  vs  hueso
+    double softTissueMean = 40.0;   // Media HU de la clase de tejido blando
+};
+
+/**
+ * @brief Estima los umbrales entre tejidos de un corte o volumen
+ *
+ * Otsu de 3 clases en la ventana [-1024, 3071] (aire / tejido / hueso) y
+ * Otsu de 2 clases dentro de la clase de tejido (grasa / tejido blando).
+ * Cada umbral se limita a un rango anatómicamente plausible.
+ *
+ * @param hist Histograma HU (CV_16S)
+ * @return Umbrales estimados (valid = false si el histograma no sirve)
+ */
+AutoHUThresholds computeAutoThresholds(const HUHistogram& hist);
+
+/**
+ * @brief Parámetros de pulmones con el límite aire/tejido adaptativo
+ * @param thresholds Umbrales estimados
+ * @return Parámetros para segmentOrgan
+ */
+SegmentationParams getAdaptiveLungParams(const AutoHUThresholds& thresholds);
+
+/**
+ * @brief Parámetros de corazón desplazados según la media del tejido blando
+ * @param thresholds Umbrales estimados
+ * @return Parámetros para segmentOrgan
+ */
+SegmentationParams getAdaptiveHeartParams(const AutoHUThresholds& thresholds);
+
+/**
+ * @brief Parámetros de huesos con el límite tejido/hueso adaptativo
+ * @param thresholds Umbrales estimados
+ * @return Parámetros para segmentOrgan
+ */
+SegmentationParams getAdaptiveBoneParams(const AutoHUThresholds& thresholds);
+
+/**
+ * @brief Parámetros de aorta desplazados según la media del tejido blando
+ * @param thresholds Umbrales estimados
+ * @return Parámetros para segmentAorta
+ */
+SegmentationParams getAdaptiveAortaParams(const AutoHUThresholds& thresholds);
+
+} // namespace Segmentation
+
+#endif // AUTO_THRESHOLD_H
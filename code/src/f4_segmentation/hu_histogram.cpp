@@ -0,0 +1,282 @@
+#include "hu_histogram.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace Segmentation {
+
+namespace {
+
+void initHistogram(HUHistogram& hist, int depth) {
+    hist.depth = depth;
+    hist.offset = (depth == CV_16S) ? -32768 : 0;
+    hist.counts.assign(depth == CV_8U ? 256 : 65536, 0.0);
+    hist.total = 0.0;
+}
+
+template <typename T>
+void accumulateTyped(HUHistogram& hist, const cv::Mat& image, const cv::Mat& mask) {
+    double* counts = hist.counts.data();
+    const int offset = hist.offset;
+    double added = 0.0;
+
+    for (int y = 0; y < image.rows; y++) {
+        const T* src = image.ptr<T>(y);
+        if (mask.empty()) {
+            for (int x = 0; x < image.cols; x++) {
+                counts[src[x] - offset] += 1.0;
+            }
+            added += image.cols;
+        } else {
+            const uchar* m = mask.ptr<uchar>(y);
+            for (int x = 0; x < image.cols; x++) {
+                if (m[x]) {
+                    counts[src[x] - offset] += 1.0;
+                    added += 1.0;
+                }
+            }
+        }
+    }
+    hist.total += added;
+}
+
+template <typename D>
+std::vector<D> buildClassLUT(int levels, int offset, const std::vector<int>& thresholds,
+                             const std::vector<double>& values) {
+    std::vector<D> lut(levels);
+    size_t cls = 0;
+    for (int i = 0; i < levels; i++) {
+        const int v = i + offset;
+        while (cls < thresholds.size() && v > thresholds[cls]) cls++;
+        lut[i] = cv::saturate_cast<D>(values[cls]);
+    }
+    return lut;
+}
+
+template <typename S, typename D>
+void applyLUTTyped(const cv::Mat& src, cv::Mat& dst, const std::vector<D>& lut, int offset) {
+    const D* table = lut.data();
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const S* s = src.ptr<S>(y);
+            D* d = dst.ptr<D>(y);
+            for (int x = 0; x < src.cols; x++) {
+                d[x] = table[s[x] - offset];
+            }
+        }
+    });
+}
+
+template <typename D>
+void dispatchLUT(const cv::Mat& src, cv::Mat& dst, const std::vector<int>& thresholds,
+                 const std::vector<double>& values) {
+    switch (src.depth()) {
+        case CV_8U:
+            applyLUTTyped<uchar, D>(src, dst, buildClassLUT<D>(256, 0, thresholds, values), 0);
+            break;
+        case CV_16S:
+            applyLUTTyped<short, D>(src, dst, buildClassLUT<D>(65536, -32768, thresholds, values), -32768);
+            break;
+        case CV_16U:
+            applyLUTTyped<ushort, D>(src, dst, buildClassLUT<D>(65536, 0, thresholds, values), 0);
+            break;
+    }
+}
+
+bool isSupportedDepth(int depth) {
+    return depth == CV_8U || depth == CV_16S || depth == CV_16U;
+}
+
+} // namespace
+
+// HISTOGRAMA
+
+HUHistogram computeHUHistogram(const cv::Mat& image, const cv::Mat& mask) {
+    HUHistogram hist;
+    accumulateHUHistogram(hist, image, mask);
+    return hist;
+}
+
+void accumulateHUHistogram(HUHistogram& hist, const cv::Mat& image, const cv::Mat& mask) {
+    if (image.empty() || image.channels() != 1 || !isSupportedDepth(image.depth())) {
+        std::cerr << "Error: El histograma HU requiere una imagen monocanal de 8 o 16 bits" << std::endl;
+        return;
+    }
+    if (!mask.empty() && (mask.size() != image.size() || mask.type() != CV_8UC1)) {
+        std::cerr << "Error: La máscara del histograma debe ser CV_8U del mismo tamaño" << std::endl;
+        return;
+    }
+
+    if (hist.counts.empty()) {
+        initHistogram(hist, image.depth());
+    } else if (hist.depth != image.depth()) {
+        std::cerr << "Error: No se pueden acumular imágenes de distinta profundidad" << std::endl;
+        return;
+    }
+
+    switch (image.depth()) {
+        case CV_8U:  accumulateTyped<uchar>(hist, image, mask);  break;
+        case CV_16S: accumulateTyped<short>(hist, image, mask);  break;
+        case CV_16U: accumulateTyped<ushort>(hist, image, mask); break;
+    }
+}
+
+// K-MEANS 1D SOBRE EL HISTOGRAMA
+
+HistogramClusters kmeansHistogram(const HUHistogram& hist, int K, int attempts, int maxIterations) {
+    HistogramClusters result;
+    if (hist.empty() || K < 1) {
+        std::cerr << "Error: Histograma vacío o K inválido en kmeansHistogram" << std::endl;
+        return result;
+    }
+    attempts = std::max(1, attempts);
+
+    // Recortar al rango de bins ocupados
+    int first = 0;
+    int last = static_cast<int>(hist.counts.size()) - 1;
+    while (hist.counts[first] == 0.0) first++;
+    while (hist.counts[last] == 0.0) last--;
+    const int n = last - first + 1;
+
+    // Sumas prefijas (en unidades de bin relativas a 'first')
+    std::vector<double> P0(n + 1, 0.0), P1(n + 1, 0.0), P2(n + 1, 0.0);
+    for (int i = 0; i < n; i++) {
+        const double c = hist.counts[first + i];
+        P0[i + 1] = P0[i] + c;
+        P1[i + 1] = P1[i] + c * i;
+        P2[i + 1] = P2[i] + c * i * static_cast<double>(i);
+    }
+    const double totalWeight = P0[n];
+
+    auto binAtWeight = [&](double target) {
+        int idx = static_cast<int>(std::lower_bound(P0.begin() + 1, P0.end(), target) - (P0.begin() + 1));
+        return std::min(idx, n - 1);
+    };
+
+    std::vector<double> bestCenters;
+    std::vector<int> bestBounds;
+    double bestCompactness = -1.0;
+
+    std::vector<double> c(K);
+    std::vector<int> bounds(K + 1), prevBounds(K + 1);
+    std::vector<double> dist2(n);
+
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        if (attempt == 0) {
+            // Inicialización determinista por cuantiles
+            for (int j = 0; j < K; j++) {
+                c[j] = binAtWeight(totalWeight * (j + 0.5) / K);
+            }
+        } else {
+            // Inicialización tipo k-means++ ponderada por el histograma
+            cv::RNG rng(0x9E3779B9u + attempt);
+            c[0] = binAtWeight(rng.uniform(0.0, totalWeight));
+            for (int j = 1; j < K; j++) {
+                double acc = 0.0;
+                for (int i = 0; i < n; i++) {
+                    double d = std::abs(i - c[0]);
+                    for (int m = 1; m < j; m++) d = std::min(d, std::abs(i - c[m]));
+                    acc += hist.counts[first + i] * d * d;
+                    dist2[i] = acc;
+                }
+                if (acc <= 0.0) {
+                    c[j] = c[j - 1];
+                    continue;
+                }
+                const double r = rng.uniform(0.0, acc);
+                c[j] = std::min<int>(static_cast<int>(std::lower_bound(dist2.begin(), dist2.end(), r) - dist2.begin()), n - 1);
+            }
+        }
+        std::sort(c.begin(), c.end());
+
+        std::fill(prevBounds.begin(), prevBounds.end(), -1);
+        for (int iter = 0; iter < maxIterations; iter++) {
+            // Asignación: en 1D las clases son intervalos separados por los puntos medios
+            bounds[0] = 0;
+            bounds[K] = n;
+            for (int j = 1; j < K; j++) {
+                const int b = static_cast<int>(std::floor((c[j - 1] + c[j]) * 0.5)) + 1;
+                bounds[j] = std::min(std::max(b, bounds[j - 1]), n);
+            }
+            if (bounds == prevBounds) break;
+            prevBounds = bounds;
+
+            // Actualización: media ponderada de cada intervalo en O(1)
+            for (int j = 0; j < K; j++) {
+                const double w = P0[bounds[j + 1]] - P0[bounds[j]];
+                if (w > 0.0) {
+                    c[j] = (P1[bounds[j + 1]] - P1[bounds[j]]) / w;
+                }
+            }
+            std::sort(c.begin(), c.end());
+        }
+
+        double compactness = 0.0;
+        for (int j = 0; j < K; j++) {
+            const int b0 = bounds[j], b1 = bounds[j + 1];
+            const double w = P0[b1] - P0[b0];
+            const double s1 = P1[b1] - P1[b0];
+            const double s2 = P2[b1] - P2[b0];
+            compactness += s2 - 2.0 * c[j] * s1 + c[j] * c[j] * w;
+        }
+
+        if (bestCompactness < 0.0 || compactness < bestCompactness) {
+            bestCompactness = compactness;
+            bestCenters = c;
+            bestBounds = bounds;
+        }
+    }
+
+    const double base = hist.valueOf(first);
+    result.centers.resize(K);
+    for (int j = 0; j < K; j++) {
+        result.centers[j] = base + bestCenters[j];
+    }
+    result.thresholds.resize(K - 1);
+    for (int j = 0; j < K - 1; j++) {
+        result.thresholds[j] = hist.valueOf(first + bestBounds[j + 1] - 1);
+    }
+    result.compactness = bestCompactness;
+    return result;
+}
+
+// ESCRITURA DE ETIQUETAS (LUT)
+
+cv::Mat applyHistogramLUT(const cv::Mat& image, const std::vector<int>& thresholds,
+                          const std::vector<double>& values, int dtype) {
+    if (image.empty() || image.channels() != 1 || !isSupportedDepth(image.depth())) {
+        std::cerr << "Error: applyHistogramLUT requiere una imagen monocanal de 8 o 16 bits" << std::endl;
+        return cv::Mat();
+    }
+    if (values.size() != thresholds.size() + 1) {
+        std::cerr << "Error: Se esperaban " << thresholds.size() + 1
+                  << " valores de clase y se recibieron " << values.size() << std::endl;
+        return cv::Mat();
+    }
+
+    const int outDepth = (dtype < 0) ? image.depth() : CV_MAT_DEPTH(dtype);
+    cv::Mat result(image.size(), CV_MAKETYPE(outDepth, 1));
+
+    switch (outDepth) {
+        case CV_8U:  dispatchLUT<uchar>(image, result, thresholds, values);  break;
+        case CV_16S: dispatchLUT<short>(image, result, thresholds, values);  break;
+        case CV_16U: dispatchLUT<ushort>(image, result, thresholds, values); break;
+        case CV_32F: dispatchLUT<float>(image, result, thresholds, values);  break;
+        default:
+            std::cerr << "Error: Tipo de salida no soportado en applyHistogramLUT" << std::endl;
+            return cv::Mat();
+    }
+    return result;
+}
+
+cv::Mat labelsFromThresholds(const cv::Mat& image, const std::vector<int>& thresholds) {
+    if (thresholds.size() > 255) {
+        std::cerr << "Error: Demasiadas clases para una imagen de etiquetas de 8 bits" << std::endl;
+        return cv::Mat();
+    }
+    std::vector<double> labels(thresholds.size() + 1);
+    for (size_t i = 0; i < labels.size(); i++) labels[i] = static_cast<double>(i);
+    return applyHistogramLUT(image, thresholds, labels, CV_8U);
+}
+
+} // namespace Segmentation
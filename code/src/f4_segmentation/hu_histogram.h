@@ -0,0 +1,99 @@
+#ifndef HU_HISTOGRAM_H
+#define HU_HISTOGRAM_H
+
+#include "opencv2/core.hpp"
+#include <vector>
+
+namespace Segmentation {
+
+// ============================================================================
+// HISTOGRAMA DE INTENSIDADES (HU)
+// ============================================================================
+
+/**
+ * @brief Histograma de intensidades con un bin por nivel de gris
+ *
+ * Para imágenes de 8 bits usa 256 bins; para 16 bits (CV_16S / CV_16U)
+ * usa 65536 bins, de modo que cada valor HU tiene su propio bin y no se
+ * pierde resolución. El valor representado por el bin i es (i + offset).
+ */
+struct HUHistogram {
+    int depth = -1;                 // Profundidad de las imágenes acumuladas
+    int offset = 0;                 // Valor del bin 0 (-32768 para CV_16S)
+    std::vector<double> counts;     // Conteo por bin
+    double total = 0.0;             // Número total de píxeles acumulados
+
+    bool empty() const { return total <= 0.0; }
+    int valueOf(int bin) const { return bin + offset; }
+};
+
+/**
+ * @brief Resultado de agrupar un histograma en K clases
+ *
+ * Las clases están ordenadas por intensidad. La clase i contiene los
+ * valores v tales que thresholds[i-1] < v <= thresholds[i].
+ */
+struct HistogramClusters {
+    std::vector<double> centers;    // Media de cada clase (K valores)
+    std::vector<int> thresholds;    // Límite superior (inclusive) de las K-1 primeras clases
+    double compactness = 0.0;       // Suma ponderada de distancias al cuadrado
+};
+
+/**
+ * @brief Calcula el histograma de una imagen monocanal (8U, 16S o 16U)
+ * @param image Imagen de entrada
+ * @param mask Máscara opcional (CV_8U); solo cuentan los píxeles != 0
+ * @return Histograma de intensidades
+ */
+HUHistogram computeHUHistogram(const cv::Mat& image, const cv::Mat& mask = cv::Mat());
+
+/**
+ * @brief Acumula una imagen más en un histograma existente (uso por volumen)
+ * @param hist Histograma acumulado (se inicializa en la primera llamada)
+ * @param image Imagen monocanal con la misma profundidad que las anteriores
+ * @param mask Máscara opcional (CV_8U)
+ */
+void accumulateHUHistogram(HUHistogram& hist, const cv::Mat& image,
+                           const cv::Mat& mask = cv::Mat());
+
+// ============================================================================
+// AGRUPAMIENTO EN EL DOMINIO DEL HISTOGRAMA
+// ============================================================================
+
+/**
+ * @brief K-means 1D ponderado sobre el histograma
+ *
+ * Cada iteración cuesta O(K) gracias a sumas prefijas sobre los bins, en
+ * lugar de O(píxeles) como cv::kmeans sobre las muestras.
+ *
+ * @param hist Histograma de entrada
+ * @param K Número de clases
+ * @param attempts Número de inicializaciones (se conserva la más compacta)
+ * @param maxIterations Máximo de iteraciones por intento
+ * @return Centros ordenados y umbrales entre clases
+ */
+HistogramClusters kmeansHistogram(const HUHistogram& hist, int K,
+                                  int attempts = 3, int maxIterations = 100);
+
+/**
+ * @brief Reemplaza cada píxel por el valor de su clase en una sola pasada (LUT)
+ * @param image Imagen monocanal (8U, 16S o 16U)
+ * @param thresholds Umbrales entre clases (ver HistogramClusters)
+ * @param values Valor de salida de cada clase (thresholds.size() + 1 valores)
+ * @param dtype Tipo de salida (-1 = mismo tipo que la entrada)
+ * @return Imagen con los valores de clase
+ */
+cv::Mat applyHistogramLUT(const cv::Mat& image, const std::vector<int>& thresholds,
+                          const std::vector<double>& values, int dtype = -1);
+
+/**
+ * @brief Obtiene la imagen de etiquetas (0..K-1, CV_8U) a partir de los umbrales
+ * @param image Imagen monocanal (8U, 16S o 16U)
+ * @param thresholds Umbrales entre clases
+ * @return Imagen de etiquetas
+ */
+cv::Mat labelsFromThresholds(const cv::Mat& image, const std::vector<int>& thresholds);
+
+} // namespace Segmentation
+
+#endif // HU_HISTOGRAM_H
@@ -0,0 +1,239 @@
+#include "labeling3d.h"
+#include "opencv2/imgproc.hpp"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+
+namespace Segmentation {
+
+namespace {
+
+// Union-find sobre etiquetas globales (0 = fondo)
+inline int findRoot(std::vector<int>& parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];  // Compresión por división a la mitad
+        x = parent[x];
+    }
+    return x;
+}
+
+inline void unite(std::vector<int>& parent, int a, int b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) return;
+    // La raíz es siempre la etiqueta menor: resultado determinista
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+/**
+ * @brief Une las etiquetas del corte z con las del corte z-1
+ */
+void mergeSlicePair(const cv::Mat& prev, const cv::Mat& cur, int prevOffset, int curOffset,
+                    const std::vector<cv::Point>& offsets, std::vector<int>& parent) {
+    const int rows = cur.rows, cols = cur.cols;
+    for (int y = 0; y < rows; y++) {
+        const int* c = cur.ptr<int>(y);
+        for (int x = 0; x < cols; x++) {
+            const int a = c[x];
+            if (a == 0) continue;
+            int lastB = 0;
+            for (const auto& d : offsets) {
+                const int ny = y + d.y, nx = x + d.x;
+                if (ny < 0 || ny >= rows || nx < 0 || nx >= cols) continue;
+                const int b = prev.ptr<int>(ny)[nx];
+                if (b == 0 || b == lastB) continue;
+                lastB = b;
+                unite(parent, curOffset + a, prevOffset + b);
+            }
+        }
+    }
+}
+
+} // namespace
+
+Labeling3DResult labelComponents3D(const std::vector<cv::Mat>& masks,
+                                   Connectivity3D connectivity,
+                                   const cv::Vec3d& spacing) {
+    Labeling3DResult result;
+    const int depth = static_cast<int>(masks.size());
+    if (depth == 0) return result;
+
+    const cv::Size size = masks[0].size();
+    for (const auto& m : masks) {
+        if (m.size() != size || m.type() != CV_8UC1) {
+            std::cerr << "Error: Todos los cortes deben ser CV_8U del mismo tamaño" << std::endl;
+            return result;
+        }
+    }
+
+    // 1. Etiquetado 2D de cada corte en paralelo (estadísticas incluidas)
+    const int connectivity2D = (connectivity == Connectivity3D::C6) ? 4 : 8;
+    result.labels.resize(depth);
+    std::vector<cv::Mat> stats(depth), centroids(depth);
+    std::vector<int> counts(depth, 0);
+
+    cv::parallel_for_(cv::Range(0, depth), [&](const cv::Range& range) {
+        for (int z = range.start; z < range.end; z++) {
+            counts[z] = cv::connectedComponentsWithStats(masks[z], result.labels[z], stats[z],
+                                                         centroids[z], connectivity2D, CV_32S) - 1;
+        }
+    });
+
+    // Desplazamiento global de las etiquetas de cada corte
+    std::vector<int> offsets(depth + 1, 0);
+    for (int z = 0; z < depth; z++) {
+        offsets[z + 1] = offsets[z] + counts[z];
+    }
+    const int totalLabels = offsets[depth];
+
+    std::vector<int> parent(totalLabels + 1);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    // Vecinos en el corte anterior según la conectividad
+    std::vector<cv::Point> neighbors;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const int manhattan = std::abs(dx) + std::abs(dy);
+            if (connectivity == Connectivity3D::C6 && manhattan > 0) continue;
+            if (connectivity == Connectivity3D::C18 && manhattan > 1) continue;
+            neighbors.emplace_back(dx, dy);
+        }
+    }
+
+    // 2. Union-find por losas en Z: cada losa solo toca sus propias etiquetas
+    const int numSlabs = std::max(1, std::min(depth, cv::getNumThreads()));
+    const int slabSize = (depth + numSlabs - 1) / numSlabs;
+
+    cv::parallel_for_(cv::Range(0, numSlabs), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; s++) {
+            const int zStart = s * slabSize;
+            const int zEnd = std::min(depth, zStart + slabSize);
+            for (int z = zStart + 1; z < zEnd; z++) {
+                mergeSlicePair(result.labels[z - 1], result.labels[z], offsets[z - 1], offsets[z],
+                               neighbors, parent);
+            }
+        }
+    });
+
+    // 3. Fusión de las fronteras entre losas
+    for (int s = 1; s < numSlabs; s++) {
+        const int z = s * slabSize;
+        if (z >= depth) break;
+        mergeSlicePair(result.labels[z - 1], result.labels[z], offsets[z - 1], offsets[z],
+                       neighbors, parent);
+    }
+
+    // 4. Etiquetas finales consecutivas
+    std::vector<int> finalLabel(totalLabels + 1, 0);
+    int numComponents = 0;
+    for (int g = 1; g <= totalLabels; g++) {
+        const int root = findRoot(parent, g);
+        if (root == g) {
+            finalLabel[g] = ++numComponents;
+        } else {
+            finalLabel[g] = finalLabel[root];
+        }
+    }
+
+    // 5. Estadísticas agregadas a partir de los componentes 2D
+    result.components.resize(numComponents);
+    std::vector<cv::Point3d> weightedSum(numComponents, cv::Point3d(0, 0, 0));
+    for (int i = 0; i < numComponents; i++) {
+        Component3D& comp = result.components[i];
+        comp.label = i + 1;
+        comp.voxelCount = 0;
+        comp.zMin = depth;
+        comp.zMax = -1;
+        comp.boundingBox = cv::Rect();
+        comp.volumeML = 0.0;
+    }
+
+    for (int z = 0; z < depth; z++) {
+        for (int l = 1; l <= counts[z]; l++) {
+            const int id = finalLabel[offsets[z] + l] - 1;
+            Component3D& comp = result.components[id];
+            const int* st = stats[z].ptr<int>(l);
+            const double* c = centroids[z].ptr<double>(l);
+            const int area = st[cv::CC_STAT_AREA];
+            const cv::Rect box(st[cv::CC_STAT_LEFT], st[cv::CC_STAT_TOP],
+                               st[cv::CC_STAT_WIDTH], st[cv::CC_STAT_HEIGHT]);
+
+            comp.boundingBox = (comp.voxelCount == 0) ? box : (comp.boundingBox | box);
+            comp.voxelCount += area;
+            comp.zMin = std::min(comp.zMin, z);
+            comp.zMax = std::max(comp.zMax, z);
+            weightedSum[id].x += c[0] * area;
+            weightedSum[id].y += c[1] * area;
+            weightedSum[id].z += static_cast<double>(z) * area;
+        }
+    }
+
+    const double voxelML = spacing[0] * spacing[1] * spacing[2] / 1000.0;
+    for (int i = 0; i < numComponents; i++) {
+        Component3D& comp = result.components[i];
+        const double n = static_cast<double>(comp.voxelCount);
+        comp.centroid = cv::Point3d(weightedSum[i].x / n, weightedSum[i].y / n, weightedSum[i].z / n);
+        comp.volumeML = n * voxelML;
+    }
+
+    // 6. Reetiquetado de los vóxeles (LUT por corte, en paralelo)
+    cv::parallel_for_(cv::Range(0, depth), [&](const cv::Range& range) {
+        for (int z = range.start; z < range.end; z++) {
+            const int* lut = finalLabel.data() + offsets[z];
+            cv::Mat& lab = result.labels[z];
+            for (int y = 0; y < lab.rows; y++) {
+                int* row = lab.ptr<int>(y);
+                for (int x = 0; x < lab.cols; x++) {
+                    if (row[x] != 0) row[x] = lut[row[x]];
+                }
+            }
+        }
+    });
+
+    return result;
+}
+
+std::vector<cv::Mat> extractComponent3D(const std::vector<cv::Mat>& labels, int label) {
+    std::vector<cv::Mat> masks(labels.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(labels.size())), [&](const cv::Range& range) {
+        for (int z = range.start; z < range.end; z++) {
+            masks[z] = (labels[z] == label);
+        }
+    });
+    return masks;
+}
+
+std::vector<cv::Mat> keepLargestComponents3D(const std::vector<cv::Mat>& masks, int count,
+                                             Connectivity3D connectivity) {
+    Labeling3DResult labeling = labelComponents3D(masks, connectivity);
+    if (labeling.labels.empty()) return std::vector<cv::Mat>();
+
+    // Ordenar componentes por número de vóxeles (mayor a menor)
+    std::vector<Component3D> sorted = labeling.components;
+    std::sort(sorted.begin(), sorted.end(),
+        [](const Component3D& a, const Component3D& b) { return a.voxelCount > b.voxelCount; });
+
+    std::vector<uchar> keep(labeling.components.size() + 1, 0);
+    for (int i = 0; i < std::min<int>(count, static_cast<int>(sorted.size())); i++) {
+        keep[sorted[i].label] = 255;
+    }
+
+    std::vector<cv::Mat> result(labeling.labels.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(labeling.labels.size())), [&](const cv::Range& range) {
+        for (int z = range.start; z < range.end; z++) {
+            const cv::Mat& lab = labeling.labels[z];
+            result[z].create(lab.size(), CV_8U);
+            for (int y = 0; y < lab.rows; y++) {
+                const int* src = lab.ptr<int>(y);
+                uchar* dst = result[z].ptr<uchar>(y);
+                for (int x = 0; x < lab.cols; x++) {
+                    dst[x] = keep[src[x]];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace Segmentation
@@ -0,0 +1,81 @@
+#ifndef LABELING3D_H
+#define LABELING3D_H
+
+#include "opencv2/core.hpp"
+#include <vector>
+
+namespace Segmentation {
+
+// ============================================================================
+// ETIQUETADO 3D DE COMPONENTES CONECTADOS
+// ============================================================================
+
+/**
+ * @brief Conectividad 3D: caras (6), caras+aristas (18) o completa (26)
+ */
+enum class Connectivity3D {
+    C6 = 6,
+    C18 = 18,
+    C26 = 26
+};
+
+/**
+ * @brief Información de un componente conectado 3D
+ */
+struct Component3D {
+    int label;                      // Etiqueta final (1..N)
+    long long voxelCount;           // Número de vóxeles
+    cv::Rect boundingBox;           // Caja delimitadora en el plano XY
+    int zMin;                       // Primer corte que contiene el componente
+    int zMax;                       // Último corte que contiene el componente
+    cv::Point3d centroid;           // Centro de masa (x, y en píxeles; z en índice de corte)
+    double volumeML;                // Volumen físico en mL
+};
+
+/**
+ * @brief Resultado del etiquetado 3D
+ */
+struct Labeling3DResult {
+    std::vector<cv::Mat> labels;            // Un CV_32S por corte (0 = fondo)
+    std::vector<Component3D> components;    // components[i].label == i + 1
+};
+
+/**
+ * @brief Etiqueta componentes conectados en un volumen de máscaras
+ *
+ * Cada corte se etiqueta en 2D en paralelo; después se unen las etiquetas
+ * entre cortes con union-find por bloques (losas en Z procesadas en
+ * paralelo) y un paso final de fusión en las fronteras entre losas. Las
+ * estadísticas se obtienen agregando las de los componentes 2D, sin otra
+ * pasada sobre los vóxeles.
+ *
+ * @param masks Cortes binarios CV_8U del mismo tamaño (!= 0 es primer plano)
+ * @param connectivity Conectividad 3D
+ * @param spacing Espaciado de vóxel en mm (x, y, z) para el volumen en mL
+ * @return Etiquetas por corte y estadísticas por componente
+ */
+Labeling3DResult labelComponents3D(const std::vector<cv::Mat>& masks,
+                                   Connectivity3D connectivity = Connectivity3D::C26,
+                                   const cv::Vec3d& spacing = cv::Vec3d(1.0, 1.0, 1.0));
+
+/**
+ * @brief Extrae la máscara de un componente a partir de las etiquetas
+ * @param labels Etiquetas por corte (CV_32S)
+ * @param label Etiqueta del componente
+ * @return Cortes CV_8U (0/255)
+ */
+std::vector<cv::Mat> extractComponent3D(const std::vector<cv::Mat>& labels, int label);
+
+/**
+ * @brief Conserva solo los N componentes 3D más grandes de un volumen
+ * @param masks Cortes binarios CV_8U
+ * @param count Número de componentes a conservar
+ * @param connectivity Conectividad 3D
+ * @return Cortes CV_8U (0/255) con los componentes conservados
+ */
+std::vector<cv::Mat> keepLargestComponents3D(const std::vector<cv::Mat>& masks, int count,
+                                             Connectivity3D connectivity = Connectivity3D::C26);
+
+} // namespace Segmentation
+
+#endif // LABELING3D_H
@@ -0,0 +1,148 @@
+#include "local_threshold.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace Segmentation {
+
+namespace {
+
+/**
+ * @brief Imágenes integrales de suma y suma de cuadrados ((rows+1) x (cols+1))
+ */
+struct IntegralImages {
+    int stride = 0;
+    std::vector<int64_t> sum;
+    std::vector<int64_t> sqsum;
+};
+
+template <typename T>
+void computeIntegrals(const cv::Mat& image, IntegralImages& ii) {
+    const int rows = image.rows, cols = image.cols;
+    const int stride = cols + 1;
+    ii.stride = stride;
+    ii.sum.assign(static_cast<size_t>(rows + 1) * stride, 0);
+    ii.sqsum.assign(static_cast<size_t>(rows + 1) * stride, 0);
+    int64_t* S = ii.sum.data();
+    int64_t* Q = ii.sqsum.data();
+
+    // Paso 1: sumas prefijas por fila (filas independientes)
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const T* src = image.ptr<T>(y);
+            int64_t* s = S + static_cast<size_t>(y + 1) * stride;
+            int64_t* q = Q + static_cast<size_t>(y + 1) * stride;
+            int64_t accS = 0, accQ = 0;
+            for (int x = 0; x < cols; x++) {
+                const int64_t v = src[x];
+                accS += v;
+                accQ += v * v;
+                s[x + 1] = accS;
+                q[x + 1] = accQ;
+            }
+        }
+    });
+
+    // Paso 2: acumulación vertical por bandas de columnas
+    cv::parallel_for_(cv::Range(1, stride), [&](const cv::Range& range) {
+        for (int y = 1; y <= rows; y++) {
+            const int64_t* sPrev = S + static_cast<size_t>(y - 1) * stride;
+            const int64_t* qPrev = Q + static_cast<size_t>(y - 1) * stride;
+            int64_t* s = S + static_cast<size_t>(y) * stride;
+            int64_t* q = Q + static_cast<size_t>(y) * stride;
+            for (int x = range.start; x < range.end; x++) {
+                s[x] += sPrev[x];
+                q[x] += qPrev[x];
+            }
+        }
+    });
+}
+
+template <typename T>
+void thresholdTyped(const cv::Mat& image, cv::Mat& binary, const LocalThresholdParams& params,
+                    int blockSize, double R) {
+    IntegralImages ii;
+    computeIntegrals<T>(image, ii);
+
+    const int rows = image.rows, cols = image.cols;
+    const int radius = blockSize / 2;
+    const int stride = ii.stride;
+    const int64_t* S = ii.sum.data();
+    const int64_t* Q = ii.sqsum.data();
+    const uchar hi = params.invert ? 0 : 255;
+    const uchar lo = params.invert ? 255 : 0;
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const int y0 = std::max(0, y - radius);
+            const int y1 = std::min(rows, y + radius + 1);
+            const int64_t* sTop = S + static_cast<size_t>(y0) * stride;
+            const int64_t* sBot = S + static_cast<size_t>(y1) * stride;
+            const int64_t* qTop = Q + static_cast<size_t>(y0) * stride;
+            const int64_t* qBot = Q + static_cast<size_t>(y1) * stride;
+            const T* src = image.ptr<T>(y);
+            uchar* dst = binary.ptr<uchar>(y);
+
+            for (int x = 0; x < cols; x++) {
+                const int x0 = std::max(0, x - radius);
+                const int x1 = std::min(cols, x + radius + 1);
+                const double n = static_cast<double>((y1 - y0) * (x1 - x0));
+                const double sum = static_cast<double>(sBot[x1] - sBot[x0] - sTop[x1] + sTop[x0]);
+                const double sq = static_cast<double>(qBot[x1] - qBot[x0] - qTop[x1] + qTop[x0]);
+                const double mean = sum / n;
+
+                double thr;
+                if (params.method == LocalThresholdMethod::MEAN) {
+                    thr = mean - params.C;
+                } else {
+                    const double stdDev = std::sqrt(std::max(0.0, sq / n - mean * mean));
+                    if (params.method == LocalThresholdMethod::NIBLACK) {
+                        thr = mean + params.k * stdDev - params.C;
+                    } else {
+                        const double shifted = mean + params.offset;
+                        thr = shifted * (1.0 + params.k * (stdDev / R - 1.0)) - params.offset - params.C;
+                    }
+                }
+                dst[x] = (src[x] > thr) ? hi : lo;
+            }
+        }
+    });
+}
+
+} // namespace
+
+cv::Mat thresholdLocal(const cv::Mat& image, const LocalThresholdParams& params) {
+    if (image.empty() || image.channels() != 1) {
+        std::cerr << "Error: thresholdLocal requiere una imagen monocanal" << std::endl;
+        return cv::Mat();
+    }
+
+    // Asegurar que blockSize sea impar y al menos 3
+    int blockSize = std::max(3, params.blockSize);
+    if (blockSize % 2 == 0) {
+        blockSize++;
+    }
+
+    // Rango dinámico de la desviación para Sauvola: la mitad del rango de la imagen
+    double R = params.R;
+    if (params.method == LocalThresholdMethod::SAUVOLA && R <= 0.0) {
+        double minVal, maxVal;
+        cv::minMaxLoc(image, &minVal, &maxVal);
+        R = std::max(1.0, (maxVal - minVal) / 2.0);
+    }
+
+    cv::Mat binary(image.size(), CV_8U);
+    switch (image.depth()) {
+        case CV_8U:  thresholdTyped<uchar>(image, binary, params, blockSize, R);  break;
+        case CV_16S: thresholdTyped<short>(image, binary, params, blockSize, R);  break;
+        case CV_16U: thresholdTyped<ushort>(image, binary, params, blockSize, R); break;
+        default:
+            std::cerr << "Error: thresholdLocal solo soporta imágenes de 8 o 16 bits" << std::endl;
+            return cv::Mat();
+    }
+    return binary;
+}
+
+} // namespace Segmentation
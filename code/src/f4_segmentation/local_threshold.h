@@ -0,0 +1,50 @@
+#ifndef LOCAL_THRESHOLD_H
+#define LOCAL_THRESHOLD_H
+
+#include "opencv2/core.hpp"
+
+namespace Segmentation {
+
+// ============================================================================
+// UMBRALIZACIÓN LOCAL (IMÁGENES INTEGRALES DE 64 BITS)
+// ============================================================================
+
+/**
+ * @brief Método de cálculo del umbral local
+ */
+enum class LocalThresholdMethod {
+    MEAN,       // T = m - C
+    NIBLACK,    // T = m + k·s - C
+    SAUVOLA     // T = m·(1 + k·(s/R - 1)) - C   (sobre valores desplazados)
+};
+
+/**
+ * @brief Parámetros de la umbralización local
+ */
+struct LocalThresholdParams {
+    LocalThresholdMethod method = LocalThresholdMethod::MEAN;
+    int blockSize = 31;             // Tamaño de la ventana (impar)
+    double k = 0.2;                 // Peso de la desviación (Niblack suele usar k < 0)
+    double C = 0.0;                 // Constante restada al umbral
+    double R = 0.0;                 // Rango dinámico de s para Sauvola (0 = automático)
+    double offset = 1024.0;         // Desplazamiento para Sauvola (aire = -1024 HU -> 0)
+    bool invert = false;            // true: píxeles <= T a 255 (THRESH_BINARY_INV)
+};
+
+/**
+ * @brief Umbralización local por media, Niblack o Sauvola
+ *
+ * Usa imágenes integrales de 64 bits del valor y del valor², por lo que el
+ * coste por píxel es constante para cualquier tamaño de ventana. Trabaja
+ * directamente sobre HU (CV_16S) sin normalizar, y procesa por bandas de
+ * filas en paralelo.
+ *
+ * @param image Imagen monocanal (8U, 16S o 16U)
+ * @param params Parámetros del método
+ * @return Máscara binaria (CV_8U, 0/255)
+ */
+cv::Mat thresholdLocal(const cv::Mat& image, const LocalThresholdParams& params = LocalThresholdParams());
+
+} // namespace Segmentation
+
+#endif // LOCAL_THRESHOLD_H
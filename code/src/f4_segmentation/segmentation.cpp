@@ -1,4 +1,8 @@
 #include "segmentation.h"
+#include "hu_histogram.h"
+#include "auto_threshold.h"
+#include "local_threshold.h"
+#include "vesselness.h"
 #include <opencv2/imgcodecs.hpp>
 #include <iostream>
 #include <algorithm>
@@ -8,6 +12,14 @@ namespace Segmentation {
 // UMBRALIZACIÓN (THRESHOLDING)
 
 cv::Mat thresholdOtsu(const cv::Mat& image) {
+    // 16 bits: Otsu sobre el histograma completo, sin pasar por 8 bits
+    if (image.channels() == 1 && (image.depth() == CV_16S || image.depth() == CV_16U)) {
+        HistogramClusters otsu = multiOtsu(computeHUHistogram(image), 2);
+        if (otsu.thresholds.empty()) return cv::Mat::zeros(image.size(), CV_8U);
+        cv::Mat binary = image > otsu.thresholds[0];
+        return binary;
+    }
+
     cv::Mat binary;
     cv::threshold(image, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
     return binary;
@@ -33,6 +45,15 @@ cv::Mat thresholdAdaptive(const cv::Mat& image, int blockSize, double C) {
         blockSize++;
     }
     
+    // 16 bits: umbral por media local con imágenes integrales, sin perder precisión HU
+    if (image.channels() == 1 && (image.depth() == CV_16S || image.depth() == CV_16U)) {
+        LocalThresholdParams params;
+        params.method = LocalThresholdMethod::MEAN;
+        params.blockSize = blockSize;
+        params.C = C;
+        return thresholdLocal(image, params);
+    }
+    
     cv::adaptiveThreshold(image, binary, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, 
                           cv::THRESH_BINARY, blockSize, C);
     return binary;
@@ -53,24 +74,24 @@ cv::Mat segmentWatershed(const cv::Mat& image, cv::Mat& markers) {
 }
 
 cv::Mat segmentKMeans(const cv::Mat& image, int K, int attempts) {
-    // TODO: Implementar K-means cuando se necesite
-    
-    cv::Mat samples(image.rows * image.cols, image.channels(), CV_32F);
-    
-    // Convertir imagen a vector de muestras
-    for (int y = 0; y < image.rows; y++) {
-        for (int x = 0; x < image.cols; x++) {
-            if (image.channels() == 1) {
-                samples.at<float>(y + x * image.rows, 0) = image.at<uchar>(y, x);
-            } else {
-                for (int z = 0; z < image.channels(); z++) {
-                    samples.at<float>(y + x * image.rows, z) = 
-                        image.at<cv::Vec3b>(y, x)[z];
-                }
-            }
-        }
+    if (image.empty() || K < 1) {
+        std::cerr << "Error: Imagen vacía o K inválido en segmentKMeans" << std::endl;
+        return cv::Mat();
     }
-    
+
+    // Imágenes monocanal (8 o 16 bits): agrupar sobre el histograma y
+    // reescribir los píxeles con una sola pasada de LUT
+    if (image.channels() == 1) {
+        HistogramClusters clusters = kmeansHistogram(computeHUHistogram(image), K, attempts);
+        if (clusters.centers.empty()) return cv::Mat();
+        return applyHistogramLUT(image, clusters.thresholds, clusters.centers);
+    }
+
+    // Imágenes en color: cv::kmeans sobre las muestras en orden de filas
+    cv::Mat continuous = image.isContinuous() ? image : image.clone();
+    cv::Mat samples;
+    continuous.reshape(1, image.rows * image.cols).convertTo(samples, CV_32F);
+
     cv::Mat labels;
     cv::Mat centers;
     cv::kmeans(samples, K, labels, 
@@ -78,20 +99,38 @@ cv::Mat segmentKMeans(const cv::Mat& image, int K, int attempts) {
                attempts, cv::KMEANS_PP_CENTERS, centers);
     
     // Reconstruir imagen segmentada
-    cv::Mat segmented(image.size(), image.type());
-    for (int y = 0; y < image.rows; y++) {
-        for (int x = 0; x < image.cols; x++) {
-            int cluster_idx = labels.at<int>(y + x * image.rows, 0);
-            if (image.channels() == 1) {
-                segmented.at<uchar>(y, x) = centers.at<float>(cluster_idx, 0);
-            } else {
-                for (int z = 0; z < image.channels(); z++) {
-                    segmented.at<cv::Vec3b>(y, x)[z] = centers.at<float>(cluster_idx, z);
-                }
-            }
+    cv::Mat centers8U;
+    centers.convertTo(centers8U, CV_8U);
+    const int channels = image.channels();
+    cv::Mat segmented(image.rows * image.cols, channels, CV_8U);
+    const int* labelPtr = labels.ptr<int>(0);
+    for (int i = 0; i < segmented.rows; i++) {
+        const uchar* center = centers8U.ptr<uchar>(labelPtr[i]);
+        uchar* dst = segmented.ptr<uchar>(i);
+        for (int z = 0; z < channels; z++) {
+            dst[z] = center[z];
         }
     }
     
+    return segmented.reshape(channels, image.rows);
+}
+
+std::vector<cv::Mat> segmentKMeansVolume(const std::vector<cv::Mat>& slices, int K, int attempts) {
+    std::vector<cv::Mat> segmented;
+    if (slices.empty()) return segmented;
+
+    // Un único histograma para todo el volumen: las clases son consistentes entre cortes
+    HUHistogram hist;
+    for (const auto& slice : slices) {
+        accumulateHUHistogram(hist, slice);
+    }
+    HistogramClusters clusters = kmeansHistogram(hist, K, attempts);
+    if (clusters.centers.empty()) return segmented;
+
+    segmented.reserve(slices.size());
+    for (const auto& slice : slices) {
+        segmented.push_back(applyHistogramLUT(slice, clusters.thresholds, clusters.centers));
+    }
     return segmented;
 }
 
@@ -338,28 +377,6 @@ cv::Mat applyColorMap(const cv::Mat& mask, int colormapType) {
     return colored;
 }
 
-cv::Mat overlaySegmentations(const cv::Mat& image, 
-                              const std::vector<SegmentedRegion>& regions,
-                              double alpha) {
-    cv::Mat overlay;
-    
-    // Convertir a BGR si es necesario
-    if (image.channels() == 1) {
-        cv::cvtColor(image, overlay, cv::COLOR_GRAY2BGR);
-    } else {
-        overlay = image.clone();
-    }
-    
-    // Superponer cada región
-    for (const auto& region : regions) {
-        cv::Mat colorMask = cv::Mat::zeros(overlay.size(), overlay.type());
-        colorMask.setTo(region.color, region.mask);
-        cv::addWeighted(overlay, 1.0, colorMask, alpha, 0, overlay);
-    }
-    
-    return overlay;
-}
-
 cv::Mat drawSegmentationContours(const cv::Mat& image, 
                                   const std::vector<SegmentedRegion>& regions,
                                   int thickness) {
@@ -405,6 +422,16 @@ SegmentationParams getDefaultHeartParams() {
     return params;
 }
 
+SegmentationParams getDefaultAortaParams() {
+    SegmentationParams params;
+    params.minHU = 30;              // Sangre sin contraste
+    params.maxHU = 120;             // Pared / sangre con poco contraste
+    params.minArea = 200;           // Área mínima
+    params.maxArea = 8000;          // Área máxima
+    params.visualColor = cv::Scalar(0, 255, 0);  // Verde
+    return params;
+}
+
 SegmentationParams getDefaultBoneParams() {
     SegmentationParams params;
     params.minHU = 200;             // Hueso trabecular
@@ -428,20 +455,28 @@ void saveSegmentationMasks(const std::vector<SegmentedRegion>& regions,
 // ... (includes y funciones anteriores)
 
 std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image) {
+    return segmentAorta(image, getDefaultAortaParams());
+}
+
+std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image, const SegmentationParams& params) {
+    return segmentAorta(image, params, cv::Mat(), 0.0);
+}
+
+std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image, const SegmentationParams& params,
+                                          const cv::Mat& vesselness, double minVesselness) {
     std::vector<SegmentedRegion> aortaRegions;
     cv::Point2d imgCenter(image.cols / 2.0, image.rows / 2.0);
 
-    // 1. Umbralización (Rango de contraste de vasos: 30 a 120 HU)
+    // 1. Umbralización (Rango de contraste de vasos, por defecto 30 a 120 HU)
     // Nota: Si usas la imagen preprocesada (8-bit), estos valores podrían necesitar ajuste.
     // Si usas originalRaw (16-bit), estos valores son exactos.
-    cv::Mat mask = thresholdByRange(image, 30, 120);
+    cv::Mat mask = thresholdByRange(image, params.minHU, params.maxHU);
+    if (!vesselness.empty()) {
+        // Canal de vesselness: descarta tejido con HU de vaso pero no tubular
+        mask = gateByVesselness(mask, vesselness, minVesselness);
+    }
 
     // 2. Segmentación inicial (Candidatos)
-    SegmentationParams params;
-    params.minArea = 200;
-    params.maxArea = 8000;
-    params.visualColor = cv::Scalar(0, 255, 0); // Verde
-    
     // Reutilizamos findConnectedComponents para obtener candidatos básicos
     auto candidates = findConnectedComponents(mask, params.minArea);
 
@@ -491,7 +526,7 @@ std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image) {
             
             if (dist < 120.0) {
                 largest.label = "Aorta / Arterias";
-                largest.color = cv::Scalar(0, 255, 0); // Verde
+                largest.color = params.visualColor;
                 aortaRegions.push_back(largest);
             }
         }
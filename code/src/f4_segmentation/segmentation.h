@@ -42,7 +42,7 @@ struct SegmentationParams {
 
 /**
  * @brief Aplica umbralización global usando método de Otsu
- * @param image Imagen en escala de grises
+ * @param image Imagen en escala de grises (8 bits, o 16 bits usando el histograma HU)
  * @return Máscara binaria
  */
 cv::Mat thresholdOtsu(const cv::Mat& image);
@@ -68,7 +68,11 @@ cv::Mat thresholdByRange(const cv::Mat& image, double minVal, double maxVal);
 
 /**
  * @brief Aplica umbralización adaptativa
- * @param image Imagen en escala de grises
+ *
+ * Las imágenes de 16 bits usan la media local sobre imágenes integrales
+ * (ver thresholdLocal), sin normalizar a 8 bits.
+ *
+ * @param image Imagen en escala de grises (8 o 16 bits)
  * @param blockSize Tamaño del vecindario (debe ser impar)
  * @param C Constante sustraída de la media ponderada
  * @return Máscara binaria
@@ -89,13 +93,26 @@ cv::Mat segmentWatershed(const cv::Mat& image, cv::Mat& markers);
 
 /**
  * @brief Aplica K-means clustering para segmentar
+ *
+ * Para imágenes monocanal (8U, 16S o 16U) el agrupamiento se hace sobre el
+ * histograma de intensidades (K-means 1D ponderado), sin copiar píxeles.
+ *
  * @param image Imagen de entrada
  * @param K Número de clusters
  * @param attempts Número de intentos (default: 3)
- * @return Imagen segmentada
+ * @return Imagen segmentada (cada píxel toma el valor del centro de su cluster)
  */
 cv::Mat segmentKMeans(const cv::Mat& image, int K, int attempts = 3);
 
+/**
+ * @brief K-means por volumen: un único histograma para todos los cortes
+ * @param slices Cortes monocanal con la misma profundidad
+ * @param K Número de clusters
+ * @param attempts Número de intentos (default: 3)
+ * @return Cortes segmentados con clases consistentes en todo el volumen
+ */
+std::vector<cv::Mat> segmentKMeansVolume(const std::vector<cv::Mat>& slices, int K, int attempts = 3);
+
 /**
  * @brief Segmentación por crecimiento de regiones (Region Growing)
  * @param image Imagen de entrada
@@ -137,6 +154,29 @@ std::vector<SegmentedRegion> segmentLungs(const cv::Mat& image,
  */
 std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image);                                      
 
+/**
+ * @brief Segmenta la Aorta con un rango HU y límites de área configurables
+ * @param image Imagen CT (16-bit HU)
+ * @param params Parámetros (ver getDefaultAortaParams / getAdaptiveAortaParams)
+ * @return Vector con la región de la aorta detectada
+ */
+std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image, const SegmentationParams& params);
+
+/**
+ * @brief Segmenta la Aorta usando la vesselness como canal adicional
+ *
+ * La máscara de rango HU se restringe a los píxeles con vesselness >=
+ * minVesselness antes de buscar candidatos (ver vesselness.h).
+ *
+ * @param image Imagen CT (16-bit HU)
+ * @param params Parámetros de segmentación
+ * @param vesselness Vesselness CV_32F del corte (vacía: sin restricción)
+ * @param minVesselness Vesselness mínima
+ * @return Vector con la región de la aorta detectada
+ */
+std::vector<SegmentedRegion> segmentAorta(const cv::Mat& image, const SegmentationParams& params,
+                                          const cv::Mat& vesselness, double minVesselness);
+
 /**
  * @brief Segmenta el corazón usando valores HU típicos (0 a 100)
  * @param image Imagen CT preprocesada
@@ -208,17 +248,6 @@ cv::Mat combineMasks(const std::vector<cv::Mat>& masks);
  */
 cv::Mat applyColorMap(const cv::Mat& mask, int colormapType = cv::COLORMAP_JET);
 
-/**
- * @brief Superpone máscaras de color sobre la imagen original
- * @param image Imagen original
- * @param regions Vector de regiones segmentadas
- * @param alpha Transparencia de las máscaras (0.0 a 1.0, default: 0.5)
- * @return Imagen con máscaras superpuestas
- */
-cv::Mat overlaySegmentations(const cv::Mat& image, 
-                              const std::vector<SegmentedRegion>& regions,
-                              double alpha = 0.5);
-
 /**
  * @brief Dibuja contornos de las regiones segmentadas
  * @param image Imagen de salida
@@ -252,6 +281,12 @@ SegmentationParams getDefaultHeartParams();
  */
 SegmentationParams getDefaultBoneParams();
 
+/**
+ * @brief Obtiene parámetros predeterminados para segmentación de la aorta
+ * @return Parámetros configurados para aorta (30 a 120 HU)
+ */
+SegmentationParams getDefaultAortaParams();
+
 /**
  * @brief Guarda las máscaras de segmentación en archivos
  * @param regions Vector de regiones
@@ -0,0 +1,501 @@
+#include "vesselness.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Segmentation {
+
+namespace {
+
+// Cortes de salida por bloque en el filtro 3D; la ventana de componentes en el
+// plano abarca el bloque más el halo en Z y avanza con él
+const int kChunkSlices = 32;
+
+const float kEpsilon = 1e-10f;
+
+/**
+ * @brief Kernels 1D de la gaussiana y sus derivadas, normalizadas en escala
+ *
+ * d1 y d2 ya incluyen los factores sigma y sigma², así que la Hessiana sale
+ * normalizada. Los coeficientes están dispuestos para correlación
+ * (sepFilter2D no invierte el kernel).
+ */
+struct DerivativeKernels {
+    cv::Mat g;
+    cv::Mat d1;
+    cv::Mat d2;
+    int radius;
+};
+
+DerivativeKernels derivativeKernels(double sigma) {
+    DerivativeKernels k;
+    k.radius = std::max(1, static_cast<int>(std::ceil(3.0 * sigma)));
+    const int size = 2 * k.radius + 1;
+    k.g.create(size, 1, CV_32F);
+    k.d1.create(size, 1, CV_32F);
+    k.d2.create(size, 1, CV_32F);
+
+    const double s2 = sigma * sigma;
+    double sum = 0.0;
+    for (int i = 0; i < size; i++) {
+        const double t = i - k.radius;
+        sum += std::exp(-t * t / (2.0 * s2));
+    }
+
+    double meanD2 = 0.0;
+    for (int i = 0; i < size; i++) {
+        const double t = i - k.radius;
+        const double g = std::exp(-t * t / (2.0 * s2)) / sum;
+        k.g.at<float>(i) = static_cast<float>(g);
+        k.d1.at<float>(i) = static_cast<float>(sigma * (t / s2) * g);
+        const double d2 = s2 * (t * t / (s2 * s2) - 1.0 / s2) * g;
+        k.d2.at<float>(i) = static_cast<float>(d2);
+        meanD2 += d2;
+    }
+    // Respuesta nula en zonas planas pese al truncado
+    meanD2 /= size;
+    for (int i = 0; i < size; i++) {
+        k.d2.at<float>(i) -= static_cast<float>(meanD2);
+    }
+    return k;
+}
+
+cv::Mat filterSeparable(const cv::Mat& src, const cv::Mat& kernelX, const cv::Mat& kernelY) {
+    cv::Mat dst;
+    cv::sepFilter2D(src, dst, CV_32F, kernelX, kernelY, cv::Point(-1, -1), 0, cv::BORDER_REPLICATE);
+    return dst;
+}
+
+/**
+ * @brief Buffers de fila para los exponentes (cv::exp trabaja sobre ellos)
+ */
+struct RowBuffers {
+    cv::Mat e0, e1, e2, valid;
+
+    explicit RowBuffers(int cols)
+        : e0(1, cols, CV_32F), e1(1, cols, CV_32F), e2(1, cols, CV_32F), valid(1, cols, CV_32F) {
+    }
+};
+
+/**
+ * @brief Frangi 2D de una fila con acumulación del máximo en out
+ */
+void frangiRow2D(const float* hxx, const float* hxy, const float* hyy, int cols,
+                 float betaTerm, float cTerm, bool bright, RowBuffers& buf, float* out) {
+    float* rb = buf.e0.ptr<float>();
+    float* s = buf.e1.ptr<float>();
+    float* valid = buf.valid.ptr<float>();
+
+    // Autovalores en forma cerrada, ordenados por |lambda| (bucle sin ramas)
+    for (int x = 0; x < cols; x++) {
+        const float a = hxx[x], b = hxy[x], d = hyy[x];
+        const float tmp = std::sqrt((a - d) * (a - d) + 4.0f * b * b);
+        const float mu1 = 0.5f * (a + d + tmp);
+        const float mu2 = 0.5f * (a + d - tmp);
+        const bool swap = std::fabs(mu1) > std::fabs(mu2);
+        const float l1 = swap ? mu2 : mu1;
+        const float l2 = swap ? mu1 : mu2;
+        rb[x] = betaTerm * (l1 * l1) / (l2 * l2 + kEpsilon);
+        s[x] = cTerm * (l1 * l1 + l2 * l2);
+        valid[x] = (bright ? l2 < 0.0f : l2 > 0.0f) ? 1.0f : 0.0f;
+    }
+
+    cv::exp(buf.e0, buf.e0);
+    cv::exp(buf.e1, buf.e1);
+
+    for (int x = 0; x < cols; x++) {
+        const float v = valid[x] * rb[x] * (1.0f - s[x]);
+        out[x] = std::max(out[x], v);
+    }
+}
+
+#if CV_SIMD
+/**
+ * @brief Intercambio condicional para que |lo| <= |hi| en cada carril
+ */
+inline void sortByMagnitude(cv::v_float32& lo, cv::v_float32& hi) {
+    const cv::v_float32 swap = cv::v_abs(lo) > cv::v_abs(hi);
+    const cv::v_float32 a = cv::v_select(swap, hi, lo);
+    hi = cv::v_select(swap, lo, hi);
+    lo = a;
+}
+
+/**
+ * @brief acos(r) para r en [-1, 1] (Abramowitz-Stegun 4.4.46)
+ */
+inline cv::v_float32 acosApprox(const cv::v_float32& r) {
+    const cv::v_float32 ar = cv::v_abs(r);
+    cv::v_float32 poly = cv::vx_setall_f32(-0.0012624911f);
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(0.0066700901f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(-0.0170881256f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(0.0308918810f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(-0.0501743046f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(0.0889789874f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(-0.2145988016f));
+    poly = cv::v_fma(poly, ar, cv::vx_setall_f32(1.5707963050f));
+    const cv::v_float32 one = cv::vx_setall_f32(1.0f);
+    const cv::v_float32 res = cv::v_sqrt(cv::v_max(one - ar, cv::vx_setzero_f32())) * poly;
+    const cv::v_float32 negative = r < cv::vx_setzero_f32();
+    return cv::v_select(negative, cv::vx_setall_f32(static_cast<float>(CV_PI)) - res, res);
+}
+
+/**
+ * @brief cos(phi) para phi en [0, pi/3] (Taylor de grado 8, error < 5e-7)
+ */
+inline cv::v_float32 cosApprox(const cv::v_float32& phi) {
+    const cv::v_float32 x2 = phi * phi;
+    cv::v_float32 poly = cv::vx_setall_f32(1.0f / 40320.0f);
+    poly = cv::v_fma(poly, x2, cv::vx_setall_f32(-1.0f / 720.0f));
+    poly = cv::v_fma(poly, x2, cv::vx_setall_f32(1.0f / 24.0f));
+    poly = cv::v_fma(poly, x2, cv::vx_setall_f32(-0.5f));
+    return cv::v_fma(poly, x2, cv::vx_setall_f32(1.0f));
+}
+#endif
+
+/**
+ * @brief Frangi 3D de una fila con acumulación del máximo en out
+ *
+ * El bloque SIMD usa acos/cos polinómicos y ordena los autovalores con una
+ * red de intercambios sin ramas; la cola escalar conserva el método trigonométrico exacto.
+ */
+void frangiRow3D(const float* hxx, const float* hyy, const float* hzz,
+                 const float* hxy, const float* hxz, const float* hyz, int cols,
+                 float alphaTerm, float betaTerm, float cTerm, bool bright, RowBuffers& buf, float* out) {
+    float* ra = buf.e0.ptr<float>();
+    float* rb = buf.e1.ptr<float>();
+    float* s = buf.e2.ptr<float>();
+    float* valid = buf.valid.ptr<float>();
+    const float twoThirdsPi = static_cast<float>(2.0 * CV_PI / 3.0);
+
+    int x = 0;
+#if CV_SIMD
+    {
+        const int lanes = cv::v_float32::nlanes;
+        const cv::v_float32 zero = cv::vx_setzero_f32();
+        const cv::v_float32 one = cv::vx_setall_f32(1.0f);
+        const cv::v_float32 minusOne = cv::vx_setall_f32(-1.0f);
+        const cv::v_float32 two = cv::vx_setall_f32(2.0f);
+        const cv::v_float32 three = cv::vx_setall_f32(3.0f);
+        const cv::v_float32 third = cv::vx_setall_f32(1.0f / 3.0f);
+        const cv::v_float32 sixth = cv::vx_setall_f32(1.0f / 6.0f);
+        const cv::v_float32 half = cv::vx_setall_f32(0.5f);
+        const cv::v_float32 halfSqrt3 = cv::vx_setall_f32(0.8660254038f);
+        const cv::v_float32 eps = cv::vx_setall_f32(kEpsilon);
+        const cv::v_float32 vAlpha = cv::vx_setall_f32(alphaTerm);
+        const cv::v_float32 vBeta = cv::vx_setall_f32(betaTerm);
+        const cv::v_float32 vC = cv::vx_setall_f32(cTerm);
+
+        for (; x <= cols - lanes; x += lanes) {
+            const cv::v_float32 a = cv::vx_load(hxx + x), d = cv::vx_load(hyy + x), f = cv::vx_load(hzz + x);
+            const cv::v_float32 b = cv::vx_load(hxy + x), c = cv::vx_load(hxz + x), e = cv::vx_load(hyz + x);
+
+            const cv::v_float32 q = (a + d + f) * third;
+            const cv::v_float32 am = a - q, dm = d - q, fm = f - q;
+            const cv::v_float32 p1 = b * b + c * c + e * e;
+            const cv::v_float32 p2 = am * am + dm * dm + fm * fm + two * p1;
+            const cv::v_float32 p = cv::v_sqrt(p2 * sixth);
+            const cv::v_float32 inv = cv::v_select(p > eps, one / cv::v_max(p, eps), zero);
+            const cv::v_float32 b11 = am * inv, b22 = dm * inv, b33 = fm * inv;
+            const cv::v_float32 b12 = b * inv, b13 = c * inv, b23 = e * inv;
+            const cv::v_float32 det = b11 * (b22 * b33 - b23 * b23) - b12 * (b12 * b33 - b23 * b13) +
+                                      b13 * (b12 * b23 - b22 * b13);
+            const cv::v_float32 r = cv::v_min(one, cv::v_max(minusOne, half * det));
+
+            // cos(phi + 2pi/3) a partir de cos(phi) y sin(phi), con phi en [0, pi/3]
+            const cv::v_float32 cosPhi = cosApprox(acosApprox(r) * third);
+            const cv::v_float32 sinPhi = cv::v_sqrt(cv::v_max(one - cosPhi * cosPhi, zero));
+            const cv::v_float32 cosPhi3 = zero - half * cosPhi - halfSqrt3 * sinPhi;
+            const cv::v_float32 twoP = two * p;
+            cv::v_float32 l1 = q + twoP * cosPhi;
+            cv::v_float32 l3 = q + twoP * cosPhi3;
+            cv::v_float32 l2 = three * q - l1 - l3;
+
+            // Orden por |lambda|: |l1| <= |l2| <= |l3|
+            sortByMagnitude(l1, l2);
+            sortByMagnitude(l2, l3);
+            sortByMagnitude(l1, l2);
+
+            const cv::v_float32 l1sq = l1 * l1, l2sq = l2 * l2, l3sq = l3 * l3;
+            cv::v_store(ra + x, vAlpha * l2sq / (l3sq + eps));
+            cv::v_store(rb + x, vBeta * l1sq / (cv::v_abs(l2 * l3) + eps));
+            cv::v_store(s + x, vC * (l1sq + l2sq + l3sq));
+            const cv::v_float32 tube = bright ? ((l2 < zero) & (l3 < zero)) : ((l2 > zero) & (l3 > zero));
+            cv::v_store(valid + x, cv::v_select(tube, one, zero));
+        }
+    }
+#endif
+    for (; x < cols; x++) {
+        const float a = hxx[x], d = hyy[x], f = hzz[x];
+        const float b = hxy[x], c = hxz[x], e = hyz[x];
+
+        // Método trigonométrico para matrices simétricas 3x3
+        const float q = (a + d + f) / 3.0f;
+        const float p1 = b * b + c * c + e * e;
+        const float p2 = (a - q) * (a - q) + (d - q) * (d - q) + (f - q) * (f - q) + 2.0f * p1;
+        const float p = std::sqrt(p2 / 6.0f);
+        const float inv = p > kEpsilon ? 1.0f / p : 0.0f;
+        const float b11 = (a - q) * inv, b22 = (d - q) * inv, b33 = (f - q) * inv;
+        const float b12 = b * inv, b13 = c * inv, b23 = e * inv;
+        const float det = b11 * (b22 * b33 - b23 * b23) - b12 * (b12 * b33 - b23 * b13) +
+                          b13 * (b12 * b23 - b22 * b13);
+        const float r = std::min(1.0f, std::max(-1.0f, 0.5f * det));
+        const float phi = std::acos(r) / 3.0f;
+        float l1 = q + 2.0f * p * std::cos(phi);
+        float l3 = q + 2.0f * p * std::cos(phi + twoThirdsPi);
+        float l2 = 3.0f * q - l1 - l3;
+
+        // Orden por |lambda|: |l1| <= |l2| <= |l3|
+        if (std::fabs(l1) > std::fabs(l2)) std::swap(l1, l2);
+        if (std::fabs(l2) > std::fabs(l3)) std::swap(l2, l3);
+        if (std::fabs(l1) > std::fabs(l2)) std::swap(l1, l2);
+
+        ra[x] = alphaTerm * (l2 * l2) / (l3 * l3 + kEpsilon);
+        rb[x] = betaTerm * (l1 * l1) / (std::fabs(l2 * l3) + kEpsilon);
+        s[x] = cTerm * (l1 * l1 + l2 * l2 + l3 * l3);
+        const bool tube = bright ? (l2 < 0.0f && l3 < 0.0f) : (l2 > 0.0f && l3 > 0.0f);
+        valid[x] = tube ? 1.0f : 0.0f;
+    }
+
+    cv::exp(buf.e0, buf.e0);
+    cv::exp(buf.e1, buf.e1);
+    cv::exp(buf.e2, buf.e2);
+
+    x = 0;
+#if CV_SIMD
+    {
+        const int lanes = cv::v_float32::nlanes;
+        const cv::v_float32 one = cv::vx_setall_f32(1.0f);
+        for (; x <= cols - lanes; x += lanes) {
+            const cv::v_float32 v = cv::vx_load(valid + x) * (one - cv::vx_load(ra + x)) * cv::vx_load(rb + x) *
+                                    (one - cv::vx_load(s + x));
+            cv::v_store(out + x, cv::v_max(cv::vx_load(out + x), v));
+        }
+    }
+#endif
+    for (; x < cols; x++) {
+        const float v = valid[x] * (1.0f - ra[x]) * rb[x] * (1.0f - s[x]);
+        out[x] = std::max(out[x], v);
+    }
+}
+
+/**
+ * @brief Exponente -1 / (2·k²) de cada término de Frangi
+ */
+float frangiTerm(double k) {
+    return static_cast<float>(-1.0 / (2.0 * k * k));
+}
+
+} // namespace
+
+VesselnessParams getPulmonaryArteryVesselnessParams() {
+    VesselnessParams params;
+    params.scales = {1.0, 2.0, 3.0};
+    params.c = 50.0;
+    return params;
+}
+
+VesselnessParams getAortaVesselnessParams() {
+    VesselnessParams params;
+    params.scales = {6.0, 9.0, 12.0};
+    params.c = 50.0;
+    return params;
+}
+
+// ============================================================================
+// VESSELNESS 2D
+// ============================================================================
+
+cv::Mat computeVesselness2D(const cv::Mat& image, const VesselnessParams& params) {
+    if (image.empty() || image.channels() != 1) {
+        std::cerr << "Advertencia: computeVesselness2D requiere una imagen monocanal" << std::endl;
+        return cv::Mat();
+    }
+    cv::Mat output = cv::Mat::zeros(image.size(), CV_32F);
+    if (params.scales.empty()) {
+        std::cerr << "Advertencia: computeVesselness2D sin escalas" << std::endl;
+        return output;
+    }
+
+    cv::Mat src;
+    image.convertTo(src, CV_32F);
+
+    // 1. Hessiana de cada escala (una escala por tarea)
+    const int numScales = static_cast<int>(params.scales.size());
+    std::vector<std::array<cv::Mat, 3>> hessians(numScales);
+    cv::parallel_for_(cv::Range(0, numScales), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; i++) {
+            const DerivativeKernels k = derivativeKernels(params.scales[i]);
+            hessians[i][0] = filterSeparable(src, k.d2, k.g);   // Hxx
+            hessians[i][1] = filterSeparable(src, k.d1, k.d1);  // Hxy
+            hessians[i][2] = filterSeparable(src, k.g, k.d2);   // Hyy
+        }
+    });
+
+    // 2. Autovalores y máximo sobre escalas, en la propia salida
+    const float betaTerm = frangiTerm(params.beta);
+    for (int i = 0; i < numScales; i++) {
+        const cv::Mat& hxx = hessians[i][0];
+        const cv::Mat& hxy = hessians[i][1];
+        const cv::Mat& hyy = hessians[i][2];
+
+        double c = params.c;
+        if (c <= 0.0) {
+            // Frangi: la mitad de la norma máxima de la Hessiana
+            double maxNorm2 = 0.0;
+            for (int y = 0; y < hxx.rows; y++) {
+                const float* a = hxx.ptr<float>(y);
+                const float* b = hxy.ptr<float>(y);
+                const float* d = hyy.ptr<float>(y);
+                for (int x = 0; x < hxx.cols; x++) {
+                    maxNorm2 = std::max(maxNorm2, static_cast<double>(a[x] * a[x] + 2.0f * b[x] * b[x] + d[x] * d[x]));
+                }
+            }
+            c = std::max(0.5 * std::sqrt(maxNorm2), 1e-3);
+        }
+        const float cTerm = frangiTerm(c);
+
+        cv::parallel_for_(cv::Range(0, output.rows), [&](const cv::Range& range) {
+            RowBuffers buf(output.cols);
+            for (int y = range.start; y < range.end; y++) {
+                frangiRow2D(hxx.ptr<float>(y), hxy.ptr<float>(y), hyy.ptr<float>(y), output.cols,
+                            betaTerm, cTerm, params.brightVessels, buf, output.ptr<float>(y));
+            }
+        });
+    }
+    return output;
+}
+
+// ============================================================================
+// VESSELNESS 3D
+// ============================================================================
+
+std::vector<cv::Mat> computeVesselness3D(const std::vector<cv::Mat>& slices,
+                                         const VesselnessParams& params,
+                                         const cv::Vec3d& spacing) {
+    if (slices.empty()) {
+        return {};
+    }
+    const cv::Size size = slices.front().size();
+    for (const cv::Mat& slice : slices) {
+        if (slice.empty() || slice.channels() != 1 || slice.size() != size) {
+            std::cerr << "Advertencia: computeVesselness3D requiere cortes monocanal del mismo tamaño" << std::endl;
+            return {};
+        }
+    }
+
+    const int numSlices = static_cast<int>(slices.size());
+    std::vector<cv::Mat> output(numSlices);
+    for (cv::Mat& out : output) {
+        out = cv::Mat::zeros(size, CV_32F);
+    }
+    if (params.scales.empty()) {
+        std::cerr << "Advertencia: computeVesselness3D sin escalas" << std::endl;
+        return output;
+    }
+
+    double c = params.c;
+    if (c <= 0.0) {
+        c = getAortaVesselnessParams().c;
+        std::cerr << "Advertencia: computeVesselness3D requiere c > 0; se usa c = " << c << std::endl;
+    }
+    const float alphaTerm = frangiTerm(params.alpha);
+    const float betaTerm = frangiTerm(params.beta);
+    const float cTerm = frangiTerm(c);
+
+    // Sigma en Z (en cortes) equivalente en mm al del plano
+    const double zRatio = (spacing[0] > 0.0 && spacing[2] > 0.0) ? spacing[0] / spacing[2] : 1.0;
+
+    // Componentes en el plano: se suavizan o derivan después a lo largo de Z
+    enum { P_XX, P_YY, P_XY, P_SMOOTH, P_X, P_Y, NUM_PLANES };
+
+    for (double sigma : params.scales) {
+        const DerivativeKernels k = derivativeKernels(sigma);
+        const DerivativeKernels kz = derivativeKernels(std::max(0.5, sigma * zRatio));
+        const int rz = kz.radius;
+
+        // Ventana deslizante: cada corte se filtra en el plano una sola vez por escala
+        std::vector<std::array<cv::Mat, NUM_PLANES>> planes(numSlices);
+        int filtered = 0;
+        int evicted = 0;
+
+        for (int z0 = 0; z0 < numSlices; z0 += kChunkSlices) {
+            const int z1 = std::min(numSlices, z0 + kChunkSlices);
+            const int lo = std::max(0, z0 - rz);
+            const int hi = std::min(numSlices, z1 + rz);
+
+            // 1. Liberar los cortes que ya quedaron detrás de la ventana
+            for (; evicted < lo; evicted++) {
+                planes[evicted] = {};
+            }
+
+            // 2. Filtrado en el plano de los cortes nuevos (un corte por tarea)
+            cv::parallel_for_(cv::Range(std::max(filtered, lo), hi), [&](const cv::Range& range) {
+                for (int z = range.start; z < range.end; z++) {
+                    cv::Mat src;
+                    slices[z].convertTo(src, CV_32F);
+                    std::array<cv::Mat, NUM_PLANES>& p = planes[z];
+                    p[P_XX] = filterSeparable(src, k.d2, k.g);
+                    p[P_YY] = filterSeparable(src, k.g, k.d2);
+                    p[P_XY] = filterSeparable(src, k.d1, k.d1);
+                    p[P_SMOOTH] = filterSeparable(src, k.g, k.g);
+                    p[P_X] = filterSeparable(src, k.d1, k.g);
+                    p[P_Y] = filterSeparable(src, k.g, k.d1);
+                }
+            });
+            filtered = hi;
+
+            // 3. Filtrado en Z, autovalores y máximo sobre escalas (un corte por tarea)
+            cv::parallel_for_(cv::Range(z0, z1), [&](const cv::Range& range) {
+                RowBuffers buf(size.width);
+                std::array<cv::Mat, 6> h;
+                for (int z = range.start; z < range.end; z++) {
+                    for (cv::Mat& component : h) {
+                        component = cv::Mat::zeros(size, CV_32F);
+                    }
+                    for (int t = -rz; t <= rz; t++) {
+                        const int zi = std::min(numSlices - 1, std::max(0, z + t));
+                        const std::array<cv::Mat, NUM_PLANES>& p = planes[zi];
+                        const double g = kz.g.at<float>(t + rz);
+                        const double d1 = kz.d1.at<float>(t + rz);
+                        const double d2 = kz.d2.at<float>(t + rz);
+                        cv::scaleAdd(p[P_XX], g, h[0], h[0]);          // Hxx
+                        cv::scaleAdd(p[P_YY], g, h[1], h[1]);          // Hyy
+                        cv::scaleAdd(p[P_SMOOTH], d2, h[2], h[2]);     // Hzz
+                        cv::scaleAdd(p[P_XY], g, h[3], h[3]);          // Hxy
+                        cv::scaleAdd(p[P_X], d1, h[4], h[4]);          // Hxz
+                        cv::scaleAdd(p[P_Y], d1, h[5], h[5]);          // Hyz
+                    }
+
+                    for (int y = 0; y < size.height; y++) {
+                        frangiRow3D(h[0].ptr<float>(y), h[1].ptr<float>(y), h[2].ptr<float>(y),
+                                    h[3].ptr<float>(y), h[4].ptr<float>(y), h[5].ptr<float>(y), size.width,
+                                    alphaTerm, betaTerm, cTerm, params.brightVessels, buf,
+                                    output[z].ptr<float>(y));
+                    }
+                }
+            });
+        }
+    }
+    return output;
+}
+
+// ============================================================================
+// COMBINACIÓN CON MÁSCARAS
+// ============================================================================
+
+cv::Mat gateByVesselness(const cv::Mat& mask, const cv::Mat& vesselness, double minVesselness) {
+    if (vesselness.empty() || vesselness.size() != mask.size()) {
+        std::cerr << "Advertencia: vesselness vacía o de otro tamaño; se usa la máscara sin filtrar" << std::endl;
+        return mask.clone();
+    }
+    cv::Mat tubular = vesselness >= minVesselness;
+    cv::Mat foreground = mask != 0;
+    cv::Mat gated;
+    cv::bitwise_and(foreground, tubular, gated);
+    return gated;
+}
+
+} // namespace Segmentation
@@ -0,0 +1,78 @@
+#ifndef VESSELNESS_H
+#define VESSELNESS_H
+
+#include "opencv2/core.hpp"
+#include <vector>
+
+namespace Segmentation {
+
+// ============================================================================
+// VESSELNESS DE FRANGI (HESSIANA MULTIESCALA)
+// ============================================================================
+
+/**
+ * @brief Parámetros del filtro de vesselness de Frangi
+ */
+struct VesselnessParams {
+    std::vector<double> scales = {1.5, 2.5, 4.0};  // Sigmas en píxeles del plano
+    double alpha = 0.5;             // Sensibilidad a estructuras planas (solo 3D)
+    double beta = 0.5;              // Sensibilidad a estructuras tipo blob
+    double c = 50.0;                // Sensibilidad a la "estructuralidad" (en HU); <= 0: automático (solo 2D)
+    bool brightVessels = true;      // Vasos con contraste: más brillantes que el entorno
+};
+
+/**
+ * @brief Parámetros para las arterias pulmonares (ramas finas, 2D por corte)
+ */
+VesselnessParams getPulmonaryArteryVesselnessParams();
+
+/**
+ * @brief Parámetros para la aorta (tubo grueso, pensado para el filtro 3D)
+ */
+VesselnessParams getAortaVesselnessParams();
+
+/**
+ * @brief Vesselness de Frangi 2D de un corte
+ *
+ * Para cada escala se calcula la Hessiana normalizada (sigma²) con
+ * derivadas gaussianas separables (Hxx, Hxy, Hyy); las escalas se filtran
+ * en paralelo. Los autovalores se obtienen en forma cerrada sobre buffers
+ * de fila contiguos (bucles sin ramas, vectorizables) y la respuesta se
+ * acumula como máximo sobre escalas directamente en la salida.
+ *
+ * @param image Imagen monocanal (16S en HU, 8U, 32F...)
+ * @param params Escalas y sensibilidades
+ * @return Vesselness CV_32F en [0, 1]
+ */
+cv::Mat computeVesselness2D(const cv::Mat& image,
+                            const VesselnessParams& params = VesselnessParams());
+
+/**
+ * @brief Vesselness de Frangi 3D de un volumen
+ *
+ * Las seis componentes de la Hessiana se obtienen con filtros separables:
+ * primero en el plano de cada corte (cortes en paralelo) y después a lo
+ * largo de Z, por bloques de cortes para acotar la memoria. El sigma en Z
+ * se ajusta con el espaciado para que el filtro sea isótropo en mm.
+ *
+ * @param slices Cortes monocanal del mismo tamaño, ordenados en Z
+ * @param params Escalas (en píxeles del plano) y sensibilidades; c debe ser > 0
+ * @param spacing Espaciado de vóxel en mm (x, y, z)
+ * @return Vesselness CV_32F en [0, 1], un Mat por corte
+ */
+std::vector<cv::Mat> computeVesselness3D(const std::vector<cv::Mat>& slices,
+                                         const VesselnessParams& params = getAortaVesselnessParams(),
+                                         const cv::Vec3d& spacing = cv::Vec3d(1.0, 1.0, 1.0));
+
+/**
+ * @brief Restringe una máscara (p.ej. de rango HU) a los píxeles tubulares
+ * @param mask Máscara binaria CV_8U
+ * @param vesselness Vesselness CV_32F del mismo tamaño
+ * @param minVesselness Vesselness mínima para conservar un píxel
+ * @return Máscara CV_8U (0/255)
+ */
+cv::Mat gateByVesselness(const cv::Mat& mask, const cv::Mat& vesselness, double minVesselness);
+
+} // namespace Segmentation
+
+#endif // VESSELNESS_H
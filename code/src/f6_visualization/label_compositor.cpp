@@ -0,0 +1,152 @@
+#include "label_compositor.h"
+#include "opencv2/imgproc.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace Visualization {
+
+LabelCompositor::LabelCompositor() {
+    reset();
+}
+
+bool LabelCompositor::isValidLabel(int label) const {
+    if (label < 0 || label >= kLabels) {
+        std::cerr << "Error: Etiqueta fuera de rango (0-255): " << label << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void LabelCompositor::updateEntry(int label) {
+    const LabelStyle& s = styles[label];
+    // Peso de la etiqueta en 1/256; invisible equivale a opacidad 0
+    const uint32_t weight = s.visible
+        ? static_cast<uint32_t>(cvRound(std::clamp(s.alpha, 0.0, 1.0) * 256.0))
+        : 0u;
+
+    keepLut[label] = 256u - weight;
+    for (int c = 0; c < 3; c++) {
+        const uint32_t channel = static_cast<uint32_t>(cv::saturate_cast<uchar>(s.color[c]));
+        addLut[c][label] = channel * weight;
+    }
+}
+
+void LabelCompositor::setStyle(int label, const LabelStyle& style) {
+    if (!isValidLabel(label)) return;
+    styles[label] = style;
+    updateEntry(label);
+}
+
+void LabelCompositor::setColor(int label, const cv::Scalar& color) {
+    if (!isValidLabel(label)) return;
+    styles[label].color = color;
+    updateEntry(label);
+}
+
+void LabelCompositor::setAlpha(int label, double alpha) {
+    if (!isValidLabel(label)) return;
+    styles[label].alpha = alpha;
+    updateEntry(label);
+}
+
+void LabelCompositor::setVisible(int label, bool visible) {
+    if (!isValidLabel(label)) return;
+    styles[label].visible = visible;
+    updateEntry(label);
+}
+
+const LabelStyle& LabelCompositor::style(int label) const {
+    return styles[std::clamp(label, 0, kLabels - 1)];
+}
+
+void LabelCompositor::reset() {
+    for (int label = 0; label < kLabels; label++) {
+        styles[label] = LabelStyle();
+        updateEntry(label);
+    }
+}
+
+cv::Mat LabelCompositor::compose(const cv::Mat& base, const cv::Mat& labels) const {
+    if (base.empty() || base.depth() != CV_8U ||
+        (base.channels() != 1 && base.channels() != 3)) {
+        std::cerr << "Error: La imagen base debe ser CV_8UC1 o CV_8UC3" << std::endl;
+        return cv::Mat();
+    }
+
+    cv::Mat output(base.size(), CV_8UC3);
+
+    if (labels.empty() || labels.type() != CV_8UC1 || labels.size() != base.size()) {
+        std::cerr << "Error: El mapa de etiquetas debe ser CV_8UC1 y del tamaño de la imagen" << std::endl;
+        if (base.channels() == 1) {
+            cv::cvtColor(base, output, cv::COLOR_GRAY2BGR);
+        } else {
+            base.copyTo(output);
+        }
+        return output;
+    }
+
+    const uint32_t* keep = keepLut.data();
+    const uint32_t* addB = addLut[0].data();
+    const uint32_t* addG = addLut[1].data();
+    const uint32_t* addR = addLut[2].data();
+    const bool gray = base.channels() == 1;
+
+    // Una sola pasada por filas: la expansión gris->BGR y la mezcla de todas
+    // las etiquetas se hacen a la vez, sin máscaras ni imágenes intermedias
+    cv::parallel_for_(cv::Range(0, base.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; y++) {
+            const uchar* lab = labels.ptr<uchar>(y);
+            const uchar* src = base.ptr<uchar>(y);
+            uchar* dst = output.ptr<uchar>(y);
+
+            if (gray) {
+                for (int x = 0; x < base.cols; x++) {
+                    const uint32_t l = lab[x];
+                    const uint32_t g = src[x] * keep[l] + 128u;
+                    dst[3 * x]     = static_cast<uchar>((g + addB[l]) >> 8);
+                    dst[3 * x + 1] = static_cast<uchar>((g + addG[l]) >> 8);
+                    dst[3 * x + 2] = static_cast<uchar>((g + addR[l]) >> 8);
+                }
+            } else {
+                for (int x = 0; x < base.cols; x++) {
+                    const uint32_t l = lab[x];
+                    const uint32_t k = keep[l];
+                    dst[3 * x]     = static_cast<uchar>((src[3 * x]     * k + addB[l] + 128u) >> 8);
+                    dst[3 * x + 1] = static_cast<uchar>((src[3 * x + 1] * k + addG[l] + 128u) >> 8);
+                    dst[3 * x + 2] = static_cast<uchar>((src[3 * x + 2] * k + addR[l] + 128u) >> 8);
+                }
+            }
+        }
+    });
+
+    return output;
+}
+
+cv::Mat overlaySegmentations(const cv::Mat& image,
+                             const std::vector<Segmentation::SegmentedRegion>& regions,
+                             double alpha) {
+    cv::Mat base = image;
+    if (image.depth() != CV_8U) {
+        cv::normalize(image, base, 0, 255, cv::NORM_MINMAX, CV_8U);
+    }
+
+    // Mapa de etiquetas: región i -> etiqueta i + 1 (0 = fondo)
+    const size_t maxRegions = LabelCompositor::kLabels - 1;
+    if (regions.size() > maxRegions) {
+        std::cerr << "Advertencia: Solo se superponen las primeras " << maxRegions
+                  << " regiones" << std::endl;
+    }
+
+    cv::Mat labels = cv::Mat::zeros(image.size(), CV_8U);
+    LabelCompositor compositor;
+    for (size_t i = 0; i < regions.size() && i < maxRegions; i++) {
+        const int label = static_cast<int>(i) + 1;
+        labels.setTo(label, regions[i].mask);
+        compositor.setStyle(label, LabelStyle{regions[i].color, alpha, true});
+    }
+
+    // Mezcla de todas las regiones en una pasada
+    return compositor.compose(base, labels);
+}
+
+} // namespace Visualization
@@ -0,0 +1,86 @@
+#ifndef LABEL_COMPOSITOR_H
+#define LABEL_COMPOSITOR_H
+
+#include "opencv2/core.hpp"
+#include "f4_segmentation/segmentation.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Visualization {
+
+// ============================================================================
+// COMPOSICIÓN DE MAPAS DE ETIQUETAS
+// ============================================================================
+
+/**
+ * @brief Estilo de una etiqueta en la superposición
+ */
+struct LabelStyle {
+    cv::Scalar color = cv::Scalar(0, 0, 0);  // Color BGR
+    double alpha = 0.0;                      // Opacidad (0.0 a 1.0)
+    bool visible = false;                    // Si la etiqueta se dibuja
+};
+
+/**
+ * @brief Superpone un mapa de etiquetas CV_8U sobre una imagen en una pasada
+ *
+ * Cada etiqueta (0-255) tiene un color, una opacidad y una visibilidad. La
+ * tabla se guarda también en punto fijo (pesos de 8 bits), de modo que cada
+ * píxel de salida es out = (base * keep[l] + add[l] + 128) >> 8, con una sola
+ * búsqueda en tabla por píxel. La etiqueta 0 es el fondo y por defecto no se
+ * dibuja. Cambiar la visibilidad de una etiqueta solo actualiza su entrada.
+ */
+class LabelCompositor {
+public:
+    static constexpr int kLabels = 256;
+
+    LabelCompositor();
+
+    void setStyle(int label, const LabelStyle& style);
+    void setColor(int label, const cv::Scalar& color);
+    void setAlpha(int label, double alpha);
+    void setVisible(int label, bool visible);
+    const LabelStyle& style(int label) const;
+
+    /**
+     * @brief Deja todas las etiquetas invisibles
+     */
+    void reset();
+
+    /**
+     * @brief Mezcla las etiquetas visibles sobre la imagen base
+     * @param base Imagen CV_8UC1 (gris) o CV_8UC3 (BGR)
+     * @param labels Mapa de etiquetas CV_8UC1 del mismo tamaño
+     * @return Imagen BGR CV_8UC3
+     */
+    cv::Mat compose(const cv::Mat& base, const cv::Mat& labels) const;
+
+private:
+    bool isValidLabel(int label) const;
+    void updateEntry(int label);
+
+    std::array<LabelStyle, kLabels> styles;
+    std::array<uint32_t, kLabels> keepLut;       // Peso de la base (256 = sin cambio)
+    std::array<uint32_t, kLabels> addLut[3];     // Color premultiplicado por canal (B, G, R)
+};
+
+/**
+ * @brief Superpone máscaras de color sobre la imagen original
+ *
+ * Las regiones se vuelcan en un único mapa de etiquetas y se mezclan en una
+ * sola pasada con LabelCompositor. Donde se solapan regiones prevalece la
+ * última.
+ *
+ * @param image Imagen original (gris o BGR)
+ * @param regions Vector de regiones segmentadas
+ * @param alpha Transparencia de las máscaras (0.0 a 1.0, default: 0.5)
+ * @return Imagen con máscaras superpuestas
+ */
+cv::Mat overlaySegmentations(const cv::Mat& image,
+                             const std::vector<Segmentation::SegmentedRegion>& regions,
+                             double alpha = 0.5);
+
+} // namespace Visualization
+
+#endif // LABEL_COMPOSITOR_H
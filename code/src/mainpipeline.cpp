@@ -9,6 +9,8 @@
 #include "f2_io/dicom_reader.h"
 #include "utils/itk_opencv_bridge.h"
 #include "f4_segmentation/segmentation.h"
+#include "f4_segmentation/auto_threshold.h"
+#include "f4_segmentation/vesselness.h"
 #include "f5_morphology/morphology.h"
 #include "f3_preprocessing/preprocessing.h"
 
@@ -31,11 +33,17 @@ double distanciaAlCentro(const cv::Point2d& centroide, const cv::Size& imageSize
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <ruta_al_archivo.IMA>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " <ruta_al_archivo.IMA> [--vesselness]" << std::endl;
         return -1;
     }
 
     std::string dicomPath = argv[1];
+    
+    // Filtrado de arterias por vesselness de Frangi (opcional: cambia la máscara)
+    bool usarVesselness = false;
+    for (int i = 2; i < argc; i++) {
+        if (std::string(argv[i]) == "--vesselness") usarVesselness = true;
+    }
 
     try {
         // --- 1. LECTURA (Usando dicom_reader.cpp) ---
@@ -55,10 +63,19 @@ int main(int argc, char* argv[]) {
         // --- 3. SEGMENTACIÓN (Basada en consulta médica) ---
         std::cout << "\n=== 3. SEGMENTACIÓN POR RANGOS HU (Criterio Médico) ===" << std::endl;
 
-        // Cargar parámetros de segmentación
-        auto boneParams = Segmentation::getDefaultBoneParams();
-        auto lungParams = Segmentation::getDefaultLungParams(); // Ventana de Pulmón (Aire: -1000 a -400 HU)
-        auto softTissueParams = Segmentation::getDefaultHeartParams(); // Tejido Blando (0 a 100 HU)
+        // Umbrales automáticos a partir del histograma HU del corte (una sola pasada)
+        Segmentation::HUHistogram histHU = Segmentation::computeHUHistogram(imageHU_16bit);
+        Segmentation::AutoHUThresholds autoHU = Segmentation::computeAutoThresholds(histHU);
+        if (autoHU.valid) {
+            std::cout << "Umbrales automáticos (Otsu multinivel): aire/tejido = " << autoHU.airTissue
+                      << " HU, grasa/blando = " << autoHU.fatSoft
+                      << " HU, blando/hueso = " << autoHU.softBone << " HU" << std::endl;
+        }
+
+        // Cargar parámetros de segmentación (por defecto si el histograma no es válido)
+        auto boneParams = Segmentation::getAdaptiveBoneParams(autoHU);
+        auto lungParams = Segmentation::getAdaptiveLungParams(autoHU); // Ventana de Pulmón (Aire: -1000 a ~-400 HU)
+        auto softTissueParams = Segmentation::getAdaptiveHeartParams(autoHU); // Tejido Blando (~0 a 100 HU)
         
         // Parámetros personalizados para arterias pulmonares (con contraste son más brillantes)
         Segmentation::SegmentationParams arteryParams;
@@ -150,6 +167,21 @@ int main(int argc, char* argv[]) {
                 cv::bitwise_or(arteryMask, r.mask, arteryMask);
             }
             
+            // Canal de vesselness (--vesselness): conservar solo estructuras tubulares
+            // (descarta tejido con HU de contraste que no es vaso, p.ej. cavidades
+            // cardíacas). Las escalas de las ramas finas no cubren el interior de los
+            // troncos centrales, así que se añaden escalas del radio del tronco.
+            if (usarVesselness) {
+                cv::TickMeter vesselTimer;
+                vesselTimer.start();
+                Segmentation::VesselnessParams vesselParams = Segmentation::getPulmonaryArteryVesselnessParams();
+                vesselParams.scales.insert(vesselParams.scales.end(), {6.0, 10.0});
+                cv::Mat vesselness = Segmentation::computeVesselness2D(imageHU_16bit, vesselParams);
+                arteryMask = Segmentation::gateByVesselness(arteryMask, vesselness, 0.05);
+                vesselTimer.stop();
+                std::cout << "  -> Vesselness de Frangi 2D: " << vesselTimer.getTimeMilli() << " ms" << std::endl;
+            }
+            
             // Aplicar cierre morfológico para conectar ramas del árbol arterial
             cv::Mat kernelConnect = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(9, 9));
             cv::morphologyEx(arteryMask, arteryMask, cv::MORPH_CLOSE, kernelConnect);
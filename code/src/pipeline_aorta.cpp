@@ -2,13 +2,21 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <chrono>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include "f2_io/dicom_reader.h"
+#include "f2_io/dataset_explorer.h"
 #include "utils/itk_opencv_bridge.h"
 #include "f3_preprocessing/denoising.h"
+#include "f3_preprocessing/slab_denoising.h"
 #include "f4_segmentation/segmentation.h"
+#include "f4_segmentation/aorta_tracker.h"
+#include "f4_segmentation/labeling3d.h"
+#include "f4_segmentation/vesselness.h"
 #include "f5_morphology/morphology.h"
 
 namespace fs = std::filesystem;
@@ -31,24 +39,17 @@ void saveProcessImage(const cv::Mat& image, const std::string& step, const std::
 }
 
 // FUNCIÓN PARA SEGMENTAR AORTA (reutilizable)
+// Rango HU, áreas y color vienen de arteryParams (por defecto los de segmentAorta
+// y AortaTracker, para que los tres modos segmenten lo mismo)
 std::vector<Segmentation::SegmentedRegion> segmentarAorta(
     const cv::Mat& imageHU_16bit, 
     const cv::Mat& image8bit,
-    const std::string& label) {
+    const std::string& label,
+    const Segmentation::SegmentationParams& arteryParams = Segmentation::getDefaultAortaParams()) {
     
     cv::Point2d imgCenter(imageHU_16bit.cols / 2.0, imageHU_16bit.rows / 2.0);
     
-    // Umbralización
-    cv::Mat thresholdMask = Segmentation::thresholdByRange(imageHU_16bit, 30, 120);
-    
-    // Segmentación
-    Segmentation::SegmentationParams arteryParams;
-    arteryParams.minHU = 30;
-    arteryParams.maxHU = 120;
-    arteryParams.minArea = 200;
-    arteryParams.maxArea = 8000;
-    arteryParams.visualColor = cv::Scalar(0, 255, 0);
-    
+    // Umbralización y segmentación
     auto candidates = Segmentation::segmentOrgan(imageHU_16bit, arteryParams, "Arteria");
     
     // Filtros anatómicos
@@ -91,7 +92,7 @@ std::vector<Segmentation::SegmentedRegion> segmentarAorta(
             
             if (dist < 120.0) {
                 largest.label = label;
-                largest.color = cv::Scalar(0, 255, 0);
+                largest.color = arteryParams.visualColor;
                 finalArteries.push_back(largest);
             }
         }
@@ -100,14 +101,202 @@ std::vector<Segmentation::SegmentedRegion> segmentarAorta(
     return finalArteries;
 }
 
+// MODO SERIE: seguimiento de la aorta corte a corte sobre una carpeta
+int procesarSerie(const std::string& folderPath, bool compararBusquedaCompleta, bool usarVesselness,
+                  const Preprocessing::SlabParams& slabParams) {
+    auto files = DatasetExplorer::getDicomFileList(folderPath);
+    if (files.empty()) {
+        std::cerr << "✗ No se encontraron archivos DICOM en: " << folderPath << std::endl;
+        return -1;
+    }
+
+    fs::path outputPath = fs::path(folderPath) / "resultados_aorta_serie";
+    fs::create_directories(outputPath);
+    g_outputDir = outputPath.string();
+
+    std::cout << "╔═══════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║  PIPELINE: AORTA - SEGUIMIENTO EN SERIE 🫀    ║" << std::endl;
+    std::cout << "╚═══════════════════════════════════════════════╝\n" << std::endl;
+    std::cout << "→ " << files.size() << " cortes en " << folderPath << "\n" << std::endl;
+
+    std::ofstream csv(g_outputDir + "/aorta_serie.csv");
+    csv << "corte,archivo,modo,confianza,area,centroide_x,centroide_y,tiempo_ms";
+    if (compararBusquedaCompleta) csv << ",tiempo_completo_ms,area_completa";
+    csv << ",area_3d\n";
+
+    // Denoising 2.5D opcional (halfWidth > 0): la losa recorre la serie en orden
+    // con un buffer circular, así que cada archivo se lee una sola vez
+    Preprocessing::SlabDenoiser slab(static_cast<int>(files.size()),
+        [&files](int index) {
+            return Bridge::itkToOpenCV(DicomIO::readDicomImage(files[index]));
+        }, slabParams);
+    auto leerCorte = [&](size_t i) -> cv::Mat {
+        if (slabParams.halfWidth > 0) {
+            return slab.denoise(static_cast<int>(i));
+        }
+        return Bridge::itkToOpenCV(DicomIO::readDicomImage(files[i]));
+    };
+    if (slabParams.halfWidth > 0) {
+        std::cout << "→ Denoising 2.5D: " << Preprocessing::slabMethodName(slabParams.method)
+                  << " con ±" << slabParams.halfWidth << " cortes\n" << std::endl;
+    }
+
+    // Vesselness 3D: la aorta es un tubo a lo largo de Z (en 2D axial se ve como un disco)
+    std::vector<cv::Mat> vesselness;
+    std::vector<cv::Mat> volumen;
+    if (usarVesselness) {
+        volumen.reserve(files.size());
+        for (size_t i = 0; i < files.size(); i++) {
+            volumen.push_back(leerCorte(i));
+        }
+        DicomIO::VoxelSpacing spacing = DicomIO::readVoxelSpacing(files.front(),
+                                                                  files.size() > 1 ? files[1] : "");
+
+        auto inicio = std::chrono::high_resolution_clock::now();
+        vesselness = Segmentation::computeVesselness3D(volumen, Segmentation::getAortaVesselnessParams(),
+                                                       cv::Vec3d(spacing.x, spacing.y, spacing.z));
+        auto fin = std::chrono::high_resolution_clock::now();
+        std::cout << "→ Vesselness de Frangi 3D: "
+                  << std::chrono::duration<double, std::milli>(fin - inicio).count() << " ms ("
+                  << spacing.x << " x " << spacing.y << " x " << spacing.z << " mm)\n" << std::endl;
+    }
+
+    Segmentation::AortaTracker tracker;
+    double tiempoSeguimiento = 0.0;
+    double tiempoCompleto = 0.0;
+    int cortesConAorta = 0;
+
+    // Máscara de la aorta y fila del CSV por corte; la columna area_3d se
+    // añade tras la limpieza 3D
+    std::vector<cv::Mat> mascarasAorta(files.size());
+    std::vector<std::string> filasCsv(files.size());
+
+    for (size_t i = 0; i < files.size(); i++) {
+        // Con vesselness el volumen ya está leído (y filtrado si hay losa)
+        cv::Mat imageHU_16bit = i < volumen.size() ? volumen[i] : leerCorte(i);
+        if (imageHU_16bit.empty()) {
+            std::cerr << "⚠ No se pudo leer el corte " << i << ": " << files[i] << std::endl;
+            continue;
+        }
+        const cv::Mat vesselnessCorte = i < vesselness.size() ? vesselness[i] : cv::Mat();
+
+        auto inicio = std::chrono::high_resolution_clock::now();
+        Segmentation::AortaTrackResult resultado = tracker.process(imageHU_16bit, vesselnessCorte);
+        auto fin = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(fin - inicio).count();
+        tiempoSeguimiento += ms;
+
+        double area = 0.0;
+        cv::Point2d centroide(-1, -1);
+        if (!resultado.regions.empty()) {
+            area = resultado.regions.front().area;
+            centroide = resultado.regions.front().centroid;
+            mascarasAorta[i] = resultado.regions.front().mask;
+            cortesConAorta++;
+        } else {
+            mascarasAorta[i] = cv::Mat::zeros(imageHU_16bit.size(), CV_8U);
+        }
+
+        std::ostringstream fila;
+        fila << i << "," << fs::path(files[i]).filename().string() << ","
+             << (resultado.tracked ? "ROI" : "completo") << "," << resultado.confidence << ","
+             << area << "," << centroide.x << "," << centroide.y << "," << ms;
+
+        // Referencia: búsqueda en toda la imagen en cada corte
+        if (compararBusquedaCompleta) {
+            inicio = std::chrono::high_resolution_clock::now();
+            auto completo = Segmentation::segmentAorta(imageHU_16bit, Segmentation::getDefaultAortaParams(),
+                                                       vesselnessCorte, Segmentation::AortaTrackerParams().minVesselness);
+            fin = std::chrono::high_resolution_clock::now();
+            double msCompleto = std::chrono::duration<double, std::milli>(fin - inicio).count();
+            tiempoCompleto += msCompleto;
+            fila << "," << msCompleto << "," << (completo.empty() ? 0.0 : completo.front().area);
+        }
+        filasCsv[i] = fila.str();
+    }
+
+    // Limpieza 3D: la aorta es un único tubo a lo largo de la serie, así que
+    // solo se conserva el mayor componente 3D de las máscaras por corte. Se
+    // descartan detecciones aisladas que el seguimiento 2D no puede rechazar
+    cv::Size tamanioCorte;
+    for (const cv::Mat& mascara : mascarasAorta) {
+        if (!mascara.empty()) {
+            tamanioCorte = mascara.size();
+            break;
+        }
+    }
+    std::vector<cv::Mat> aorta3D;
+    int cortesConAorta3D = 0;
+    if (!tamanioCorte.empty()) {
+        for (cv::Mat& mascara : mascarasAorta) {
+            // Corte ilegible o de otro tamaño: cuenta como corte sin aorta
+            if (mascara.size() != tamanioCorte) {
+                mascara = cv::Mat::zeros(tamanioCorte, CV_8U);
+            }
+        }
+        auto inicio = std::chrono::high_resolution_clock::now();
+        aorta3D = Segmentation::keepLargestComponents3D(mascarasAorta, 1);
+        auto fin = std::chrono::high_resolution_clock::now();
+        std::cout << "→ Limpieza 3D (mayor componente, 26-conectividad): "
+                  << std::chrono::duration<double, std::milli>(fin - inicio).count() << " ms" << std::endl;
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (filasCsv[i].empty()) continue;
+        const int area3D = i < aorta3D.size() ? cv::countNonZero(aorta3D[i]) : 0;
+        if (area3D > 0) cortesConAorta3D++;
+        csv << filasCsv[i] << "," << area3D << "\n";
+    }
+
+    const double n = static_cast<double>(files.size());
+    std::cout << "\n📊 Resumen de la serie:" << std::endl;
+    std::cout << "   Cortes con aorta: " << cortesConAorta << " / " << files.size() << std::endl;
+    std::cout << "   Cortes con aorta tras la limpieza 3D: " << cortesConAorta3D << " / " << files.size() << std::endl;
+    std::cout << "   Cortes por seguimiento (ROI): " << tracker.getTrackedCount() << std::endl;
+    std::cout << "   Cortes por búsqueda completa: " << tracker.getFullSearchCount() << std::endl;
+    std::cout << "   Tiempo seguimiento: " << tiempoSeguimiento << " ms ("
+              << tiempoSeguimiento / n << " ms/corte)" << std::endl;
+    if (compararBusquedaCompleta) {
+        std::cout << "   Tiempo búsqueda completa: " << tiempoCompleto << " ms ("
+                  << tiempoCompleto / n << " ms/corte)" << std::endl;
+        if (tiempoSeguimiento > 0.0) {
+            std::cout << "   Aceleración: x" << tiempoCompleto / tiempoSeguimiento << std::endl;
+        }
+    }
+    std::cout << "\n Resultados guardados en: " << g_outputDir << "/aorta_serie.csv" << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <ruta_archivo.IMA>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " <ruta_archivo.IMA | carpeta_serie> [--comparar] [--vesselness]"
+                  << " [--slab <k>] [--nlm]" << std::endl;
         return -1;
     }
 
     std::string dicomPath = argv[1];
 
+    // Carpeta: seguimiento de la aorta en toda la serie
+    if (fs::is_directory(dicomPath)) {
+        bool comparar = false;
+        bool vesselness = false;
+        Preprocessing::SlabParams slabParams;
+        slabParams.halfWidth = 0;   // Sin losa salvo --slab <k>
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--comparar") comparar = true;
+            else if (arg == "--vesselness") vesselness = true;
+            else if (arg == "--slab" && i + 1 < argc) slabParams.halfWidth = std::stoi(argv[++i]);
+            else if (arg == "--nlm") slabParams.method = Preprocessing::SlabMethod::NLM;
+        }
+        try {
+            return procesarSerie(dicomPath, comparar, vesselness, slabParams);
+        } catch (const std::exception& e) {
+            std::cerr << "\n✗ ERROR: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
     try {
         // Configurar directorio de salida
         fs::path dicomFilePath = fs::path(dicomPath);
@@ -147,6 +336,10 @@ int main(int argc, char* argv[]) {
         std::string modelPath = "models/dncnn_grayscale.onnx";
         
         bool denoisingAvailable = denoiser.loadModel(modelPath);
+        if (denoisingAvailable) {
+            // Reejecuciones sobre el mismo corte no repiten la inferencia
+            denoiser.enableCache();
+        }
         
         if (!denoisingAvailable) {
             std::cerr << "  Advertencia: No se pudo cargar el modelo de denoising" << std::endl;
@@ -6,16 +6,24 @@
 
 #include "f2_io/dicom_reader.h"
 #include "utils/itk_opencv_bridge.h"
+#include "f3_preprocessing/preprocessing.h"
 #include "f4_segmentation/segmentation.h"
 #include "f5_morphology/morphology.h"
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <ruta_archivo.IMA>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " <ruta_archivo.IMA> [--mediana <kernel>]" << std::endl;
         return -1;
     }
 
     std::string dicomPath = argv[1];
+    // Mediana opcional sobre HU antes de segmentar
+    int medianKernel = 0;
+    for (int i = 2; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--mediana") {
+            medianKernel = std::stoi(argv[i + 1]);
+        }
+    }
 
     try {
         std::cout << "\n╔═══════════════════════════════════════════╗" << std::endl;
@@ -33,6 +41,11 @@ int main(int argc, char* argv[]) {
         }
         std::cout << "  Dimensiones: " << imageHU_16bit.cols << "x" << imageHU_16bit.rows << std::endl;
 
+        if (medianKernel > 1) {
+            std::cout << "  Mediana sobre HU (kernel " << medianKernel << ")..." << std::endl;
+            imageHU_16bit = Preprocessing::applyMedianFilter(imageHU_16bit, medianKernel);
+        }
+
         cv::Point2d imgCenter(imageHU_16bit.cols / 2.0, imageHU_16bit.rows / 2.0);
 
         // 3. SEGMENTACIÓN DE HUESOS
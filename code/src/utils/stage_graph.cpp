@@ -0,0 +1,96 @@
+#include "stage_graph.h"
+#include <algorithm>
+
+namespace Pipeline {
+
+ParamHash& ParamHash::mix(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return *this;
+}
+
+StageGraph::StageGraph(size_t entriesPerStage)
+    : capacity(std::max<size_t>(1, entriesPerStage)) {
+}
+
+int StageGraph::addStage(const std::string& name, const std::vector<int>& inputs) {
+    const int id = static_cast<int>(stages.size());
+    for (int input : inputs) {
+        if (input < 0 || input >= id) {
+            throw std::invalid_argument("StageGraph: la etapa '" + name +
+                                        "' depende de una etapa no declarada antes");
+        }
+    }
+    Stage stage;
+    stage.name = name;
+    stage.inputs = inputs;
+    stages.push_back(std::move(stage));
+    return id;
+}
+
+uint64_t StageGraph::computeKey(int id, uint64_t params) const {
+    ParamHash hash;
+    hash.add(id).add(params);
+    for (int input : stages[id].inputs) {
+        hash.add(stages[input].currentKey);
+    }
+    return hash.value();
+}
+
+const std::any* StageGraph::lookup(Stage& stage, uint64_t key) {
+    for (auto it = stage.entries.begin(); it != stage.entries.end(); ++it) {
+        if (it->key == key) {
+            // Pasa a ser la más reciente (splice no invalida punteros)
+            stage.entries.splice(stage.entries.begin(), stage.entries, it);
+            return &stage.entries.front().value;
+        }
+    }
+    return nullptr;
+}
+
+const std::any* StageGraph::store(Stage& stage, uint64_t key, std::any value) {
+    stage.entries.push_front(Entry{key, std::move(value)});
+    while (stage.entries.size() > capacity) {
+        stage.entries.pop_back();
+    }
+    return &stage.entries.front().value;
+}
+
+void StageGraph::clear() {
+    for (Stage& stage : stages) {
+        stage.entries.clear();
+        stage.forwarded.reset();
+        stage.current = nullptr;
+        stage.currentKey = 0;
+    }
+}
+
+std::vector<StageStats> StageGraph::stats() const {
+    std::vector<StageStats> result;
+    result.reserve(stages.size());
+    for (const Stage& stage : stages) {
+        StageStats s;
+        s.name = stage.name;
+        s.hits = stage.hits;
+        s.misses = stage.misses;
+        s.lastMs = stage.lastMs;
+        s.totalMs = stage.totalMs;
+        s.entries = stage.entries.size();
+        result.push_back(s);
+    }
+    return result;
+}
+
+void StageGraph::resetStats() {
+    for (Stage& stage : stages) {
+        stage.hits = 0;
+        stage.misses = 0;
+        stage.lastMs = 0.0;
+        stage.totalMs = 0.0;
+    }
+}
+
+} // namespace Pipeline
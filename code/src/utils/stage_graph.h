@@ -0,0 +1,198 @@
+#ifndef STAGE_GRAPH_H
+#define STAGE_GRAPH_H
+
+#include <opencv2/core.hpp>
+#include <any>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Pipeline {
+
+// ============================================================================
+// HASH DE PARÁMETROS
+// ============================================================================
+
+/**
+ * @brief Hash FNV-1a de 64 bits de los parámetros de una etapa
+ *
+ * Uso: ParamHash().add(kernel).add(sigma).add(enabled).value()
+ */
+class ParamHash {
+public:
+    ParamHash& add(int64_t v) { return mix(&v, sizeof(v)); }
+    ParamHash& add(int v) { return add(static_cast<int64_t>(v)); }
+    ParamHash& add(uint64_t v) { return mix(&v, sizeof(v)); }
+    ParamHash& add(double v) { return mix(&v, sizeof(v)); }
+    ParamHash& add(bool v) { return add(static_cast<int64_t>(v ? 1 : 0)); }
+    ParamHash& add(const std::string& v) { add(static_cast<uint64_t>(v.size())); return mix(v.data(), v.size()); }
+
+    uint64_t value() const { return hash; }
+
+private:
+    ParamHash& mix(const void* data, size_t size);
+
+    uint64_t hash = 1469598103934665603ULL;
+};
+
+// ============================================================================
+// GRAFO DE ETAPAS CON MEMOIZACIÓN
+// ============================================================================
+
+/**
+ * @brief Estadísticas de caché de una etapa
+ */
+struct StageStats {
+    std::string name;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    double lastMs = 0.0;        // Tiempo del último cálculo (0 si fue acierto)
+    double totalMs = 0.0;       // Tiempo acumulado de cálculo
+    size_t entries = 0;         // Resultados guardados
+};
+
+/**
+ * @brief DAG de etapas de procesamiento con caché por etapa
+ *
+ * Cada etapa declara sus entradas (etapas anteriores). Su clave es el hash
+ * de sus parámetros y de las claves actuales de sus entradas, así que si
+ * cambia un parámetro solo se recalculan esa etapa y las que dependen de
+ * ella; las etapas anteriores devuelven su resultado guardado. Cada etapa
+ * guarda los últimos resultados (LRU) para que volver a un valor anterior
+ * de un slider también sea un acierto.
+ *
+ * Las etapas se ejecutan en orden topológico por quien llama (run de una
+ * etapa después de run de sus entradas).
+ */
+class StageGraph {
+public:
+    /**
+     * @param entriesPerStage Resultados guardados por etapa (mínimo 1)
+     */
+    explicit StageGraph(size_t entriesPerStage = 4);
+
+    /**
+     * @brief Declara una etapa
+     * @param name Nombre (para las métricas)
+     * @param inputs Etapas de las que depende
+     * @return Identificador (secuencial desde 0)
+     */
+    int addStage(const std::string& name, const std::vector<int>& inputs = {});
+
+    /**
+     * @brief Ejecuta una etapa o devuelve su resultado guardado
+     * @param id Etapa
+     * @param params Hash de sus parámetros (ver ParamHash)
+     * @param compute Cálculo del resultado a partir de los valores de las entradas
+     */
+    template <typename T>
+    const T& run(int id, uint64_t params, const std::function<T()>& compute);
+
+    /**
+     * @brief Etapa desactivada o de selección: reenvía el valor y la clave de otra etapa
+     */
+    template <typename T>
+    const T& forward(int id, int from);
+
+    /**
+     * @brief Último valor de una etapa (debe haberse ejecutado)
+     */
+    template <typename T>
+    const T& value(int id) const;
+
+    /**
+     * @brief Clave actual de una etapa (0 si no se ha ejecutado)
+     */
+    uint64_t key(int id) const { return stages.at(id).currentKey; }
+
+    /**
+     * @brief Borra los resultados guardados (no las estadísticas)
+     */
+    void clear();
+
+    std::vector<StageStats> stats() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::any value;
+    };
+
+    struct Stage {
+        std::string name;
+        std::vector<int> inputs;
+        std::list<Entry> entries;           // Más reciente primero
+        uint64_t currentKey = 0;
+        const std::any* current = nullptr;
+        std::any forwarded;                 // Valor reenviado por forward()
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        double lastMs = 0.0;
+        double totalMs = 0.0;
+    };
+
+    uint64_t computeKey(int id, uint64_t params) const;
+    const std::any* lookup(Stage& stage, uint64_t key);
+    const std::any* store(Stage& stage, uint64_t key, std::any value);
+
+    std::vector<Stage> stages;
+    size_t capacity;
+};
+
+// ============================================================================
+// IMPLEMENTACIÓN DE LAS PLANTILLAS
+// ============================================================================
+
+template <typename T>
+const T& StageGraph::run(int id, uint64_t params, const std::function<T()>& compute) {
+    Stage& stage = stages.at(id);
+    const uint64_t stageKey = computeKey(id, params);
+
+    const std::any* result = lookup(stage, stageKey);
+    if (result) {
+        stage.hits++;
+        stage.lastMs = 0.0;
+    } else {
+        cv::TickMeter timer;
+        timer.start();
+        std::any computed = compute();
+        timer.stop();
+        stage.misses++;
+        stage.lastMs = timer.getTimeMilli();
+        stage.totalMs += stage.lastMs;
+        result = store(stage, stageKey, std::move(computed));
+    }
+    stage.currentKey = stageKey;
+    stage.current = result;
+    return *std::any_cast<T>(result);
+}
+
+template <typename T>
+const T& StageGraph::forward(int id, int from) {
+    Stage& stage = stages.at(id);
+    const Stage& source = stages.at(from);
+    if (!source.current) {
+        throw std::logic_error("StageGraph: la etapa '" + source.name + "' no se ha ejecutado");
+    }
+    stage.forwarded = *source.current;
+    stage.currentKey = source.currentKey;
+    stage.current = &stage.forwarded;
+    return *std::any_cast<T>(stage.current);
+}
+
+template <typename T>
+const T& StageGraph::value(int id) const {
+    const Stage& stage = stages.at(id);
+    if (!stage.current) {
+        throw std::logic_error("StageGraph: la etapa '" + stage.name + "' no se ha ejecutado");
+    }
+    return *std::any_cast<T>(stage.current);
+}
+
+} // namespace Pipeline
+
+#endif // STAGE_GRAPH_H
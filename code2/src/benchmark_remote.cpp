@@ -0,0 +1,153 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "core/remote_denoiser.h"
+#include "core/shm_denoiser.h"
+
+// Benchmark del cliente remoto de denoising (latencia y throughput)
+// Uso: BenchmarkRemote [url_base] [num_cortes] [tamaño]
+// Para medir solo el transporte: python app.py --standin
+// Si DenoiseWorker está en marcha se mide también la memoria compartida
+
+namespace {
+
+    double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Corte CT sintético en HU: cuerpo elíptico con ruido
+    cv::Mat syntheticSlice(int size, cv::RNG& rng) {
+        cv::Mat slice(size, size, CV_16S, cv::Scalar(-1000));
+        cv::ellipse(slice, cv::Point(size / 2, size / 2), cv::Size(size * 2 / 5, size / 3), 0, 0, 360,
+                    cv::Scalar(40), cv::FILLED);
+        cv::circle(slice, cv::Point(size / 2, size / 2 + size / 8), size / 20, cv::Scalar(700), cv::FILLED);
+        cv::Mat noise(slice.size(), CV_16S);
+        rng.fill(noise, cv::RNG::NORMAL, 0, 25);
+        return slice + noise;
+    }
+
+    void printRow(const std::string& mode, double totalMs, size_t slices) {
+        std::cout << "  " << std::left << std::setw(30) << mode
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << totalMs << " ms"
+                  << std::setw(10) << std::setprecision(2) << (slices * 1000.0 / totalMs) << " cortes/s" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string url = (argc > 1) ? argv[1] : "http://localhost:5000";
+    size_t numSlices = (argc > 2) ? static_cast<size_t>(std::stoi(argv[2])) : 32;
+    int size = (argc > 3) ? std::stoi(argv[3]) : 512;
+
+    cv::RNG rng(1234);
+    std::vector<cv::Mat> slices;
+    for (size_t i = 0; i < numSlices; i++) {
+        slices.push_back(syntheticSlice(size, rng));
+    }
+    std::cout << numSlices << " cortes CV_16S de " << size << "x" << size << std::endl;
+
+    Preprocessing::RemoteDenoiser client(url);
+    Preprocessing::ShmDenoiser shm;
+    const bool httpAvailable = client.ping();
+    const bool shmAvailable = shm.connect();
+    if (!httpAvailable && !shmAvailable) {
+        std::cerr << "Ni el servidor (" << url << ") ni DenoiseWorker responden" << std::endl;
+        return -1;
+    }
+    std::vector<cv::Mat> outputs;
+    std::vector<double> latencies;
+    std::chrono::high_resolution_clock::time_point start;
+    double totalMs = 0.0;
+
+    if (httpAvailable) {
+        // 1. Latencia: un corte por petición, secuencial (conexión reutilizada)
+        std::cout << "\n=== 1. HTTP: LATENCIA (un corte por petición) ===" << std::endl;
+        client.denoise(slices[0]);  // Calentamiento: abre la conexión
+        start = std::chrono::high_resolution_clock::now();
+        for (const cv::Mat& slice : slices) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            if (client.denoise(slice).empty()) {
+                std::cerr << "Petición fallida" << std::endl;
+                return -1;
+            }
+            latencies.push_back(elapsedMs(t0));
+        }
+        totalMs = elapsedMs(start);
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  p50: " << std::setprecision(2) << latencies[latencies.size() / 2] << " ms"
+                  << " | p95: " << latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)] << " ms"
+                  << " | max: " << latencies.back() << " ms" << std::endl;
+        printRow("Secuencial", totalMs, slices.size());
+
+        // 2. Throughput: peticiones concurrentes y lotes
+        std::cout << "\n=== 2. HTTP: THROUGHPUT ===" << std::endl;
+        for (int inFlight : {2, 4, 8}) {
+            start = std::chrono::high_resolution_clock::now();
+            bool ok = client.denoiseConcurrent(slices, outputs, inFlight);
+            totalMs = elapsedMs(start);
+            printRow("Concurrente (" + std::to_string(inFlight) + " en vuelo)" + (ok ? "" : " FALLO"),
+                     totalMs, slices.size());
+        }
+        for (int batch : {4, 8, 16}) {
+            start = std::chrono::high_resolution_clock::now();
+            bool ok = client.denoiseBatch(slices, outputs, batch, 2);
+            totalMs = elapsedMs(start);
+            printRow("Lotes de " + std::to_string(batch) + " (2 en vuelo)" + (ok ? "" : " FALLO"),
+                     totalMs, slices.size());
+        }
+    }
+
+    // 3. Memoria compartida con DenoiseWorker
+    if (shmAvailable) {
+        std::cout << "\n=== 3. MEMORIA COMPARTIDA (DenoiseWorker) ===" << std::endl;
+        shm.denoise(slices[0]);  // Calentamiento
+        latencies.clear();
+        start = std::chrono::high_resolution_clock::now();
+        for (const cv::Mat& slice : slices) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            if (shm.denoise(slice).empty()) {
+                std::cerr << "Petición al worker fallida" << std::endl;
+                return -1;
+            }
+            latencies.push_back(elapsedMs(t0));
+        }
+        totalMs = elapsedMs(start);
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  p50: " << std::setprecision(2) << latencies[latencies.size() / 2] << " ms"
+                  << " | p95: " << latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)] << " ms"
+                  << std::endl;
+        printRow("Secuencial", totalMs, slices.size());
+
+        start = std::chrono::high_resolution_clock::now();
+        bool ok = shm.denoiseBatch(slices, outputs);
+        totalMs = elapsedMs(start);
+        printRow(std::string("Todos los slots en vuelo") + (ok ? "" : " FALLO"), totalMs, slices.size());
+    }
+
+    // 4. Coste de serialización (sin red)
+    std::cout << "\n=== 4. SERIALIZACIÓN ===" << std::endl;
+    std::string body;
+    std::vector<cv::Mat> decoded;
+    start = std::chrono::high_resolution_clock::now();
+    Preprocessing::RemoteDenoiser::encodeFrames(slices, body);
+    Preprocessing::RemoteDenoiser::decodeFrames(body, decoded);
+    totalMs = elapsedMs(start);
+    printRow("Binario (codificar+decodificar)", totalMs, slices.size());
+    std::vector<uchar> png;
+    start = std::chrono::high_resolution_clock::now();
+    for (const cv::Mat& slice : slices) {
+        cv::Mat slice16u;
+        slice.convertTo(slice16u, CV_16U, 1.0, 32768.0);
+        cv::imencode(".png", slice16u, png);
+        cv::imdecode(png, cv::IMREAD_UNCHANGED);
+    }
+    totalMs = elapsedMs(start);
+    printRow("PNG (codificar+decodificar)", totalMs, slices.size());
+
+    return 0;
+}
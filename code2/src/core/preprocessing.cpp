@@ -53,20 +53,41 @@ namespace Preprocessing {
 
     // Implementar DnCNN
 
-    // Callback para recibir datos de CURL
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-        ((std::string*)userp)->append((char*)contents, size * nmemb);
-        return size * nmemb;
+    // Flask y el worker local admiten cortes de un canal de 8 bits o 16 bits con signo
+    static cv::Mat toTransportFormat(const cv::Mat& image) {
+        cv::Mat input = convertToGrayscale(image);
+        if (input.depth() != CV_8U && input.depth() != CV_16S) {
+            input = normalizeImage(input);
+        }
+        return input;
     }
 
-    DnCNNDenoiser::DnCNNDenoiser() : modelLoaded(false), useFlaskServer(false), flaskServerUrl("http://localhost:5000/denoise") {}
+    DnCNNDenoiser::DnCNNDenoiser() : modelLoaded(false), useFlaskServer(false) {}
 
     void DnCNNDenoiser::setFlaskServer(const std::string& url) {
-        flaskServerUrl = url;
+        remote = std::make_shared<RemoteDenoiser>(url);
         useFlaskServer = true;
         std::cout << "[INFO] DnCNN configurado para usar Flask server: " << url << std::endl;
     }
 
+    bool DnCNNDenoiser::setSharedMemoryWorker(const std::string& name) {
+        auto worker = std::make_shared<ShmDenoiser>();
+        if (!worker->connect(name)) {
+            shmWorker.reset();
+            return false;
+        }
+        shmWorker = worker;
+        std::cout << "[INFO] DnCNN configurado para usar el worker local: " << name << std::endl;
+        return true;
+    }
+
+    void DnCNNDenoiser::takeLocalModel(DnCNNDenoiser& other) {
+        net = std::move(other.net);
+        modelLoaded = other.modelLoaded;
+        other.net = cv::dnn::Net();
+        other.modelLoaded = false;
+    }
+
     bool DnCNNDenoiser::loadModel(const std::string& onnxPath) {
         try {
             std::ifstream f(onnxPath.c_str());
@@ -91,63 +112,36 @@ namespace Preprocessing {
         }
     }
 
-    cv::Mat DnCNNDenoiser::denoiseViaFlask(const cv::Mat& noisyImage) {
+    bool DnCNNDenoiser::warmUp(const cv::Size& size) {
+        if (!modelLoaded) return false;
         try {
-            // Codificar imagen a PNG en memoria
-            std::vector<uchar> buffer;
-            cv::imencode(".png", noisyImage, buffer);
-            
-            CURL* curl = curl_easy_init();
-            if (!curl) {
-                std::cerr << "No se pudo inicializar CURL" << std::endl;
-                return noisyImage.clone();
-            }
-            
-            // Preparar form data
-            curl_mime* form = curl_mime_init(curl);
-            curl_mimepart* field = curl_mime_addpart(form);
-            curl_mime_name(field, "image");
-            curl_mime_data(field, (const char*)buffer.data(), buffer.size());
-            curl_mime_filename(field, "image.png");
-            curl_mime_type(field, "image/png");
-            
-            // Configurar request
-            std::string responseBuffer;
-            curl_easy_setopt(curl, CURLOPT_URL, flaskServerUrl.c_str());
-            curl_easy_setopt(curl, CURLOPT_MIMEPOST, form);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBuffer);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-            
-            // Realizar request
-            CURLcode res = curl_easy_perform(curl);
-            
-            curl_mime_free(form);
-            curl_easy_cleanup(curl);
-            
-            if (res != CURLE_OK) {
-                std::cerr << "Flask request falló: " << curl_easy_strerror(res) << std::endl;
-                return noisyImage.clone();
-            }
-            
-            // Decodificar respuesta
-            std::vector<uchar> responseData(responseBuffer.begin(), responseBuffer.end());
-            cv::Mat denoised = cv::imdecode(responseData, cv::IMREAD_GRAYSCALE);
-            
-            if (denoised.empty()) {
-                std::cerr << "No se pudo decodificar la respuesta del servidor" << std::endl;
-                return noisyImage.clone();
-            }
-            
-            return denoised;
-            
+            // La primera inferencia reserva memoria e inicializa las capas
+            const int sizes[] = {1, 1, size.height, size.width};
+            cv::Mat blob(4, sizes, CV_32F, cv::Scalar(0));
+            net.setInput(blob);
+            net.forward();
+            return true;
         } catch (const std::exception& e) {
-            std::cerr << "[Excepción Flask]: " << e.what() << std::endl;
-            return noisyImage.clone();
+            std::cerr << "[Excepción DnCNN warm-up]: " << e.what() << std::endl;
+            return false;
         }
     }
 
-    cv::Mat DnCNNDenoiser::denoiseViaOpenCV(const cv::Mat& noisyImage) {
+    cv::Mat DnCNNDenoiser::denoiseViaFlask(const cv::Mat& noisyImage) {
+        // Mat vacío si falla, para que denoise() pase al fallback local
+        if (!remote) return cv::Mat();
+
+        return remote->denoise(toTransportFormat(noisyImage));
+    }
+
+    cv::Mat DnCNNDenoiser::denoiseViaSharedMemory(const cv::Mat& noisyImage) {
+        if (!shmWorker) return cv::Mat();
+
+        return shmWorker->denoise(toTransportFormat(noisyImage));
+    }
+
+    cv::Mat DnCNNDenoiser::denoiseViaOpenCV(const cv::Mat& noisyImage, bool* ok) {
+        if (ok) *ok = false;
         if (!modelLoaded) return noisyImage.clone();
 
         try {
@@ -210,6 +204,7 @@ namespace Preprocessing {
                 result = denoisedFloat;
             }
             
+            if (ok) *ok = true;
             return result;
             
         } catch (const std::exception& e) {
@@ -218,7 +213,23 @@ namespace Preprocessing {
         }
     }
 
+    cv::Mat DnCNNDenoiser::denoiseLocal(const cv::Mat& noisyImage) {
+        // Sin el fallback a la entrada: quien llama distingue el fallo
+        bool ok = false;
+        cv::Mat result = denoiseViaOpenCV(noisyImage, &ok);
+        return ok ? result : cv::Mat();
+    }
+
     cv::Mat DnCNNDenoiser::denoise(const cv::Mat& noisyImage) {
+        // intentar el worker local por memoria compartida
+        if (shmWorker) {
+            cv::Mat result = denoiseViaSharedMemory(noisyImage);
+            if (!result.empty()) {
+                return result;
+            }
+            std::cerr << "[!] Worker local no disponible, intentando Flask/OpenCV DNN..." << std::endl;
+        }
+        
         // intentar Flask Server
         if (useFlaskServer) {
             std::cout << "[INFO] Intentando denoising via Flask server..." << std::endl;
@@ -246,6 +257,38 @@ namespace Preprocessing {
         return noisyImage.clone();
     }
 
+    std::vector<cv::Mat> DnCNNDenoiser::denoiseBatch(const std::vector<cv::Mat>& noisyImages, int batchSize) {
+        std::vector<cv::Mat> results;
+        if (shmWorker) {
+            std::vector<cv::Mat> inputs;
+            inputs.reserve(noisyImages.size());
+            for (const cv::Mat& image : noisyImages) {
+                inputs.push_back(toTransportFormat(image));
+            }
+            if (shmWorker->denoiseBatch(inputs, results)) {
+                return results;
+            }
+            std::cerr << "[!] Lote via worker local falló" << std::endl;
+        }
+        if (useFlaskServer && remote) {
+            std::vector<cv::Mat> inputs;
+            inputs.reserve(noisyImages.size());
+            for (const cv::Mat& image : noisyImages) {
+                inputs.push_back(toTransportFormat(image));
+            }
+            if (remote->denoiseBatch(inputs, results, batchSize)) {
+                return results;
+            }
+            std::cerr << "[!] Lote via Flask falló, procesando corte a corte..." << std::endl;
+        }
+
+        results.clear();
+        for (const cv::Mat& image : noisyImages) {
+            results.push_back(modelLoaded ? denoiseViaOpenCV(image) : image.clone());
+        }
+        return results;
+    }
+
     // Aplicar DnCNN fácilmente
 
     cv::Mat applyDnCNN(const cv::Mat& noisyImage, const std::string& modelPath) {
@@ -5,7 +5,9 @@
 #include <opencv2/dnn.hpp>
 #include <string>
 #include <memory>
-#include <curl/curl.h>
+#include <vector>
+#include "remote_denoiser.h"
+#include "shm_denoiser.h"
 
 namespace Preprocessing {
 
@@ -23,11 +25,14 @@ namespace Preprocessing {
     private:
         cv::dnn::Net net;
         bool modelLoaded;
-        std::string flaskServerUrl;
+        std::shared_ptr<RemoteDenoiser> remote;  // Compartido entre copias (conexiones keep-alive)
         bool useFlaskServer;
+        std::shared_ptr<ShmDenoiser> shmWorker;  // Worker local por memoria compartida
         
         cv::Mat denoiseViaFlask(const cv::Mat& noisyImage);
-        cv::Mat denoiseViaOpenCV(const cv::Mat& noisyImage);
+        cv::Mat denoiseViaSharedMemory(const cv::Mat& noisyImage);
+        // ok (opcional) queda en false si se devuelve la entrada sin filtrar
+        cv::Mat denoiseViaOpenCV(const cv::Mat& noisyImage, bool* ok = nullptr);
         
     public:
         DnCNNDenoiser();
@@ -35,10 +40,27 @@ namespace Preprocessing {
         // Cargar el modelo .onnx (para fallback)
         bool loadModel(const std::string& onnxPath);
         
+        // Forward de calentamiento con un blob de ceros (tras loadModel)
+        bool warmUp(const cv::Size& size = cv::Size(512, 512));
+        
+        // URL base del servidor, p.ej. "http://localhost:5000"
         void setFlaskServer(const std::string& url);
+        // Conectar al proceso DenoiseWorker; tiene prioridad sobre Flask y OpenCV
+        bool setSharedMemoryWorker(const std::string& name = kDefaultShmName);
+        bool usesSharedMemoryWorker() const { return shmWorker != nullptr; }
         cv::Mat denoise(const cv::Mat& noisyImage);
+        // Varios cortes: un lote por petición al servidor, fallback local corte a corte
+        std::vector<cv::Mat> denoiseBatch(const std::vector<cv::Mat>& noisyImages, int batchSize = 8);
+        
+        // Inferencia con el modelo local, sin pasar por Flask ni el worker; Mat vacío si falla
+        cv::Mat denoiseLocal(const cv::Mat& noisyImage);
+        
+        // Toma solo el modelo local de otra instancia (p.ej. cargado en otro hilo);
+        // conserva la configuración de Flask y del worker de esta
+        void takeLocalModel(DnCNNDenoiser& other);
         
-        bool isLoaded() const { return modelLoaded || useFlaskServer; }
+        bool isLoaded() const { return modelLoaded || useFlaskServer || shmWorker != nullptr; }
+        bool isLocalModelLoaded() const { return modelLoaded; }
     };
 
     // Aplicar DnCNN fácilmente
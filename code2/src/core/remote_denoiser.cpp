@@ -0,0 +1,302 @@
+#include "remote_denoiser.h"
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace Preprocessing {
+
+    namespace {
+
+        const char kMagic[4] = {'D', 'N', 'R', '1'};
+
+        // Tope de peticiones simultáneas; también es el tamaño de la caché de conexiones
+        const int kMaxInFlight = 16;
+
+        // El protocolo es little-endian, igual que x86 y ARM: se copian los enteros tal cual
+        struct FrameHeader {
+            int32_t rows;
+            int32_t cols;
+            int32_t depth;
+            int32_t reserved;
+        };
+
+        size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+            ((std::string*)userp)->append((char*)contents, size * nmemb);
+            return size * nmemb;
+        }
+
+        std::once_flag curlInitFlag;
+
+    }
+
+    struct RemoteDenoiser::Transfer {
+        std::string url;
+        std::string body;           // vacío = GET
+        std::string response;
+        size_t first = 0;           // Índice del primer corte de la petición
+        size_t count = 0;
+        CURL* handle = nullptr;
+        CURLcode result = CURLE_OK;
+        long status = 0;
+    };
+
+    RemoteDenoiser::RemoteDenoiser(const std::string& baseUrl)
+        : baseUrl(baseUrl), connectTimeoutMs(1000), requestTimeoutMs(10000), multi(nullptr), headers(nullptr) {
+        std::call_once(curlInitFlag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        multi = curl_multi_init();
+        if (multi) {
+            // Una conexión abierta por petición simultánea, fijado una sola vez
+            curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(kMaxInFlight));
+        }
+        headers = curl_slist_append(headers, "Content-Type: application/octet-stream");
+        // Sin "Expect: 100-continue": ahorra un round-trip en cuerpos grandes
+        headers = curl_slist_append(headers, "Expect:");
+    }
+
+    RemoteDenoiser::~RemoteDenoiser() {
+        for (CURL* handle : idleHandles) {
+            curl_easy_cleanup(handle);
+        }
+        if (multi) curl_multi_cleanup(multi);
+        curl_slist_free_all(headers);
+    }
+
+    void RemoteDenoiser::setTimeouts(long connectMs, long requestMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        connectTimeoutMs = connectMs;
+        requestTimeoutMs = requestMs;
+    }
+
+    // Serialización
+
+    bool RemoteDenoiser::encodeFrames(const std::vector<cv::Mat>& images, std::string& body) {
+        size_t total = sizeof(kMagic) + sizeof(uint32_t);
+        for (const cv::Mat& image : images) {
+            if (image.empty() || image.channels() != 1 ||
+                (image.depth() != CV_8U && image.depth() != CV_16S)) {
+                std::cerr << "[RemoteDenoiser] Solo se admiten cortes de un canal CV_8U o CV_16S" << std::endl;
+                return false;
+            }
+            total += sizeof(FrameHeader) + image.total() * image.elemSize();
+        }
+
+        body.clear();
+        body.reserve(total);
+        const uint32_t count = static_cast<uint32_t>(images.size());
+        body.append(kMagic, sizeof(kMagic));
+        body.append(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const cv::Mat& image : images) {
+            const FrameHeader header = {image.rows, image.cols, image.depth(), 0};
+            body.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            const size_t rowBytes = image.cols * image.elemSize();
+            for (int y = 0; y < image.rows; y++) {
+                body.append(reinterpret_cast<const char*>(image.ptr(y)), rowBytes);
+            }
+        }
+        return true;
+    }
+
+    bool RemoteDenoiser::decodeFrames(const std::string& body, std::vector<cv::Mat>& images) {
+        images.clear();
+        size_t offset = sizeof(kMagic) + sizeof(uint32_t);
+        if (body.size() < offset || std::memcmp(body.data(), kMagic, sizeof(kMagic)) != 0) {
+            return false;
+        }
+        uint32_t count = 0;
+        std::memcpy(&count, body.data() + sizeof(kMagic), sizeof(count));
+
+        for (uint32_t i = 0; i < count; i++) {
+            FrameHeader header;
+            if (body.size() < offset + sizeof(header)) return false;
+            std::memcpy(&header, body.data() + offset, sizeof(header));
+            offset += sizeof(header);
+
+            if (header.rows <= 0 || header.cols <= 0 ||
+                (header.depth != CV_8U && header.depth != CV_16S)) {
+                return false;
+            }
+            cv::Mat image(header.rows, header.cols, CV_MAKETYPE(header.depth, 1));
+            const size_t bytes = image.total() * image.elemSize();
+            if (body.size() < offset + bytes) return false;
+            std::memcpy(image.data, body.data() + offset, bytes);
+            offset += bytes;
+            images.push_back(image);
+        }
+        return true;
+    }
+
+    // Transferencias
+
+    CURL* RemoteDenoiser::acquireHandle() {
+        if (!idleHandles.empty()) {
+            CURL* handle = idleHandles.back();
+            idleHandles.pop_back();
+            return handle;
+        }
+        return curl_easy_init();
+    }
+
+    void RemoteDenoiser::releaseHandle(CURL* handle) {
+        // reset conserva las conexiones abiertas; las opciones se vuelven a fijar en cada petición
+        curl_easy_reset(handle);
+        idleHandles.push_back(handle);
+    }
+
+    bool RemoteDenoiser::perform(std::vector<Transfer>& transfers, int maxInFlight) {
+        if (!multi) return false;
+        maxInFlight = std::min(kMaxInFlight, std::max(1, maxInFlight));
+
+        size_t next = 0;
+        int active = 0;
+        auto start = [&](Transfer& t) {
+            t.handle = acquireHandle();
+            if (!t.handle) {
+                t.result = CURLE_FAILED_INIT;
+                return false;
+            }
+            curl_easy_setopt(t.handle, CURLOPT_URL, t.url.c_str());
+            if (!t.body.empty()) {
+                curl_easy_setopt(t.handle, CURLOPT_POSTFIELDS, t.body.data());
+                curl_easy_setopt(t.handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(t.body.size()));
+                curl_easy_setopt(t.handle, CURLOPT_HTTPHEADER, headers);
+            }
+            curl_easy_setopt(t.handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+            curl_easy_setopt(t.handle, CURLOPT_WRITEDATA, &t.response);
+            curl_easy_setopt(t.handle, CURLOPT_PRIVATE, &t);
+            curl_easy_setopt(t.handle, CURLOPT_CONNECTTIMEOUT_MS, connectTimeoutMs);
+            curl_easy_setopt(t.handle, CURLOPT_TIMEOUT_MS, requestTimeoutMs);
+            curl_easy_setopt(t.handle, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(t.handle, CURLOPT_NOSIGNAL, 1L);
+            curl_multi_add_handle(multi, t.handle);
+            return true;
+        };
+        auto fill = [&]() {
+            while (next < transfers.size() && active < maxInFlight) {
+                if (start(transfers[next++])) active++;
+            }
+        };
+
+        fill();
+        bool multiError = false;
+        while (active > 0) {
+            int running = 0;
+            if (curl_multi_perform(multi, &running) != CURLM_OK) {
+                multiError = true;
+                break;
+            }
+
+            CURLMsg* msg;
+            int queued = 0;
+            while ((msg = curl_multi_info_read(multi, &queued))) {
+                if (msg->msg != CURLMSG_DONE) continue;
+                CURL* handle = msg->easy_handle;
+                Transfer* t = nullptr;
+                curl_easy_getinfo(handle, CURLINFO_PRIVATE, reinterpret_cast<char**>(&t));
+                t->result = msg->data.result;
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &t->status);
+                curl_multi_remove_handle(multi, handle);
+                releaseHandle(handle);
+                t->handle = nullptr;
+                active--;
+            }
+            fill();
+
+            if (active > 0) {
+                curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+            }
+        }
+
+        if (multiError) {
+            for (Transfer& t : transfers) {
+                if (t.handle) {
+                    curl_multi_remove_handle(multi, t.handle);
+                    releaseHandle(t.handle);
+                    t.handle = nullptr;
+                }
+            }
+            std::cerr << "[RemoteDenoiser] Error en el handle multi de CURL" << std::endl;
+            return false;
+        }
+
+        bool ok = next == transfers.size();
+        for (const Transfer& t : transfers) {
+            if (t.result != CURLE_OK) {
+                std::cerr << "[RemoteDenoiser] Petición falló: " << curl_easy_strerror(t.result) << std::endl;
+                ok = false;
+            } else if (t.status != 200) {
+                std::cerr << "[RemoteDenoiser] El servidor respondió HTTP " << t.status << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    bool RemoteDenoiser::run(const std::string& endpoint, const std::vector<cv::Mat>& images,
+                             std::vector<cv::Mat>& outputs, int framesPerRequest, int maxInFlight) {
+        outputs.assign(images.size(), cv::Mat());
+        if (images.empty()) return true;
+        framesPerRequest = std::max(1, framesPerRequest);
+
+        std::vector<Transfer> transfers;
+        transfers.reserve((images.size() + framesPerRequest - 1) / framesPerRequest);
+        for (size_t first = 0; first < images.size(); first += framesPerRequest) {
+            const size_t count = std::min(images.size() - first, static_cast<size_t>(framesPerRequest));
+            std::vector<cv::Mat> chunk(images.begin() + first, images.begin() + first + count);
+
+            Transfer t;
+            t.url = baseUrl + endpoint;
+            t.first = first;
+            t.count = count;
+            if (!encodeFrames(chunk, t.body)) return false;
+            transfers.push_back(std::move(t));
+        }
+
+        bool ok;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ok = perform(transfers, maxInFlight);
+        }
+
+        std::vector<cv::Mat> frames;
+        for (const Transfer& t : transfers) {
+            if (t.result != CURLE_OK || t.status != 200) continue;
+            if (!decodeFrames(t.response, frames) || frames.size() != t.count) {
+                std::cerr << "[RemoteDenoiser] Respuesta con formato inválido" << std::endl;
+                ok = false;
+                continue;
+            }
+            for (size_t i = 0; i < t.count; i++) {
+                outputs[t.first + i] = frames[i];
+            }
+        }
+        return ok;
+    }
+
+    cv::Mat RemoteDenoiser::denoise(const cv::Mat& image) {
+        std::vector<cv::Mat> outputs;
+        if (!run("/denoise_raw", {image}, outputs, 1, 1)) {
+            return cv::Mat();
+        }
+        return outputs[0];
+    }
+
+    bool RemoteDenoiser::denoiseConcurrent(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                                           int maxInFlight) {
+        return run("/denoise_raw", images, outputs, 1, maxInFlight);
+    }
+
+    bool RemoteDenoiser::denoiseBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                                      int batchSize, int maxInFlight) {
+        return run("/denoise_batch", images, outputs, batchSize, maxInFlight);
+    }
+
+    bool RemoteDenoiser::ping() {
+        std::vector<Transfer> transfers(1);
+        transfers[0].url = baseUrl + "/health";
+        std::lock_guard<std::mutex> lock(mutex);
+        return perform(transfers, 1);
+    }
+
+}
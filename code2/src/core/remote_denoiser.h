@@ -0,0 +1,77 @@
+#ifndef REMOTE_DENOISER_H
+#define REMOTE_DENOISER_H
+
+#include <opencv2/opencv.hpp>
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace Preprocessing {
+
+    // Cliente HTTP del servidor de denoising (src/server/app.py)
+    //
+    // Protocolo binario (application/octet-stream, little-endian):
+    //   cabecera: "DNR1" + uint32 numero_de_cortes
+    //   por corte: int32 filas, int32 columnas, int32 depth (CV_8U o CV_16S), int32 reservado
+    //              + píxeles en crudo (filas * columnas * bytes_por_pixel)
+    // La respuesta usa el mismo formato. Endpoints: /denoise_raw (un corte) y
+    // /denoise_batch (varios cortes en un solo forward).
+    //
+    // Un handle multi de CURL mantiene las conexiones keep-alive entre llamadas
+    // y permite varias peticiones en vuelo a la vez. Seguro desde varios hilos
+    // (las transferencias se serializan con un mutex).
+    class RemoteDenoiser {
+    public:
+        // baseUrl: p.ej. "http://localhost:5000" (sin endpoint)
+        explicit RemoteDenoiser(const std::string& baseUrl);
+        ~RemoteDenoiser();
+
+        RemoteDenoiser(const RemoteDenoiser&) = delete;
+        RemoteDenoiser& operator=(const RemoteDenoiser&) = delete;
+
+        // Un corte por petición (/denoise_raw). Devuelve Mat vacío si falla.
+        cv::Mat denoise(const cv::Mat& image);
+
+        // Un corte por petición, hasta maxInFlight peticiones simultáneas (máx. 16)
+        bool denoiseConcurrent(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                               int maxInFlight = 4);
+
+        // batchSize cortes por petición (/denoise_batch), hasta maxInFlight lotes simultáneos
+        bool denoiseBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                          int batchSize = 8, int maxInFlight = 2);
+
+        // Comprueba que el servidor responde (GET /health)
+        bool ping();
+
+        void setTimeouts(long connectMs, long requestMs);
+        const std::string& getBaseUrl() const { return baseUrl; }
+
+        // Serialización del protocolo (públicas para poder probarlas sin servidor)
+        static bool encodeFrames(const std::vector<cv::Mat>& images, std::string& body);
+        static bool decodeFrames(const std::string& body, std::vector<cv::Mat>& images);
+
+    private:
+        struct Transfer;
+
+        CURL* acquireHandle();
+        void releaseHandle(CURL* handle);
+        // Ejecuta las transferencias en el handle multi; true si todas devolvieron 200
+        bool perform(std::vector<Transfer>& transfers, int maxInFlight);
+        // Divide images en peticiones de framesPerRequest cortes y las ejecuta
+        bool run(const std::string& endpoint, const std::vector<cv::Mat>& images,
+                 std::vector<cv::Mat>& outputs, int framesPerRequest, int maxInFlight);
+
+        std::string baseUrl;
+        long connectTimeoutMs;
+        long requestTimeoutMs;
+
+        CURLM* multi;
+        curl_slist* headers;
+        std::vector<CURL*> idleHandles;
+        std::mutex mutex;
+    };
+
+}
+
+#endif // REMOTE_DENOISER_H
@@ -0,0 +1,442 @@
+#include "shm_denoiser.h"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#endif
+
+namespace Preprocessing {
+
+    const char* const kDefaultShmName = "/medvision_denoise";
+
+#ifdef __linux__
+
+    namespace {
+
+        const uint32_t kMagic = 0x4D485344;    // "DSHM"
+        const uint32_t kVersion = 2;
+        const int kMaxSlots = 64;
+        const size_t kAlign = 64;              // Línea de caché
+
+        // Ciclo de vida de un slot
+        enum SlotState : uint32_t {
+            SLOT_FREE = 0,
+            SLOT_CLAIMED = 1,       // Reservado por el cliente, rellenándose
+            SLOT_SUBMITTED = 2,     // En el anillo o en proceso en el worker
+            SLOT_DONE = 3,
+            SLOT_FAILED = 4,
+            SLOT_ABANDONED = 5      // El cliente dejó de esperar; el worker lo libera al terminar
+        };
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "Los futex necesitan atómicos de 32 bits sin lock");
+
+        struct SegmentHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t slotCount;
+            int32_t workerPid;
+            uint64_t slotStride;        // Bytes por slot (cabecera + píxeles), múltiplo de kAlign
+            uint64_t maxPixelBytes;
+            alignas(kAlign) std::atomic<uint32_t> submitHead;   // Posiciones reservadas por los clientes (palabra futex)
+            alignas(kAlign) std::atomic<uint32_t> submitTail;   // Escribe el worker
+            std::atomic<uint32_t> stop;
+            // Índice del slot + 1 en cada posición; 0 = reservada pero aún sin escribir
+            std::atomic<uint32_t> ring[kMaxSlots];
+        };
+
+        struct SlotHeader {
+            std::atomic<uint32_t> state;    // Palabra futex de la respuesta
+            int32_t rows;
+            int32_t cols;
+            int32_t depth;
+        };
+
+        size_t roundUp(size_t value) {
+            return (value + kAlign - 1) / kAlign * kAlign;
+        }
+
+        const size_t kHeaderBytes = roundUp(sizeof(SegmentHeader));
+        const size_t kSlotHeaderBytes = roundUp(sizeof(SlotHeader));
+
+        SegmentHeader* header(void* base) {
+            return static_cast<SegmentHeader*>(base);
+        }
+
+        SlotHeader* slotAt(void* base, int index) {
+            return reinterpret_cast<SlotHeader*>(static_cast<char*>(base) + kHeaderBytes +
+                                                 index * header(base)->slotStride);
+        }
+
+        uchar* slotPixels(SlotHeader* slot) {
+            return reinterpret_cast<uchar*>(slot) + kSlotHeaderBytes;
+        }
+
+        // Futex compartidos entre procesos (sin FUTEX_PRIVATE_FLAG)
+        void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+            timespec timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+        }
+
+        void futexWake(std::atomic<uint32_t>* word) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        bool supportedDepth(int depth) {
+            return depth == CV_8U || depth == CV_16S;
+        }
+
+    }
+
+    // Cliente
+
+    ShmDenoiser::ShmDenoiser() : base(nullptr), mappedBytes(0) {}
+
+    ShmDenoiser::~ShmDenoiser() {
+        disconnect();
+    }
+
+    bool ShmDenoiser::connect(const std::string& name) {
+        disconnect();
+
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kHeaderBytes) {
+            close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "[ShmDenoiser] mmap falló: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        SegmentHeader* h = header(mapped);
+        if (h->magic != kMagic || h->version != kVersion || h->slotCount == 0 || h->slotCount > kMaxSlots) {
+            std::cerr << "[ShmDenoiser] Segmento " << name << " con formato incompatible" << std::endl;
+            munmap(mapped, info.st_size);
+            return false;
+        }
+
+        base = mapped;
+        mappedBytes = info.st_size;
+        if (!workerAlive()) {
+            std::cerr << "[ShmDenoiser] El worker del segmento " << name << " no está en marcha" << std::endl;
+            disconnect();
+            return false;
+        }
+        std::cout << "[INFO] Conectado al worker de denoising (" << h->slotCount << " slots, pid "
+                  << h->workerPid << ")" << std::endl;
+        return true;
+    }
+
+    void ShmDenoiser::disconnect() {
+        if (base) {
+            munmap(base, mappedBytes);
+            base = nullptr;
+            mappedBytes = 0;
+        }
+    }
+
+    bool ShmDenoiser::workerAlive() const {
+        if (!base) return false;
+        const pid_t pid = header(base)->workerPid;
+        return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM) && header(base)->stop.load() == 0;
+    }
+
+    ShmDenoiser::Slot ShmDenoiser::acquire(int rows, int cols, int depth) {
+        Slot slot;
+        if (!base || !supportedDepth(depth) || rows <= 0 || cols <= 0) return slot;
+
+        SegmentHeader* h = header(base);
+        const size_t bytes = static_cast<size_t>(rows) * cols * (depth == CV_8U ? 1 : 2);
+        if (bytes > h->maxPixelBytes) {
+            std::cerr << "[ShmDenoiser] Corte de " << cols << "x" << rows << " no cabe en un slot" << std::endl;
+            return slot;
+        }
+
+        for (uint32_t i = 0; i < h->slotCount; i++) {
+            SlotHeader* s = slotAt(base, i);
+            uint32_t expected = SLOT_FREE;
+            if (s->state.compare_exchange_strong(expected, SLOT_CLAIMED, std::memory_order_acquire)) {
+                s->rows = rows;
+                s->cols = cols;
+                s->depth = depth;
+                slot.index = static_cast<int>(i);
+                slot.pixels = cv::Mat(rows, cols, CV_MAKETYPE(depth, 1), slotPixels(s));
+                return slot;
+            }
+        }
+        return slot;
+    }
+
+    bool ShmDenoiser::submit(Slot& slot) {
+        if (!base || slot.index < 0) return false;
+        SegmentHeader* h = header(base);
+        slotAt(base, slot.index)->state.store(SLOT_SUBMITTED, std::memory_order_release);
+
+        // Varios clientes (hilos o procesos) pueden enviar a la vez: cada uno
+        // reserva su posición con fetch_add y después la rellena. Cada slot está
+        // como mucho una vez en el anillo, así que nunca se desborda
+        const uint32_t head = h->submitHead.fetch_add(1, std::memory_order_acq_rel);
+        std::atomic<uint32_t>& entry = h->ring[head % h->slotCount];
+        entry.store(static_cast<uint32_t>(slot.index) + 1, std::memory_order_release);
+        futexWake(&h->submitHead);
+        futexWake(&entry);
+        return true;
+    }
+
+    bool ShmDenoiser::wait(Slot& slot, int timeoutMs) {
+        if (!base || slot.index < 0) return false;
+        SlotHeader* s = slotAt(base, slot.index);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (true) {
+            const uint32_t state = s->state.load(std::memory_order_acquire);
+            if (state == SLOT_DONE) return true;
+            if (state == SLOT_FAILED) return false;
+
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                std::cerr << "[ShmDenoiser] Timeout esperando al worker" << std::endl;
+                return false;
+            }
+            if (!workerAlive()) {
+                std::cerr << "[ShmDenoiser] El worker terminó" << std::endl;
+                return false;
+            }
+            // Despertar periódicamente para detectar la muerte del worker
+            futexWait(&s->state, state, static_cast<int>(std::min<long long>(remaining, 500)));
+        }
+    }
+
+    void ShmDenoiser::release(Slot& slot) {
+        if (base && slot.index >= 0) {
+            SlotHeader* s = slotAt(base, slot.index);
+            uint32_t expected = SLOT_SUBMITTED;
+            if (!s->state.compare_exchange_strong(expected, SLOT_ABANDONED, std::memory_order_acq_rel)) {
+                s->state.store(SLOT_FREE, std::memory_order_release);
+            }
+        }
+        slot.index = -1;
+        slot.pixels.release();
+    }
+
+    cv::Mat ShmDenoiser::denoise(const cv::Mat& image, int timeoutMs) {
+        if (image.channels() != 1 || !supportedDepth(image.depth())) return cv::Mat();
+
+        Slot slot = acquire(image.rows, image.cols, image.depth());
+        if (slot.index < 0) return cv::Mat();
+
+        image.copyTo(slot.pixels);
+        cv::Mat result;
+        if (submit(slot) && wait(slot, timeoutMs)) {
+            result = slot.pixels.clone();
+        }
+        release(slot);
+        return result;
+    }
+
+    bool ShmDenoiser::denoiseBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                                   int timeoutMs) {
+        outputs.assign(images.size(), cv::Mat());
+        bool ok = true;
+
+        // Cola de cortes en vuelo; se recogen en orden de envío
+        std::vector<std::pair<size_t, Slot>> inFlight;
+        size_t oldest = 0;
+        auto collectOldest = [&]() {
+            auto& entry = inFlight[oldest++];
+            if (wait(entry.second, timeoutMs)) {
+                outputs[entry.first] = entry.second.pixels.clone();
+            } else {
+                ok = false;
+            }
+            release(entry.second);
+        };
+
+        for (size_t i = 0; i < images.size() && ok; i++) {
+            const cv::Mat& image = images[i];
+            if (image.channels() != 1 || !supportedDepth(image.depth())) {
+                ok = false;
+                break;
+            }
+            Slot slot = acquire(image.rows, image.cols, image.depth());
+            while (slot.index < 0 && oldest < inFlight.size()) {
+                collectOldest();
+                slot = acquire(image.rows, image.cols, image.depth());
+            }
+            if (slot.index < 0) {
+                ok = false;
+                break;
+            }
+            image.copyTo(slot.pixels);
+            submit(slot);
+            inFlight.push_back({i, slot});
+        }
+        while (oldest < inFlight.size()) {
+            collectOldest();
+        }
+        return ok;
+    }
+
+    // Worker
+
+    ShmWorkerSegment::ShmWorkerSegment() : base(nullptr), mappedBytes(0) {}
+
+    ShmWorkerSegment::~ShmWorkerSegment() {
+        if (base) {
+            requestStop();
+            munmap(base, mappedBytes);
+            shm_unlink(name.c_str());
+        }
+    }
+
+    bool ShmWorkerSegment::create(const std::string& segmentName, int slots, size_t maxPixelBytes) {
+        if (slots <= 0 || slots > kMaxSlots) {
+            std::cerr << "[DenoiseWorker] Número de slots inválido (1-" << kMaxSlots << ")" << std::endl;
+            return false;
+        }
+        name = segmentName;
+        const size_t stride = kSlotHeaderBytes + roundUp(maxPixelBytes);
+        const size_t total = kHeaderBytes + stride * slots;
+
+        // Un segmento de una ejecución anterior se descarta
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            std::cerr << "[DenoiseWorker] shm_open falló: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        // ftruncate deja el segmento a cero: todos los slots empiezan libres
+        if (ftruncate(fd, total) != 0) {
+            std::cerr << "[DenoiseWorker] ftruncate falló: " << std::strerror(errno) << std::endl;
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        void* mapped = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "[DenoiseWorker] mmap falló: " << std::strerror(errno) << std::endl;
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        base = mapped;
+        mappedBytes = total;
+        SegmentHeader* h = header(base);
+        h->version = kVersion;
+        h->slotCount = static_cast<uint32_t>(slots);
+        h->workerPid = getpid();
+        h->slotStride = stride;
+        h->maxPixelBytes = maxPixelBytes;
+        // La firma se escribe al final: un cliente nunca ve un segmento a medio inicializar
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = kMagic;
+        return true;
+    }
+
+    int ShmWorkerSegment::next(int timeoutMs) {
+        if (!base) return -1;
+        SegmentHeader* h = header(base);
+
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (h->stop.load(std::memory_order_acquire)) return -1;
+            const uint32_t tail = h->submitTail.load(std::memory_order_relaxed);
+            const uint32_t head = h->submitHead.load(std::memory_order_acquire);
+            if (head != tail) {
+                // La posición puede estar reservada y aún sin escribir
+                std::atomic<uint32_t>& entry = h->ring[tail % h->slotCount];
+                uint32_t value = entry.load(std::memory_order_acquire);
+                while (value == 0) {
+                    if (h->stop.load(std::memory_order_acquire)) return -1;
+                    futexWait(&entry, 0, 100);
+                    value = entry.load(std::memory_order_acquire);
+                }
+                entry.store(0, std::memory_order_relaxed);
+                h->submitTail.store(tail + 1, std::memory_order_release);
+                return static_cast<int>(value - 1);
+            }
+            if (attempt == 0) {
+                futexWait(&h->submitHead, head, timeoutMs);
+            }
+        }
+        return -1;
+    }
+
+    cv::Mat ShmWorkerSegment::pixels(int index) {
+        SlotHeader* s = slotAt(base, index);
+        return cv::Mat(s->rows, s->cols, CV_MAKETYPE(s->depth, 1), slotPixels(s));
+    }
+
+    void ShmWorkerSegment::complete(int index, bool ok) {
+        SlotHeader* s = slotAt(base, index);
+        uint32_t expected = SLOT_SUBMITTED;
+        if (!s->state.compare_exchange_strong(expected, ok ? SLOT_DONE : SLOT_FAILED, std::memory_order_release)) {
+            // El cliente abandonó el slot: queda libre para otro envío
+            s->state.store(SLOT_FREE, std::memory_order_release);
+        }
+        futexWake(&s->state);
+    }
+
+    void ShmWorkerSegment::requestStop() {
+        if (!base) return;
+        header(base)->stop.store(1, std::memory_order_release);
+        futexWake(&header(base)->submitHead);
+    }
+
+    bool ShmWorkerSegment::stopRequested() const {
+        return !base || header(base)->stop.load(std::memory_order_acquire) != 0;
+    }
+
+#else
+
+    // Sin POSIX shm/futex: el transporte no está disponible y se usan Flask u OpenCV
+
+    ShmDenoiser::ShmDenoiser() : base(nullptr), mappedBytes(0) {}
+    ShmDenoiser::~ShmDenoiser() {}
+    bool ShmDenoiser::connect(const std::string&) {
+        std::cerr << "[ShmDenoiser] Memoria compartida solo disponible en Linux" << std::endl;
+        return false;
+    }
+    void ShmDenoiser::disconnect() {}
+    bool ShmDenoiser::workerAlive() const { return false; }
+    ShmDenoiser::Slot ShmDenoiser::acquire(int, int, int) { return Slot(); }
+    bool ShmDenoiser::submit(Slot&) { return false; }
+    bool ShmDenoiser::wait(Slot&, int) { return false; }
+    void ShmDenoiser::release(Slot& slot) { slot.index = -1; slot.pixels.release(); }
+    cv::Mat ShmDenoiser::denoise(const cv::Mat&, int) { return cv::Mat(); }
+    bool ShmDenoiser::denoiseBatch(const std::vector<cv::Mat>&, std::vector<cv::Mat>&, int) { return false; }
+
+    ShmWorkerSegment::ShmWorkerSegment() : base(nullptr), mappedBytes(0) {}
+    ShmWorkerSegment::~ShmWorkerSegment() {}
+    bool ShmWorkerSegment::create(const std::string&, int, size_t) { return false; }
+    int ShmWorkerSegment::next(int) { return -1; }
+    cv::Mat ShmWorkerSegment::pixels(int) { return cv::Mat(); }
+    void ShmWorkerSegment::complete(int, bool) {}
+    void ShmWorkerSegment::requestStop() {}
+    bool ShmWorkerSegment::stopRequested() const { return true; }
+
+#endif
+
+}
@@ -0,0 +1,96 @@
+#ifndef SHM_DENOISER_H
+#define SHM_DENOISER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace Preprocessing {
+
+    // Transporte por memoria compartida con el proceso DenoiseWorker (solo Linux)
+    //
+    // El worker crea un segmento POSIX (shm_open) con N slots de píxeles y un
+    // anillo de envíos. El cliente escribe el corte directamente en un slot,
+    // publica su índice en el anillo (la posición se reserva con un fetch_add
+    // atómico, así que varios clientes pueden compartir el worker) y espera
+    // con un futex sobre el estado del slot; el worker deja la salida en el
+    // mismo slot. No hay codificación ni copias por socket: la única copia es
+    // la que hace el llamador al rellenar el slot (ninguna si usa acquire() y
+    // escribe en Slot::pixels).
+
+    // Nombre por defecto del segmento
+    extern const char* const kDefaultShmName;
+
+    // Lado del cliente (MedicalApp)
+    class ShmDenoiser {
+    public:
+        // Vista de un slot: pixels apunta a la memoria compartida
+        struct Slot {
+            int index = -1;
+            cv::Mat pixels;
+        };
+
+        ShmDenoiser();
+        ~ShmDenoiser();
+
+        ShmDenoiser(const ShmDenoiser&) = delete;
+        ShmDenoiser& operator=(const ShmDenoiser&) = delete;
+
+        // Conectar a un worker en marcha; false si no existe el segmento o el worker no vive
+        bool connect(const std::string& name = kDefaultShmName);
+        void disconnect();
+        bool isConnected() const { return base != nullptr; }
+
+        // API sin copias: reservar slot, escribir en pixels, enviar y esperar
+        Slot acquire(int rows, int cols, int depth);
+        bool submit(Slot& slot);
+        // Tras wait() con éxito, pixels contiene la salida (en el mismo buffer)
+        bool wait(Slot& slot, int timeoutMs = 10000);
+        void release(Slot& slot);
+
+        // Copia de entrada y de salida; Mat vacío si falla
+        cv::Mat denoise(const cv::Mat& image, int timeoutMs = 10000);
+        // Envía tantos cortes como slots libres y los recoge en orden
+        bool denoiseBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs,
+                          int timeoutMs = 10000);
+
+    private:
+        bool workerAlive() const;
+
+        void* base;
+        size_t mappedBytes;
+    };
+
+    // Lado del worker (DenoiseWorker)
+    class ShmWorkerSegment {
+    public:
+        ShmWorkerSegment();
+        ~ShmWorkerSegment();
+
+        ShmWorkerSegment(const ShmWorkerSegment&) = delete;
+        ShmWorkerSegment& operator=(const ShmWorkerSegment&) = delete;
+
+        // Crea (o recrea) el segmento con slots de hasta maxPixelBytes
+        bool create(const std::string& name, int slots, size_t maxPixelBytes);
+
+        // Espera el siguiente envío; -1 si vence el timeout o se pidió parar
+        int next(int timeoutMs);
+        // Vista del slot recibido (entrada; la salida se escribe encima)
+        cv::Mat pixels(int index);
+        // Marca el slot como terminado y despierta al cliente
+        void complete(int index, bool ok);
+
+        // Pide al bucle del worker que termine (p.ej. desde un manejador de señal)
+        void requestStop();
+        bool stopRequested() const;
+
+    private:
+        std::string name;
+        void* base;
+        size_t mappedBytes;
+    };
+
+}
+
+#endif // SHM_DENOISER_H
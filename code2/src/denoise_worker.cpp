@@ -0,0 +1,69 @@
+#include <iostream>
+#include <string>
+#include <csignal>
+#include <opencv2/opencv.hpp>
+
+#include "core/preprocessing.h"
+#include "core/shm_denoiser.h"
+
+// Worker local de denoising por memoria compartida
+// Uso: DenoiseWorker <modelo.onnx> [nombre_segmento] [slots] [lado_max]
+// MedicalApp se conecta al arrancar si el worker ya está en marcha.
+
+namespace {
+
+    volatile std::sig_atomic_t stopFlag = 0;
+
+    void onSignal(int) {
+        stopFlag = 1;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <modelo.onnx> [nombre_segmento] [slots] [lado_max]" << std::endl;
+        return -1;
+    }
+    std::string modelPath = argv[1];
+    std::string name = (argc > 2) ? argv[2] : Preprocessing::kDefaultShmName;
+    int slots = (argc > 3) ? std::stoi(argv[3]) : 8;
+    int maxSide = (argc > 4) ? std::stoi(argv[4]) : 1024;
+
+    Preprocessing::DnCNNDenoiser denoiser;
+    if (!denoiser.loadModel(modelPath) || !denoiser.warmUp()) {
+        std::cerr << "No se pudo cargar el modelo: " << modelPath << std::endl;
+        return -1;
+    }
+
+    // Slots dimensionados para cortes de 16 bits de hasta lado_max x lado_max
+    Preprocessing::ShmWorkerSegment segment;
+    if (!segment.create(name, slots, static_cast<size_t>(maxSide) * maxSide * sizeof(short))) {
+        return -1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::cout << "[✓] DenoiseWorker escuchando en " << name << " (" << slots << " slots de hasta "
+              << maxSide << "x" << maxSide << ")" << std::endl;
+
+    size_t processed = 0;
+    while (!stopFlag && !segment.stopRequested()) {
+        int index = segment.next(500);
+        if (index < 0) continue;
+
+        // La entrada está en el slot; la salida se escribe encima. Si la
+        // inferencia falla el slot queda como fallido, no con la entrada
+        cv::Mat pixels = segment.pixels(index);
+        cv::Mat denoised = denoiser.denoiseLocal(pixels);
+        bool ok = !denoised.empty() && denoised.size() == pixels.size() && denoised.type() == pixels.type();
+        if (ok) {
+            denoised.copyTo(pixels);
+        }
+        segment.complete(index, ok);
+        processed++;
+    }
+
+    std::cout << "DenoiseWorker terminado (" << processed << " cortes procesados)" << std::endl;
+    return 0;
+}
@@ -1,16 +1,123 @@
-from flask import Flask, request, jsonify, send_file
+from flask import Flask, request, jsonify, send_file, Response
+from werkzeug.serving import WSGIRequestHandler
 import cv2
 import numpy as np
 import io
+import os
+import struct
+import sys
+import threading
 
 app = Flask(__name__)
 
-net = cv2.dnn.readNetFromONNX("../models/dncnn_grayscale.onnx")
-net.setPreferableBackend(cv2.dnn.DNN_BACKEND_OPENCV)
-net.setPreferableTarget(cv2.dnn.DNN_TARGET_CPU)
+# Modo stand-in: devuelve los cortes sin tocar (para probar el transporte sin modelo)
+STANDIN = "--standin" in sys.argv or os.environ.get("DENOISE_STANDIN") == "1"
+
+net = None
+if not STANDIN:
+    net = cv2.dnn.readNetFromONNX("../models/dncnn_grayscale.onnx")
+    net.setPreferableBackend(cv2.dnn.DNN_BACKEND_OPENCV)
+    net.setPreferableTarget(cv2.dnn.DNN_TARGET_CPU)
+
+# cv2.dnn.Net no es seguro entre hilos: un forward a la vez
+net_lock = threading.Lock()
+
+# Protocolo binario (ver src/core/remote_denoiser.h)
+MAGIC = b"DNR1"
+FRAME_HEADER = struct.Struct("<iiii")   # filas, columnas, depth, reservado
+DEPTH_TO_DTYPE = {0: np.uint8, 3: np.int16}   # CV_8U, CV_16S
+
+
+def decode_frames(body):
+    if len(body) < 8 or body[:4] != MAGIC:
+        raise ValueError("Cabecera inválida")
+    (count,) = struct.unpack_from("<I", body, 4)
+    offset = 8
+    frames = []
+    for _ in range(count):
+        rows, cols, depth, _ = FRAME_HEADER.unpack_from(body, offset)
+        offset += FRAME_HEADER.size
+        dtype = DEPTH_TO_DTYPE.get(depth)
+        if dtype is None or rows <= 0 or cols <= 0:
+            raise ValueError("Tipo o tamaño de corte no soportado")
+        nbytes = rows * cols * np.dtype(dtype).itemsize
+        if offset + nbytes > len(body):
+            raise ValueError("Cuerpo truncado")
+        frames.append(np.frombuffer(body, dtype=dtype, count=rows * cols, offset=offset).reshape(rows, cols))
+        offset += nbytes
+    return frames
+
+
+def encode_frames(frames):
+    parts = [MAGIC, struct.pack("<I", len(frames))]
+    for frame in frames:
+        depth = 0 if frame.dtype == np.uint8 else 3
+        parts.append(FRAME_HEADER.pack(frame.shape[0], frame.shape[1], depth, 0))
+        parts.append(np.ascontiguousarray(frame).tobytes())
+    return b"".join(parts)
+
+
+def to_unit_range(img):
+    # Igual que el fallback local en C++: 8 bits / 255, 16 bits min-max por corte
+    if img.dtype == np.uint8:
+        return img.astype(np.float32) / 255.0, 0.0, 255.0
+    lo, hi = float(img.min()), float(img.max())
+    scale = hi - lo if hi > lo else 1.0
+    return (img.astype(np.float32) - lo) / scale, lo, scale
+
+
+def from_unit_range(out, dtype, lo, scale):
+    out = np.clip(out, 0.0, 1.0) * scale + lo
+    if dtype == np.uint8:
+        return np.clip(np.rint(out), 0, 255).astype(np.uint8)
+    return np.clip(np.rint(out), -32768, 32767).astype(np.int16)
+
+
+def denoise_frames(frames):
+    if STANDIN:
+        return [frame.copy() for frame in frames]
+
+    results = [None] * len(frames)
+    # Los cortes del mismo tamaño van en un único forward NCHW
+    groups = {}
+    for i, frame in enumerate(frames):
+        groups.setdefault(frame.shape, []).append(i)
+
+    for indices in groups.values():
+        normalized = [to_unit_range(frames[i]) for i in indices]
+        blob = cv2.dnn.blobFromImages([n[0] for n in normalized])
+        with net_lock:
+            net.setInput(blob)
+            output = net.forward()
+        for k, i in enumerate(indices):
+            _, lo, scale = normalized[k]
+            results[i] = from_unit_range(output[k, 0, :, :], frames[i].dtype, lo, scale)
+    return results
+
+
+@app.route('/health', methods=['GET'])
+def health():
+    return jsonify({"status": "ok", "standin": STANDIN})
+
+
+@app.route('/denoise_raw', methods=['POST'])
+@app.route('/denoise_batch', methods=['POST'])
+def denoise_raw():
+    try:
+        frames = decode_frames(request.get_data(cache=False))
+    except (ValueError, struct.error) as e:
+        return jsonify({"error": str(e)}), 400
+
+    try:
+        body = encode_frames(denoise_frames(frames))
+        return Response(body, mimetype='application/octet-stream')
+    except Exception as e:
+        return jsonify({"error": str(e)}), 500
+
 
 @app.route('/denoise', methods=['POST'])
 def denoise_image():
+    # Endpoint PNG original (clientes antiguos)
     try:
         file = request.files['image'].read()
         npimg = np.frombuffer(file, np.uint8)
@@ -19,16 +126,7 @@ def denoise_image():
         if img is None:
             return jsonify({"error": "No se pudo decodificar la imagen"}), 400
 
-        # preprocesar para la red (Float32, normalizado 0-1)
-        img_float = img.astype(np.float32) / 255.0
-        blob = cv2.dnn.blobFromImage(img_float)
-        net.setInput(blob)
-
-        # inferencia
-        output = net.forward()
-
-        clean_img_float = output[0, 0, :, :]
-        clean_img = np.clip(clean_img_float * 255, 0, 255).astype(np.uint8)
+        clean_img = denoise_frames([img])[0]
 
         # devolver la imagen denoised
         _, img_encoded = cv2.imencode('.png', clean_img)
@@ -41,5 +139,8 @@ def denoise_image():
         return jsonify({"error": str(e)}), 500
 
 if __name__ == '__main__':
-    print("Iniciando servidor de IA en puerto 5000...")
-    app.run(host='0.0.0.0', port=5000, debug=False)
\ No newline at end of file
+    # HTTP/1.1 para que el cliente pueda reutilizar la conexión (keep-alive)
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
+    modo = " (stand-in, sin modelo)" if STANDIN else ""
+    print("Iniciando servidor de IA en puerto 5000" + modo + "...")
+    app.run(host='0.0.0.0', port=5000, debug=False, threaded=True)
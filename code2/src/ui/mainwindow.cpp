@@ -15,7 +15,7 @@
 #include <chrono>
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), tabWidget(nullptr), dncnnModelLoaded(false)
+    : QMainWindow(parent), tabWidget(nullptr), dncnnModelLoaded(false), modelLoaderThread(nullptr), denoiseThread(nullptr)
 {
     // Intentar cargar modelo DnCNN al inicio - probar múltiples rutas
     std::vector<std::string> possiblePaths = {
@@ -26,10 +26,15 @@ MainWindow::MainWindow(QWidget *parent)
     };
     
     std::string modelPath;
+    // PRIORIDAD 0: Worker local por memoria compartida (si DenoiseWorker está en marcha)
+    if (dncnnDenoiser.setSharedMemoryWorker()) {
+        std::cout << "[✓] Worker DenoiseWorker detectado (memoria compartida)" << std::endl;
+    }
+    
     // PRIORIDAD 1: Configurar Flask Server
     std::cout << "[INFO] Configurando DnCNN via Flask Server" << std::endl;
-    std::cout << "[INFO] URL: http://localhost:5000/denoise" << std::endl;
-    dncnnDenoiser.setFlaskServer("http://localhost:5000/denoise");
+    std::cout << "[INFO] URL: http://localhost:5000" << std::endl;
+    dncnnDenoiser.setFlaskServer("http://localhost:5000");
     dncnnModelLoaded = true; // Flask está configurado
     std::cout << "[✓] Flask server configurado exitosamente" << std::endl;
     
@@ -49,27 +54,75 @@ MainWindow::MainWindow(QWidget *parent)
         }
     }
     
+    setupUI();
+    setWindowTitle("Medical Vision App - Clean Architecture");
+    resize(1400, 900);
+    
+    // El modelo local se carga en segundo plano: la ventana queda usable de inmediato
     if (fileFound) {
-        std::cout << "[INFO] Cargando modelo local como fallback desde: " << modelPath << std::endl;
-        bool localLoaded = dncnnDenoiser.loadModel(modelPath);
-        if (localLoaded) {
-            std::cout << "[✓] Modelo DnCNN local cargado (fallback disponible)" << std::endl;
-        } else {
-            std::cerr << "[!] Modelo encontrado pero falló al cargar (solo Flask disponible)" << std::endl;
-        }
+        startModelLoading(modelPath);
     } else {
         std::cout << "[!] Modelo local no encontrado (solo Flask disponible)" << std::endl;
     }
-    
-    setupUI();
-    setWindowTitle("Medical Vision App - Clean Architecture");
-    resize(1400, 900);
 }
 
 MainWindow::~MainWindow() {
+    // El hilo de carga escribe en pendingDenoiser y el de DnCNN usa dncnnDenoiser:
+    // esperar a que terminen
+    if (modelLoaderThread) {
+        modelLoaderThread->wait();
+    }
+    if (denoiseThread) {
+        denoiseThread->wait();
+    }
     // Qt se encarga de la limpieza de memoria
 }
 
+void MainWindow::startModelLoading(const std::string& modelPath) {
+    std::cout << "[INFO] Cargando modelo local como fallback (segundo plano): " << modelPath << std::endl;
+    if (checkUseDnCNN) {
+        checkUseDnCNN->setToolTip("Modelo local cargando... (Flask disponible)");
+    }
+    
+    // Instancia propia del hilo; al terminar solo se traspasa el modelo local
+    pendingDenoiser = std::make_unique<Preprocessing::DnCNNDenoiser>();
+    Preprocessing::DnCNNDenoiser* denoiser = pendingDenoiser.get();
+    modelLoaderThread = QThread::create([denoiser, modelPath]() {
+        if (denoiser->loadModel(modelPath)) {
+            denoiser->warmUp();
+        }
+    });
+    connect(modelLoaderThread, &QThread::finished, this, &MainWindow::onModelLoaded);
+    connect(modelLoaderThread, &QThread::finished, modelLoaderThread, &QObject::deleteLater);
+    modelLoaderThread->start();
+}
+
+void MainWindow::onModelLoaded() {
+    // Se ejecuta en el hilo de la interfaz (conexión en cola desde QThread::finished)
+    modelLoaderThread = nullptr;
+    if (pendingDenoiser && pendingDenoiser->isLocalModelLoaded()) {
+        // El hilo de DnCNN puede estar usando dncnnDenoiser: esperar antes del traspaso
+        if (denoiseThread) {
+            denoiseThread->wait();
+        }
+        // Solo el modelo: el worker de memoria compartida y Flask configurados
+        // después de lanzar la carga se conservan
+        dncnnDenoiser.takeLocalModel(*pendingDenoiser);
+        dncnnModelLoaded = true;
+        std::cout << "[✓] Modelo DnCNN local cargado (fallback disponible)" << std::endl;
+    } else {
+        std::cerr << "[!] Modelo encontrado pero falló al cargar (solo Flask disponible)" << std::endl;
+    }
+    pendingDenoiser.reset();
+    
+    if (checkUseDnCNN) {
+        checkUseDnCNN->setEnabled(dncnnModelLoaded);
+        checkUseDnCNN->setToolTip(dncnnDenoiser.isLocalModelLoaded()
+            ? "Flask con modelo local como fallback"
+            : "Solo Flask (modelo local no disponible)");
+    }
+}
+
 // CONFIGURACIÓN DE LA INTERFAZ
 
 void MainWindow::setupUI() {
@@ -1235,21 +1288,62 @@ void MainWindow::onApplyPreprocessing() {
     
     // Imagen de trabajo (empezar con la original)
     cv::Mat working = currentSlice.original8bit.clone();
-    int filtersApplied = 0;
     
+    // === FASE 1: REDUCCIÓN DE RUIDO ===
+    
+    // === 1. Red Neuronal DnCNN ===
+    if (checkUseDnCNN->isChecked() && dncnnModelLoaded) {
+        logMessage(textPreprocessingLog, "[1/6] Aplicando Red Neuronal DnCNN...");
+        
+        // La inferencia (worker, Flask u OpenCV DNN) corre fuera del hilo de la
+        // interfaz; el resto de filtros sigue en onDnCNNFinished
+        btnApplyPreprocessing->setEnabled(false);
+        auto result = std::make_shared<cv::Mat>();
+        Preprocessing::DnCNNDenoiser* denoiser = &dncnnDenoiser;
+        const int sliceIndex = currentSlice.sliceIndex;
+        const std::string datasetPath = currentDatasetPath;
+        denoiseThread = QThread::create([denoiser, working, result]() {
+            try {
+                *result = denoiser->denoise(working);
+            } catch (const std::exception& e) {
+                std::cerr << "[!] Error en DnCNN: " << e.what() << std::endl;
+            }
+        });
+        connect(denoiseThread, &QThread::finished, this, [this, result, sliceIndex, datasetPath]() {
+            onDnCNNFinished(*result, sliceIndex, datasetPath);
+        });
+        connect(denoiseThread, &QThread::finished, denoiseThread, &QObject::deleteLater);
+        denoiseThread->start();
+        return;
+    }
+    if (checkUseDnCNN->isChecked() && !dncnnModelLoaded) {
+        logMessage(textPreprocessingLog, "[!] DnCNN no disponible (modelo no cargado)");
+    }
+    applyRemainingFilters(working, 0);
+}
+
+void MainWindow::onDnCNNFinished(const cv::Mat& denoised, int sliceIndex, const std::string& datasetPath) {
+    // Se ejecuta en el hilo de la interfaz (conexión en cola desde QThread::finished)
+    denoiseThread = nullptr;
+    btnApplyPreprocessing->setEnabled(true);
+    
+    // Se cambió de corte o de dataset mientras tanto: el resultado ya no aplica
+    if (sliceIndex != currentSlice.sliceIndex || datasetPath != currentDatasetPath || !currentSlice.hasData()) {
+        logMessage(textPreprocessingLog, "[!] Corte cambiado durante DnCNN; resultado descartado");
+        return;
+    }
+    
+    if (denoised.empty()) {
+        logMessage(textPreprocessingLog, "[!] DnCNN falló; se continúa sin él");
+        applyRemainingFilters(currentSlice.original8bit.clone(), 0);
+        return;
+    }
+    logMessage(textPreprocessingLog, "   DnCNN aplicado exitosamente");
+    applyRemainingFilters(denoised, 1);
+}
+
+void MainWindow::applyRemainingFilters(cv::Mat working, int filtersApplied) {
     try {
-        // === FASE 1: REDUCCIÓN DE RUIDO ===
-        
-        // === 1. Red Neuronal DnCNN ===
-        if (checkUseDnCNN->isChecked() && dncnnModelLoaded) {
-            logMessage(textPreprocessingLog, "[1/6] Aplicando Red Neuronal DnCNN...");
-            working = dncnnDenoiser.denoise(working);
-            logMessage(textPreprocessingLog, "   DnCNN aplicado exitosamente");
-            filtersApplied++;
-        } else if (checkUseDnCNN->isChecked() && !dncnnModelLoaded) {
-            logMessage(textPreprocessingLog, "[!] DnCNN no disponible (modelo no cargado)");
-        }
-        
         // === 2. Filtro Gaussiano ===
         if (checkUseGaussian->isChecked()) {
             int kernel = sliderGaussianKernel->value();
@@ -21,11 +21,13 @@
 #include <QMessageBox>
 #include <QPixmap>
 #include <QImage>
+#include <QThread>
 
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
 
 // Backend Modules
 #include "../core/dicom_reader.h"
@@ -185,6 +187,9 @@ private:
     
     Preprocessing::DnCNNDenoiser dncnnDenoiser;
     bool dncnnModelLoaded;
+    std::unique_ptr<Preprocessing::DnCNNDenoiser> pendingDenoiser;  // Escrito por el hilo de carga
+    QThread* modelLoaderThread;
+    QThread* denoiseThread;                 // DnCNN de onApplyPreprocessing (nullptr = inactivo)
     
     // Funciones auxiliares
     void setupUI();
@@ -195,6 +200,12 @@ private:
     void setupTabVisualization();
     void setupTabMetrics();
     
+    void startModelLoading(const std::string& modelPath);
+    void onModelLoaded();
+    void onDnCNNFinished(const cv::Mat& denoised, int sliceIndex, const std::string& datasetPath);
+    // Filtros 2-6, resultado y métricas de onApplyPreprocessing
+    void applyRemainingFilters(cv::Mat working, int filtersApplied);
+    
     void loadSlice(int index);
     void updateImageDisplay(QLabel* label, const cv::Mat& image);
     QImage cvMatToQImage(const cv::Mat& mat);